@@ -0,0 +1,154 @@
+//--------------------------------------------------------------------------------------
+// File: LZCodec.h
+//
+// Decoder for the portable LZ77 stream written by 'xbcompress -codec:lz' and '-codec:lzhc'.
+// Shared by the tool and by ReadCompressedData, and only uses standard C++ so it also
+// builds on non-Windows platforms.
+//
+// The stream is a series of sequences in the style of LZ4:
+//
+//   token       high nibble = literal count, low nibble = match length - 4
+//               (a nibble of 15 is extended by bytes that are added until one is < 255)
+//   literals
+//   offset      16-bit little-endian distance back to the match (1 to 65535)
+//
+// The last sequence holds literals only, and ends the stream.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <sal.h>
+#else
+#ifndef _In_reads_bytes_
+#define _In_reads_bytes_(size)
+#endif
+#ifndef _Out_writes_bytes_
+#define _Out_writes_bytes_(size)
+#endif
+#ifndef _Out_writes_bytes_to_
+#define _Out_writes_bytes_to_(size, count)
+#endif
+#ifndef _Use_decl_annotations_
+#define _Use_decl_annotations_
+#endif
+#endif
+
+namespace LZ
+{
+    constexpr size_t c_MinMatch = 4;
+    constexpr size_t c_MaxOffset = 65535;
+
+    // Returns false if the stream is malformed or does not expand to exactly destLen bytes
+    inline bool Decompress(
+        _In_reads_bytes_(srcLen) const uint8_t* src, size_t srcLen,
+        _Out_writes_bytes_(destLen) uint8_t* dest, size_t destLen) noexcept
+    {
+        if ((!src && srcLen) || (!dest && destLen))
+            return false;
+
+        size_t ip = 0;
+        size_t op = 0;
+
+        for (;;)
+        {
+            if (ip >= srcLen)
+                return false;
+
+            const uint8_t token = src[ip++];
+
+            size_t literalCount = token >> 4;
+            if (literalCount == 15)
+            {
+                uint8_t b;
+                do
+                {
+                    if (ip >= srcLen)
+                        return false;
+
+                    b = src[ip++];
+                    literalCount += b;
+                } while (b == 255);
+            }
+
+            if (literalCount > srcLen - ip || literalCount > destLen - op)
+                return false;
+
+            if (literalCount)
+            {
+                memcpy(dest + op, src + ip, literalCount);
+                ip += literalCount;
+                op += literalCount;
+            }
+
+            if (ip == srcLen)
+                break;
+
+            if (srcLen - ip < 2)
+                return false;
+
+            const size_t offset = size_t(src[ip]) | (size_t(src[ip + 1]) << 8);
+            ip += 2;
+
+            if (!offset || offset > op)
+                return false;
+
+            size_t length = token & 0xF;
+            if (length == 15)
+            {
+                uint8_t b;
+                do
+                {
+                    if (ip >= srcLen)
+                        return false;
+
+                    b = src[ip++];
+                    length += b;
+                } while (b == 255);
+            }
+            length += c_MinMatch;
+
+            if (length > destLen - op)
+                return false;
+
+            uint8_t* out = dest + op;
+            const uint8_t* match = out - offset;
+            op += length;
+
+            if (offset >= length)
+            {
+                memcpy(out, match, length);
+            }
+            else if (offset >= sizeof(uint64_t))
+            {
+                // Overlapping copies are still safe 8 bytes at a time when the source is at least 8 bytes back
+                for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t))
+                {
+                    memcpy(out, match, sizeof(uint64_t));
+                    out += sizeof(uint64_t);
+                    match += sizeof(uint64_t);
+                }
+                while (length--)
+                {
+                    *out++ = *match++;
+                }
+            }
+            else
+            {
+                while (length--)
+                {
+                    *out++ = *match++;
+                }
+            }
+        }
+
+        return op == destLen;
+    }
+}
@@ -10,12 +10,16 @@
 
 #include "pch.h"
 #include "ReadCompressedData.h"
+#include "LZCodec.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <exception>
 #include <fstream>
 #include <memory>
 #include <stdexcept>
+#include <thread>
 
 #ifndef NTDDI_WIN10_FE
 #undef WINAPI_FAMILY_PARTITION
@@ -33,6 +37,7 @@ namespace
 {
     constexpr uint8_t c_CFileSignatureLen = 8;
     constexpr uint8_t c_CFileVersion = 0x41;
+    constexpr uint8_t c_CFileVersionChunked = 0x42;
 
     const uint8_t c_Signature[c_CFileSignatureLen] = { 0x41, 0x46, 0x43, 0x57, 0x47, 0x50, 0x53, 0x4d };
 
@@ -40,14 +45,29 @@ namespace
     struct CFileHeader
     {
         uint8_t     magic[c_CFileSignatureLen]; // Must match c_Signature below
-        uint8_t     mode;                       // COMPRESS_ALGORITHM_x enum
+        uint8_t     mode;                       // COMPRESS_ALGORITHM_x enum or c_CompressModeLZ
         uint8_t     version;
         wchar_t     lastChar;
         uint32_t    uncompressedSized;
     };
+
+    // Chunked files (xbcompress -chunk) follow the header with an index of independently compressed chunks
+    struct CChunkHeader
+    {
+        uint32_t    chunkSize;                  // Uncompressed size of every chunk but the last
+        uint32_t    chunkCount;
+    };
+
+    struct CChunkEntry
+    {
+        uint32_t    offset;                     // From the start of the file
+        uint32_t    compressedSize;             // Same as the uncompressed size if the chunk is stored
+    };
 #pragma pack(pop)
 
     static_assert(sizeof(CFileHeader) == 16, "File header size mismatch");
+    static_assert(sizeof(CChunkHeader) == 8, "Chunk header size mismatch");
+    static_assert(sizeof(CChunkEntry) == 8, "Chunk entry size mismatch");
 
     PVOID SimpleAlloc(PVOID, SIZE_T Size)
     {
@@ -61,95 +81,214 @@ namespace
 
     struct decompressor_closer { void operator()(void* h) { if (h) CloseDecompressor(static_cast<DECOMPRESSOR_HANDLE>(h)); } };
 
-    HRESULT DecompressFile(
-        _In_reads_bytes_(dataLen) const void* data,
+    // Portable LZ stream written by 'xbcompress -codec:lz' or '-codec:lzhc' (see LZCodec.h)
+    constexpr uint8_t c_CompressModeLZ = 0x80;
+
+    bool IsSupportedMode(uint8_t mode) noexcept
+    {
+        return mode == COMPRESS_ALGORITHM_MSZIP || mode == COMPRESS_ALGORITHM_LZMS || mode == c_CompressModeLZ;
+    }
+
+    // Expands one block with the Compression API or the portable LZ decoder, depending on the file mode
+    class BlockDecoder
+    {
+    public:
+        explicit BlockDecoder(uint8_t mode) noexcept : m_mode(mode) {}
+
+        HRESULT Decompress(
+            _In_reads_bytes_(srcLen) const uint8_t* src,
+            size_t srcLen,
+            _Out_writes_bytes_(destLen) uint8_t* dest,
+            size_t destLen)
+        {
+            if (m_mode == c_CompressModeLZ)
+            {
+                // LZ blocks that didn't compress are stored as-is, in single-stream files as well as chunks
+                if (srcLen == destLen)
+                {
+                    memcpy(dest, src, destLen);
+                    return S_OK;
+                }
+
+                return LZ::Decompress(src, srcLen, dest, destLen) ? S_OK : E_FAIL;
+            }
+
+            if (!m_decompressor)
+            {
+                COMPRESS_ALLOCATION_ROUTINES allocData = { SimpleAlloc, SimpleFree, nullptr };
+
+                DECOMPRESSOR_HANDLE h = nullptr;
+                if (!CreateDecompressor(
+                    static_cast<DWORD>(m_mode),
+                    &allocData,
+                    &h))
+                {
+                    return HRESULT_FROM_WIN32(GetLastError());
+                }
+
+                m_decompressor.reset(h);
+            }
+
+            SIZE_T expandedSize;
+            if (!::Decompress(
+                static_cast<DECOMPRESSOR_HANDLE>(m_decompressor.get()),
+                src,
+                srcLen,
+                dest,
+                destLen,
+                &expandedSize))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            if (expandedSize != destLen)
+                return E_FAIL;
+
+            return S_OK;
+        }
+
+    private:
+        uint8_t                                     m_mode;
+        std::unique_ptr<void, decompressor_closer>  m_decompressor;
+    };
+
+    // Expands the chunks of a chunked file across worker threads, each with its own decompressor
+    HRESULT DecompressChunks(
+        _In_reads_bytes_(dataLen) const uint8_t* data,
         size_t dataLen,
         std::vector<uint8_t>& blob)
     {
-        if (!data || !dataLen)
-            return E_INVALIDARG;
+        auto hdr = reinterpret_cast<const CFileHeader*>(data);
 
-        if (dataLen <= sizeof(CFileHeader))
+        if (dataLen < sizeof(CFileHeader) + sizeof(CChunkHeader))
             return E_FAIL;
 
-        auto hdr = reinterpret_cast<const CFileHeader*>(data);
-        if (memcmp(hdr, c_Signature, c_CFileSignatureLen) != 0)
+        auto chunkHeader = reinterpret_cast<const CChunkHeader*>(data + sizeof(CFileHeader));
+        const size_t uncompressedSize = hdr->uncompressedSized;
+        const size_t chunkSize = chunkHeader->chunkSize;
+        const size_t chunkCount = chunkHeader->chunkCount;
+
+        if (!chunkSize || chunkCount != (uncompressedSize + chunkSize - 1) / chunkSize)
             return E_FAIL;
 
-        if (hdr->version != c_CFileVersion)
-            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        if ((dataLen - sizeof(CFileHeader) - sizeof(CChunkHeader)) / sizeof(CChunkEntry) < chunkCount)
+            return E_FAIL;
 
-        switch (hdr->mode)
-        {
-        case COMPRESS_ALGORITHM_MSZIP:
-        case COMPRESS_ALGORITHM_LZMS:
-            break;
+        auto entries = reinterpret_cast<const CChunkEntry*>(data + sizeof(CFileHeader) + sizeof(CChunkHeader));
 
-        default:
-            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            if (uint64_t(entries[chunk].offset) + entries[chunk].compressedSize > dataLen)
+                return E_FAIL;
         }
 
-        COMPRESS_ALLOCATION_ROUTINES allocData = { SimpleAlloc, SimpleFree, nullptr };
+        blob.resize(uncompressedSize);
 
-        std::unique_ptr<void, decompressor_closer> decompressor;
+        std::atomic<size_t> nextChunk(0);
+
+        auto worker = [&]() -> HRESULT
         {
-            DECOMPRESSOR_HANDLE h = nullptr;
-            if (!CreateDecompressor(
-                static_cast<DWORD>(hdr->mode),
-                &allocData,
-                &h))
+            BlockDecoder decoder(hdr->mode);
+
+            for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
             {
-                return HRESULT_FROM_WIN32(GetLastError());
+                const size_t offset = chunk * chunkSize;
+                const size_t chunkLen = std::min(chunkSize, uncompressedSize - offset);
+                const CChunkEntry& entry = entries[chunk];
+
+                if (entry.compressedSize == chunkLen)
+                {
+                    memcpy(blob.data() + offset, data + entry.offset, chunkLen);
+                    continue;
+                }
+
+                HRESULT hr = decoder.Decompress(data + entry.offset, entry.compressedSize, blob.data() + offset, chunkLen);
+                if (FAILED(hr))
+                    return hr;
             }
 
-            decompressor.reset(h);
-        }
+            return S_OK;
+        };
 
-        // Query decompressed buffer size.
-        auto payload = reinterpret_cast<const void*>(reinterpret_cast<const uint8_t*>(data) + sizeof(CFileHeader));
-        size_t payloadLen = dataLen - sizeof(CFileHeader);
+        const size_t workers = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), chunkCount));
+
+        std::vector<HRESULT> results(workers, S_OK);
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
 
-        SIZE_T bufferSize;
-        if (!Decompress(
-            static_cast<DECOMPRESSOR_HANDLE>(decompressor.get()),
-            payload,
-            payloadLen,
-            nullptr,
-            0,
-            &bufferSize))
+        auto joinAll = [&threads]()
+            {
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+            };
+
+        try
         {
-            DWORD errorCode = GetLastError();
-            if (errorCode != ERROR_INSUFFICIENT_BUFFER)
+            for (size_t j = 1; j < workers; ++j)
             {
-                return HRESULT_FROM_WIN32(GetLastError());
+                threads.emplace_back([&results, &worker, j]() { results[j] = worker(); });
             }
         }
+        catch (const std::exception&)
+        {
+            // Carry on with the threads that did start
+        }
 
-        if (SIZE_T(hdr->uncompressedSized) != bufferSize)
-            return E_FAIL;
+        // Joinable threads must never be destroyed, even if the caller's share throws
+        try
+        {
+            results[0] = worker();
+        }
+        catch (...)
+        {
+            joinAll();
+            throw;
+        }
 
-        blob.resize(bufferSize);
+        joinAll();
 
-        SIZE_T blobSize;
-        if (!Decompress(
-            static_cast<DECOMPRESSOR_HANDLE>(decompressor.get()),
-            payload,
-            payloadLen,
-            blob.data(),
-            bufferSize,
-            &blobSize))
+        for (auto hr : results)
         {
-            return HRESULT_FROM_WIN32(GetLastError());
+            if (FAILED(hr))
+                return hr;
         }
 
-        if (blobSize > UINT32_MAX)
-        {
+        return S_OK;
+    }
+
+    HRESULT DecompressFile(
+        _In_reads_bytes_(dataLen) const void* data,
+        size_t dataLen,
+        std::vector<uint8_t>& blob)
+    {
+        if (!data || !dataLen)
+            return E_INVALIDARG;
+
+        if (dataLen <= sizeof(CFileHeader))
+            return E_FAIL;
+
+        auto hdr = reinterpret_cast<const CFileHeader*>(data);
+        if (memcmp(hdr, c_Signature, c_CFileSignatureLen) != 0)
             return E_FAIL;
-        }
 
-        blob.resize(blobSize);
+        if (hdr->version != c_CFileVersion && hdr->version != c_CFileVersionChunked)
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 
-        return S_OK;
+        if (!IsSupportedMode(hdr->mode))
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        if (hdr->version == c_CFileVersionChunked)
+            return DecompressChunks(static_cast<const uint8_t*>(data), dataLen, blob);
+
+        auto payload = reinterpret_cast<const uint8_t*>(data) + sizeof(CFileHeader);
+        size_t payloadLen = dataLen - sizeof(CFileHeader);
+
+        blob.resize(hdr->uncompressedSized);
+
+        BlockDecoder decoder(hdr->mode);
+        return decoder.Decompress(payload, payloadLen, blob.data(), blob.size());
     }
 }
 
@@ -184,3 +323,213 @@ std::vector<uint8_t> DX::ReadCompressedData(_In_z_ const wchar_t* name)
 
     return blob;
 }
+
+
+//--------------------------------------------------------------------------------------
+// CompressedDataReader
+//--------------------------------------------------------------------------------------
+class DX::CompressedDataReader::Impl
+{
+public:
+    explicit Impl(_In_z_ const wchar_t* name) :
+        m_file(name, std::ios::in | std::ios::binary | std::ios::ate),
+        m_chunked(false),
+        m_uncompressedSize(0),
+        m_chunkSize(0),
+        m_position(0),
+        m_cachedChunk(SIZE_MAX)
+    {
+        if (!m_file)
+            throw std::runtime_error("CompressedDataReader");
+
+        const auto fileLen = static_cast<uint64_t>(m_file.tellg());
+
+        CFileHeader hdr = {};
+        ReadFileData(0, &hdr, sizeof(hdr));
+
+        if (memcmp(&hdr, c_Signature, c_CFileSignatureLen) != 0)
+            throw std::runtime_error("CompressedDataReader");
+
+        if (hdr.version != c_CFileVersion && hdr.version != c_CFileVersionChunked)
+            throw std::runtime_error("CompressedDataReader");
+
+        if (!IsSupportedMode(hdr.mode))
+            throw std::runtime_error("CompressedDataReader");
+
+        m_decoder = std::make_unique<BlockDecoder>(hdr.mode);
+        m_uncompressedSize = hdr.uncompressedSized;
+
+        if (hdr.version == c_CFileVersionChunked)
+        {
+            CChunkHeader chunkHeader = {};
+            ReadFileData(sizeof(CFileHeader), &chunkHeader, sizeof(chunkHeader));
+
+            m_chunked = true;
+            m_chunkSize = chunkHeader.chunkSize;
+
+            if (!m_chunkSize || chunkHeader.chunkCount != (m_uncompressedSize + m_chunkSize - 1) / m_chunkSize)
+                throw std::runtime_error("CompressedDataReader");
+
+            if (sizeof(CFileHeader) + sizeof(CChunkHeader) + sizeof(CChunkEntry) * uint64_t(chunkHeader.chunkCount) > fileLen)
+                throw std::runtime_error("CompressedDataReader");
+
+            m_index.resize(chunkHeader.chunkCount);
+            ReadFileData(sizeof(CFileHeader) + sizeof(CChunkHeader), m_index.data(), sizeof(CChunkEntry) * m_index.size());
+        }
+        else
+        {
+            // Single-stream files are treated as one chunk
+            if (fileLen <= sizeof(CFileHeader) || fileLen > UINT32_MAX)
+                throw std::runtime_error("CompressedDataReader");
+
+            m_chunkSize = std::max<size_t>(m_uncompressedSize, 1);
+            m_index.push_back({ static_cast<uint32_t>(sizeof(CFileHeader)), static_cast<uint32_t>(fileLen - sizeof(CFileHeader)) });
+        }
+
+        // Scratch buffers are sized once here, so reads never reallocate
+        size_t maxCompressed = 0;
+        for (auto& entry : m_index)
+        {
+            if (uint64_t(entry.offset) + entry.compressedSize > fileLen)
+                throw std::runtime_error("CompressedDataReader");
+
+            maxCompressed = std::max<size_t>(maxCompressed, entry.compressedSize);
+        }
+
+        // The chunk size comes from the file, and no chunk is larger than the data it covers
+        m_compressed.reset(new uint8_t[maxCompressed]);
+        m_chunk.reset(new uint8_t[std::max<size_t>(1, std::min(m_chunkSize, m_uncompressedSize))]);
+    }
+
+    size_t GetSize() const noexcept { return m_uncompressedSize; }
+
+    void Read(size_t offset, _Out_writes_bytes_(size) void* buffer, size_t size)
+    {
+        if (!buffer && size > 0)
+            throw std::invalid_argument("CompressedDataReader");
+
+        if (offset > m_uncompressedSize || size > m_uncompressedSize - offset)
+            throw std::out_of_range("CompressedDataReader");
+
+        auto dest = static_cast<uint8_t*>(buffer);
+
+        while (size > 0)
+        {
+            const size_t chunk = offset / m_chunkSize;
+            const size_t chunkStart = chunk * m_chunkSize;
+            const size_t chunkLen = std::min(m_chunkSize, m_uncompressedSize - chunkStart);
+            const size_t within = offset - chunkStart;
+            const size_t count = std::min(size, chunkLen - within);
+
+            if (count == chunkLen && chunk != m_cachedChunk)
+            {
+                // Whole chunks go straight into the caller's buffer
+                DecodeChunk(chunk, dest, chunkLen);
+            }
+            else
+            {
+                if (chunk != m_cachedChunk)
+                {
+                    m_cachedChunk = SIZE_MAX;
+                    DecodeChunk(chunk, m_chunk.get(), chunkLen);
+                    m_cachedChunk = chunk;
+                }
+
+                memcpy(dest, m_chunk.get() + within, count);
+            }
+
+            dest += count;
+            offset += count;
+            size -= count;
+        }
+    }
+
+    size_t ReadNext(_Out_writes_bytes_to_(size, return) void* buffer, size_t size)
+    {
+        const size_t count = std::min(size, m_uncompressedSize - m_position);
+        Read(m_position, buffer, count);
+        m_position += count;
+        return count;
+    }
+
+    void Seek(size_t offset)
+    {
+        if (offset > m_uncompressedSize)
+            throw std::out_of_range("CompressedDataReader");
+
+        m_position = offset;
+    }
+
+    size_t GetPosition() const noexcept { return m_position; }
+
+private:
+    void ReadFileData(uint64_t offset, _Out_writes_bytes_(size) void* buffer, size_t size)
+    {
+        m_file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        m_file.read(static_cast<char*>(buffer), static_cast<std::streamsize>(size));
+        if (!m_file)
+            throw std::runtime_error("CompressedDataReader");
+    }
+
+    void DecodeChunk(size_t chunk, _Out_writes_bytes_(chunkLen) uint8_t* dest, size_t chunkLen)
+    {
+        const CChunkEntry& entry = m_index[chunk];
+
+        // Chunks that didn't compress are stored as-is
+        if (m_chunked && entry.compressedSize == chunkLen)
+        {
+            ReadFileData(entry.offset, dest, chunkLen);
+            return;
+        }
+
+        ReadFileData(entry.offset, m_compressed.get(), entry.compressedSize);
+
+        if (FAILED(m_decoder->Decompress(m_compressed.get(), entry.compressedSize, dest, chunkLen)))
+            throw std::runtime_error("CompressedDataReader");
+    }
+
+    std::ifstream                                   m_file;
+    bool                                            m_chunked;
+    size_t                                          m_uncompressedSize;
+    size_t                                          m_chunkSize;
+    size_t                                          m_position;
+    size_t                                          m_cachedChunk;
+    std::vector<CChunkEntry>                        m_index;
+    std::unique_ptr<uint8_t[]>                      m_compressed;
+    std::unique_ptr<uint8_t[]>                      m_chunk;
+    std::unique_ptr<BlockDecoder>                   m_decoder;
+};
+
+DX::CompressedDataReader::CompressedDataReader(_In_z_ const wchar_t* name) :
+    pImpl(std::make_unique<Impl>(name))
+{
+}
+
+DX::CompressedDataReader::CompressedDataReader(CompressedDataReader&&) noexcept = default;
+DX::CompressedDataReader& DX::CompressedDataReader::operator= (CompressedDataReader&&) noexcept = default;
+DX::CompressedDataReader::~CompressedDataReader() = default;
+
+size_t DX::CompressedDataReader::GetSize() const noexcept
+{
+    return pImpl->GetSize();
+}
+
+void DX::CompressedDataReader::Read(size_t offset, _Out_writes_bytes_(size) void* buffer, size_t size)
+{
+    pImpl->Read(offset, buffer, size);
+}
+
+size_t DX::CompressedDataReader::ReadNext(_Out_writes_bytes_to_(size, return) void* buffer, size_t size)
+{
+    return pImpl->ReadNext(buffer, size);
+}
+
+void DX::CompressedDataReader::Seek(size_t offset)
+{
+    pImpl->Seek(offset);
+}
+
+size_t DX::CompressedDataReader::GetPosition() const noexcept
+{
+    return pImpl->GetPosition();
+}
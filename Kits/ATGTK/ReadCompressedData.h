@@ -10,6 +10,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #ifdef _GAMING_DESKTOP
@@ -20,4 +21,39 @@
 namespace DX
 {
     std::vector<uint8_t> ReadCompressedData(_In_z_ const wchar_t* name);
+
+    // Random-access reader for files compressed with the 'xbcompress' tool. For files written with
+    // '-chunk', each read decompresses only the chunks it overlaps. Other files are decompressed
+    // in full on the first read. A reader is not thread-safe, so use one reader per thread.
+    class CompressedDataReader
+    {
+    public:
+        explicit CompressedDataReader(_In_z_ const wchar_t* name);
+
+        CompressedDataReader(CompressedDataReader&&) noexcept;
+        CompressedDataReader& operator= (CompressedDataReader&&) noexcept;
+
+        CompressedDataReader(CompressedDataReader const&) = delete;
+        CompressedDataReader& operator= (CompressedDataReader const&) = delete;
+
+        ~CompressedDataReader();
+
+        // Size of the uncompressed content in bytes
+        size_t GetSize() const noexcept;
+
+        // Reads [offset, offset + size) of the uncompressed content
+        void Read(size_t offset, _Out_writes_bytes_(size) void* buffer, size_t size);
+
+        // Streaming reads from the current position, returning the bytes read (0 at the end)
+        size_t ReadNext(_Out_writes_bytes_to_(size, return) void* buffer, size_t size);
+
+        void Seek(size_t offset);
+        size_t GetPosition() const noexcept;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
 }
@@ -17,9 +17,35 @@
 
 #include "BC.h"
 
+// Batched SIMD encoding of BC1 color blocks (selected at runtime, SSE4.1 or AVX)
+#if defined(_XM_SSE_INTRINSICS_) && !defined(COLOR_WEIGHTS) && ((defined(_MSC_VER) && !defined(__clang__)) || defined(__SSE4_1__))
+#define BC_BATCH_SIMD
+#if (defined(_MSC_VER) && !defined(__clang__)) || defined(__AVX__)
+#define BC_BATCH_AVX
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+#endif
+
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
+// The batched BC1 encoder must match the scalar one bit for bit, so the encoders are
+// compiled with strict IEEE semantics and no FMA contraction regardless of /fp:fast.
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma float_control(precise, on, push)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
 namespace
 {
     //-------------------------------------------------------------------------------------
@@ -717,234 +743,1145 @@ namespace
         pBC->bitmap = 0x00000000;
     }
 #endif // COLOR_WEIGHTS
-}
 
 
-//=====================================================================================
-// Entry points
-//=====================================================================================
+    //-------------------------------------------------------------------------------------
+    // Loads a BC1 block, applying alpha dithering if requested
+    //-------------------------------------------------------------------------------------
+    void LoadBC1Block(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA *pBlock,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor,
+        uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_DITHER_A)
+        {
+            float fError[NUM_PIXELS_PER_BLOCK] = {};
 
-//-------------------------------------------------------------------------------------
-// BC1 Compression
-//-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-void DirectX::D3DXDecodeBC1(XMVECTOR *pColor, const uint8_t *pBC) noexcept
-{
-    auto pBC1 = reinterpret_cast<const D3DX_BC1 *>(pBC);
-    DecodeBC1(pColor, pBC1, true);
-}
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                HDRColorA clr;
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&clr), pColor[i]);
 
-_Use_decl_annotations_
-void DirectX::D3DXEncodeBC1(uint8_t *pBC, const XMVECTOR *pColor, float threshold, uint32_t flags) noexcept
-{
-    assert(pBC && pColor);
+                float fAlph = clr.a + fError[i];
+
+                pBlock[i].r = clr.r;
+                pBlock[i].g = clr.g;
+                pBlock[i].b = clr.b;
+                pBlock[i].a = static_cast<float>(static_cast<int32_t>(clr.a + fError[i] + 0.5f));
+
+                float fDiff = fAlph - pBlock[i].a;
+
+                if (3 != (i & 3))
+                {
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&pBlock[i]), pColor[i]);
+            }
+        }
+    }
 
-    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
 
-    if (flags & BC_FLAGS_DITHER_A)
+    //-------------------------------------------------------------------------------------
+    // Encodes the alpha half of a BC3 block
+    //-------------------------------------------------------------------------------------
+    void EncodeBC3Alpha(
+        _Out_ D3DX_BC3 *pBC3,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *Color,
+        uint32_t flags) noexcept
     {
+        // Quantize block to A8, using Floyd Stienberg error diffusion.  This 
+        // increases the chance that colors will map directly to the quantized 
+        // axis endpoints.
+        float fAlpha[NUM_PIXELS_PER_BLOCK] = {};
         float fError[NUM_PIXELS_PER_BLOCK] = {};
 
+        float fMinAlpha = Color[0].a;
+        float fMaxAlpha = Color[0].a;
+
         for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
-            HDRColorA clr;
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&clr), pColor[i]);
-
-            float fAlph = clr.a + fError[i];
-
-            Color[i].r = clr.r;
-            Color[i].g = clr.g;
-            Color[i].b = clr.b;
-            Color[i].a = static_cast<float>(static_cast<int32_t>(clr.a + fError[i] + 0.5f));
+            float fAlph = Color[i].a;
+            if (flags & BC_FLAGS_DITHER_A)
+                fAlph += fError[i];
 
-            float fDiff = fAlph - Color[i].a;
+            fAlpha[i] = static_cast<float>(static_cast<int32_t>(fAlph * 255.0f + 0.5f)) * (1.0f / 255.0f);
 
-            if (3 != (i & 3))
-            {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
-            }
+            if (fAlpha[i] < fMinAlpha)
+                fMinAlpha = fAlpha[i];
+            else if (fAlpha[i] > fMaxAlpha)
+                fMaxAlpha = fAlpha[i];
 
-            if (i < 12)
+            if (flags & BC_FLAGS_DITHER_A)
             {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
-
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
+                float fDiff = fAlph - fAlpha[i];
 
                 if (3 != (i & 3))
                 {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
                 }
             }
         }
-    }
-    else
-    {
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+
+#ifdef COLOR_WEIGHTS
+        if (0.0f == fMaxAlpha)
         {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
+            EncodeSolidBC1(&pBC3->dxt1, Color);
+            pBC3->alpha[0] = 0x00;
+            pBC3->alpha[1] = 0x00;
+            memset(pBC3->bitmap, 0x00, 6);
         }
-    }
+#endif
 
-    auto pBC1 = reinterpret_cast<D3DX_BC1 *>(pBC);
-    EncodeBC1(pBC1, Color, true, threshold, flags);
-}
+        // Alpha part
+        if (1.0f == fMinAlpha)
+        {
+            pBC3->alpha[0] = 0xff;
+            pBC3->alpha[1] = 0xff;
+            memset(pBC3->bitmap, 0x00, 6);
+            return;
+        }
 
+        // Optimize and Quantize Min and Max values
+        uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
 
-//-------------------------------------------------------------------------------------
-// BC2 Compression
-//-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-void DirectX::D3DXDecodeBC2(XMVECTOR *pColor, const uint8_t *pBC) noexcept
-{
-    assert(pColor && pBC);
-    static_assert(sizeof(D3DX_BC2) == 16, "D3DX_BC2 should be 16 bytes");
+        float fAlphaA, fAlphaB;
+        OptimizeAlpha<false>(&fAlphaA, &fAlphaB, fAlpha, uSteps);
 
-    auto pBC2 = reinterpret_cast<const D3DX_BC2 *>(pBC);
+        auto bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
+        auto bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
 
-    // RGB part
-    DecodeBC1(pColor, &pBC2->bc1, false);
+        fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
+        fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
 
-    // 4-bit alpha part
-    uint32_t dw = pBC2->bitmap[0];
+        // Setup block
+        if ((8 == uSteps) && (bAlphaA == bAlphaB))
+        {
+            pBC3->alpha[0] = bAlphaA;
+            pBC3->alpha[1] = bAlphaB;
+            memset(pBC3->bitmap, 0x00, 6);
+            return;
+        }
 
-    for (size_t i = 0; i < 8; ++i, dw >>= 4)
-    {
-#pragma prefast(suppress:22103, "writing blocks in two halves confuses tool")
-        pColor[i] = XMVectorSetW(pColor[i], static_cast<float>(dw & 0xf) * (1.0f / 15.0f));
-    }
+        static const size_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
+        static const size_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
 
-    dw = pBC2->bitmap[1];
+        const size_t *pSteps;
+        float fStep[8] = {};
 
-    for (size_t i = 8; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 4)
-        pColor[i] = XMVectorSetW(pColor[i], static_cast<float>(dw & 0xf) * (1.0f / 15.0f));
-}
+        if (6 == uSteps)
+        {
+            pBC3->alpha[0] = bAlphaA;
+            pBC3->alpha[1] = bAlphaB;
 
-_Use_decl_annotations_
-void DirectX::D3DXEncodeBC2(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
-{
-    assert(pBC && pColor);
-    static_assert(sizeof(D3DX_BC2) == 16, "D3DX_BC2 should be 16 bytes");
+            fStep[0] = fAlphaA;
+            fStep[1] = fAlphaB;
 
-    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-    {
-        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
-    }
+            for (size_t i = 1; i < 5; ++i)
+                fStep[i + 1] = (fStep[0] * float(5u - i) + fStep[1] * float(i)) * (1.0f / 5.0f);
 
-    auto pBC2 = reinterpret_cast<D3DX_BC2 *>(pBC);
+            fStep[6] = 0.0f;
+            fStep[7] = 1.0f;
 
-    // 4-bit alpha part.  Dithered using Floyd Stienberg error diffusion.
-    pBC2->bitmap[0] = 0;
-    pBC2->bitmap[1] = 0;
+            pSteps = pSteps6;
+        }
+        else
+        {
+            pBC3->alpha[0] = bAlphaB;
+            pBC3->alpha[1] = bAlphaA;
 
-    float fError[NUM_PIXELS_PER_BLOCK] = {};
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-    {
-        float fAlph = Color[i].a;
-        if (flags & BC_FLAGS_DITHER_A)
-            fAlph += fError[i];
+            fStep[0] = fAlphaB;
+            fStep[1] = fAlphaA;
 
-        auto u = static_cast<uint32_t>(fAlph * 15.0f + 0.5f);
+            for (size_t i = 1; i < 7; ++i)
+                fStep[i + 1] = (fStep[0] * float(7u - i) + fStep[1] * float(i)) * (1.0f / 7.0f);
 
-        pBC2->bitmap[i >> 3] >>= 4;
-        pBC2->bitmap[i >> 3] |= (u << 28);
+            pSteps = pSteps8;
+        }
+
+        // Encode alpha bitmap
+        auto fSteps = static_cast<float>(uSteps - 1);
+        float fScale = (fStep[0] != fStep[1]) ? (fSteps / (fStep[1] - fStep[0])) : 0.0f;
 
         if (flags & BC_FLAGS_DITHER_A)
+            memset(fError, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(float));
+
+        for (size_t iSet = 0; iSet < 2; iSet++)
         {
-            float fDiff = fAlph - float(u) * (1.0f / 15.0f);
+            uint32_t dw = 0;
 
-            if (3 != (i & 3))
-            {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
-            }
+            size_t iMin = iSet * 8;
+            size_t iLim = iMin + 8;
 
-            if (i < 12)
+            for (size_t i = iMin; i < iLim; ++i)
             {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
+                float fAlph = Color[i].a;
+                if (flags & BC_FLAGS_DITHER_A)
+                    fAlph += fError[i];
+                float fDot = (fAlph - fStep[0]) * fScale;
 
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
+                uint32_t iStep;
+                if (fDot <= 0.0f)
+                    iStep = ((6 == uSteps) && (fAlph <= fStep[0] * 0.5f)) ? 6u : 0u;
+                else if (fDot >= fSteps)
+                    iStep = ((6 == uSteps) && (fAlph >= (fStep[1] + 1.0f) * 0.5f)) ? 7u : 1u;
+                else
+                    iStep = uint32_t(pSteps[uint32_t(fDot + 0.5f)]);
 
-                if (3 != (i & 3))
+                dw = (iStep << 21) | (dw >> 3);
+
+                if (flags & BC_FLAGS_DITHER_A)
                 {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    float fDiff = (fAlph - fStep[iStep]);
+
+                    if (3 != (i & 3))
+                        fError[i + 1] += fDiff * (7.0f / 16.0f);
+
+                    if (i < 12)
+                    {
+                        if (i & 3)
+                            fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                        fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                        if (3 != (i & 3))
+                            fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
                 }
             }
+
+            pBC3->bitmap[0 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[0];
+            pBC3->bitmap[1 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[1];
+            pBC3->bitmap[2 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[2];
         }
     }
 
-    // RGB part
-#ifdef COLOR_WEIGHTS
-    if (!pBC2->bitmap[0] && !pBC2->bitmap[1])
+
+#ifdef BC_BATCH_SIMD
+    //-------------------------------------------------------------------------------------
+    // Batched BC1 encoding
+    //
+    // Encodes several blocks at once with one block per SIMD lane (structure-of-arrays).
+    // Every lane performs exactly the same sequence of IEEE single-precision operations as
+    // OptimizeRGB / EncodeBC1 above, with lane masks standing in for the early-outs, so the
+    // output is bit-identical to the scalar encoder. This relies on the floating-point
+    // pragmas at the top of this file, and is checked by VerifyBC1BatchEncoder below.
+    //-------------------------------------------------------------------------------------
+    struct LanesSSE41
     {
-        EncodeSolidBC1(pBC2->dxt1, Color);
-        return;
-    }
-#endif // COLOR_WEIGHTS
+        static constexpr size_t Width = 4;
+        using V = __m128;
+
+        static V Load(const float* p) noexcept { return _mm_load_ps(p); }
+        static void Store(float* p, V v) noexcept { _mm_store_ps(p, v); }
+        static V Splat(float f) noexcept { return _mm_set1_ps(f); }
+        static V Zero() noexcept { return _mm_setzero_ps(); }
+        static V True() noexcept { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+        static V Add(V a, V b) noexcept { return _mm_add_ps(a, b); }
+        static V Sub(V a, V b) noexcept { return _mm_sub_ps(a, b); }
+        static V Mul(V a, V b) noexcept { return _mm_mul_ps(a, b); }
+        static V Div(V a, V b) noexcept { return _mm_div_ps(a, b); }
+        static V Min(V a, V b) noexcept { return _mm_min_ps(a, b); } // (a < b) ? a : b
+        static V Max(V a, V b) noexcept { return _mm_max_ps(a, b); } // (a > b) ? a : b
+        static V Truncate(V v) noexcept { return _mm_cvtepi32_ps(_mm_cvttps_epi32(v)); }
+
+        static V Less(V a, V b) noexcept { return _mm_cmplt_ps(a, b); }
+        static V LessEq(V a, V b) noexcept { return _mm_cmple_ps(a, b); }
+        static V Greater(V a, V b) noexcept { return _mm_cmpgt_ps(a, b); }
+        static V GreaterEq(V a, V b) noexcept { return _mm_cmpge_ps(a, b); }
+        static V Equal(V a, V b) noexcept { return _mm_cmpeq_ps(a, b); }
+
+        static V And(V a, V b) noexcept { return _mm_and_ps(a, b); }
+        static V AndNot(V a, V b) noexcept { return _mm_andnot_ps(b, a); } // a & ~b
+        static V Select(V mask, V a, V b) noexcept { return _mm_blendv_ps(b, a, mask); } // mask ? a : b
+        static bool Any(V mask) noexcept { return _mm_movemask_ps(mask) != 0; }
+
+        static void Finish() noexcept {}
+    };
+
+#ifdef BC_BATCH_AVX
+    struct LanesAVX
+    {
+        static constexpr size_t Width = 8;
+        using V = __m256;
+
+        static V Load(const float* p) noexcept { return _mm256_load_ps(p); }
+        static void Store(float* p, V v) noexcept { _mm256_store_ps(p, v); }
+        static V Splat(float f) noexcept { return _mm256_set1_ps(f); }
+        static V Zero() noexcept { return _mm256_setzero_ps(); }
+        static V True() noexcept { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+
+        static V Add(V a, V b) noexcept { return _mm256_add_ps(a, b); }
+        static V Sub(V a, V b) noexcept { return _mm256_sub_ps(a, b); }
+        static V Mul(V a, V b) noexcept { return _mm256_mul_ps(a, b); }
+        static V Div(V a, V b) noexcept { return _mm256_div_ps(a, b); }
+        static V Min(V a, V b) noexcept { return _mm256_min_ps(a, b); }
+        static V Max(V a, V b) noexcept { return _mm256_max_ps(a, b); }
+        static V Truncate(V v) noexcept { return _mm256_cvtepi32_ps(_mm256_cvttps_epi32(v)); }
+
+        static V Less(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OS); }
+        static V LessEq(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OS); }
+        static V Greater(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OS); }
+        static V GreaterEq(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GE_OS); }
+        static V Equal(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+        static V And(V a, V b) noexcept { return _mm256_and_ps(a, b); }
+        static V AndNot(V a, V b) noexcept { return _mm256_andnot_ps(b, a); }
+        static V Select(V mask, V a, V b) noexcept { return _mm256_blendv_ps(b, a, mask); }
+        static bool Any(V mask) noexcept { return _mm256_movemask_ps(mask) != 0; }
+
+        static void Finish() noexcept { _mm256_zeroupper(); }
+    };
+#endif // BC_BATCH_AVX
+
+    template<size_t W>
+    struct alignas(32) BatchPoints
+    {
+        float r[NUM_PIXELS_PER_BLOCK][W];
+        float g[NUM_PIXELS_PER_BLOCK][W];
+        float b[NUM_PIXELS_PER_BLOCK][W];
+        float a[NUM_PIXELS_PER_BLOCK][W];
+    };
+
+    template<size_t W>
+    struct alignas(32) BatchLanes
+    {
+        float v[W];
+    };
 
-    EncodeBC1(&pBC2->bc1, Color, false, 0.f, flags);
-}
 
+    //-------------------------------------------------------------------------------------
+    // Batched form of OptimizeRGB; pfSteps holds (cSteps - 1) for each lane
+    //-------------------------------------------------------------------------------------
+    template<class L>
+    void OptimizeRGBBatch(
+        _Out_writes_(L::Width) HDRColorA *pX,
+        _Out_writes_(L::Width) HDRColorA *pY,
+        const BatchPoints<L::Width>& points,
+        const BatchLanes<L::Width>& steps,
+        uint32_t flags) noexcept
+    {
+        using V = typename L::V;
+        constexpr size_t W = L::Width;
+        constexpr float fEpsilon = (0.25f / 64.0f) * (0.25f / 64.0f);
 
-//-------------------------------------------------------------------------------------
-// BC3 Compression
-//-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-void DirectX::D3DXDecodeBC3(XMVECTOR *pColor, const uint8_t *pBC) noexcept
-{
-    assert(pColor && pBC);
-    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
+        const V zero = L::Zero();
+        const V one = L::Splat(1.0f);
+        const V two = L::Splat(2.0f);
+        const V three = L::Splat(3.0f);
+        const V fSteps = L::Load(steps.v);
+        const V is3 = L::Equal(fSteps, two);
+
+        // Interpolation weights; lanes using 3 steps never select the 4th entry
+        V vC[4], vD[4];
+        vC[0] = L::Splat(3.0f / 3.0f);
+        vD[0] = L::Splat(0.0f / 3.0f);
+        vC[1] = L::Select(is3, L::Splat(1.0f / 2.0f), L::Splat(2.0f / 3.0f));
+        vD[1] = L::Select(is3, L::Splat(1.0f / 2.0f), L::Splat(1.0f / 3.0f));
+        vC[2] = L::Select(is3, L::Splat(0.0f / 2.0f), L::Splat(1.0f / 3.0f));
+        vD[2] = L::Select(is3, L::Splat(2.0f / 2.0f), L::Splat(2.0f / 3.0f));
+        vC[3] = L::Splat(0.0f / 3.0f);
+        vD[3] = L::Splat(3.0f / 3.0f);
 
-    auto pBC3 = reinterpret_cast<const D3DX_BC3 *>(pBC);
+        // Find Min and Max points, as starting point
+        const bool uniform = (flags & BC_FLAGS_UNIFORM) != 0;
+        V Xr = L::Splat(uniform ? 1.f : g_Luminance.r);
+        V Xg = L::Splat(uniform ? 1.f : g_Luminance.g);
+        V Xb = L::Splat(uniform ? 1.f : g_Luminance.b);
+        V Yr = zero;
+        V Yg = zero;
+        V Yb = zero;
 
-    // RGB part
-    DecodeBC1(pColor, &pBC3->bc1, false);
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            const V pr = L::Load(points.r[iPoint]);
+            const V pg = L::Load(points.g[iPoint]);
+            const V pb = L::Load(points.b[iPoint]);
+
+            Xr = L::Min(pr, Xr);
+            Xg = L::Min(pg, Xg);
+            Xb = L::Min(pb, Xb);
+            Yr = L::Max(pr, Yr);
+            Yg = L::Max(pg, Yg);
+            Yb = L::Max(pb, Yb);
+        }
 
-    // Adaptive 3-bit alpha part
-    float fAlpha[8];
+        // Diagonal axis
+        const V ABr = L::Sub(Yr, Xr);
+        const V ABg = L::Sub(Yg, Xg);
+        const V ABb = L::Sub(Yb, Xb);
 
-    fAlpha[0] = static_cast<float>(pBC3->alpha[0]) * (1.0f / 255.0f);
-    fAlpha[1] = static_cast<float>(pBC3->alpha[1]) * (1.0f / 255.0f);
+        const V fAB = L::Add(L::Add(L::Mul(ABr, ABr), L::Mul(ABg, ABg)), L::Mul(ABb, ABb));
 
-    if (pBC3->alpha[0] > pBC3->alpha[1])
-    {
-        for (size_t i = 1; i < 7; ++i)
-            fAlpha[i + 1] = (fAlpha[0] * float(7u - i) + fAlpha[1] * float(i)) * (1.0f / 7.0f);
+        // Single color blocks keep the unswapped min/max
+        const V singleColor = L::Less(fAB, L::Splat(FLT_MIN));
+        const V Xr0 = Xr, Xg0 = Xg, Xb0 = Xb;
+        const V Yr0 = Yr, Yg0 = Yg, Yb0 = Yb;
+
+        // Try all four axis directions, to determine which diagonal best fits data
+        const V fABInv = L::Div(one, fAB);
+
+        V Dirr = L::Mul(ABr, fABInv);
+        V Dirg = L::Mul(ABg, fABInv);
+        V Dirb = L::Mul(ABb, fABInv);
+
+        const V half = L::Splat(0.5f);
+        const V Midr = L::Mul(L::Add(Xr, Yr), half);
+        const V Midg = L::Mul(L::Add(Xg, Yg), half);
+        const V Midb = L::Mul(L::Add(Xb, Yb), half);
+
+        V fDir0 = zero, fDir1 = zero, fDir2 = zero, fDir3 = zero;
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            const V Ptr = L::Mul(L::Sub(L::Load(points.r[iPoint]), Midr), Dirr);
+            const V Ptg = L::Mul(L::Sub(L::Load(points.g[iPoint]), Midg), Dirg);
+            const V Ptb = L::Mul(L::Sub(L::Load(points.b[iPoint]), Midb), Dirb);
+
+            V f = L::Add(L::Add(Ptr, Ptg), Ptb);
+            fDir0 = L::Add(fDir0, L::Mul(f, f));
+
+            f = L::Sub(L::Add(Ptr, Ptg), Ptb);
+            fDir1 = L::Add(fDir1, L::Mul(f, f));
+
+            f = L::Add(L::Sub(Ptr, Ptg), Ptb);
+            fDir2 = L::Add(fDir2, L::Mul(f, f));
+
+            f = L::Sub(L::Sub(Ptr, Ptg), Ptb);
+            fDir3 = L::Add(fDir3, L::Mul(f, f));
+        }
+
+        // iDirMax bit 0 swaps blue, bit 1 swaps green
+        const V allSet = L::True();
+        V fDirMax = fDir0;
+        V swapB = zero;
+        V swapG = zero;
+
+        V m = L::Greater(fDir1, fDirMax);
+        fDirMax = L::Select(m, fDir1, fDirMax);
+        swapB = L::Select(m, allSet, swapB);
+
+        m = L::Greater(fDir2, fDirMax);
+        fDirMax = L::Select(m, fDir2, fDirMax);
+        swapB = L::Select(m, zero, swapB);
+        swapG = L::Select(m, allSet, swapG);
+
+        m = L::Greater(fDir3, fDirMax);
+        swapB = L::Select(m, allSet, swapB);
+        swapG = L::Select(m, allSet, swapG);
+
+        {
+            const V t = Xg;
+            Xg = L::Select(swapG, Yg, Xg);
+            Yg = L::Select(swapG, t, Yg);
+        }
+        {
+            const V t = Xb;
+            Xb = L::Select(swapB, Yb, Xb);
+            Yb = L::Select(swapB, t, Yb);
+        }
+
+        // Two color blocks.. no need to root-find
+        const V minLen = L::Splat(1.0f / 4096.0f);
+        V active = L::AndNot(L::AndNot(allSet, singleColor), L::Less(fAB, minLen));
+
+        // Use Newton's Method to find local minima of sum-of-squares error.
+        const V eps = L::Splat(fEpsilon);
+        const V eighth = L::Splat(1.0f / 8.0f);
+        const V negOne = L::Splat(-1.0f);
+
+        for (size_t iIteration = 0; iIteration < 8 && L::Any(active); iIteration++)
+        {
+            // Calculate new steps
+            V Sr[4], Sg[4], Sb[4];
+            for (size_t iStep = 0; iStep < 4; iStep++)
+            {
+                Sr[iStep] = L::Add(L::Mul(Xr, vC[iStep]), L::Mul(Yr, vD[iStep]));
+                Sg[iStep] = L::Add(L::Mul(Xg, vC[iStep]), L::Mul(Yg, vD[iStep]));
+                Sb[iStep] = L::Add(L::Mul(Xb, vC[iStep]), L::Mul(Yb, vD[iStep]));
+            }
+
+            // Calculate color direction
+            Dirr = L::Sub(Yr, Xr);
+            Dirg = L::Sub(Yg, Xg);
+            Dirb = L::Sub(Yb, Xb);
+
+            const V fLen = L::Add(L::Add(L::Mul(Dirr, Dirr), L::Mul(Dirg, Dirg)), L::Mul(Dirb, Dirb));
+
+            active = L::AndNot(active, L::Less(fLen, minLen));
+            if (!L::Any(active))
+                break;
+
+            const V fScale = L::Div(fSteps, fLen);
+
+            Dirr = L::Mul(Dirr, fScale);
+            Dirg = L::Mul(Dirg, fScale);
+            Dirb = L::Mul(Dirb, fScale);
+
+            // Evaluate function, and derivatives
+            V d2X = zero, d2Y = zero;
+            V dXr = zero, dXg = zero, dXb = zero;
+            V dYr = zero, dYg = zero, dYb = zero;
+
+            for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+            {
+                const V pr = L::Load(points.r[iPoint]);
+                const V pg = L::Load(points.g[iPoint]);
+                const V pb = L::Load(points.b[iPoint]);
+
+                const V fDot = L::Add(L::Add(
+                    L::Mul(L::Sub(pr, Xr), Dirr),
+                    L::Mul(L::Sub(pg, Xg), Dirg)),
+                    L::Mul(L::Sub(pb, Xb), Dirb));
+
+                V iStep = L::Truncate(L::Add(fDot, half));
+                iStep = L::Select(L::GreaterEq(fDot, fSteps), fSteps, iStep);
+                iStep = L::Select(L::LessEq(fDot, zero), zero, iStep);
+
+                const V m1 = L::Equal(iStep, one);
+                const V m2 = L::Equal(iStep, two);
+                const V m3 = L::Equal(iStep, three);
+
+                const V c = L::Select(m3, vC[3], L::Select(m2, vC[2], L::Select(m1, vC[1], vC[0])));
+                const V d = L::Select(m3, vD[3], L::Select(m2, vD[2], L::Select(m1, vD[1], vD[0])));
+
+                const V Diffr = L::Sub(L::Select(m3, Sr[3], L::Select(m2, Sr[2], L::Select(m1, Sr[1], Sr[0]))), pr);
+                const V Diffg = L::Sub(L::Select(m3, Sg[3], L::Select(m2, Sg[2], L::Select(m1, Sg[1], Sg[0]))), pg);
+                const V Diffb = L::Sub(L::Select(m3, Sb[3], L::Select(m2, Sb[2], L::Select(m1, Sb[1], Sb[0]))), pb);
+
+                const V fC = L::Mul(c, eighth);
+                const V fD = L::Mul(d, eighth);
+
+                d2X = L::Add(d2X, L::Mul(fC, c));
+                dXr = L::Add(dXr, L::Mul(fC, Diffr));
+                dXg = L::Add(dXg, L::Mul(fC, Diffg));
+                dXb = L::Add(dXb, L::Mul(fC, Diffb));
+
+                d2Y = L::Add(d2Y, L::Mul(fD, d));
+                dYr = L::Add(dYr, L::Mul(fD, Diffr));
+                dYg = L::Add(dYg, L::Mul(fD, Diffg));
+                dYb = L::Add(dYb, L::Mul(fD, Diffb));
+            }
+
+            // Move endpoints
+            const V moveX = L::And(active, L::Greater(d2X, zero));
+            const V fX = L::Div(negOne, d2X);
+            Xr = L::Select(moveX, L::Add(Xr, L::Mul(dXr, fX)), Xr);
+            Xg = L::Select(moveX, L::Add(Xg, L::Mul(dXg, fX)), Xg);
+            Xb = L::Select(moveX, L::Add(Xb, L::Mul(dXb, fX)), Xb);
+
+            const V moveY = L::And(active, L::Greater(d2Y, zero));
+            const V fY = L::Div(negOne, d2Y);
+            Yr = L::Select(moveY, L::Add(Yr, L::Mul(dYr, fY)), Yr);
+            Yg = L::Select(moveY, L::Add(Yg, L::Mul(dYg, fY)), Yg);
+            Yb = L::Select(moveY, L::Add(Yb, L::Mul(dYb, fY)), Yb);
+
+            V converged = L::And(L::Less(L::Mul(dXr, dXr), eps), L::Less(L::Mul(dXg, dXg), eps));
+            converged = L::And(converged, L::Less(L::Mul(dXb, dXb), eps));
+            converged = L::And(converged, L::Less(L::Mul(dYr, dYr), eps));
+            converged = L::And(converged, L::Less(L::Mul(dYg, dYg), eps));
+            converged = L::And(converged, L::Less(L::Mul(dYb, dYb), eps));
+
+            active = L::AndNot(active, converged);
+        }
+
+        Xr = L::Select(singleColor, Xr0, Xr);
+        Xg = L::Select(singleColor, Xg0, Xg);
+        Xb = L::Select(singleColor, Xb0, Xb);
+        Yr = L::Select(singleColor, Yr0, Yr);
+        Yg = L::Select(singleColor, Yg0, Yg);
+        Yb = L::Select(singleColor, Yb0, Yb);
+
+        BatchLanes<W> xr, xg, xb, yr, yg, yb;
+        L::Store(xr.v, Xr);
+        L::Store(xg.v, Xg);
+        L::Store(xb.v, Xb);
+        L::Store(yr.v, Yr);
+        L::Store(yg.v, Yg);
+        L::Store(yb.v, Yb);
+
+        for (size_t j = 0; j < W; ++j)
+        {
+            pX[j] = HDRColorA(xr.v[j], xg.v[j], xb.v[j], 1.0f);
+            pY[j] = HDRColorA(yr.v[j], yg.v[j], yb.v[j], 1.0f);
+        }
     }
-    else
+
+
+    //-------------------------------------------------------------------------------------
+    // Batched form of EncodeBC1 without RGB dithering (L::Width blocks)
+    //-------------------------------------------------------------------------------------
+    template<class L>
+    void EncodeBC1Batch(
+        _Out_writes_(L::Width) D3DX_BC1 * const *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK * L::Width) const HDRColorA *pColor,
+        bool bColorKey,
+        float threshold,
+        uint32_t flags) noexcept
     {
-        for (size_t i = 1; i < 5; ++i)
-            fAlpha[i + 1] = (fAlpha[0] * float(5u - i) + fAlpha[1] * float(i)) * (1.0f / 5.0f);
+        using V = typename L::V;
+        constexpr size_t W = L::Width;
 
-        fAlpha[6] = 0.0f;
-        fAlpha[7] = 1.0f;
+        assert(!(flags & BC_FLAGS_DITHER_RGB));
+
+        const bool uniform = (flags & BC_FLAGS_UNIFORM) != 0;
+
+        const V zero = L::Zero();
+        const V one = L::Splat(1.0f);
+        const V two = L::Splat(2.0f);
+        const V three = L::Splat(3.0f);
+        const V half = L::Splat(0.5f);
+        const V vThreshold = L::Splat(threshold);
+
+        // Transpose to structure-of-arrays
+        BatchPoints<W> source;
+        for (size_t j = 0; j < W; ++j)
+        {
+            const HDRColorA* pBlock = pColor + j * NUM_PIXELS_PER_BLOCK;
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                source.r[i][j] = pBlock[i].r;
+                source.g[i][j] = pBlock[i].g;
+                source.b[i][j] = pBlock[i].b;
+                source.a[i][j] = pBlock[i].a;
+            }
+        }
+
+        // Determine if we need to colorkey each block
+        BatchLanes<W> keyed = {};
+        if (bColorKey)
+        {
+            V uColorKey = zero;
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                uColorKey = L::Add(uColorKey, L::And(L::Less(L::Load(source.a[i]), vThreshold), one));
+            }
+            L::Store(keyed.v, uColorKey);
+        }
+
+        BatchLanes<W> steps;
+        for (size_t j = 0; j < W; ++j)
+        {
+            steps.v[j] = (keyed.v[j] > 0.0f) ? 2.0f : 3.0f;
+        }
+
+        // Quantize blocks to R5G6B5
+        BatchPoints<W> points;
+        {
+            const V scale5 = L::Splat(31.0f);
+            const V scale6 = L::Splat(63.0f);
+            const V inv5 = L::Splat(1.0f / 31.0f);
+            const V inv6 = L::Splat(1.0f / 63.0f);
+            const V lumR = L::Splat(g_Luminance.r);
+            const V lumG = L::Splat(g_Luminance.g);
+            const V lumB = L::Splat(g_Luminance.b);
+
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                V r = L::Mul(L::Truncate(L::Add(L::Mul(L::Load(source.r[i]), scale5), half)), inv5);
+                V g = L::Mul(L::Truncate(L::Add(L::Mul(L::Load(source.g[i]), scale6), half)), inv6);
+                V b = L::Mul(L::Truncate(L::Add(L::Mul(L::Load(source.b[i]), scale5), half)), inv5);
+
+                if (!uniform)
+                {
+                    r = L::Mul(r, lumR);
+                    g = L::Mul(g, lumG);
+                    b = L::Mul(b, lumB);
+                }
+
+                L::Store(points.r[i], r);
+                L::Store(points.g[i], g);
+                L::Store(points.b[i], b);
+            }
+        }
+
+        // Perform 6D root finding function to find two endpoints of color axis.
+        HDRColorA ColorA[W], ColorB[W];
+        OptimizeRGBBatch<L>(ColorA, ColorB, points, steps, flags);
+
+        // Quantize and sort the endpoints depending on mode (per block)
+        BatchLanes<W> step0r, step0g, step0b, dirr, dirg, dirb;
+        bool done[W];
+        for (size_t j = 0; j < W; ++j)
+        {
+            D3DX_BC1* pBlock = pBC[j];
+            const uint32_t uSteps = (steps.v[j] == 2.0f) ? 3u : 4u;
+
+            step0r.v[j] = step0g.v[j] = step0b.v[j] = 0.0f;
+            dirr.v[j] = dirg.v[j] = dirb.v[j] = 0.0f;
+            done[j] = true;
+
+            if (keyed.v[j] == float(NUM_PIXELS_PER_BLOCK))
+            {
+                pBlock->rgb[0] = 0x0000;
+                pBlock->rgb[1] = 0xffff;
+                pBlock->bitmap = 0xffffffff;
+                continue;
+            }
+
+            HDRColorA ColorC, ColorD;
+            if (uniform)
+            {
+                ColorC = ColorA[j];
+                ColorD = ColorB[j];
+            }
+            else
+            {
+                ColorC.r = ColorA[j].r * g_LuminanceInv.r;
+                ColorC.g = ColorA[j].g * g_LuminanceInv.g;
+                ColorC.b = ColorA[j].b * g_LuminanceInv.b;
+                ColorC.a = ColorA[j].a;
+
+                ColorD.r = ColorB[j].r * g_LuminanceInv.r;
+                ColorD.g = ColorB[j].g * g_LuminanceInv.g;
+                ColorD.b = ColorB[j].b * g_LuminanceInv.b;
+                ColorD.a = ColorB[j].a;
+            }
+
+            const uint16_t wColorA = Encode565(&ColorC);
+            const uint16_t wColorB = Encode565(&ColorD);
+
+            if ((uSteps == 4) && (wColorA == wColorB))
+            {
+                pBlock->rgb[0] = wColorA;
+                pBlock->rgb[1] = wColorB;
+                pBlock->bitmap = 0x00000000;
+                continue;
+            }
+
+            Decode565(&ColorC, wColorA);
+            Decode565(&ColorD, wColorB);
+
+            HDRColorA EndA, EndB;
+            if (uniform)
+            {
+                EndA = ColorC;
+                EndB = ColorD;
+            }
+            else
+            {
+                EndA.r = ColorC.r * g_Luminance.r;
+                EndA.g = ColorC.g * g_Luminance.g;
+                EndA.b = ColorC.b * g_Luminance.b;
+
+                EndB.r = ColorD.r * g_Luminance.r;
+                EndB.g = ColorD.g * g_Luminance.g;
+                EndB.b = ColorD.b * g_Luminance.b;
+            }
+
+            HDRColorA Step0, Step1;
+            if ((3 == uSteps) == (wColorA <= wColorB))
+            {
+                pBlock->rgb[0] = wColorA;
+                pBlock->rgb[1] = wColorB;
+
+                Step0 = EndA;
+                Step1 = EndB;
+            }
+            else
+            {
+                pBlock->rgb[0] = wColorB;
+                pBlock->rgb[1] = wColorA;
+
+                Step0 = EndB;
+                Step1 = EndA;
+            }
+
+            // Calculate color direction
+            HDRColorA Dir;
+            Dir.r = Step1.r - Step0.r;
+            Dir.g = Step1.g - Step0.g;
+            Dir.b = Step1.b - Step0.b;
+
+            const float fSteps = steps.v[j];
+            const float fScale = (wColorA != wColorB) ? (fSteps / (Dir.r * Dir.r + Dir.g * Dir.g + Dir.b * Dir.b)) : 0.0f;
+
+            step0r.v[j] = Step0.r;
+            step0g.v[j] = Step0.g;
+            step0b.v[j] = Step0.b;
+            dirr.v[j] = Dir.r * fScale;
+            dirg.v[j] = Dir.g * fScale;
+            dirb.v[j] = Dir.b * fScale;
+            done[j] = false;
+        }
+
+        // Encode colors
+        const V fSteps = L::Load(steps.v);
+        const V is3 = L::Equal(fSteps, two);
+        const V S0r = L::Load(step0r.v);
+        const V S0g = L::Load(step0g.v);
+        const V S0b = L::Load(step0b.v);
+        const V Dirr = L::Load(dirr.v);
+        const V Dirg = L::Load(dirg.v);
+        const V Dirb = L::Load(dirb.v);
+        const V lumR = L::Splat(uniform ? 1.0f : g_Luminance.r);
+        const V lumG = L::Splat(uniform ? 1.0f : g_Luminance.g);
+        const V lumB = L::Splat(uniform ? 1.0f : g_Luminance.b);
+
+        BatchLanes<W> index[NUM_PIXELS_PER_BLOCK];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            V Clrr = L::Load(source.r[i]);
+            V Clrg = L::Load(source.g[i]);
+            V Clrb = L::Load(source.b[i]);
+            if (!uniform)
+            {
+                Clrr = L::Mul(Clrr, lumR);
+                Clrg = L::Mul(Clrg, lumG);
+                Clrb = L::Mul(Clrb, lumB);
+            }
+
+            const V fDot = L::Add(L::Add(
+                L::Mul(L::Sub(Clrr, S0r), Dirr),
+                L::Mul(L::Sub(Clrg, S0g), Dirg)),
+                L::Mul(L::Sub(Clrb, S0b), Dirb));
+
+            // pSteps3 = { 0, 2, 1 }, pSteps4 = { 0, 2, 3, 1 }
+            const V t = L::Truncate(L::Add(fDot, half));
+            V iStep = L::Select(L::Equal(t, one), two, zero);
+            iStep = L::Select(L::Equal(t, two), L::Select(is3, one, three), iStep);
+            iStep = L::Select(L::Equal(t, three), one, iStep);
+            iStep = L::Select(L::GreaterEq(fDot, fSteps), one, iStep);
+            iStep = L::Select(L::LessEq(fDot, zero), zero, iStep);
+
+            if (bColorKey)
+            {
+                iStep = L::Select(L::And(is3, L::Less(L::Load(source.a[i]), vThreshold)), three, iStep);
+            }
+
+            L::Store(index[i].v, iStep);
+        }
+
+        L::Finish();
+
+        for (size_t j = 0; j < W; ++j)
+        {
+            if (done[j])
+                continue;
+
+            uint32_t dw = 0;
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                dw = (static_cast<uint32_t>(index[i].v[j]) << 30) | (dw >> 2);
+            }
+
+            pBC[j]->bitmap = dw;
+        }
     }
 
-    uint32_t dw = uint32_t(pBC3->bitmap[0]) | uint32_t(pBC3->bitmap[1] << 8) | uint32_t(pBC3->bitmap[2] << 16);
 
-    for (size_t i = 0; i < 8; ++i, dw >>= 3)
-        pColor[i] = XMVectorSetW(pColor[i], fAlpha[dw & 0x7]);
+    //-------------------------------------------------------------------------------------
+    // Runtime selection of the batched encoder based on CPU features
+    //-------------------------------------------------------------------------------------
+    template<class L>
+    void EncodeBC1Blocks(
+        _Out_writes_(count) D3DX_BC1 * const *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK * count) const HDRColorA *pColor,
+        size_t count,
+        bool bColorKey,
+        float threshold,
+        uint32_t flags) noexcept
+    {
+        size_t j = 0;
+        for (; j + L::Width <= count; j += L::Width)
+        {
+            EncodeBC1Batch<L>(pBC + j, pColor + j * NUM_PIXELS_PER_BLOCK, bColorKey, threshold, flags);
+        }
 
-    dw = uint32_t(pBC3->bitmap[3]) | uint32_t(pBC3->bitmap[4] << 8) | uint32_t(pBC3->bitmap[5] << 16);
+        // Remainder that doesn't fill all the lanes
+        for (; j < count; ++j)
+        {
+            EncodeBC1(pBC[j], pColor + j * NUM_PIXELS_PER_BLOCK, bColorKey, threshold, flags);
+        }
+    }
 
-    for (size_t i = 8; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 3)
-        pColor[i] = XMVectorSetW(pColor[i], fAlpha[dw & 0x7]);
+    using BC1BlocksFunc = void(*)(D3DX_BC1 * const *, const HDRColorA *, size_t, bool, float, uint32_t);
+
+    //-------------------------------------------------------------------------------------
+    // Compares a batched encoder against the scalar one over a fixed set of random blocks
+    //-------------------------------------------------------------------------------------
+    bool VerifyBC1BatchEncoder(_In_ BC1BlocksFunc pfEncode) noexcept
+    {
+        constexpr size_t c_blocks = 32;
+
+        HDRColorA color[c_blocks * NUM_PIXELS_PER_BLOCK];
+        D3DX_BC1 batch[c_blocks];
+        D3DX_BC1 *pBatch[c_blocks];
+
+        // Mix of noisy, solid, two-color, and gradient blocks to cover the early-outs
+        uint32_t seed = 0x2545F491;
+        auto random = [&seed]() noexcept -> float
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) * (1.0f / 16777216.0f);
+        };
+
+        for (size_t j = 0; j < c_blocks; ++j)
+        {
+            const HDRColorA base(random(), random(), random(), 1.0f);
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                HDRColorA& clr = color[j * NUM_PIXELS_PER_BLOCK + i];
+                switch (j & 3)
+                {
+                case 0:  clr = HDRColorA(random(), random(), random(), random()); break;
+                case 1:  clr = base; break;
+                case 2:  clr = (i & 1) ? base : HDRColorA(base.r * 0.5f, base.g, base.b, 0.0f); break;
+                default:
+                    {
+                        const float t = random();
+                        clr = HDRColorA(base.r * t, base.g * t, base.b * t, 1.0f);
+                    }
+                    break;
+                }
+            }
+            pBatch[j] = &batch[j];
+        }
+
+        for (uint32_t pass = 0; pass < 4; ++pass)
+        {
+            const bool bColorKey = (pass & 1) != 0;
+            const uint32_t flags = (pass & 2) ? BC_FLAGS_UNIFORM : BC_FLAGS_NONE;
+
+            pfEncode(pBatch, color, c_blocks, bColorKey, 0.5f, flags);
+
+            for (size_t j = 0; j < c_blocks; ++j)
+            {
+                D3DX_BC1 scalar;
+                EncodeBC1(&scalar, color + j * NUM_PIXELS_PER_BLOCK, bColorKey, 0.5f, flags);
+
+                if (memcmp(&scalar, &batch[j], sizeof(D3DX_BC1)) != 0)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    BC1BlocksFunc SelectBC1BatchEncoder() noexcept
+    {
+#ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 1)
+            return nullptr;
+
+        __cpuid(info, 1);
+        const auto ecx = static_cast<unsigned int>(info[2]);
+#else
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return nullptr;
+#endif
+
+        const bool sse41 = (ecx & (1u << 19)) != 0;
+        const bool osxsave = (ecx & (1u << 27)) != 0;
+        const bool avx = (ecx & (1u << 28)) != 0;
+
+#ifdef BC_BATCH_AVX
+        if (sse41 && osxsave && avx)
+        {
+            // Confirm the OS saves the YMM registers
+#ifdef _MSC_VER
+            const uint64_t xcr0 = _xgetbv(0);
+#else
+            uint32_t xlo, xhi;
+            __asm__("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+            const uint64_t xcr0 = (uint64_t(xhi) << 32) | xlo;
+#endif
+            if ((xcr0 & 0x6) == 0x6)
+                return EncodeBC1Blocks<LanesAVX>;
+        }
+#else
+        UNREFERENCED_PARAMETER(osxsave);
+        UNREFERENCED_PARAMETER(avx);
+#endif
+
+        if (sse41)
+            return EncodeBC1Blocks<LanesSSE41>;
+
+        return nullptr;
+    }
+
+    BC1BlocksFunc GetBC1BatchEncoder() noexcept
+    {
+        static const BC1BlocksFunc s_encoder = []() noexcept -> BC1BlocksFunc
+        {
+            const BC1BlocksFunc pfEncode = SelectBC1BatchEncoder();
+            if (pfEncode && !VerifyBC1BatchEncoder(pfEncode))
+            {
+                // Fall back to the scalar encoder rather than produce different output
+                assert(false);
+                return nullptr;
+            }
+            return pfEncode;
+        }();
+        return s_encoder;
+    }
+#endif // BC_BATCH_SIMD
+
+    //-------------------------------------------------------------------------------------
+    // Encodes 'count' blocks of RGB data, in SIMD batches when supported
+    //-------------------------------------------------------------------------------------
+    void EncodeBC1Blocks(
+        _Out_writes_(count) D3DX_BC1 * const *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK * count) const HDRColorA *pColor,
+        size_t count,
+        bool bColorKey,
+        float threshold,
+        uint32_t flags) noexcept
+    {
+#ifdef BC_BATCH_SIMD
+        if (!(flags & BC_FLAGS_DITHER_RGB))
+        {
+            auto pfEncode = GetBC1BatchEncoder();
+            if (pfEncode)
+            {
+                pfEncode(pBC, pColor, count, bColorKey, threshold, flags);
+                return;
+            }
+        }
+#endif
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            EncodeBC1(pBC[j], pColor + j * NUM_PIXELS_PER_BLOCK, bColorKey, threshold, flags);
+        }
+    }
+
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma float_control(pop)
+#elif defined(__clang__)
+#pragma clang fp contract(on)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+
+//=====================================================================================
+// Entry points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// BC1 Compression
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC1(XMVECTOR *pColor, const uint8_t *pBC) noexcept
+{
+    auto pBC1 = reinterpret_cast<const D3DX_BC1 *>(pBC);
+    DecodeBC1(pColor, pBC1, true);
 }
 
 _Use_decl_annotations_
-void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+void DirectX::D3DXEncodeBC1(uint8_t *pBC, const XMVECTOR *pColor, float threshold, uint32_t flags) noexcept
 {
     assert(pBC && pColor);
-    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
+
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+    LoadBC1Block(Color, pColor, flags);
+
+    auto pBC1 = reinterpret_cast<D3DX_BC1 *>(pBC);
+    EncodeBC1(pBC1, Color, true, threshold, flags);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC1Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t count, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK * BC_BATCH_MAX];
+    D3DX_BC1* pBlocks[BC_BATCH_MAX];
+
+    for (size_t j = 0; j < count; j += BC_BATCH_MAX)
+    {
+        const size_t nblocks = std::min<size_t>(BC_BATCH_MAX, count - j);
+        for (size_t k = 0; k < nblocks; ++k)
+        {
+            LoadBC1Block(&Color[k * NUM_PIXELS_PER_BLOCK], pColor + (j + k) * NUM_PIXELS_PER_BLOCK, flags);
+            pBlocks[k] = reinterpret_cast<D3DX_BC1 *>(pBC + (j + k) * sizeof(D3DX_BC1));
+        }
+
+        EncodeBC1Blocks(pBlocks, Color, nblocks, true, threshold, flags);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// BC2 Compression
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC2(XMVECTOR *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC2) == 16, "D3DX_BC2 should be 16 bytes");
+
+    auto pBC2 = reinterpret_cast<const D3DX_BC2 *>(pBC);
+
+    // RGB part
+    DecodeBC1(pColor, &pBC2->bc1, false);
+
+    // 4-bit alpha part
+    uint32_t dw = pBC2->bitmap[0];
+
+    for (size_t i = 0; i < 8; ++i, dw >>= 4)
+    {
+#pragma prefast(suppress:22103, "writing blocks in two halves confuses tool")
+        pColor[i] = XMVectorSetW(pColor[i], static_cast<float>(dw & 0xf) * (1.0f / 15.0f));
+    }
+
+    dw = pBC2->bitmap[1];
+
+    for (size_t i = 8; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 4)
+        pColor[i] = XMVectorSetW(pColor[i], static_cast<float>(dw & 0xf) * (1.0f / 15.0f));
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC2(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    static_assert(sizeof(D3DX_BC2) == 16, "D3DX_BC2 should be 16 bytes");
 
     HDRColorA Color[NUM_PIXELS_PER_BLOCK];
     for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
@@ -952,33 +1889,27 @@ void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags
         XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
     }
 
-    auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC);
-
-    // Quantize block to A8, using Floyd Stienberg error diffusion.  This 
-    // increases the chance that colors will map directly to the quantized 
-    // axis endpoints.
-    float fAlpha[NUM_PIXELS_PER_BLOCK] = {};
-    float fError[NUM_PIXELS_PER_BLOCK] = {};
+    auto pBC2 = reinterpret_cast<D3DX_BC2 *>(pBC);
 
-    float fMinAlpha = Color[0].a;
-    float fMaxAlpha = Color[0].a;
+    // 4-bit alpha part.  Dithered using Floyd Stienberg error diffusion.
+    pBC2->bitmap[0] = 0;
+    pBC2->bitmap[1] = 0;
 
+    float fError[NUM_PIXELS_PER_BLOCK] = {};
     for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
     {
         float fAlph = Color[i].a;
         if (flags & BC_FLAGS_DITHER_A)
             fAlph += fError[i];
 
-        fAlpha[i] = static_cast<float>(static_cast<int32_t>(fAlph * 255.0f + 0.5f)) * (1.0f / 255.0f);
+        auto u = static_cast<uint32_t>(fAlph * 15.0f + 0.5f);
 
-        if (fAlpha[i] < fMinAlpha)
-            fMinAlpha = fAlpha[i];
-        else if (fAlpha[i] > fMaxAlpha)
-            fMaxAlpha = fAlpha[i];
+        pBC2->bitmap[i >> 3] >>= 4;
+        pBC2->bitmap[i >> 3] |= (u << 28);
 
         if (flags & BC_FLAGS_DITHER_A)
         {
-            float fDiff = fAlph - fAlpha[i];
+            float fDiff = fAlph - float(u) * (1.0f / 15.0f);
 
             if (3 != (i & 3))
             {
@@ -1004,138 +1935,113 @@ void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags
         }
     }
 
-#ifdef COLOR_WEIGHTS
-    if (0.0f == fMaxAlpha)
-    {
-        EncodeSolidBC1(&pBC3->dxt1, Color);
-        pBC3->alpha[0] = 0x00;
-        pBC3->alpha[1] = 0x00;
-        memset(pBC3->bitmap, 0x00, 6);
-    }
-#endif
-
     // RGB part
-    EncodeBC1(&pBC3->bc1, Color, false, 0.f, flags);
-
-    // Alpha part
-    if (1.0f == fMinAlpha)
+#ifdef COLOR_WEIGHTS
+    if (!pBC2->bitmap[0] && !pBC2->bitmap[1])
     {
-        pBC3->alpha[0] = 0xff;
-        pBC3->alpha[1] = 0xff;
-        memset(pBC3->bitmap, 0x00, 6);
+        EncodeSolidBC1(pBC2->dxt1, Color);
         return;
     }
+#endif // COLOR_WEIGHTS
 
-    // Optimize and Quantize Min and Max values
-    uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
+    EncodeBC1(&pBC2->bc1, Color, false, 0.f, flags);
+}
 
-    float fAlphaA, fAlphaB;
-    OptimizeAlpha<false>(&fAlphaA, &fAlphaB, fAlpha, uSteps);
 
-    auto bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
-    auto bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
+//-------------------------------------------------------------------------------------
+// BC3 Compression
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC3(XMVECTOR *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-    fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
-    fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
+    auto pBC3 = reinterpret_cast<const D3DX_BC3 *>(pBC);
 
-    // Setup block
-    if ((8 == uSteps) && (bAlphaA == bAlphaB))
-    {
-        pBC3->alpha[0] = bAlphaA;
-        pBC3->alpha[1] = bAlphaB;
-        memset(pBC3->bitmap, 0x00, 6);
-        return;
-    }
+    // RGB part
+    DecodeBC1(pColor, &pBC3->bc1, false);
 
-    static const size_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
-    static const size_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+    // Adaptive 3-bit alpha part
+    float fAlpha[8];
 
-    const size_t *pSteps;
-    float fStep[8] = {};
+    fAlpha[0] = static_cast<float>(pBC3->alpha[0]) * (1.0f / 255.0f);
+    fAlpha[1] = static_cast<float>(pBC3->alpha[1]) * (1.0f / 255.0f);
 
-    if (6 == uSteps)
+    if (pBC3->alpha[0] > pBC3->alpha[1])
     {
-        pBC3->alpha[0] = bAlphaA;
-        pBC3->alpha[1] = bAlphaB;
-
-        fStep[0] = fAlphaA;
-        fStep[1] = fAlphaB;
-
-        for (size_t i = 1; i < 5; ++i)
-            fStep[i + 1] = (fStep[0] * float(5u - i) + fStep[1] * float(i)) * (1.0f / 5.0f);
-
-        fStep[6] = 0.0f;
-        fStep[7] = 1.0f;
-
-        pSteps = pSteps6;
+        for (size_t i = 1; i < 7; ++i)
+            fAlpha[i + 1] = (fAlpha[0] * float(7u - i) + fAlpha[1] * float(i)) * (1.0f / 7.0f);
     }
     else
     {
-        pBC3->alpha[0] = bAlphaB;
-        pBC3->alpha[1] = bAlphaA;
+        for (size_t i = 1; i < 5; ++i)
+            fAlpha[i + 1] = (fAlpha[0] * float(5u - i) + fAlpha[1] * float(i)) * (1.0f / 5.0f);
 
-        fStep[0] = fAlphaB;
-        fStep[1] = fAlphaA;
+        fAlpha[6] = 0.0f;
+        fAlpha[7] = 1.0f;
+    }
 
-        for (size_t i = 1; i < 7; ++i)
-            fStep[i + 1] = (fStep[0] * float(7u - i) + fStep[1] * float(i)) * (1.0f / 7.0f);
+    uint32_t dw = uint32_t(pBC3->bitmap[0]) | uint32_t(pBC3->bitmap[1] << 8) | uint32_t(pBC3->bitmap[2] << 16);
 
-        pSteps = pSteps8;
-    }
+    for (size_t i = 0; i < 8; ++i, dw >>= 3)
+        pColor[i] = XMVectorSetW(pColor[i], fAlpha[dw & 0x7]);
 
-    // Encode alpha bitmap
-    auto fSteps = static_cast<float>(uSteps - 1);
-    float fScale = (fStep[0] != fStep[1]) ? (fSteps / (fStep[1] - fStep[0])) : 0.0f;
+    dw = uint32_t(pBC3->bitmap[3]) | uint32_t(pBC3->bitmap[4] << 8) | uint32_t(pBC3->bitmap[5] << 16);
 
-    if (flags & BC_FLAGS_DITHER_A)
-        memset(fError, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(float));
+    for (size_t i = 8; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 3)
+        pColor[i] = XMVectorSetW(pColor[i], fAlpha[dw & 0x7]);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-    for (size_t iSet = 0; iSet < 2; iSet++)
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
     {
-        uint32_t dw = 0;
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
+    }
 
-        size_t iMin = iSet * 8;
-        size_t iLim = iMin + 8;
+    auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC);
 
-        for (size_t i = iMin; i < iLim; ++i)
-        {
-            float fAlph = Color[i].a;
-            if (flags & BC_FLAGS_DITHER_A)
-                fAlph += fError[i];
-            float fDot = (fAlph - fStep[0]) * fScale;
+    // RGB part
+    EncodeBC1(&pBC3->bc1, Color, false, 0.f, flags);
 
-            uint32_t iStep;
-            if (fDot <= 0.0f)
-                iStep = ((6 == uSteps) && (fAlph <= fStep[0] * 0.5f)) ? 6u : 0u;
-            else if (fDot >= fSteps)
-                iStep = ((6 == uSteps) && (fAlph >= (fStep[1] + 1.0f) * 0.5f)) ? 7u : 1u;
-            else
-                iStep = uint32_t(pSteps[uint32_t(fDot + 0.5f)]);
+    // Alpha part
+    EncodeBC3Alpha(pBC3, Color, flags);
+}
 
-            dw = (iStep << 21) | (dw >> 3);
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t count, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
 
-            if (flags & BC_FLAGS_DITHER_A)
-            {
-                float fDiff = (fAlph - fStep[iStep]);
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK * BC_BATCH_MAX];
+    D3DX_BC1* pBlocks[BC_BATCH_MAX];
 
-                if (3 != (i & 3))
-                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+    for (size_t j = 0; j < count; j += BC_BATCH_MAX)
+    {
+        const size_t nblocks = std::min<size_t>(BC_BATCH_MAX, count - j);
+        for (size_t k = 0; k < nblocks * NUM_PIXELS_PER_BLOCK; ++k)
+        {
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[k]), pColor[j * NUM_PIXELS_PER_BLOCK + k]);
+        }
 
-                if (i < 12)
-                {
-                    if (i & 3)
-                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+        for (size_t k = 0; k < nblocks; ++k)
+        {
+            pBlocks[k] = &reinterpret_cast<D3DX_BC3 *>(pBC)[j + k].bc1;
+        }
 
-                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+        // RGB part
+        EncodeBC1Blocks(pBlocks, Color, nblocks, false, 0.f, flags);
 
-                    if (3 != (i & 3))
-                        fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
+        // Alpha part
+        for (size_t k = 0; k < nblocks; ++k)
+        {
+            EncodeBC3Alpha(&reinterpret_cast<D3DX_BC3 *>(pBC)[j + k], &Color[k * NUM_PIXELS_PER_BLOCK], flags);
         }
-
-        pBC3->bitmap[0 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[0];
-        pBC3->bitmap[1 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[1];
-        pBC3->bitmap[2 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[2];
     }
 }
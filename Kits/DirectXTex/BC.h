@@ -22,6 +22,7 @@ namespace DirectX
 
 // Because these are used in SAL annotations, they need to remain macros rather than const values
 #define NUM_PIXELS_PER_BLOCK 16
+#define BC_BATCH_MAX 8
 
 //-------------------------------------------------------------------------------------
 // Constants
@@ -35,6 +36,8 @@ enum BC_FLAGS : uint32_t
     BC_FLAGS_UNIFORM            = 0x40000,  // By default, uses perceptual weighting for BC1-3; this flag makes it a uniform weighting
     BC_FLAGS_USE_3SUBSETS       = 0x80000,  // By default, BC7 skips mode 0 & 2; this flag adds those modes back
     BC_FLAGS_FORCE_BC7_MODE6    = 0x100000, // BC7 should only use mode 6; skip other modes
+    BC_FLAGS_BC7_QUALITY_MASK   = 0xE00000, // BC7 quality level + 1 (0 means exhaustive search); lower levels prune the mode/partition search
+    BC_FLAGS_BC6H_QUICK         = 0x20000000, // BC6H tries a reduced set of modes and partitions
 };
 
 //-------------------------------------------------------------------------------------
@@ -327,4 +330,8 @@ void D3DXEncodeBC6HU(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BL
 void D3DXEncodeBC6HS(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 void D3DXEncodeBC7(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 
+void D3DXEncodeBC1Batch(_Out_writes_(8 * count) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK * count) const XMVECTOR *pColor, _In_ size_t count, _In_ float threshold, _In_ uint32_t flags) noexcept;
+void D3DXEncodeBC3Batch(_Out_writes_(16 * count) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK * count) const XMVECTOR *pColor, _In_ size_t count, _In_ uint32_t flags) noexcept;
+    // Encode 'count' consecutive blocks using SIMD when available; output is identical to the per-block encoders
+
 } // namespace
@@ -41,6 +41,11 @@ namespace
     constexpr size_t BC6H_NUM_CHANNELS = 3;
     constexpr size_t BC6H_MAX_SHAPES = 32;
 
+    // BC6H quick search: mode info entries 0, 1, 5, 9 (two regions) and 10-13 (one region),
+    // refining only the best few shapes per mode
+    constexpr uint32_t BC6H_QUICK_MODES = 0x3E23;
+    constexpr size_t BC6H_QUICK_SHAPES = 2;
+
     constexpr size_t BC7_NUM_CHANNELS = 4;
     constexpr size_t BC7_MAX_SHAPES = 64;
 
@@ -657,7 +662,7 @@ namespace
     {
     public:
         void Decode(_In_ bool bSigned, _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA* pOut) const noexcept;
-        void Encode(_In_ bool bSigned, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
+        void Encode(_In_ bool bSigned, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn, _In_ uint32_t flags) noexcept;
 
     private:
 #pragma warning(push)
@@ -703,14 +708,15 @@ namespace
         {
             float fBestErr;
             const bool bSigned;
+            const bool bQuick;
             uint8_t uMode;
             uint8_t uShape;
             const HDRColorA* const aHDRPixels;
             INTEndPntPair aUnqEndPts[BC6H_MAX_SHAPES][BC6H_MAX_REGIONS];
             INTColor aIPixels[NUM_PIXELS_PER_BLOCK];
 
-            EncodeParams(const HDRColorA* const aOriginal, bool bSignedFormat) noexcept :
-                fBestErr(FLT_MAX), bSigned(bSignedFormat), uMode(0), uShape(0), aHDRPixels(aOriginal), aUnqEndPts{}, aIPixels{}
+            EncodeParams(const HDRColorA* const aOriginal, bool bSignedFormat, bool bQuickSearch) noexcept :
+                fBestErr(FLT_MAX), bSigned(bSignedFormat), bQuick(bQuickSearch), uMode(0), uShape(0), aHDRPixels(aOriginal), aUnqEndPts{}, aIPixels{}
             {
                 for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
                 {
@@ -729,6 +735,10 @@ namespace
         void GeneratePaletteQuantized(_In_ const EncodeParams* pEP, _In_ const INTEndPntPair& endPts,
             _Out_writes_(BC6H_MAX_INDICES) INTColor aPalette[]) const noexcept;
         float MapColorsQuantized(_In_ const EncodeParams* pEP, _In_reads_(np) const INTColor aColors[], _In_ size_t np, _In_ const INTEndPntPair &endPts) const noexcept;
+        static float MapColorsQuantizedScalar(_In_reads_(np) const INTColor aColors[], _In_ size_t np,
+            _In_reads_(uNumIndices) const INTColor aPalette[], _In_ size_t uNumIndices) noexcept;
+        static float MapColorsQuantizedSIMD(_In_reads_(np) const INTColor aColors[], _In_ size_t np,
+            _In_reads_(uNumIndices) const INTColor aPalette[], _In_ size_t uNumIndices) noexcept;
         float PerturbOne(_In_ const EncodeParams* pEP, _In_reads_(np) const INTColor aColors[], _In_ size_t np, _In_ uint8_t ch,
             _In_ const INTEndPntPair& oldEndPts, _Out_ INTEndPntPair& newEndPts, _In_ float fOldErr, _In_ int do_b) const noexcept;
         void OptimizeOne(_In_ const EncodeParams* pEP, _In_reads_(np) const INTColor aColors[], _In_ size_t np, _In_ float aOrgErr,
@@ -1637,6 +1647,139 @@ namespace
 #endif
         }
     }
+
+    //-------------------------------------------------------------------------------------
+    // BC7 search effort for each quality level (see TEX_COMPRESS_BC7_QUALITY_*)
+    //-------------------------------------------------------------------------------------
+    struct BC7QualityLevel
+    {
+        uint8_t uModes;         // Mask of modes to try (modes 0 & 2 also require BC_FLAGS_USE_3SUBSETS)
+        uint8_t uRankedShapes;  // Partitions kept after the cheap pre-ranking (0 to use them all)
+        uint8_t uRefineShift;   // Refine max(1, candidates >> shift) of the best rough partitions
+        bool bAllRotations;     // Try every rotation and index mode (modes 4 & 5)
+        bool bPruneModes;       // Skip refinement when the best rough error can't beat the best so far
+        float fGoodEnough;      // Stop searching once the block error is at or below this value
+    };
+
+    const BC7QualityLevel g_BC7Quality[] =
+    {
+        { 0x40, 0,  6, false, false, 0.f },     // 0: mode 6 only (same as TEX_COMPRESS_BC7_QUICK)
+        { 0xE2, 8,  6, false, true,  48.f },    // 1: modes 1, 5, 6, 7
+        { 0xFA, 16, 3, true,  true,  16.f },    // 2: modes 1, 3-7
+        { 0xFF, 32, 3, true,  true,  4.f },     // 3: all modes
+        { 0xFF, 0,  2, true,  false, 0.f },     // 4: exhaustive search (default)
+    };
+
+    constexpr size_t BC7_MAX_QUALITY = std::size(g_BC7Quality) - 1;
+    constexpr uint32_t BC7_QUALITY_SHIFT = 21;
+    static_assert((BC_FLAGS_BC7_QUALITY_MASK >> BC7_QUALITY_SHIFT) == 0x7, "BC7 quality field mismatch");
+
+    inline size_t GetBC7Quality(uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_FORCE_BC7_MODE6)
+            return 0;
+
+        // Field holds the quality level + 1, with 0 meaning the default exhaustive search
+        const uint32_t field = (flags & BC_FLAGS_BC7_QUALITY_MASK) >> BC7_QUALITY_SHIFT;
+        return (field > 0) ? std::min<size_t>(field - 1, BC7_MAX_QUALITY) : BC7_MAX_QUALITY;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Cheap estimate of how well a partition fits the block: for each subset, the scatter
+    // left over after projecting onto its principal axis (trace minus largest eigenvalue
+    // of the RGBA covariance, approximated with a few power iterations)
+    //-------------------------------------------------------------------------------------
+    float EstimatePartitionError(
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const LDRColorA* const pPixels,
+        size_t uPartitions,
+        size_t uShape) noexcept
+    {
+        assert(uPartitions < BC7_MAX_REGIONS && uShape < BC7_MAX_SHAPES);
+
+        float afSum[BC7_MAX_REGIONS][4] = {};
+        float afCross[BC7_MAX_REGIONS][4][4] = {};
+        float afCount[BC7_MAX_REGIONS] = {};
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const size_t p = g_aPartitionTable[uPartitions][uShape][i];
+            const float c[4] = { float(pPixels[i].r), float(pPixels[i].g), float(pPixels[i].b), float(pPixels[i].a) };
+
+            afCount[p] += 1.f;
+            for (size_t j = 0; j < 4; ++j)
+            {
+                afSum[p][j] += c[j];
+                for (size_t k = j; k < 4; ++k)
+                    afCross[p][j][k] += c[j] * c[k];
+            }
+        }
+
+        float fError = 0.f;
+        for (size_t p = 0; p <= uPartitions; ++p)
+        {
+            if (afCount[p] < 3.f)
+            {
+                // One or two pixels are always represented exactly by the endpoints
+                continue;
+            }
+
+            // Covariance (scaled by pixel count)
+            float cov[4][4];
+            const float fInvCount = 1.f / afCount[p];
+            for (size_t j = 0; j < 4; ++j)
+            {
+                for (size_t k = j; k < 4; ++k)
+                {
+                    cov[j][k] = cov[k][j] = afCross[p][j][k] - afSum[p][j] * afSum[p][k] * fInvCount;
+                }
+            }
+
+            const float fTrace = cov[0][0] + cov[1][1] + cov[2][2] + cov[3][3];
+            if (fTrace <= 0.f)
+                continue;
+
+            // Start from the channel with the largest variance
+            size_t uMax = 0;
+            for (size_t j = 1; j < 4; ++j)
+            {
+                if (cov[j][j] > cov[uMax][uMax])
+                    uMax = j;
+            }
+
+            float v[4] = { cov[0][uMax], cov[1][uMax], cov[2][uMax], cov[3][uMax] };
+            for (size_t iteration = 0; iteration < 4; ++iteration)
+            {
+                float w[4];
+                float fLen = 0.f;
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    w[j] = cov[j][0] * v[0] + cov[j][1] * v[1] + cov[j][2] * v[2] + cov[j][3] * v[3];
+                    fLen = std::max(fLen, fabsf(w[j]));
+                }
+
+                if (fLen <= 0.f)
+                    break;
+
+                for (size_t j = 0; j < 4; ++j)
+                    v[j] = w[j] / fLen;
+            }
+
+            // Rayleigh quotient never exceeds the largest eigenvalue, so the estimate is conservative
+            float fVV = 0.f;
+            float fVCV = 0.f;
+            for (size_t j = 0; j < 4; ++j)
+            {
+                fVV += v[j] * v[j];
+                fVCV += v[j] * (cov[j][0] * v[0] + cov[j][1] * v[1] + cov[j][2] * v[2] + cov[j][3] * v[3]);
+            }
+
+            const float fLambda = (fVV > 0.f) ? (fVCV / fVV) : 0.f;
+            fError += std::max(0.f, fTrace - fLambda);
+        }
+
+        return fError;
+    }
 }
 
 
@@ -1805,45 +1948,66 @@ void D3DX_BC6H::Decode(bool bSigned, HDRColorA* pOut) const noexcept
 
 
 _Use_decl_annotations_
-void D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn) noexcept
+void D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn, uint32_t flags) noexcept
 {
     assert(pIn);
 
-    EncodeParams EP(pIn, bSigned);
+    EncodeParams EP(pIn, bSigned, (flags & BC_FLAGS_BC6H_QUICK) != 0);
+
+    const uint32_t uModes = EP.bQuick ? BC6H_QUICK_MODES : UINT32_MAX;
+
+    // The rough endpoints and errors only depend on the shape and index precision, which is the
+    // same for every mode with a given number of regions, so they are ranked once per region count
+    float afRoughMSE[BC6H_MAX_REGIONS][BC6H_MAX_SHAPES];
+    uint8_t auShape[BC6H_MAX_REGIONS][BC6H_MAX_SHAPES];
+    uint8_t auIndexPrec[BC6H_MAX_REGIONS] = {};
 
     for (EP.uMode = 0; EP.uMode < std::size(ms_aInfo) && EP.fBestErr > 0; ++EP.uMode)
     {
-        const uint8_t uShapes = ms_aInfo[EP.uMode].uPartitions ? 32u : 1u;
+        if (!(uModes & (1u << EP.uMode)))
+            continue;
+
+        const uint8_t uPartitions = ms_aInfo[EP.uMode].uPartitions;
+        assert(uPartitions < BC6H_MAX_REGIONS);
+        _Analysis_assume_(uPartitions < BC6H_MAX_REGIONS);
+
+        const uint8_t uShapes = uPartitions ? 32u : 1u;
         // Number of rough cases to look at. reasonable values of this are 1, uShapes/4, and uShapes
         // uShapes/4 gets nearly all the cases; you can increase that a bit (say by 3 or 4) if you really want to squeeze the last bit out
-        const size_t uItems = std::max<size_t>(1u, size_t(uShapes >> 2));
-        float afRoughMSE[BC6H_MAX_SHAPES];
-        uint8_t auShape[BC6H_MAX_SHAPES];
+        const size_t uItems = EP.bQuick
+            ? std::min<size_t>(uShapes, BC6H_QUICK_SHAPES)
+            : std::max<size_t>(1u, size_t(uShapes >> 2));
 
-        // pick the best uItems shapes and refine these.
-        for (EP.uShape = 0; EP.uShape < uShapes; ++EP.uShape)
+        if (!auIndexPrec[uPartitions])
         {
-            size_t uShape = EP.uShape;
-            afRoughMSE[uShape] = RoughMSE(&EP);
-            auShape[uShape] = static_cast<uint8_t>(uShape);
-        }
+            auIndexPrec[uPartitions] = ms_aInfo[EP.uMode].uIndexPrec;
 
-        // Bubble up the first uItems items
-        for (size_t i = 0; i < uItems; i++)
-        {
-            for (size_t j = i + 1; j < uShapes; j++)
+            // pick the best uItems shapes and refine these.
+            for (EP.uShape = 0; EP.uShape < uShapes; ++EP.uShape)
             {
-                if (afRoughMSE[i] > afRoughMSE[j])
+                size_t uShape = EP.uShape;
+                afRoughMSE[uPartitions][uShape] = RoughMSE(&EP);
+                auShape[uPartitions][uShape] = static_cast<uint8_t>(uShape);
+            }
+
+            // Bubble up the first uItems items
+            for (size_t i = 0; i < uItems; i++)
+            {
+                for (size_t j = i + 1; j < uShapes; j++)
                 {
-                    std::swap(afRoughMSE[i], afRoughMSE[j]);
-                    std::swap(auShape[i], auShape[j]);
+                    if (afRoughMSE[uPartitions][i] > afRoughMSE[uPartitions][j])
+                    {
+                        std::swap(afRoughMSE[uPartitions][i], afRoughMSE[uPartitions][j]);
+                        std::swap(auShape[uPartitions][i], auShape[uPartitions][j]);
+                    }
                 }
             }
         }
+        assert(auIndexPrec[uPartitions] == ms_aInfo[EP.uMode].uIndexPrec);
 
         for (size_t i = 0; i < uItems && EP.fBestErr > 0; i++)
         {
-            EP.uShape = auShape[i];
+            EP.uShape = auShape[uPartitions][i];
             Refine(&EP);
         }
     }
@@ -2035,6 +2199,23 @@ float D3DX_BC6H::MapColorsQuantized(const EncodeParams* pEP, const INTColor aCol
     INTColor aPalette[BC6H_MAX_INDICES];
     GeneratePaletteQuantized(pEP, endPts, aPalette);
 
+    if (!pEP->bQuick)
+        return MapColorsQuantizedScalar(aColors, np, aPalette, uNumIndices);
+
+    const float fTotErr = MapColorsQuantizedSIMD(aColors, np, aPalette, uNumIndices);
+
+#ifdef _DEBUG
+    // The quick search must not change the encoded blocks, only how fast they are found
+    assert(fTotErr == MapColorsQuantizedScalar(aColors, np, aPalette, uNumIndices));
+#endif
+
+    return fTotErr;
+}
+
+
+_Use_decl_annotations_
+float D3DX_BC6H::MapColorsQuantizedScalar(const INTColor aColors[], size_t np, const INTColor aPalette[], size_t uNumIndices) noexcept
+{
     float fTotErr = 0;
     for (size_t i = 0; i < np; ++i)
     {
@@ -2045,7 +2226,7 @@ float D3DX_BC6H::MapColorsQuantized(const EncodeParams* pEP, const INTColor aCol
         tpal = XMVectorSubtract(vcolors, tpal);
         float fBestErr = XMVectorGetX(XMVector3Dot(tpal, tpal));
 
-        for (int j = 1; j < uNumIndices && fBestErr > 0; ++j)
+        for (size_t j = 1; j < uNumIndices && fBestErr > 0; ++j)
         {
             // Compute ErrorMetricRGB
             tpal = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&aPalette[j]));
@@ -2060,6 +2241,61 @@ float D3DX_BC6H::MapColorsQuantized(const EncodeParams* pEP, const INTColor aCol
 }
 
 
+// Same as MapColorsQuantizedScalar, but scores four palette entries at a time against each color.
+// The per-entry error is summed in the same order as XMVector3Dot and the same early-out walk picks
+// the entry, so both versions return bit-identical errors and therefore encode identical blocks.
+_Use_decl_annotations_
+float D3DX_BC6H::MapColorsQuantizedSIMD(const INTColor aColors[], size_t np, const INTColor aPalette[], size_t uNumIndices) noexcept
+{
+    assert(uNumIndices > 0 && uNumIndices <= BC6H_MAX_INDICES && (uNumIndices % 4) == 0);
+    _Analysis_assume_(uNumIndices > 0 && uNumIndices <= BC6H_MAX_INDICES);
+
+    // Transpose the palette into per-channel planes
+    XMVECTOR vPalR[BC6H_MAX_INDICES / 4], vPalG[BC6H_MAX_INDICES / 4], vPalB[BC6H_MAX_INDICES / 4];
+    const size_t uGroups = uNumIndices / 4;
+    for (size_t j = 0; j < uGroups; ++j)
+    {
+        const INTColor* pal = &aPalette[j * 4];
+        vPalR[j] = XMVectorSet(float(pal[0].r), float(pal[1].r), float(pal[2].r), float(pal[3].r));
+        vPalG[j] = XMVectorSet(float(pal[0].g), float(pal[1].g), float(pal[2].g), float(pal[3].g));
+        vPalB[j] = XMVectorSet(float(pal[0].b), float(pal[1].b), float(pal[2].b), float(pal[3].b));
+    }
+
+    XMFLOAT4A aErr[BC6H_MAX_INDICES / 4];
+
+    float fTotErr = 0;
+    for (size_t i = 0; i < np; ++i)
+    {
+        // XMLoadSInt4 already converts to float lanes
+        const XMVECTOR vcolor = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&aColors[i]));
+        const XMVECTOR r = XMVectorSplatX(vcolor);
+        const XMVECTOR g = XMVectorSplatY(vcolor);
+        const XMVECTOR b = XMVectorSplatZ(vcolor);
+
+        for (size_t j = 0; j < uGroups; ++j)
+        {
+            // No multiply-add, which would round differently from XMVector3Dot
+            const XMVECTOR dr = XMVectorSubtract(r, vPalR[j]);
+            const XMVECTOR dg = XMVectorSubtract(g, vPalG[j]);
+            const XMVECTOR db = XMVectorSubtract(b, vPalB[j]);
+            XMVECTOR vErr = XMVectorAdd(XMVectorMultiply(dr, dr), XMVectorMultiply(dg, dg));
+            vErr = XMVectorAdd(vErr, XMVectorMultiply(db, db));
+            XMStoreFloat4A(&aErr[j], vErr);
+        }
+
+        const float* pErr = &aErr[0].x;
+        float fBestErr = pErr[0];
+        for (size_t j = 1; j < uNumIndices && fBestErr > 0; ++j)
+        {
+            if (pErr[j] > fBestErr) break;     // error increased, so we're done searching
+            if (pErr[j] < fBestErr) fBestErr = pErr[j];
+        }
+        fTotErr += fBestErr;
+    }
+    return fTotErr;
+}
+
+
 _Use_decl_annotations_
 float D3DX_BC6H::PerturbOne(const EncodeParams* pEP, const INTColor aColors[], size_t np, uint8_t ch,
     const INTEndPntPair& oldEndPts, INTEndPntPair& newEndPts, float fOldErr, int do_b) const noexcept
@@ -2746,7 +2982,14 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
 
     const bool bHasAlpha = (alphaMask != 0xFF);
 
-    for (EP.uMode = 0; EP.uMode < 8 && fMSEBest > 0; ++EP.uMode)
+    const BC7QualityLevel& quality = g_BC7Quality[GetBC7Quality(flags)];
+    const float fGoodEnough = quality.fGoodEnough;
+
+    // Cheap partition estimates for 2 and 3 subset modes, computed on first use
+    float afEstimate[2][BC7_MAX_SHAPES];
+    bool abEstimated[2] = {};
+
+    for (EP.uMode = 0; EP.uMode < 8 && fMSEBest > fGoodEnough; ++EP.uMode)
     {
         if (!(flags & BC_FLAGS_USE_3SUBSETS) && (EP.uMode == 0 || EP.uMode == 2))
         {
@@ -2754,9 +2997,9 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
             continue;
         }
 
-        if ((flags & TEX_COMPRESS_BC7_QUICK) && (EP.uMode != 6))
+        if (!(quality.uModes & (1u << EP.uMode)))
         {
-            // Use only mode 6
+            // Mode not searched at this quality level (TEX_COMPRESS_BC7_QUICK uses only mode 6)
             continue;
         }
 
@@ -2770,15 +3013,42 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
         assert(uShapes <= BC7_MAX_SHAPES);
         _Analysis_assume_(uShapes <= BC7_MAX_SHAPES);
 
-        const size_t uNumRots = size_t(1) << ms_aInfo[EP.uMode].uRotationBits;
-        const size_t uNumIdxMode = size_t(1) << ms_aInfo[EP.uMode].uIndexModeBits;
+        const size_t uNumRots = quality.bAllRotations ? (size_t(1) << ms_aInfo[EP.uMode].uRotationBits) : 1u;
+        const size_t uNumIdxMode = quality.bAllRotations ? (size_t(1) << ms_aInfo[EP.uMode].uIndexModeBits) : 1u;
+
+        // Candidate shapes are either all of them, or the best few by the cheap estimate
+        size_t auCandidates[BC7_MAX_SHAPES];
+        size_t uCandidates = uShapes;
+        for (size_t s = 0; s < uShapes; s++)
+        {
+            auCandidates[s] = s;
+        }
+
+        const uint8_t uPartitions = ms_aInfo[EP.uMode].uPartitions;
+        if (quality.uRankedShapes > 0 && uPartitions > 0 && uShapes > quality.uRankedShapes)
+        {
+            const float* afEst = afEstimate[uPartitions - 1];
+            if (!abEstimated[uPartitions - 1])
+            {
+                for (size_t s = 0; s < BC7_MAX_SHAPES; s++)
+                {
+                    afEstimate[uPartitions - 1][s] = EstimatePartitionError(EP.aLDRPixels, uPartitions, s);
+                }
+                abEstimated[uPartitions - 1] = true;
+            }
+
+            uCandidates = quality.uRankedShapes;
+            std::partial_sort(auCandidates, auCandidates + uCandidates, auCandidates + uShapes,
+                [afEst](size_t a, size_t b) noexcept { return afEst[a] < afEst[b]; });
+        }
+
         // Number of rough cases to look at. reasonable values of this are 1, uShapes/4, and uShapes
         // uShapes/4 gets nearly all the cases; you can increase that a bit (say by 3 or 4) if you really want to squeeze the last bit out
-        const size_t uItems = std::max<size_t>(1, uShapes >> 2);
+        const size_t uItems = std::max<size_t>(1, uCandidates >> quality.uRefineShift);
         float afRoughMSE[BC7_MAX_SHAPES];
         size_t auShape[BC7_MAX_SHAPES];
 
-        for (size_t r = 0; r < uNumRots && fMSEBest > 0; ++r)
+        for (size_t r = 0; r < uNumRots && fMSEBest > fGoodEnough; ++r)
         {
             switch (r)
             {
@@ -2787,19 +3057,19 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
             case 3: for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; i++) std::swap(EP.aLDRPixels[i].b, EP.aLDRPixels[i].a); break;
             }
 
-            for (size_t im = 0; im < uNumIdxMode && fMSEBest > 0; ++im)
+            for (size_t im = 0; im < uNumIdxMode && fMSEBest > fGoodEnough; ++im)
             {
                 // pick the best uItems shapes and refine these.
-                for (size_t s = 0; s < uShapes; s++)
+                for (size_t i = 0; i < uCandidates; i++)
                 {
-                    afRoughMSE[s] = RoughMSE(&EP, s, im);
-                    auShape[s] = s;
+                    afRoughMSE[i] = RoughMSE(&EP, auCandidates[i], im);
+                    auShape[i] = auCandidates[i];
                 }
 
                 // Bubble up the first uItems items
                 for (size_t i = 0; i < uItems; i++)
                 {
-                    for (size_t j = i + 1; j < uShapes; j++)
+                    for (size_t j = i + 1; j < uCandidates; j++)
                     {
                         if (afRoughMSE[i] > afRoughMSE[j])
                         {
@@ -2809,7 +3079,13 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
                     }
                 }
 
-                for (size_t i = 0; i < uItems && fMSEBest > 0; i++)
+                if (quality.bPruneModes && (afRoughMSE[0] >= fMSEBest))
+                {
+                    // Even the best rough fit can't improve on what we already have
+                    continue;
+                }
+
+                for (size_t i = 0; i < uItems && fMSEBest > fGoodEnough; i++)
                 {
                     float fMSE = Refine(&EP, auShape[i], r, im);
                     if (fMSE < fMSEBest)
@@ -3530,19 +3806,17 @@ void DirectX::D3DXDecodeBC6HS(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC6HU(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
-    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(false, reinterpret_cast<const HDRColorA*>(pColor));
+    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(false, reinterpret_cast<const HDRColorA*>(pColor), flags);
 }
 
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC6HS(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
-    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(true, reinterpret_cast<const HDRColorA*>(pColor));
+    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(true, reinterpret_cast<const HDRColorA*>(pColor), flags);
 }
 
 
@@ -186,8 +186,9 @@ HRESULT GPUCompressBC::Prepare(size_t width, size_t height, uint32_t flags, DXGI
 
     m_alphaWeight = alphaWeight;
 
-    if (flags & TEX_COMPRESS_BC7_QUICK)
+    if ((flags & TEX_COMPRESS_BC7_QUICK) || ((flags & TEX_COMPRESS_BC7_QUALITY_MASK) == TEX_COMPRESS_BC7_QUALITY_0))
     {
+        // The DirectCompute codec only distinguishes the fastest quality level
         m_bc7_mode02 = false;
         m_bc7_mode137 = false;
     }
@@ -204,6 +204,14 @@ namespace DirectX
             // Enables the loader to read large dimension .dds files (i.e. greater than known hardware requirements)
     };
 
+    enum HDR_FLAGS : unsigned long
+    {
+        HDR_FLAGS_NONE                 = 0x0,
+
+        HDR_FLAGS_PARALLEL             = 0x10000000,
+            // Reader/writer is free to decode or encode bands of scanlines using multithreading (results match the single-threaded path)
+    };
+
     enum TGA_FLAGS : unsigned long
     {
         TGA_FLAGS_NONE                 = 0x0,
@@ -225,6 +233,9 @@ namespace DirectX
 
         TGA_FLAGS_DEFAULT_SRGB         = 0x80,
             // If no colorspace is specified in TGA 2.0 metadata, assume sRGB
+
+        TGA_FLAGS_PARALLEL             = 0x10000000,
+            // Loader is free to decode bands of RLE scanlines using multithreading (results match the single-threaded path)
     };
 
     enum WIC_FLAGS : unsigned long
@@ -411,6 +422,65 @@ namespace DirectX
         size_t  m_size;
     };
 
+    //---------------------------------------------------------------------------------
+    // Read-only image set whose pixels point directly into a memory-mapped file
+    class MappedImage
+    {
+    public:
+        MappedImage() noexcept
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_view(nullptr), m_viewSize(0) {}
+        MappedImage(MappedImage&& moveFrom) noexcept
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_view(nullptr), m_viewSize(0) { *this = std::move(moveFrom); }
+        ~MappedImage() { Release(); }
+
+        MappedImage& __cdecl operator= (MappedImage&& moveFrom) noexcept;
+
+        MappedImage(const MappedImage&) = delete;
+        MappedImage& operator=(const MappedImage&) = delete;
+
+        HRESULT __cdecl Initialize(_In_z_ const wchar_t* szFile) noexcept;
+            // Maps the whole file read-only; call SetupImages to describe its contents
+
+        HRESULT __cdecl SetupImages(_In_ const TexMetadata& mdata, _In_ size_t offset, _In_ CP_FLAGS flags = CP_FLAGS_NONE) noexcept;
+            // Lays out the image array for mdata starting offset bytes into the mapping
+
+        void __cdecl Release() noexcept;
+
+        const TexMetadata& __cdecl GetMetadata() const noexcept { return m_metadata; }
+        const Image* __cdecl GetImage(_In_ size_t mip, _In_ size_t item, _In_ size_t slice) const noexcept;
+
+        const Image* __cdecl GetImages() const noexcept { return m_image; }
+        size_t __cdecl GetImageCount() const noexcept { return m_nimages; }
+            // Image pixels are backed by a read-only mapping and must not be written
+
+        const uint8_t* __cdecl GetPixels() const noexcept { return m_memory; }
+        size_t __cdecl GetPixelsSize() const noexcept { return m_size; }
+
+        const uint8_t* __cdecl GetFileData() const noexcept { return static_cast<const uint8_t*>(m_view); }
+        size_t __cdecl GetFileSize() const noexcept { return m_viewSize; }
+
+    private:
+        size_t          m_nimages;
+        size_t          m_size;
+        TexMetadata     m_metadata;
+        Image*          m_image;
+        const uint8_t*  m_memory;
+        void*           m_view;
+        size_t          m_viewSize;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Multithreading control (used by TEX_COMPRESS_PARALLEL and other parallel operations)
+    using ParallelExecutor = std::function<void __cdecl(size_t workers, const std::function<void __cdecl(size_t worker)>& work)>;
+        // Must invoke work(0) through work(workers - 1), potentially concurrently, and return only once all have completed
+
+    void __cdecl SetParallelThreadCount(_In_ size_t threads) noexcept;
+    size_t __cdecl GetParallelThreadCount() noexcept;
+        // Maximum number of worker threads; 0 (the default) uses all hardware threads, 1 disables multithreading
+
+    void __cdecl SetParallelExecutor(_In_opt_ ParallelExecutor executor);
+        // Routes parallel work through an application thread pool instead of the built-in std::thread scheduler (nullptr restores the default)
+
     //---------------------------------------------------------------------------------
     // Image I/O
 
@@ -423,6 +493,12 @@ namespace DirectX
         _In_z_ const wchar_t* szFile,
         _In_ DDS_FLAGS flags,
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl LoadFromDDSFile(
+        _In_z_ const wchar_t* szFile,
+        _In_ DDS_FLAGS flags,
+        _Out_opt_ TexMetadata* metadata, _Out_ MappedImage& image) noexcept;
+        // Zero-copy load that maps the file rather than reading it
+        // Returns HRESULT_E_NOT_SUPPORTED for files that need legacy format conversion, which must use the ScratchImage version
 
     HRESULT __cdecl SaveToDDSMemory(
         _In_ const Image& image,
@@ -441,13 +517,15 @@ namespace DirectX
     // HDR operations
     HRESULT __cdecl LoadFromHDRMemory(
         _In_reads_bytes_(size) const void* pSource, _In_ size_t size,
+        _In_ HDR_FLAGS flags,
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
     HRESULT __cdecl LoadFromHDRFile(
         _In_z_ const wchar_t* szFile,
+        _In_ HDR_FLAGS flags,
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
 
-    HRESULT __cdecl SaveToHDRMemory(_In_ const Image& image, _Out_ Blob& blob) noexcept;
-    HRESULT __cdecl SaveToHDRFile(_In_ const Image& image, _In_z_ const wchar_t* szFile) noexcept;
+    HRESULT __cdecl SaveToHDRMemory(_In_ const Image& image, _In_ HDR_FLAGS flags, _Out_ Blob& blob) noexcept;
+    HRESULT __cdecl SaveToHDRFile(_In_ const Image& image, _In_ HDR_FLAGS flags, _In_z_ const wchar_t* szFile) noexcept;
 
     // TGA operations
     HRESULT __cdecl LoadFromTGAMemory(
@@ -500,6 +578,16 @@ namespace DirectX
 #endif // WIN32
 
     // Compatability helpers
+    HRESULT __cdecl LoadFromHDRMemory(
+        _In_reads_bytes_(size) const void* pSource, _In_ size_t size,
+        _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl LoadFromHDRFile(
+        _In_z_ const wchar_t* szFile,
+        _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
+
+    HRESULT __cdecl SaveToHDRMemory(_In_ const Image& image, _Out_ Blob& blob) noexcept;
+    HRESULT __cdecl SaveToHDRFile(_In_ const Image& image, _In_z_ const wchar_t* szFile) noexcept;
+
     HRESULT __cdecl LoadFromTGAMemory(
         _In_reads_bytes_(size) const void* pSource, _In_ size_t size,
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
@@ -570,6 +658,10 @@ namespace DirectX
         TEX_FILTER_TRIANGLE         = 0x500000,
             // Filtering mode to use for any required image resizing
 
+        TEX_FILTER_LANCZOS          = 0x600000,
+        TEX_FILTER_MITCHELL         = 0x700000,
+            // Separable windowed filters (Lanczos-3, Mitchell-Netravali B=C=1/3) for non-WIC resizing and 1D/2D mipmap generation
+
         TEX_FILTER_SRGB_IN          = 0x1000000,
         TEX_FILTER_SRGB_OUT         = 0x2000000,
         TEX_FILTER_SRGB             = (TEX_FILTER_SRGB_IN | TEX_FILTER_SRGB_OUT),
@@ -582,6 +674,13 @@ namespace DirectX
 
         TEX_FILTER_FORCE_WIC        = 0x20000000,
             // Forces use of the WIC path even when logic would have picked a non-WIC path when both are an option
+
+        TEX_FILTER_PARALLEL         = 0x40000000,
+            // Non-WIC mipmap generation and resizing are free to use multithreading (results match the single-threaded path)
+            // Rows of each level are split into bands across all array items, see SetParallelThreadCount / SetParallelExecutor
+
+        TEX_FILTER_FORCE_SCANLINE   = 0x80000000,
+            // Forces non-WIC conversions through the generic float4 scanline path instead of the direct format-pair kernels
     };
 
     constexpr unsigned long TEX_FILTER_DITHER_MASK  = 0xF0000;
@@ -624,6 +723,10 @@ namespace DirectX
         // levels of '0' indicates a full mipchain, otherwise is generates that number of total levels (including the source base image)
         // Defaults to Fant filtering which is equivalent to a box filter
 
+    HRESULT __cdecl GenerateMipLevel(_In_ const Image& srcImage, _In_ TEX_FILTER_FLAGS filter, _In_ const Image& destImage) noexcept;
+        // Filters the next 2D mip level from srcImage into a caller-owned destImage of the same format and half the size
+        // Matches the non-WIC GenerateMipMaps level for level when given the same explicit filter mode (not triangle)
+
     HRESULT __cdecl GenerateMipMaps3D(
         _In_reads_(depth) const Image* baseImages, _In_ size_t depth, _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels,
         _Out_ ScratchImage& mipChain) noexcept;
@@ -661,6 +764,9 @@ namespace DirectX
         _In_ TEX_PMALPHA_FLAGS flags, _Out_ ScratchImage& result) noexcept;
         // Converts to/from a premultiplied alpha version of the texture
 
+    HRESULT __cdecl PremultiplyAlpha(_In_ const Image& image, _In_ TEX_PMALPHA_FLAGS flags) noexcept;
+        // Converts to/from premultiplied alpha in place
+
     enum TEX_COMPRESS_FLAGS : unsigned long
     {
         TEX_COMPRESS_DEFAULT            = 0,
@@ -683,6 +789,15 @@ namespace DirectX
         TEX_COMPRESS_BC7_QUICK          = 0x100000,
             // Minimal modes (usually mode 6) for BC7 compression
 
+        TEX_COMPRESS_BC7_QUALITY_0      = 0x200000,
+        TEX_COMPRESS_BC7_QUALITY_1      = 0x400000,
+        TEX_COMPRESS_BC7_QUALITY_2      = 0x600000,
+        TEX_COMPRESS_BC7_QUALITY_3      = 0x800000,
+        TEX_COMPRESS_BC7_QUALITY_4      = 0xA00000,
+        TEX_COMPRESS_BC7_QUALITY_MASK   = 0xE00000,
+            // Graded search effort for the BC7 CPU codec, from 0 (fastest, same as BC7_QUICK) to 4 (exhaustive, the default)
+            // Lower levels pre-rank partitions with a cheap error estimate, prune modes, and stop once a block is good enough
+
         TEX_COMPRESS_SRGB_IN            = 0x1000000,
         TEX_COMPRESS_SRGB_OUT           = 0x2000000,
         TEX_COMPRESS_SRGB               = (TEX_COMPRESS_SRGB_IN | TEX_COMPRESS_SRGB_OUT),
@@ -691,6 +806,10 @@ namespace DirectX
 
         TEX_COMPRESS_PARALLEL           = 0x10000000,
             // Compress is free to use multithreading to improve performance (by default it does not use multithreading)
+            // Work is split by block rows across all images, see SetParallelThreadCount / SetParallelExecutor
+
+        TEX_COMPRESS_BC6H_QUICK         = 0x20000000,
+            // Reduced mode/partition search for the BC6H CPU codec with vectorized endpoint refinement
     };
 
     HRESULT __cdecl Compress(
@@ -701,6 +820,16 @@ namespace DirectX
         _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages) noexcept;
         // Note that threshold is only used by BC1. TEX_THRESHOLD_DEFAULT is a typical value to use
 
+    HRESULT __cdecl CompressStream(
+        _In_ size_t width, _In_ size_t height, _In_ DXGI_FORMAT srcFormat,
+        _In_ std::function<HRESULT __cdecl(size_t y, _In_ const Image& band)> pixelSource,
+        _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold,
+        _In_ std::function<HRESULT __cdecl(size_t y, _In_ const Image& blocks)> blockSink) noexcept;
+        // Compresses an image one band of scanlines at a time so peak memory is proportional to the width, not the whole image
+        // pixelSource must fill band.pixels with scanlines y to y + band.height - 1 (a multiple of 4 rows, except at the bottom edge)
+        // blockSink receives the BC blocks for the same scanlines, in top to bottom order
+        // With TEX_COMPRESS_PARALLEL each band holds one row of blocks per worker thread
+
 #if defined(__d3d11_h__) || defined(__d3d11_x_h__)
     HRESULT __cdecl Compress(
         _In_ ID3D11Device* pDevice, _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress,
@@ -768,6 +897,73 @@ namespace DirectX
         _In_ const Image& srcImage, _In_ const Rect& srcRect, _In_ const Image& dstImage,
         _In_ TEX_FILTER_FLAGS filter, _In_ size_t xOffset, _In_ size_t yOffset) noexcept;
 
+    //---------------------------------------------------------------------------------
+    // Random-access BC decompression
+    //
+    // Decodes the 4x4 blocks of a compressed image on demand, keeping the most recently
+    // used blocks in a fixed-size cache. The compressed pixels are referenced rather than
+    // copied, so they must outlive the reader. Not free-threaded: use a reader per thread.
+    class BCBlockReader
+    {
+    public:
+        BCBlockReader() noexcept
+            : m_image{}, m_format(DXGI_FORMAT_UNKNOWN), m_blockSize(0), m_blocksX(0), m_blocksY(0),
+            m_capacity(0), m_used(0), m_head(UINT32_MAX), m_bucketMask(0), m_hits(0), m_misses(0),
+            m_pfDecode(nullptr), m_blocks(nullptr), m_entries(nullptr), m_buckets(nullptr) {}
+        BCBlockReader(BCBlockReader&& moveFrom) noexcept
+            : m_image{}, m_format(DXGI_FORMAT_UNKNOWN), m_blockSize(0), m_blocksX(0), m_blocksY(0),
+            m_capacity(0), m_used(0), m_head(UINT32_MAX), m_bucketMask(0), m_hits(0), m_misses(0),
+            m_pfDecode(nullptr), m_blocks(nullptr), m_entries(nullptr), m_buckets(nullptr) { *this = std::move(moveFrom); }
+        ~BCBlockReader() { Release(); }
+
+        BCBlockReader& __cdecl operator= (BCBlockReader&& moveFrom) noexcept;
+
+        BCBlockReader(const BCBlockReader&) = delete;
+        BCBlockReader& operator=(const BCBlockReader&) = delete;
+
+        HRESULT __cdecl Initialize(_In_ const Image& cImage, _In_ size_t cacheBlocks = 4096) noexcept;
+            // Each cached block takes 256 bytes, so the default cache is 1 MB
+
+        void __cdecl Release() noexcept;
+
+        HRESULT __cdecl DecodeBlock(_In_ size_t bx, _In_ size_t by, _Out_writes_(16) XMVECTOR* pixels) noexcept;
+            // Returns the 16 pixels of block (bx,by) in row order, as decoded from the BC format (i.e. without conversion)
+
+        HRESULT __cdecl DecodeRect(
+            _In_ const Rect& srcRect, _In_ const Image& dstImage, _In_ size_t xOffset, _In_ size_t yOffset) noexcept;
+        HRESULT __cdecl DecodeRect(_In_ const Rect& srcRect, _In_ DXGI_FORMAT format, _Out_ ScratchImage& image) noexcept;
+            // Decodes a rectangle of pixels, touching only the blocks it overlaps
+            // DXGI_FORMAT_UNKNOWN picks the same default format as Decompress
+
+        void __cdecl ClearCache() noexcept;
+
+        const Image& __cdecl GetImage() const noexcept { return m_image; }
+
+        size_t __cdecl GetCacheHits() const noexcept { return m_hits; }
+        size_t __cdecl GetCacheMisses() const noexcept { return m_misses; }
+
+    private:
+        struct CacheEntry;
+
+        const XMVECTOR* __cdecl GetBlock(size_t bx, size_t by) noexcept;
+
+        Image           m_image;
+        DXGI_FORMAT     m_format;
+        size_t          m_blockSize;
+        size_t          m_blocksX;
+        size_t          m_blocksY;
+        uint32_t        m_capacity;
+        uint32_t        m_used;
+        uint32_t        m_head;
+        uint32_t        m_bucketMask;
+        size_t          m_hits;
+        size_t          m_misses;
+        void            (*m_pfDecode)(XMVECTOR* pColor, const uint8_t* pBC);
+        XMVECTOR*       m_blocks;
+        CacheEntry*     m_entries;
+        uint32_t*       m_buckets;
+    };
+
     enum CMSE_FLAGS : unsigned long
     {
         CMSE_DEFAULT                = 0,
@@ -785,10 +981,27 @@ namespace DirectX
         CMSE_IMAGE1_X2_BIAS         = 0x100,
         CMSE_IMAGE2_X2_BIAS         = 0x200,
             // Indicates that image should be scaled and biased before comparison (i.e. UNORM -> SNORM)
+
+        CMSE_PARALLEL               = 0x10000000,
+            // Compare bands of rows using multithreading (sums are combined per band, so results may differ in the last bits)
     };
 
     HRESULT __cdecl ComputeMSE(_In_ const Image& image1, _In_ const Image& image2, _Out_ float& mse, _Out_writes_opt_(4) float* mseV, _In_ CMSE_FLAGS flags = CMSE_DEFAULT) noexcept;
 
+    struct ImageMetrics
+    {
+        float   mse;        // Sum of the per-channel MSE (same as ComputeMSE)
+        float   mseV[4];
+        float   psnr;       // Peak signal-to-noise ratio in dB of the mean compared-channel MSE, for a peak value of 1.0
+        float   psnrV[4];
+        float   ssim;       // Mean structural similarity index of the compared channels
+        float   ssimV[4];
+    };
+
+    HRESULT __cdecl ComputeImageMetrics(_In_ const Image& image1, _In_ const Image& image2, _Out_ ImageMetrics& metrics, _In_ CMSE_FLAGS flags = CMSE_DEFAULT) noexcept;
+        // Computes MSE, PSNR, and SSIM (8x8 windows at a stride of 4) for each channel in a single pass over both images
+        // Ignored channels report an MSE of 0 and an SSIM of 1, and are excluded from psnr and ssim
+
     HRESULT __cdecl EvaluateImage(
         _In_ const Image& image,
         _In_ std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc);
@@ -16,6 +16,7 @@
 //=====================================================================================
 DEFINE_ENUM_FLAG_OPERATORS(CP_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(DDS_FLAGS);
+DEFINE_ENUM_FLAG_OPERATORS(HDR_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TGA_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(WIC_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TEX_FR_FLAGS);
@@ -154,6 +155,30 @@ inline HRESULT __cdecl SaveToDDSFile(const Image& image, DDS_FLAGS flags, const
 //=====================================================================================
 // Compatability helpers
 //=====================================================================================
+_Use_decl_annotations_
+inline HRESULT __cdecl LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata* metadata, ScratchImage& image) noexcept
+{
+    return LoadFromHDRMemory(pSource, size, HDR_FLAGS_NONE, metadata, image);
+}
+
+_Use_decl_annotations_
+inline HRESULT __cdecl LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, ScratchImage& image) noexcept
+{
+    return LoadFromHDRFile(szFile, HDR_FLAGS_NONE, metadata, image);
+}
+
+_Use_decl_annotations_
+inline HRESULT __cdecl SaveToHDRMemory(const Image& image, Blob& blob) noexcept
+{
+    return SaveToHDRMemory(image, HDR_FLAGS_NONE, blob);
+}
+
+_Use_decl_annotations_
+inline HRESULT __cdecl SaveToHDRFile(const Image& image, const wchar_t* szFile) noexcept
+{
+    return SaveToHDRFile(image, HDR_FLAGS_NONE, szFile);
+}
+
 _Use_decl_annotations_
 inline HRESULT __cdecl GetMetadataFromTGAMemory(const void* pSource, size_t size, TexMetadata& metadata) noexcept
 {
@@ -11,11 +11,6 @@
 
 #include "DirectXTexP.h"
 
-#ifdef _OPENMP
-#include <omp.h>
-#pragma warning(disable : 4616 6993)
-#endif
-
 #include "BC.h"
 
 using namespace DirectX;
@@ -30,7 +25,9 @@ namespace
         static_assert(static_cast<int>(TEX_COMPRESS_UNIFORM) == static_cast<int>(BC_FLAGS_UNIFORM), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_USE_3SUBSETS) == static_cast<int>(BC_FLAGS_USE_3SUBSETS), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUICK) == static_cast<int>(BC_FLAGS_FORCE_BC7_MODE6), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
-        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6));
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUALITY_MASK) == static_cast<int>(BC_FLAGS_BC7_QUALITY_MASK), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC6H_QUICK) == static_cast<int>(BC_FLAGS_BC6H_QUICK), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6 | BC_FLAGS_BC7_QUALITY_MASK | BC_FLAGS_BC6H_QUICK));
     }
 
     inline TEX_FILTER_FLAGS GetSRGBFlags(_In_ TEX_COMPRESS_FLAGS compress) noexcept
@@ -68,12 +65,18 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    HRESULT CompressBC(
+    struct BCEncodeSettings
+    {
+        BC_ENCODE           pfEncode;
+        size_t              blocksize;
+        size_t              sbpp;
+        TEX_FILTER_FLAGS    cflags;
+    };
+
+    HRESULT DetermineCompressSettings(
         const Image& image,
         const Image& result,
-        uint32_t bcflags,
-        TEX_FILTER_FLAGS srgb,
-        float threshold) noexcept
+        BCEncodeSettings& settings) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -81,8 +84,7 @@ namespace
         assert(image.width == result.width);
         assert(image.height == result.height);
 
-        const DXGI_FORMAT format = image.format;
-        size_t sbpp = BitsPerPixel(format);
+        size_t sbpp = BitsPerPixel(image.format);
         if (!sbpp)
             return E_FAIL;
 
@@ -93,197 +95,93 @@ namespace
         }
 
         // Round to bytes
-        sbpp = (sbpp + 7) / 8;
-
-        uint8_t *pDest = result.pixels;
+        settings.sbpp = (sbpp + 7) / 8;
 
         // Determine BC format encoder
-        BC_ENCODE pfEncode;
-        size_t blocksize;
-        TEX_FILTER_FLAGS cflags;
-        if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
+        if (!DetermineEncoderSettings(result.format, settings.pfEncode, settings.blocksize, settings.cflags))
             return HRESULT_E_NOT_SUPPORTED;
 
-        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = image.pixels;
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
-        const size_t rowPitch = image.rowPitch;
-        for (size_t h = 0; h < image.height; h += 4)
-        {
-            const uint8_t *sptr = pSrc;
-            uint8_t* dptr = pDest;
-            size_t ph = std::min<size_t>(4, image.height - h);
-            size_t w = 0;
-            for (size_t count = 0; (count < result.rowPitch) && (w < image.width); count += blocksize, w += 4)
-            {
-                size_t pw = std::min<size_t>(4, image.width - w);
-                assert(pw > 0 && ph > 0);
-
-                ptrdiff_t bytesLeft = pEnd - sptr;
-                assert(bytesLeft > 0);
-                size_t bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft));
-                if (!_LoadScanline(&temp[0], pw, sptr, bytesToRead, format))
-                    return E_FAIL;
-
-                if (ph > 1)
-                {
-                    bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch);
-                    if (!_LoadScanline(&temp[4], pw, sptr + rowPitch, bytesToRead, format))
-                        return E_FAIL;
-
-                    if (ph > 2)
-                    {
-                        bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 2);
-                        if (!_LoadScanline(&temp[8], pw, sptr + rowPitch * 2, bytesToRead, format))
-                            return E_FAIL;
-
-                        if (ph > 3)
-                        {
-                            bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 3);
-                            if (!_LoadScanline(&temp[12], pw, sptr + rowPitch * 3, bytesToRead, format))
-                                return E_FAIL;
-                        }
-                    }
-                }
-
-                if (pw != 4 || ph != 4)
-                {
-                    // Replicate pixels for partial block
-                    static const size_t uSrc[] = { 0, 0, 0, 1 };
-
-                    if (pw < 4)
-                    {
-                        for (size_t t = 0; t < ph && t < 4; ++t)
-                        {
-                            for (size_t s = pw; s < 4; ++s)
-                            {
-#pragma prefast(suppress: 26000, "PREFAST false positive")
-                                temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                            }
-                        }
-                    }
-
-                    if (ph < 4)
-                    {
-                        for (size_t t = ph; t < 4; ++t)
-                        {
-                            for (size_t s = 0; s < 4; ++s)
-                            {
-#pragma prefast(suppress: 26000, "PREFAST false positive")
-                                temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                            }
-                        }
-                    }
-                }
-
-                _ConvertScanline(temp, 16, result.format, format, cflags | srgb);
-
-                if (pfEncode)
-                    pfEncode(dptr, temp, bcflags);
-                else
-                    D3DXEncodeBC1(dptr, temp, threshold, bcflags);
-
-                sptr += sbpp * 4;
-                dptr += blocksize;
-            }
+        return S_OK;
+    }
 
-            pSrc += rowPitch * 4;
-            pDest += result.rowPitch;
-        }
 
-        return S_OK;
+    //-------------------------------------------------------------------------------------
+    // Encodes consecutive BC1 or BC3 blocks
+    //-------------------------------------------------------------------------------------
+    inline void EncodeBatch(
+        _Out_ uint8_t* pDest,
+        _In_reads_(NUM_PIXELS_PER_BLOCK * count) const XMVECTOR* pBlocks,
+        size_t count,
+        const BCEncodeSettings& settings,
+        uint32_t bcflags,
+        float threshold) noexcept
+    {
+        if (settings.pfEncode)
+            D3DXEncodeBC3Batch(pDest, pBlocks, count, bcflags);
+        else
+            D3DXEncodeBC1Batch(pDest, pBlocks, count, threshold, bcflags);
     }
 
 
     //-------------------------------------------------------------------------------------
-#ifdef _OPENMP
-    HRESULT CompressBC_Parallel(
+    // Encodes one row of 4x4 blocks (source scanlines h through h + 3)
+    //-------------------------------------------------------------------------------------
+    HRESULT CompressBlockRow(
         const Image& image,
         const Image& result,
+        size_t h,
+        const BCEncodeSettings& settings,
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
         float threshold) noexcept
     {
-        if (!image.pixels || !result.pixels)
-            return E_POINTER;
-
-        assert(image.width == result.width);
-        assert(image.height == result.height);
+        assert(h < image.height && (h % 4) == 0);
 
         const DXGI_FORMAT format = image.format;
-        size_t sbpp = BitsPerPixel(format);
-        if (!sbpp)
-            return E_FAIL;
-
-        if (sbpp < 8)
-        {
-            // We don't support compressing from monochrome (DXGI_FORMAT_R1_UNORM)
-            return HRESULT_E_NOT_SUPPORTED;
-        }
-
-        // Round to bytes
-        sbpp = (sbpp + 7) / 8;
-
         const uint8_t *pEnd = image.pixels + image.slicePitch;
+        const size_t rowPitch = image.rowPitch;
 
-        // Determine BC format encoder
-        BC_ENCODE pfEncode;
-        size_t blocksize;
-        TEX_FILTER_FLAGS cflags;
-        if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
-            return HRESULT_E_NOT_SUPPORTED;
-
-        // Refactored version of loop to support parallel independance
-        const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+        const uint8_t *sptr = image.pixels + rowPitch * h;
+        uint8_t* dptr = result.pixels + result.rowPitch * (h / 4);
 
-        bool fail = false;
+        // BC1 and BC3 blocks are gathered so they can be encoded several at a time
+        const bool batch = !settings.pfEncode || (settings.pfEncode == D3DXEncodeBC3);
+        uint8_t* pBatch = dptr;
+        size_t nbatch = 0;
 
-#pragma omp parallel for
-        for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+        XM_ALIGNED_DATA(16) XMVECTOR blocks[NUM_PIXELS_PER_BLOCK * BC_BATCH_MAX];
+        const size_t ph = std::min<size_t>(4, image.height - h);
+        size_t w = 0;
+        for (size_t count = 0; (count < result.rowPitch) && (w < image.width); count += settings.blocksize, w += 4)
         {
-            int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
-
-            int y = nb / nbWidth;
-            int x = (nb - (y*nbWidth)) * 4;
-            y *= 4;
-
-            assert((x >= 0) && (x < int(image.width)));
-            assert((y >= 0) && (y < int(image.height)));
+            XMVECTOR* temp = &blocks[nbatch * NUM_PIXELS_PER_BLOCK];
 
-            size_t rowPitch = image.rowPitch;
-            const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
-
-            uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
-
-            size_t ph = std::min<size_t>(4, image.height - size_t(y));
-            size_t pw = std::min<size_t>(4, image.width - size_t(x));
+            const size_t pw = std::min<size_t>(4, image.width - w);
             assert(pw > 0 && ph > 0);
 
-            ptrdiff_t bytesLeft = pEnd - pSrc;
+            const ptrdiff_t bytesLeft = pEnd - sptr;
             assert(bytesLeft > 0);
-            size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
-
-            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-            if (!_LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
-                fail = true;
+            size_t bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft));
+            if (!_LoadScanline(&temp[0], pw, sptr, bytesToRead, format))
+                return E_FAIL;
 
             if (ph > 1)
             {
-                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
-                if (!_LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
-                    fail = true;
+                bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch);
+                if (!_LoadScanline(&temp[4], pw, sptr + rowPitch, bytesToRead, format))
+                    return E_FAIL;
 
                 if (ph > 2)
                 {
-                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
-                    if (!_LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
-                        fail = true;
+                    bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 2);
+                    if (!_LoadScanline(&temp[8], pw, sptr + rowPitch * 2, bytesToRead, format))
+                        return E_FAIL;
 
                     if (ph > 3)
                     {
-                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
-                        if (!_LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
-                            fail = true;
+                        bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 3);
+                        if (!_LoadScanline(&temp[12], pw, sptr + rowPitch * 3, bytesToRead, format))
+                            return E_FAIL;
                     }
                 }
             }
@@ -299,6 +197,7 @@ namespace
                     {
                         for (size_t s = pw; s < 4; ++s)
                         {
+#pragma prefast(suppress: 26000, "PREFAST false positive")
                             temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
                         }
                     }
@@ -310,23 +209,103 @@ namespace
                     {
                         for (size_t s = 0; s < 4; ++s)
                         {
+#pragma prefast(suppress: 26000, "PREFAST false positive")
                             temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
                         }
                     }
                 }
             }
 
-            _ConvertScanline(temp, 16, result.format, format, cflags | srgb);
+            _ConvertScanline(temp, 16, result.format, format, settings.cflags | srgb);
 
-            if (pfEncode)
-                pfEncode(pDest, temp, bcflags);
-            else
-                D3DXEncodeBC1(pDest, temp, threshold, bcflags);
+            if (!batch)
+            {
+                settings.pfEncode(dptr, temp, bcflags);
+            }
+            else if (++nbatch == BC_BATCH_MAX)
+            {
+                EncodeBatch(pBatch, blocks, nbatch, settings, bcflags, threshold);
+                pBatch = dptr + settings.blocksize;
+                nbatch = 0;
+            }
+
+            sptr += settings.sbpp * 4;
+            dptr += settings.blocksize;
+        }
+
+        if (nbatch > 0)
+        {
+            EncodeBatch(pBatch, blocks, nbatch, settings, bcflags, threshold);
+        }
+
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    HRESULT CompressBC(
+        const Image& image,
+        const Image& result,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold) noexcept
+    {
+        BCEncodeSettings settings;
+        HRESULT hr = DetermineCompressSettings(image, result, settings);
+        if (FAILED(hr))
+            return hr;
+
+        for (size_t h = 0; h < image.height; h += 4)
+        {
+            hr = CompressBlockRow(image, result, h, settings, bcflags, srgb, threshold);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Compresses a set of images (mips, array items, volume slices) with block rows from
+    // all of them scheduled as a single pool of work
+    //-------------------------------------------------------------------------------------
+    HRESULT CompressBC_Parallel(
+        _In_reads_(nimages) const Image* srcImages,
+        _In_reads_(nimages) const Image* destImages,
+        size_t nimages,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold) noexcept
+    {
+        assert(srcImages != nullptr && destImages != nullptr && nimages > 0);
+
+        std::unique_ptr<BCEncodeSettings[]> settings(new (std::nothrow) BCEncodeSettings[nimages]);
+        std::unique_ptr<size_t[]> firstRow(new (std::nothrow) size_t[nimages + 1]);
+        if (!settings || !firstRow)
+            return E_OUTOFMEMORY;
+
+        firstRow[0] = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            HRESULT hr = DetermineCompressSettings(srcImages[index], destImages[index], settings[index]);
+            if (FAILED(hr))
+                return hr;
+
+            firstRow[index + 1] = firstRow[index] + (srcImages[index].height + 3) / 4;
         }
 
-        return (fail) ? E_FAIL : S_OK;
+        const size_t* rowTable = firstRow.get();
+        return _ParallelFor(firstRow[nimages], [&](size_t row) -> HRESULT
+            {
+                // Find the image that owns this block row
+                const size_t index = static_cast<size_t>(std::upper_bound(rowTable, rowTable + nimages + 1, row) - rowTable) - 1;
+                assert(index < nimages);
+
+                return CompressBlockRow(srcImages[index], destImages[index], (row - rowTable[index]) * 4,
+                    settings[index], bcflags, srgb, threshold);
+            });
     }
-#endif // _OPENMP
 
 
     //-------------------------------------------------------------------------------------
@@ -377,6 +356,50 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    bool DetermineDecoderSettings(
+        _In_ DXGI_FORMAT format,
+        _Out_ DXGI_FORMAT& cformat,
+        _Out_ BC_DECODE& pfDecode,
+        _Out_ size_t& blocksize) noexcept
+    {
+        // Promote "typeless" BC formats
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:  cformat = DXGI_FORMAT_BC1_UNORM; break;
+        case DXGI_FORMAT_BC2_TYPELESS:  cformat = DXGI_FORMAT_BC2_UNORM; break;
+        case DXGI_FORMAT_BC3_TYPELESS:  cformat = DXGI_FORMAT_BC3_UNORM; break;
+        case DXGI_FORMAT_BC4_TYPELESS:  cformat = DXGI_FORMAT_BC4_UNORM; break;
+        case DXGI_FORMAT_BC5_TYPELESS:  cformat = DXGI_FORMAT_BC5_UNORM; break;
+        case DXGI_FORMAT_BC6H_TYPELESS: cformat = DXGI_FORMAT_BC6H_UF16; break;
+        case DXGI_FORMAT_BC7_TYPELESS:  cformat = DXGI_FORMAT_BC7_UNORM; break;
+        default:                        cformat = format;                break;
+        }
+
+        // Determine BC format decoder
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    pfDecode = D3DXDecodeBC1;   blocksize = 8;   break;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    pfDecode = D3DXDecodeBC2;   blocksize = 16;  break;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    pfDecode = D3DXDecodeBC3;   blocksize = 16;  break;
+        case DXGI_FORMAT_BC4_UNORM:         pfDecode = D3DXDecodeBC4U;  blocksize = 8;   break;
+        case DXGI_FORMAT_BC4_SNORM:         pfDecode = D3DXDecodeBC4S;  blocksize = 8;   break;
+        case DXGI_FORMAT_BC5_UNORM:         pfDecode = D3DXDecodeBC5U;  blocksize = 16;  break;
+        case DXGI_FORMAT_BC5_SNORM:         pfDecode = D3DXDecodeBC5S;  blocksize = 16;  break;
+        case DXGI_FORMAT_BC6H_UF16:         pfDecode = D3DXDecodeBC6HU; blocksize = 16;  break;
+        case DXGI_FORMAT_BC6H_SF16:         pfDecode = D3DXDecodeBC6HS; blocksize = 16;  break;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    pfDecode = D3DXDecodeBC7;   blocksize = 16;  break;
+        default:                            pfDecode = nullptr;         blocksize = 0;   return false;
+        }
+
+        return true;
+    }
+
+
     //-------------------------------------------------------------------------------------
     HRESULT DecompressBC(_In_ const Image& cImage, _In_ const Image& result) noexcept
     {
@@ -404,42 +427,11 @@ namespace
         if (!pDest)
             return E_POINTER;
 
-        // Promote "typeless" BC formats
         DXGI_FORMAT cformat;
-        switch (cImage.format)
-        {
-        case DXGI_FORMAT_BC1_TYPELESS:  cformat = DXGI_FORMAT_BC1_UNORM; break;
-        case DXGI_FORMAT_BC2_TYPELESS:  cformat = DXGI_FORMAT_BC2_UNORM; break;
-        case DXGI_FORMAT_BC3_TYPELESS:  cformat = DXGI_FORMAT_BC3_UNORM; break;
-        case DXGI_FORMAT_BC4_TYPELESS:  cformat = DXGI_FORMAT_BC4_UNORM; break;
-        case DXGI_FORMAT_BC5_TYPELESS:  cformat = DXGI_FORMAT_BC5_UNORM; break;
-        case DXGI_FORMAT_BC6H_TYPELESS: cformat = DXGI_FORMAT_BC6H_UF16; break;
-        case DXGI_FORMAT_BC7_TYPELESS:  cformat = DXGI_FORMAT_BC7_UNORM; break;
-        default:                        cformat = cImage.format;         break;
-        }
-
-        // Determine BC format decoder
         BC_DECODE pfDecode;
         size_t sbpp;
-        switch (cformat)
-        {
-        case DXGI_FORMAT_BC1_UNORM:
-        case DXGI_FORMAT_BC1_UNORM_SRGB:    pfDecode = D3DXDecodeBC1;   sbpp = 8;   break;
-        case DXGI_FORMAT_BC2_UNORM:
-        case DXGI_FORMAT_BC2_UNORM_SRGB:    pfDecode = D3DXDecodeBC2;   sbpp = 16;  break;
-        case DXGI_FORMAT_BC3_UNORM:
-        case DXGI_FORMAT_BC3_UNORM_SRGB:    pfDecode = D3DXDecodeBC3;   sbpp = 16;  break;
-        case DXGI_FORMAT_BC4_UNORM:         pfDecode = D3DXDecodeBC4U;  sbpp = 8;   break;
-        case DXGI_FORMAT_BC4_SNORM:         pfDecode = D3DXDecodeBC4S;  sbpp = 8;   break;
-        case DXGI_FORMAT_BC5_UNORM:         pfDecode = D3DXDecodeBC5U;  sbpp = 16;  break;
-        case DXGI_FORMAT_BC5_SNORM:         pfDecode = D3DXDecodeBC5S;  sbpp = 16;  break;
-        case DXGI_FORMAT_BC6H_UF16:         pfDecode = D3DXDecodeBC6HU; sbpp = 16;  break;
-        case DXGI_FORMAT_BC6H_SF16:         pfDecode = D3DXDecodeBC6HS; sbpp = 16;  break;
-        case DXGI_FORMAT_BC7_UNORM:
-        case DXGI_FORMAT_BC7_UNORM_SRGB:    pfDecode = D3DXDecodeBC7;   sbpp = 16;  break;
-        default:
+        if (!DetermineDecoderSettings(cImage.format, cformat, pfDecode, sbpp))
             return HRESULT_E_NOT_SUPPORTED;
-        }
 
         XM_ALIGNED_DATA(16) XMVECTOR temp[16];
         const uint8_t *pSrc = cImage.pixels;
@@ -620,11 +612,7 @@ HRESULT DirectX::Compress(
     // Compress single image
     if (compress & TEX_COMPRESS_PARALLEL)
     {
-#ifndef _OPENMP
-        return E_NOTIMPL;
-#else
-        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-#endif // _OPENMP
+        hr = CompressBC_Parallel(&srcImage, img, 1, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
     }
     else
     {
@@ -690,32 +678,135 @@ HRESULT DirectX::Compress(
             return E_FAIL;
         }
 
-        if ((compress & TEX_COMPRESS_PARALLEL))
+        if (!(compress & TEX_COMPRESS_PARALLEL))
         {
-#ifndef _OPENMP
-            return E_NOTIMPL;
-#else
-            if (compress & TEX_COMPRESS_PARALLEL)
+            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+            if (FAILED(hr))
             {
-                hr = CompressBC_Parallel(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-                if (FAILED(hr))
-                {
-                    cImages.Release();
-                    return  hr;
-                }
+                cImages.Release();
+                return hr;
             }
-#endif // _OPENMP
         }
-        else
+    }
+
+    if (compress & TEX_COMPRESS_PARALLEL)
+    {
+        // Parallelize across block rows of every mip, array item, and slice at once
+        hr = CompressBC_Parallel(srcImages, dest, nimages, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+        if (FAILED(hr))
         {
-            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+            cImages.Release();
+            return hr;
+        }
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Streaming compression
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::CompressStream(
+    size_t width,
+    size_t height,
+    DXGI_FORMAT srcFormat,
+    std::function<HRESULT __cdecl(size_t y, const Image& band)> pixelSource,
+    DXGI_FORMAT format,
+    TEX_COMPRESS_FLAGS compress,
+    float threshold,
+    std::function<HRESULT __cdecl(size_t y, const Image& blocks)> blockSink) noexcept
+{
+    if (!width || !height || !pixelSource || !blockSink)
+        return E_INVALIDARG;
+
+    if (IsCompressed(srcFormat) || !IsCompressed(format))
+        return E_INVALIDARG;
+
+    if (IsTypeless(format)
+        || IsTypeless(srcFormat) || IsPlanar(srcFormat) || IsPalettized(srcFormat))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if ((width > UINT32_MAX) || (height > UINT32_MAX))
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+    // One row of blocks per worker is buffered at a time
+    const size_t blockRows = (height + 3) / 4;
+    size_t bandRows = 1;
+    if (compress & TEX_COMPRESS_PARALLEL)
+    {
+        bandRows = std::max<size_t>(1, std::min(_GetParallelWorkerCount(), blockRows));
+    }
+
+    ScratchImage srcBand;
+    HRESULT hr = srcBand.Initialize2D(srcFormat, width, bandRows * 4, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    ScratchImage destBand;
+    hr = destBand.Initialize2D(format, width, bandRows * 4, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    const Image* srcImage = srcBand.GetImage(0, 0, 0);
+    const Image* destImage = destBand.GetImage(0, 0, 0);
+    if (!srcImage || !destImage)
+        return E_POINTER;
+
+    BCEncodeSettings settings;
+    hr = DetermineCompressSettings(*srcImage, *destImage, settings);
+    if (FAILED(hr))
+        return hr;
+
+    const uint32_t bcflags = GetBCFlags(compress);
+    const TEX_FILTER_FLAGS srgb = GetSRGBFlags(compress);
+
+    try
+    {
+        for (size_t y = 0; y < height; y += bandRows * 4)
+        {
+            Image src = *srcImage;
+            src.height = std::min(bandRows * 4, height - y);
+            src.slicePitch = src.rowPitch * src.height;
+
+            const size_t rows = (src.height + 3) / 4;
+
+            Image dest = *destImage;
+            dest.height = src.height;
+            dest.slicePitch = dest.rowPitch * rows;
+
+            hr = pixelSource(y, src);
             if (FAILED(hr))
-            {
-                cImages.Release();
                 return hr;
+
+            if (rows > 1)
+            {
+                hr = _ParallelFor(rows, [&](size_t row) -> HRESULT
+                    {
+                        return CompressBlockRow(src, dest, row * 4, settings, bcflags, srgb, threshold);
+                    });
             }
+            else
+            {
+                hr = CompressBlockRow(src, dest, 0, settings, bcflags, srgb, threshold);
+            }
+            if (FAILED(hr))
+                return hr;
+
+            hr = blockSink(y, dest);
+            if (FAILED(hr))
+                return hr;
         }
     }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+    catch (...)
+    {
+        return E_FAIL;
+    }
 
     return S_OK;
 }
@@ -853,3 +944,387 @@ HRESULT DirectX::Decompress(
 
     return S_OK;
 }
+
+
+//=====================================================================================
+// BCBlockReader - random-access BC decompression
+//=====================================================================================
+
+// Cache entries form a circular list in recency order (m_head is the most recent, its
+// prev the least) plus a chain per hash bucket
+struct BCBlockReader::CacheEntry
+{
+    uint64_t    key;
+    uint32_t    prev;
+    uint32_t    next;
+    uint32_t    chain;
+};
+
+namespace
+{
+    inline uint32_t HashBlock(uint64_t key, uint32_t mask) noexcept
+    {
+        return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+}
+
+BCBlockReader& BCBlockReader::operator= (BCBlockReader&& moveFrom) noexcept
+{
+    if (this != &moveFrom)
+    {
+        Release();
+
+        m_image = moveFrom.m_image;
+        m_format = moveFrom.m_format;
+        m_blockSize = moveFrom.m_blockSize;
+        m_blocksX = moveFrom.m_blocksX;
+        m_blocksY = moveFrom.m_blocksY;
+        m_capacity = moveFrom.m_capacity;
+        m_used = moveFrom.m_used;
+        m_head = moveFrom.m_head;
+        m_bucketMask = moveFrom.m_bucketMask;
+        m_hits = moveFrom.m_hits;
+        m_misses = moveFrom.m_misses;
+        m_pfDecode = moveFrom.m_pfDecode;
+        m_blocks = moveFrom.m_blocks;
+        m_entries = moveFrom.m_entries;
+        m_buckets = moveFrom.m_buckets;
+
+        moveFrom.m_image = {};
+        moveFrom.m_capacity = 0;
+        moveFrom.m_used = 0;
+        moveFrom.m_head = UINT32_MAX;
+        moveFrom.m_blocks = nullptr;
+        moveFrom.m_entries = nullptr;
+        moveFrom.m_buckets = nullptr;
+    }
+    return *this;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Methods
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT BCBlockReader::Initialize(const Image& cImage, size_t cacheBlocks) noexcept
+{
+    Release();
+
+    if (!cImage.pixels || !cImage.width || !cImage.height)
+        return E_INVALIDARG;
+
+    if (!IsCompressed(cImage.format))
+        return E_INVALIDARG;
+
+    if (!cacheBlocks || cacheBlocks > (UINT32_MAX / 4))
+        return E_INVALIDARG;
+
+    DXGI_FORMAT cformat;
+    BC_DECODE pfDecode;
+    size_t blocksize;
+    if (!DetermineDecoderSettings(cImage.format, cformat, pfDecode, blocksize))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    const size_t blocksX = (cImage.width + 3) / 4;
+    const size_t blocksY = (cImage.height + 3) / 4;
+    if (cImage.rowPitch < blocksX * blocksize)
+        return E_INVALIDARG;
+
+    // There is no point caching more blocks than the image has
+    const uint64_t total = uint64_t(blocksX) * uint64_t(blocksY);
+    const auto capacity = static_cast<uint32_t>(std::min<uint64_t>(cacheBlocks, total));
+
+    // Keeps the load factor of the hash table at or below 1/2
+    uint32_t buckets = 1;
+    while (buckets < capacity * 2)
+        buckets <<= 1;
+
+    auto blocks = make_AlignedArrayXMVECTOR(uint64_t(capacity) * NUM_PIXELS_PER_BLOCK);
+    if (!blocks)
+        return E_OUTOFMEMORY;
+
+    std::unique_ptr<CacheEntry[]> entries(new (std::nothrow) CacheEntry[capacity]);
+    std::unique_ptr<uint32_t[]> table(new (std::nothrow) uint32_t[buckets]);
+    if (!entries || !table)
+        return E_OUTOFMEMORY;
+
+    m_image = cImage;
+    m_format = cformat;
+    m_blockSize = blocksize;
+    m_blocksX = blocksX;
+    m_blocksY = blocksY;
+    m_capacity = capacity;
+    m_bucketMask = buckets - 1;
+    m_pfDecode = pfDecode;
+    m_blocks = blocks.release();
+    m_entries = entries.release();
+    m_buckets = table.release();
+
+    ClearCache();
+
+    m_hits = m_misses = 0;
+
+    return S_OK;
+}
+
+void BCBlockReader::Release() noexcept
+{
+    if (m_blocks)
+    {
+        aligned_deleter()(m_blocks);
+        m_blocks = nullptr;
+    }
+
+    delete[] m_entries;
+    m_entries = nullptr;
+
+    delete[] m_buckets;
+    m_buckets = nullptr;
+
+    m_image = {};
+    m_format = DXGI_FORMAT_UNKNOWN;
+    m_blockSize = m_blocksX = m_blocksY = 0;
+    m_capacity = m_used = 0;
+    m_head = UINT32_MAX;
+    m_bucketMask = 0;
+    m_pfDecode = nullptr;
+}
+
+void BCBlockReader::ClearCache() noexcept
+{
+    m_used = 0;
+    m_head = UINT32_MAX;
+
+    if (m_buckets)
+    {
+        std::fill_n(m_buckets, size_t(m_bucketMask) + 1, UINT32_MAX);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Looks up a block, decoding it into the least recently used slot on a miss
+//-------------------------------------------------------------------------------------
+const XMVECTOR* BCBlockReader::GetBlock(size_t bx, size_t by) noexcept
+{
+    assert(bx < m_blocksX && by < m_blocksY);
+
+    const uint64_t key = uint64_t(by) * uint64_t(m_blocksX) + uint64_t(bx);
+    const uint32_t bucket = HashBlock(key, m_bucketMask);
+
+    for (uint32_t slot = m_buckets[bucket]; slot != UINT32_MAX; slot = m_entries[slot].chain)
+    {
+        if (m_entries[slot].key != key)
+            continue;
+
+        ++m_hits;
+
+        if (slot != m_head)
+        {
+            // Unlink, then reinsert in front of the current head
+            CacheEntry& entry = m_entries[slot];
+            m_entries[entry.prev].next = entry.next;
+            m_entries[entry.next].prev = entry.prev;
+
+            const uint32_t tail = m_entries[m_head].prev;
+            entry.prev = tail;
+            entry.next = m_head;
+            m_entries[tail].next = slot;
+            m_entries[m_head].prev = slot;
+            m_head = slot;
+        }
+
+        return m_blocks + size_t(slot) * NUM_PIXELS_PER_BLOCK;
+    }
+
+    ++m_misses;
+
+    uint32_t slot;
+    if (m_used < m_capacity)
+    {
+        slot = m_used++;
+
+        CacheEntry& entry = m_entries[slot];
+        if (m_head == UINT32_MAX)
+        {
+            entry.prev = entry.next = slot;
+        }
+        else
+        {
+            const uint32_t tail = m_entries[m_head].prev;
+            entry.prev = tail;
+            entry.next = m_head;
+            m_entries[tail].next = slot;
+            m_entries[m_head].prev = slot;
+        }
+    }
+    else
+    {
+        // Evict the least recently used block; in a circular list it becomes the head in place
+        slot = m_entries[m_head].prev;
+
+        uint32_t* link = &m_buckets[HashBlock(m_entries[slot].key, m_bucketMask)];
+        while (*link != slot)
+        {
+            assert(*link != UINT32_MAX);
+            link = &m_entries[*link].chain;
+        }
+        *link = m_entries[slot].chain;
+    }
+
+    m_head = slot;
+
+    CacheEntry& entry = m_entries[slot];
+    entry.key = key;
+    entry.chain = m_buckets[bucket];
+    m_buckets[bucket] = slot;
+
+    XMVECTOR* pixels = m_blocks + size_t(slot) * NUM_PIXELS_PER_BLOCK;
+    m_pfDecode(pixels, m_image.pixels + by * m_image.rowPitch + bx * m_blockSize);
+
+    return pixels;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Decoding
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT BCBlockReader::DecodeBlock(size_t bx, size_t by, XMVECTOR* pixels) noexcept
+{
+    if (!pixels)
+        return E_POINTER;
+
+    if (!m_blocks)
+        return E_UNEXPECTED;
+
+    if (bx >= m_blocksX || by >= m_blocksY)
+        return E_INVALIDARG;
+
+    const XMVECTOR* block = GetBlock(bx, by);
+    std::copy_n(block, NUM_PIXELS_PER_BLOCK, pixels);
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT BCBlockReader::DecodeRect(const Rect& srcRect, const Image& dstImage, size_t xOffset, size_t yOffset) noexcept
+{
+    if (!dstImage.pixels)
+        return E_POINTER;
+
+    if (!m_blocks)
+        return E_UNEXPECTED;
+
+    if (!srcRect.w || !srcRect.h)
+        return E_INVALIDARG;
+
+    if (((srcRect.x + srcRect.w) > m_image.width) || ((srcRect.y + srcRect.h) > m_image.height))
+        return E_INVALIDARG;
+
+    if (((xOffset + srcRect.w) > dstImage.width) || ((yOffset + srcRect.h) > dstImage.height))
+        return E_INVALIDARG;
+
+    if (IsCompressed(dstImage.format) || IsPlanar(dstImage.format) || IsPalettized(dstImage.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    size_t dbpp = BitsPerPixel(dstImage.format);
+    if (!dbpp)
+        return E_FAIL;
+
+    if (dbpp < 8)
+    {
+        // We don't support decompressing to monochrome (DXGI_FORMAT_R1_UNORM)
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    // Round to bytes
+    dbpp = (dbpp + 7) / 8;
+
+    const size_t width = srcRect.w;
+
+    // One row of blocks is gathered into scanlines before conversion
+    auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 4);
+    if (!scanline)
+        return E_OUTOFMEMORY;
+
+    const size_t bx0 = srcRect.x / 4;
+    const size_t bx1 = (srcRect.x + width - 1) / 4;
+    const size_t by0 = srcRect.y / 4;
+    const size_t by1 = (srcRect.y + srcRect.h - 1) / 4;
+
+    const size_t dstOffset = xOffset * dbpp;
+
+    for (size_t by = by0; by <= by1; ++by)
+    {
+        const size_t y0 = std::max(srcRect.y, by * 4);
+        const size_t y1 = std::min(srcRect.y + srcRect.h, by * 4 + 4);
+
+        for (size_t bx = bx0; bx <= bx1; ++bx)
+        {
+            const XMVECTOR* block = GetBlock(bx, by);
+
+            const size_t x0 = std::max(srcRect.x, bx * 4);
+            const size_t x1 = std::min(srcRect.x + width, bx * 4 + 4);
+
+            for (size_t y = y0; y < y1; ++y)
+            {
+                std::copy(block + (y - by * 4) * 4 + (x0 - bx * 4), block + (y - by * 4) * 4 + (x1 - bx * 4),
+                    scanline.get() + (y - by * 4) * width + (x0 - srcRect.x));
+            }
+        }
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            XMVECTOR* row = scanline.get() + (y - by * 4) * width;
+
+            _ConvertScanline(row, width, dstImage.format, m_format, TEX_FILTER_DEFAULT);
+
+            uint8_t* pDest = dstImage.pixels + (yOffset + y - srcRect.y) * dstImage.rowPitch + dstOffset;
+            if (!_StoreScanline(pDest, dstImage.rowPitch - dstOffset, dstImage.format, row, width))
+                return E_FAIL;
+        }
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT BCBlockReader::DecodeRect(const Rect& srcRect, DXGI_FORMAT format, ScratchImage& image) noexcept
+{
+    if (!m_blocks)
+        return E_UNEXPECTED;
+
+    if (format == DXGI_FORMAT_UNKNOWN)
+    {
+        // Pick a default decompressed format based on BC input format
+        format = DefaultDecompress(m_image.format);
+        if (format == DXGI_FORMAT_UNKNOWN)
+            return E_FAIL;
+    }
+    else
+    {
+        if (!IsValid(format) || IsCompressed(format))
+            return E_INVALIDARG;
+
+        if (IsTypeless(format) || IsPlanar(format) || IsPalettized(format))
+            return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    HRESULT hr = image.Initialize2D(format, srcRect.w, srcRect.h, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    const Image* img = image.GetImage(0, 0, 0);
+    if (!img)
+    {
+        image.Release();
+        return E_POINTER;
+    }
+
+    hr = DecodeRect(srcRect, *img, 0, 0);
+    if (FAILED(hr))
+        image.Release();
+
+    return hr;
+}
@@ -4375,6 +4375,281 @@ bool DirectX::_StoreScanlineDither(
 
 namespace
 {
+    //-------------------------------------------------------------------------------------
+    // Direct scanline kernels for the hottest format pairs
+    //
+    // The generic path round-trips every pixel through XMVECTOR (_LoadScanline ->
+    // _ConvertScanline -> _StoreScanline). The pairs below skip that:
+    //  - 8-bit RGBA/BGRA sources convert each channel independently, so any conversion to
+    //    8-bit RGBA/BGRA, RGBA16F or RGBA32F is a 256-entry table per channel (and a plain
+    //    copy or R/B swizzle when the table is the identity)
+    //  - RGBA32F <-> RGBA16F without a colorspace change converts each pixel in place
+    // The tables are built by running the generic path over all 256 input values, so the
+    // results are bit-identical to the generic path for any combination of filter flags.
+    //-------------------------------------------------------------------------------------
+    enum DIRECT_KERNEL
+    {
+        DIRECT_NONE = 0,
+        DIRECT_COPY,
+        DIRECT_SWIZZLE,
+        DIRECT_LUT8,
+        DIRECT_LUT16,
+        DIRECT_LUT32,
+        DIRECT_FLOAT_TO_HALF,
+        DIRECT_HALF_TO_FLOAT,
+    };
+
+    inline bool IsRGBA8(DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    inline bool IsBGRA8(DXGI_FORMAT format) noexcept
+    {
+        return (format == DXGI_FORMAT_B8G8R8A8_UNORM) || (format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB);
+    }
+
+    inline bool IsSwizzleOnly(TEX_FILTER_FLAGS filter, DXGI_FORMAT sformat, DXGI_FORMAT tformat) noexcept
+    {
+        if (filter & (TEX_FILTER_DITHER | TEX_FILTER_DITHER_DIFFUSION | TEX_FILTER_FORCE_SCANLINE))
+            return false;
+
+        if (!IsRGBA8(sformat) || !IsRGBA8(tformat))
+            return false;
+
+        // UNORM8 -> UNORM8 round-trips exactly unless one side converts colorspace
+        const bool srgbIn = (filter & TEX_FILTER_SRGB_IN) || IsSRGB(sformat);
+        const bool srgbOut = (filter & TEX_FILTER_SRGB_OUT) || IsSRGB(tformat);
+        return (srgbIn == srgbOut);
+    }
+
+    class DirectConverter
+    {
+    public:
+        DirectConverter() noexcept : m_kernel(DIRECT_NONE), m_swapRB(false), m_lut{} {}
+
+        DirectConverter(const DirectConverter&) = delete;
+        DirectConverter& operator=(const DirectConverter&) = delete;
+
+        bool Initialize(DXGI_FORMAT sformat, DXGI_FORMAT tformat, TEX_FILTER_FLAGS filter) noexcept
+        {
+            m_kernel = DIRECT_NONE;
+
+            if (filter & (TEX_FILTER_DITHER | TEX_FILTER_DITHER_DIFFUSION | TEX_FILTER_FORCE_SCANLINE))
+                return false;
+
+            if (IsRGBA8(sformat))
+            {
+                DIRECT_KERNEL kernel;
+                size_t bpp;
+                switch (tformat)
+                {
+                case DXGI_FORMAT_R16G16B16A16_FLOAT: kernel = DIRECT_LUT16; bpp = 8; break;
+                case DXGI_FORMAT_R32G32B32A32_FLOAT: kernel = DIRECT_LUT32; bpp = 16; break;
+                default:
+                    if (!IsRGBA8(tformat))
+                        return false;
+                    kernel = DIRECT_LUT8;
+                    bpp = 4;
+                    break;
+                }
+
+                // Run the generic path over (i,i,i,i) for every byte value i
+                auto scanline = make_AlignedArrayXMVECTOR(256);
+                std::unique_ptr<uint8_t[]> row(new (std::nothrow) uint8_t[256 * 16]);
+                if (!scanline || !row)
+                    return false;
+
+                uint32_t source[256];
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    source[i] = i * 0x01010101u;
+                }
+
+                if (!_LoadScanline(scanline.get(), 256, source, sizeof(source), sformat))
+                    return false;
+
+                _ConvertScanline(scanline.get(), 256, tformat, sformat, filter);
+
+                if (!_StoreScanline(row.get(), 256 * bpp, tformat, scanline.get(), 256, 0.f))
+                    return false;
+
+                const size_t channelBytes = bpp / 4;
+                bool identity = (kernel == DIRECT_LUT8);
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    for (size_t i = 0; i < 256; ++i)
+                    {
+                        const uint8_t* ptr = row.get() + i * bpp + c * channelBytes;
+                        switch (kernel)
+                        {
+                        case DIRECT_LUT8:
+                            m_lut.u8[c][i] = *ptr;
+                            identity = identity && (*ptr == i);
+                            break;
+                        case DIRECT_LUT16:
+                            memcpy(&m_lut.u16[c][i], ptr, sizeof(uint16_t));
+                            break;
+                        default:
+                            memcpy(&m_lut.f32[c][i], ptr, sizeof(float));
+                            break;
+                        }
+                    }
+                }
+
+                // The tables are indexed by destination channel, so only R and B may come from swapped bytes
+                m_swapRB = IsBGRA8(sformat) != ((kernel == DIRECT_LUT8) && IsBGRA8(tformat));
+
+                if (identity)
+                {
+                    kernel = (m_swapRB) ? DIRECT_SWIZZLE : DIRECT_COPY;
+                }
+
+                m_kernel = kernel;
+                return true;
+            }
+
+            // Float <-> half only match the generic path when no colorspace conversion is involved
+            const bool srgbIn = (filter & TEX_FILTER_SRGB_IN) != 0;
+            const bool srgbOut = (filter & TEX_FILTER_SRGB_OUT) != 0;
+            if (srgbIn != srgbOut)
+                return false;
+
+            if (sformat == DXGI_FORMAT_R32G32B32A32_FLOAT && tformat == DXGI_FORMAT_R16G16B16A16_FLOAT)
+            {
+                m_kernel = DIRECT_FLOAT_TO_HALF;
+            }
+            else if (sformat == DXGI_FORMAT_R16G16B16A16_FLOAT && tformat == DXGI_FORMAT_R32G32B32A32_FLOAT)
+            {
+                m_kernel = DIRECT_HALF_TO_FLOAT;
+            }
+
+            return (m_kernel != DIRECT_NONE);
+        }
+
+        void ConvertRow(_Out_ uint8_t* __restrict pDest, _In_ const uint8_t* __restrict pSrc, size_t width) const noexcept
+        {
+            const size_t r = (m_swapRB) ? 2u : 0u;
+            const size_t b = (m_swapRB) ? 0u : 2u;
+
+            switch (m_kernel)
+            {
+            case DIRECT_COPY:
+                memcpy(pDest, pSrc, width * 4);
+                break;
+
+            case DIRECT_SWIZZLE:
+                {
+                    size_t x = 0;
+#if defined(_XM_SSE_INTRINSICS_)
+                    const __m128i maskAG = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+                    const __m128i maskRB = _mm_set1_epi32(0x00FF00FF);
+                    for (; x + 4 <= width; x += 4)
+                    {
+                        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + x * 4));
+                        const __m128i rb = _mm_and_si128(v, maskRB);
+                        const __m128i br = _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_or_si128(_mm_and_si128(v, maskAG), br));
+                    }
+#endif
+                    for (; x < width; ++x)
+                    {
+                        uint32_t t;
+                        memcpy(&t, pSrc + x * 4, sizeof(t));
+                        t = (t & 0xFF00FF00) | ((t >> 16) & 0xFF) | ((t & 0xFF) << 16);
+                        memcpy(pDest + x * 4, &t, sizeof(t));
+                    }
+                }
+                break;
+
+            case DIRECT_LUT8:
+                for (size_t x = 0; x < width; ++x, pSrc += 4, pDest += 4)
+                {
+                    pDest[0] = m_lut.u8[0][pSrc[r]];
+                    pDest[1] = m_lut.u8[1][pSrc[1]];
+                    pDest[2] = m_lut.u8[2][pSrc[b]];
+                    pDest[3] = m_lut.u8[3][pSrc[3]];
+                }
+                break;
+
+            case DIRECT_LUT16:
+                {
+                    auto dPtr = reinterpret_cast<uint16_t*>(pDest);
+                    for (size_t x = 0; x < width; ++x, pSrc += 4, dPtr += 4)
+                    {
+                        dPtr[0] = m_lut.u16[0][pSrc[r]];
+                        dPtr[1] = m_lut.u16[1][pSrc[1]];
+                        dPtr[2] = m_lut.u16[2][pSrc[b]];
+                        dPtr[3] = m_lut.u16[3][pSrc[3]];
+                    }
+                }
+                break;
+
+            case DIRECT_LUT32:
+                {
+                    auto dPtr = reinterpret_cast<float*>(pDest);
+                    for (size_t x = 0; x < width; ++x, pSrc += 4, dPtr += 4)
+                    {
+                        dPtr[0] = m_lut.f32[0][pSrc[r]];
+                        dPtr[1] = m_lut.f32[1][pSrc[1]];
+                        dPtr[2] = m_lut.f32[2][pSrc[b]];
+                        dPtr[3] = m_lut.f32[3][pSrc[3]];
+                    }
+                }
+                break;
+
+            case DIRECT_FLOAT_TO_HALF:
+                {
+                    // Same clamp as _StoreScanline so out-of-range values and NaNs match
+                    auto sPtr = reinterpret_cast<const XMFLOAT4*>(pSrc);
+                    auto dPtr = reinterpret_cast<XMHALF4*>(pDest);
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        XMVECTOR v = XMLoadFloat4(sPtr++);
+                        v = XMVectorClamp(v, g_HalfMin, g_HalfMax);
+                        XMStoreHalf4(dPtr++, v);
+                    }
+                }
+                break;
+
+            case DIRECT_HALF_TO_FLOAT:
+                {
+                    auto sPtr = reinterpret_cast<const XMHALF4*>(pSrc);
+                    auto dPtr = reinterpret_cast<XMFLOAT4*>(pDest);
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        XMStoreFloat4(dPtr++, XMLoadHalf4(sPtr++));
+                    }
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+    private:
+        DIRECT_KERNEL   m_kernel;
+        bool            m_swapRB;
+
+        union
+        {
+            uint8_t     u8[4][256];
+            uint16_t    u16[4][256];
+            float       f32[4][256];
+        } m_lut;
+    };
+
     //-------------------------------------------------------------------------------------
     // Selection logic for using WIC vs. our own routines
     //-------------------------------------------------------------------------------------
@@ -4426,6 +4701,12 @@ namespace
             return false;
         }
 
+        if (IsSwizzleOnly(filter, sformat, tformat))
+        {
+            // Direct copy/swizzle kernel gives the same result without the WIC overhead
+            return false;
+        }
+
         // Check for special cases
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
         if (sformat == DXGI_FORMAT_R16G16B16A16_FLOAT
@@ -4674,6 +4955,20 @@ namespace
             else
             {
                 // No dithering
+                DirectConverter direct;
+                if (direct.Initialize(srcImage.format, destImage.format, filter))
+                {
+                    for (size_t h = 0; h < srcImage.height; ++h)
+                    {
+                        direct.ConvertRow(pDest, pSrc, width);
+
+                        pSrc += srcImage.rowPitch;
+                        pDest += destImage.rowPitch;
+                    }
+
+                    return S_OK;
+                }
+
                 for (size_t h = 0; h < srcImage.height; ++h)
                 {
                     if (!_LoadScanline(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
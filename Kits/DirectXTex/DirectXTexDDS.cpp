@@ -1975,6 +1975,63 @@ HRESULT DirectX::LoadFromDDSFile(
     return S_OK;
 }
 
+_Use_decl_annotations_
+HRESULT DirectX::LoadFromDDSFile(
+    const wchar_t* szFile,
+    DDS_FLAGS flags,
+    TexMetadata* metadata,
+    MappedImage& image) noexcept
+{
+    if (!szFile)
+        return E_INVALIDARG;
+
+    HRESULT hr = image.Initialize(szFile);
+    if (FAILED(hr))
+        return hr;
+
+    const size_t len = image.GetFileSize();
+
+    // Need at least enough data to fill the standard header and magic number to be a valid DDS
+    if (len < (sizeof(DDS_HEADER) + sizeof(uint32_t)))
+    {
+        image.Release();
+        return E_FAIL;
+    }
+
+    const size_t MAX_HEADER_SIZE = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+
+    uint32_t convFlags = 0;
+    TexMetadata mdata;
+    hr = DecodeDDSHeader(image.GetFileData(), std::min(len, MAX_HEADER_SIZE), flags, mdata, convFlags);
+    if (FAILED(hr))
+    {
+        image.Release();
+        return hr;
+    }
+
+    // Only data that is used as-is can be returned without a copy
+    if ((convFlags & (CONV_FLAGS_EXPAND | CONV_FLAGS_PAL8 | CONV_FLAGS_SWIZZLE | CONV_FLAGS_NOALPHA))
+        || (flags & (DDS_FLAGS_LEGACY_DWORD | DDS_FLAGS_BAD_DXTN_TAILS)))
+    {
+        image.Release();
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    const size_t offset = (convFlags & CONV_FLAGS_DX10) ? MAX_HEADER_SIZE : (sizeof(uint32_t) + sizeof(DDS_HEADER));
+
+    hr = image.SetupImages(mdata, offset);
+    if (FAILED(hr))
+    {
+        image.Release();
+        return hr;
+    }
+
+    if (metadata)
+        memcpy(metadata, &mdata, sizeof(TexMetadata));
+
+    return S_OK;
+}
+
 
 //-------------------------------------------------------------------------------------
 // Save a DDS file to memory
@@ -571,6 +571,275 @@ namespace
         return encSize;
 #endif
     }
+
+    //-------------------------------------------------------------------------------------
+    // Encodes a scanline as adaptive RLE, or as flat RGBE pixels if that doesn't compress
+    //-------------------------------------------------------------------------------------
+    size_t EncodeScanline(
+        _Out_writes_(width * 4) uint8_t* pDestination,
+        _In_ const uint8_t* pSource,
+        DXGI_FORMAT format,
+        size_t width,
+        _In_range_(3, 4) int fpp,
+        _Out_writes_(width * 4) uint8_t* rgbe) noexcept
+    {
+        if (format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+        {
+            HalfToRGBE(rgbe, reinterpret_cast<const uint16_t*>(pSource), width, fpp);
+        }
+        else
+        {
+            FloatToRGBE(rgbe, reinterpret_cast<const float*>(pSource), width, fpp);
+        }
+
+        // EncodeRLE never writes past rowPitch, so the flat pixels can overwrite a failed attempt
+        const size_t rowPitch = width * 4;
+        size_t encSize = EncodeRLE(pDestination, rgbe, rowPitch, width);
+        if (!encSize)
+        {
+            memcpy(pDestination, rgbe, rowPitch);
+            encSize = rowPitch;
+        }
+
+        return encSize;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Scanline index
+    //
+    // Scanlines carry no state from one to the next, so once the start of each is known
+    // they can be decoded independently. The index pass only walks the RLE headers.
+    //-------------------------------------------------------------------------------------
+    enum HDR_SCANLINE : uint8_t
+    {
+        HDR_SCANLINE_FLAT = 0,      // Uncompressed RGBE pixels
+        HDR_SCANLINE_RLE,           // "Standard" RLE runs of the previous pixel
+        HDR_SCANLINE_ADAPTIVE,      // Adaptive RLE with runs per channel
+    };
+
+    HRESULT IndexScanlines(
+        _In_reads_bytes_(size) const uint8_t* pSource,
+        size_t size,
+        size_t width,
+        size_t height,
+        _Out_writes_(height) size_t* offsets,
+        _Out_writes_(height) uint8_t* kinds) noexcept
+    {
+        size_t pos = 0;
+        for (size_t scan = 0; scan < height; ++scan)
+        {
+            if (size - pos < 4)
+                return E_FAIL;
+
+            offsets[scan] = pos;
+
+            const uint8_t* inColor = pSource + pos;
+            pos += 4;
+
+            if (inColor[0] == 2 && inColor[1] == 2 && inColor[2] < 128)
+            {
+                // Adaptive Run Length Encoding (RLE)
+                if (size_t((size_t(inColor[2]) << 8) + inColor[3]) != width)
+                    return E_FAIL;
+
+                kinds[scan] = HDR_SCANLINE_ADAPTIVE;
+
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    for (size_t pixelCount = 0; pixelCount < width;)
+                    {
+                        if (size - pos < 2)
+                            return E_FAIL;
+
+                        size_t runLen = pSource[pos];
+                        if (runLen > 128)
+                        {
+                            runLen &= 127;
+                            pos += 2;
+                        }
+                        else
+                        {
+                            if (size - pos < runLen + 1)
+                                return E_FAIL;
+
+                            pos += runLen + 1;
+                        }
+
+                        if (pixelCount + runLen > width)
+                            return E_FAIL;
+
+                        pixelCount += runLen;
+                    }
+                }
+            }
+            else
+            {
+                kinds[scan] = HDR_SCANLINE_FLAT;
+
+                int bitShift = 0;
+                for (size_t pixelCount = 0; pixelCount < width;)
+                {
+                    if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
+                    {
+                        // "Standard" Run Length Encoding
+                        if (bitShift > 24)
+                            return E_FAIL;
+
+                        const size_t spanLen = size_t(inColor[3]) << bitShift;
+                        if (spanLen + pixelCount > width)
+                            return E_FAIL;
+
+                        kinds[scan] = HDR_SCANLINE_RLE;
+                        pixelCount += spanLen;
+                        bitShift += 8;
+                    }
+                    else
+                    {
+                        // Uncompressed
+                        bitShift = 0;
+                        ++pixelCount;
+                    }
+
+                    if (pixelCount >= width)
+                        break;
+
+                    if (size - pos < 4)
+                        return E_FAIL;
+
+                    inColor = pSource + pos;
+                    pos += 4;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Decodes an indexed RLE scanline to RGBE pixels
+    //-------------------------------------------------------------------------------------
+    void DecodeScanline(
+        _Out_writes_(width * 4) uint8_t* rgbe,
+        _In_ const uint8_t* pSource,
+        size_t width,
+        uint8_t kind) noexcept
+    {
+        if (kind == HDR_SCANLINE_ADAPTIVE)
+        {
+            pSource += 4;
+
+            for (size_t channel = 0; channel < 4; ++channel)
+            {
+                uint8_t* dPtr = rgbe + channel;
+                for (size_t pixelCount = 0; pixelCount < width;)
+                {
+                    size_t runLen = *pSource;
+                    if (runLen > 128)
+                    {
+                        runLen &= 127;
+                        const uint8_t val = pSource[1];
+                        for (size_t j = 0; j < runLen; ++j)
+                        {
+                            dPtr[j * 4] = val;
+                        }
+                        pSource += 2;
+                    }
+                    else
+                    {
+                        ++pSource;
+                        for (size_t j = 0; j < runLen; ++j)
+                        {
+                            dPtr[j * 4] = pSource[j];
+                        }
+                        pSource += runLen;
+                    }
+
+                    dPtr += runLen * 4;
+                    pixelCount += runLen;
+                }
+            }
+        }
+        else
+        {
+            auto dPtr = reinterpret_cast<uint32_t*>(rgbe);
+
+            uint32_t prevColor;
+            memcpy(&prevColor, pSource, 4);
+
+            const uint8_t* inColor = pSource;
+            pSource += 4;
+
+            int bitShift = 0;
+            for (size_t pixelCount = 0; pixelCount < width;)
+            {
+                if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
+                {
+                    const size_t spanLen = size_t(inColor[3]) << bitShift;
+                    std::fill_n(dPtr, spanLen, prevColor);
+                    dPtr += spanLen;
+                    pixelCount += spanLen;
+                    bitShift += 8;
+                }
+                else
+                {
+                    memcpy(&prevColor, inColor, 4);
+                    *(dPtr++) = prevColor;
+                    bitShift = 0;
+                    ++pixelCount;
+                }
+
+                if (pixelCount >= width)
+                    break;
+
+                inColor = pSource;
+                pSource += 4;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // RGBEToFloat
+    //-------------------------------------------------------------------------------------
+    inline void RGBEToFloat(
+        _Out_writes_(width * 4) float* pDestination,
+        _In_reads_(width * 4) const uint8_t* pSource,
+        size_t width,
+        _In_reads_(256) const float* scale,
+        float invExposure) noexcept
+    {
+        // Same arithmetic as 1/exposure * ldexpf(c + 0.5, e - 136), as scale[e] is an exact power of two
+        const XMVECTOR inv = XMVectorReplicate(invExposure);
+
+        for (size_t j = 0; j < width; ++j)
+        {
+            XMVECTOR v = PackedVector::XMLoadUByte4(reinterpret_cast<const PackedVector::XMUBYTE4*>(pSource));
+            v = XMVectorMultiply(XMVectorAdd(v, g_XMOneHalf), XMVectorReplicate(scale[pSource[3]]));
+            v = XMVectorMultiply(inv, v);
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(pDestination), XMVectorSelect(g_XMOne, v, g_XMSelect1110));
+
+            pSource += 4;
+            pDestination += 4;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Splits scanlines into bands, processed concurrently with HDR_FLAGS_PARALLEL
+    //-------------------------------------------------------------------------------------
+    size_t CountBands(HDR_FLAGS flags, size_t width, size_t height) noexcept
+    {
+        // A few bands per worker for load balancing, but enough pixels to amortize the scanline allocation
+        constexpr size_t MIN_BAND_PIXELS = 16384;
+
+        size_t bands = 1;
+        if (flags & HDR_FLAGS_PARALLEL)
+        {
+            bands = std::min(height, _GetParallelWorkerCount() * 4);
+            bands = std::min(bands, (width * height) / MIN_BAND_PIXELS);
+            bands = std::max<size_t>(1, bands);
+        }
+
+        return bands;
+    }
 }
 
 
@@ -678,7 +947,7 @@ HRESULT DirectX::GetMetadataFromHDRFile(const wchar_t* szFile, TexMetadata& meta
 // Load a HDR file in memory
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata* metadata, ScratchImage& image) noexcept
+HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, HDR_FLAGS flags, TexMetadata* metadata, ScratchImage& image) noexcept
 {
     if (!pSource || size == 0)
         return E_INVALIDARG;
@@ -706,8 +975,6 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
     // Copy pixels
     auto sourcePtr = static_cast<const uint8_t*>(pSource) + offset;
 
-    size_t pixelLen = remaining;
-
     const Image* img = image.GetImage(0, 0, 0);
     if (!img)
     {
@@ -715,173 +982,66 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
         return E_POINTER;
     }
 
-    auto destPtr = img->pixels;
-
 #ifdef _DEBUG
     memset(img->pixels, 0xFF, img->rowPitch * img->height);
 #endif
 
-    for (size_t scan = 0; scan < mdata.height; ++scan)
+    // First pass finds the start of each scanline, then bands of scanlines are decoded and transformed
+    std::unique_ptr<size_t[]> offsets(new (std::nothrow) size_t[mdata.height]);
+    std::unique_ptr<uint8_t[]> kinds(new (std::nothrow) uint8_t[mdata.height]);
+    if (!offsets || !kinds)
     {
-        if (pixelLen < 4)
-        {
-            image.Release();
-            return E_FAIL;
-        }
-
-        uint8_t inColor[4];
-        memcpy(inColor, sourcePtr, 4);
-        sourcePtr += 4;
-        pixelLen -= 4;
-
-        auto scanLine = reinterpret_cast<float*>(destPtr);
+        image.Release();
+        return E_OUTOFMEMORY;
+    }
 
-        if (inColor[0] == 2 && inColor[1] == 2 && inColor[2] < 128)
-        {
-            // Adaptive Run Length Encoding (RLE)
-            if (size_t((size_t(inColor[2]) << 8) + inColor[3]) != mdata.width)
-            {
-                image.Release();
-                return E_FAIL;
-            }
+    hr = IndexScanlines(sourcePtr, remaining, mdata.width, mdata.height, offsets.get(), kinds.get());
+    if (FAILED(hr))
+    {
+        image.Release();
+        return hr;
+    }
 
-            for (int channel = 0; channel < 4; ++channel)
-            {
-                auto pixelLoc = scanLine + channel;
-                for(size_t pixelCount = 0; pixelCount < mdata.width;)
-                {
-                    if (pixelLen < 2)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
+    float scale[256];
+    for (int exponent = 0; exponent < 256; ++exponent)
+    {
+        scale[exponent] = ldexpf(1.f, exponent - (128 + 8));
+    }
 
-                    assert(sourcePtr < (reinterpret_cast<const uint8_t*>(pSource) + size));
+    const float invExposure = 1.0f / exposure;
 
-                    uint8_t runLen = *sourcePtr;
-                    if (runLen > 128)
-                    {
-                        runLen &= 127;
-                        if (pixelCount + runLen > mdata.width)
-                        {
-                            image.Release();
-                            return E_FAIL;
-                        }
+    const size_t bands = CountBands(flags, mdata.width, mdata.height);
 
-                        auto val = static_cast<float>(sourcePtr[1]);
-                        for (uint8_t j = 0; j < runLen; ++j)
-                        {
-                            *pixelLoc = val;
-                            pixelLoc += 4;
-                        }
-                        pixelCount += runLen;
-                        sourcePtr += 2;
-                        pixelLen -= 2;
-                    }
-                    else if ((size < size_t(runLen) + 1) || ((pixelCount + size_t(runLen)) > mdata.width))
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-                    else
-                    {
-                        ++sourcePtr;
-                        for (uint8_t j = 0; j < runLen; ++j)
-                        {
-                            auto val = static_cast<float>(*sourcePtr++);
-                            *pixelLoc = val;
-                            pixelLoc += 4;
-                        }
-                        pixelCount += runLen;
-                        pixelLen -= size_t(runLen) + 1;
-                    }
-                }
-            }
-        }
-        else
+    auto decodeBand = [&](size_t band) -> HRESULT
         {
-            auto pixelLoc = scanLine;
+            const size_t y0 = (mdata.height * band) / bands;
+            const size_t y1 = (mdata.height * (band + 1)) / bands;
 
-            float prevColor[4];
-            prevColor[0] = inColor[0];
-            prevColor[1] = inColor[1];
-            prevColor[2] = inColor[2];
-            prevColor[3] = inColor[3];
+            std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[mdata.width * 4]);
+            if (!temp)
+                return E_OUTOFMEMORY;
 
-            int bitShift = 0;
-            for (size_t pixelCount = 0; pixelCount < mdata.width;)
+            for (size_t scan = y0; scan < y1; ++scan)
             {
-                if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
+                // Uncompressed scanlines are transformed straight from the source
+                const uint8_t* rgbe = sourcePtr + offsets[scan];
+                if (kinds[scan] != HDR_SCANLINE_FLAT)
                 {
-                    if (bitShift > 24)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    // "Standard" Run Length Encoding
-                    size_t spanLen = size_t(inColor[3]) << bitShift;
-                    if (spanLen + pixelCount > mdata.width)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    for (size_t j = 0; j < spanLen; ++j)
-                    {
-                        pixelLoc[0] = prevColor[0];
-                        pixelLoc[1] = prevColor[1];
-                        pixelLoc[2] = prevColor[2];
-                        pixelLoc[3] = prevColor[3];
-                        pixelLoc += 4;
-                    }
-                    pixelCount += spanLen;
-                    bitShift += 8;
+                    DecodeScanline(temp.get(), rgbe, mdata.width, kinds[scan]);
+                    rgbe = temp.get();
                 }
-                else
-                {
-                    // Uncompressed
-                    pixelLoc[0] = prevColor[0] = inColor[0];
-                    pixelLoc[1] = prevColor[1] = inColor[1];
-                    pixelLoc[2] = prevColor[2] = inColor[2];
-                    pixelLoc[3] = prevColor[3] = inColor[3];
-                    bitShift = 0;
-                    ++pixelCount;
-                    pixelLoc += 4;
-                }
-
-                if (pixelCount >= mdata.width)
-                    break;
 
-                if (pixelLen < 4)
-                {
-                    image.Release();
-                    return E_FAIL;
-                }
-
-                memcpy(inColor, sourcePtr, 4);
-                sourcePtr += 4;
-                pixelLen -= 4;
+                RGBEToFloat(reinterpret_cast<float*>(img->pixels + img->rowPitch * scan), rgbe, mdata.width, scale, invExposure);
             }
-        }
 
-        destPtr += img->rowPitch;
-    }
+            return S_OK;
+        };
 
-    // Transform values
+    hr = (bands > 1) ? _ParallelFor(bands, decodeBand) : decodeBand(0);
+    if (FAILED(hr))
     {
-        auto fdata = reinterpret_cast<float*>(image.GetPixels());
-
-        for (size_t j = 0; j < image.GetPixelsSize(); j += 16)
-        {
-            auto exponent = static_cast<int>(fdata[3]);
-            fdata[0] = 1.0f / exposure*ldexpf((fdata[0] + 0.5f), exponent - (128 + 8));
-            fdata[1] = 1.0f / exposure*ldexpf((fdata[1] + 0.5f), exponent - (128 + 8));
-            fdata[2] = 1.0f / exposure*ldexpf((fdata[2] + 0.5f), exponent - (128 + 8));
-            fdata[3] = 1.f;
-
-            fdata += 4;
-        }
+        image.Release();
+        return hr;
     }
 
     if (metadata)
@@ -895,7 +1055,7 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
 // Load a HDR file from disk
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, ScratchImage& image) noexcept
+HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, HDR_FLAGS flags, TexMetadata* metadata, ScratchImage& image) noexcept
 {
     if (!szFile)
         return E_INVALIDARG;
@@ -977,7 +1137,7 @@ HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, S
         return E_FAIL;
 #endif
 
-    return LoadFromHDRMemory(temp.get(), len, metadata, image);
+    return LoadFromHDRMemory(temp.get(), len, flags, metadata, image);
 }
 
 
@@ -985,7 +1145,7 @@ HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, S
 // Save a HDR file to memory
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::SaveToHDRMemory(const Image& image, Blob& blob) noexcept
+HRESULT DirectX::SaveToHDRMemory(const Image& image, HDR_FLAGS flags, Blob& blob) noexcept
 {
     if (!image.pixels)
         return E_POINTER;
@@ -1042,39 +1202,63 @@ HRESULT DirectX::SaveToHDRMemory(const Image& image, Blob& blob) noexcept
         sPtr += image.rowPitch;
     }
 #else
-    std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch * 2]);
-    if (!temp)
-    {
-        blob.Release();
-        return E_OUTOFMEMORY;
-    }
-
-    auto rgbe = temp.get();
-    auto enc = temp.get() + rowPitch;
+    const size_t bands = CountBands(flags, image.width, image.height);
 
-    const uint8_t* sPtr = image.pixels;
-    for (size_t scan = 0; scan < image.height; ++scan)
+    if (bands <= 1)
     {
-        if (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT || image.format == DXGI_FORMAT_R32G32B32_FLOAT)
+        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch]);
+        if (!temp)
         {
-            FloatToRGBE(rgbe, reinterpret_cast<const float*>(sPtr), image.width, fpp);
+            blob.Release();
+            return E_OUTOFMEMORY;
         }
-        else if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+
+        const uint8_t* sPtr = image.pixels;
+        for (size_t scan = 0; scan < image.height; ++scan)
         {
-            HalfToRGBE(rgbe, reinterpret_cast<const uint16_t*>(sPtr), image.width, fpp);
+            dPtr += EncodeScanline(dPtr, sPtr, image.format, image.width, fpp, temp.get());
+            sPtr += image.rowPitch;
         }
-        sPtr += image.rowPitch;
+    }
+    else
+    {
+        // Each scanline is encoded into its own worst-case slot, then the slots are packed in order
+        std::unique_ptr<size_t[]> sizes(new (std::nothrow) size_t[image.height]);
+        if (!sizes)
+        {
+            blob.Release();
+            return E_OUTOFMEMORY;
+        }
+
+        uint8_t* slots = dPtr;
+
+        hr = _ParallelFor(bands, [&](size_t band) -> HRESULT
+            {
+                const size_t y0 = (image.height * band) / bands;
+                const size_t y1 = (image.height * (band + 1)) / bands;
+
+                std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch]);
+                if (!temp)
+                    return E_OUTOFMEMORY;
+
+                for (size_t scan = y0; scan < y1; ++scan)
+                {
+                    sizes[scan] = EncodeScanline(slots + rowPitch * scan, image.pixels + image.rowPitch * scan,
+                        image.format, image.width, fpp, temp.get());
+                }
 
-        size_t encSize = EncodeRLE(enc, rgbe, rowPitch, image.width);
-        if (encSize > 0)
+                return S_OK;
+            });
+        if (FAILED(hr))
         {
-            memcpy(dPtr, enc, encSize);
-            dPtr += encSize;
+            blob.Release();
+            return hr;
         }
-        else
+
+        for (size_t scan = 0; scan < image.height; ++scan)
         {
-            memcpy(dPtr, rgbe, rowPitch);
-            dPtr += rowPitch;
+            memmove(dPtr, slots + rowPitch * scan, sizes[scan]);
+            dPtr += sizes[scan];
         }
     }
 #endif
@@ -1094,7 +1278,7 @@ HRESULT DirectX::SaveToHDRMemory(const Image& image, Blob& blob) noexcept
 // Save a HDR file to disk
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::SaveToHDRFile(const Image& image, const wchar_t* szFile) noexcept
+HRESULT DirectX::SaveToHDRFile(const Image& image, HDR_FLAGS flags, const wchar_t* szFile) noexcept
 {
     if (!szFile)
         return E_INVALIDARG;
@@ -1153,12 +1337,12 @@ HRESULT DirectX::SaveToHDRFile(const Image& image, const wchar_t* szFile) noexce
 
     size_t rowPitch = static_cast<size_t>(pitch);
 
-    if (slicePitch < 65535)
+    if (slicePitch < 65535 || (flags & HDR_FLAGS_PARALLEL))
     {
-        // For small images, it is better to create an in-memory file and write it out
+        // For small images, it is better to create an in-memory file and write it out (as is needed to encode in parallel)
         Blob blob;
 
-        HRESULT hr = SaveToHDRMemory(image, blob);
+        HRESULT hr = SaveToHDRMemory(image, flags, blob);
         if (FAILED(hr))
             return hr;
 
@@ -1242,52 +1426,25 @@ HRESULT DirectX::SaveToHDRFile(const Image& image, const wchar_t* szFile) noexce
         const uint8_t* sPtr = image.pixels;
         for (size_t scan = 0; scan < image.height; ++scan)
         {
-             if (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT || image.format == DXGI_FORMAT_R32G32B32_FLOAT)
-            {
-                FloatToRGBE(rgbe, reinterpret_cast<const float*>(sPtr), image.width, fpp);
-            }
-            else if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
-            {
-                HalfToRGBE(rgbe, reinterpret_cast<const uint16_t*>(sPtr), image.width, fpp);
-            }
+            size_t encSize = EncodeScanline(enc, sPtr, image.format, image.width, fpp, rgbe);
             sPtr += image.rowPitch;
 
-            size_t encSize = EncodeRLE(enc, rgbe, rowPitch, image.width);
-            if (encSize > 0)
-            {
-                if (encSize > UINT32_MAX)
-                    return HRESULT_E_ARITHMETIC_OVERFLOW;
+            if (encSize > UINT32_MAX)
+                return HRESULT_E_ARITHMETIC_OVERFLOW;
 
 #ifdef WIN32
-                if (!WriteFile(hFile.get(), enc, static_cast<DWORD>(encSize), &bytesWritten, nullptr))
-                {
-                    return HRESULT_FROM_WIN32(GetLastError());
-                }
-
-                if (bytesWritten != encSize)
-                    return E_FAIL;
-#else
-                outFile.write(reinterpret_cast<char*>(enc), static_cast<std::streamsize>(encSize));
-                if (!outFile)
-                    return E_FAIL;
-#endif
-            }
-            else
+            if (!WriteFile(hFile.get(), enc, static_cast<DWORD>(encSize), &bytesWritten, nullptr))
             {
-#ifdef WIN32
-                if (!WriteFile(hFile.get(), rgbe, static_cast<DWORD>(rowPitch), &bytesWritten, nullptr))
-                {
-                    return HRESULT_FROM_WIN32(GetLastError());
-                }
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
 
-                if (bytesWritten != rowPitch)
-                    return E_FAIL;
+            if (bytesWritten != encSize)
+                return E_FAIL;
 #else
-                outFile.write(reinterpret_cast<char*>(rgbe), static_cast<std::streamsize>(rowPitch));
-                if (!outFile)
-                    return E_FAIL;
+            outFile.write(reinterpret_cast<char*>(enc), static_cast<std::streamsize>(encSize));
+            if (!outFile)
+                return E_FAIL;
 #endif
-            }
         }
 #endif
     }
@@ -21,6 +21,11 @@ namespace DirectX
 using namespace DirectX;
 
 #ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace
 {
     inline void * _aligned_malloc(size_t size, size_t alignment)
@@ -33,6 +38,63 @@ namespace
 }
 #endif
 
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // Determines the image array index of a mip/item/slice
+    //-------------------------------------------------------------------------------------
+    bool GetImageIndex(const TexMetadata& metadata, size_t mip, size_t item, size_t slice, size_t& index) noexcept
+    {
+        if (mip >= metadata.mipLevels)
+            return false;
+
+        index = 0;
+
+        switch (metadata.dimension)
+        {
+        case TEX_DIMENSION_TEXTURE1D:
+        case TEX_DIMENSION_TEXTURE2D:
+            if (slice > 0)
+                return false;
+
+            if (item >= metadata.arraySize)
+                return false;
+
+            index = item*(metadata.mipLevels) + mip;
+            break;
+
+        case TEX_DIMENSION_TEXTURE3D:
+            if (item > 0)
+            {
+                // No support for arrays of volumes
+                return false;
+            }
+            else
+            {
+                size_t d = metadata.depth;
+
+                for (size_t level = 0; level < mip; ++level)
+                {
+                    index += d;
+                    if (d > 1)
+                        d >>= 1;
+                }
+
+                if (slice >= d)
+                    return false;
+
+                index += slice;
+            }
+            break;
+
+        default:
+            return false;
+        }
+
+        return true;
+    }
+}
+
 //-------------------------------------------------------------------------------------
 // Determines number of image array entries and pixel size
 //-------------------------------------------------------------------------------------
@@ -732,51 +794,9 @@ bool ScratchImage::OverrideFormat(DXGI_FORMAT f) noexcept
 _Use_decl_annotations_
 const Image* ScratchImage::GetImage(size_t mip, size_t item, size_t slice) const noexcept
 {
-    if (mip >= m_metadata.mipLevels)
-        return nullptr;
-
-    size_t index = 0;
-
-    switch (m_metadata.dimension)
-    {
-    case TEX_DIMENSION_TEXTURE1D:
-    case TEX_DIMENSION_TEXTURE2D:
-        if (slice > 0)
-            return nullptr;
-
-        if (item >= m_metadata.arraySize)
-            return nullptr;
-
-        index = item*(m_metadata.mipLevels) + mip;
-        break;
-
-    case TEX_DIMENSION_TEXTURE3D:
-        if (item > 0)
-        {
-            // No support for arrays of volumes
-            return nullptr;
-        }
-        else
-        {
-            size_t d = m_metadata.depth;
-
-            for (size_t level = 0; level < mip; ++level)
-            {
-                index += d;
-                if (d > 1)
-                    d >>= 1;
-            }
-
-            if (slice >= d)
-                return nullptr;
-
-            index += slice;
-        }
-        break;
-
-    default:
+    size_t index;
+    if (!GetImageIndex(m_metadata, mip, item, slice, index))
         return nullptr;
-    }
 
     return &m_image[index];
 }
@@ -834,3 +854,192 @@ bool ScratchImage::IsAlphaAllOpaque() const noexcept
 
     return true;
 }
+
+
+//=====================================================================================
+// MappedImage - read-only image set over a file mapping
+//=====================================================================================
+
+MappedImage& MappedImage::operator= (MappedImage&& moveFrom) noexcept
+{
+    if (this != &moveFrom)
+    {
+        Release();
+
+        m_nimages = moveFrom.m_nimages;
+        m_size = moveFrom.m_size;
+        m_metadata = moveFrom.m_metadata;
+        m_image = moveFrom.m_image;
+        m_memory = moveFrom.m_memory;
+        m_view = moveFrom.m_view;
+        m_viewSize = moveFrom.m_viewSize;
+
+        moveFrom.m_nimages = 0;
+        moveFrom.m_size = 0;
+        moveFrom.m_image = nullptr;
+        moveFrom.m_memory = nullptr;
+        moveFrom.m_view = nullptr;
+        moveFrom.m_viewSize = 0;
+    }
+    return *this;
+}
+
+_Use_decl_annotations_
+HRESULT MappedImage::Initialize(const wchar_t* szFile) noexcept
+{
+    if (!szFile)
+        return E_INVALIDARG;
+
+    Release();
+
+#ifdef WIN32
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(szFile, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(szFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr)));
+#endif
+    if (!hFile)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    if (fileInfo.EndOfFile.QuadPart <= 0)
+        return E_FAIL;
+
+#if defined(_M_IX86) || defined(_M_ARM) || defined(_M_HYBRID_X86_ARM64)
+    if (fileInfo.EndOfFile.HighPart > 0)
+        return HRESULT_E_FILE_TOO_LARGE;
+#endif
+
+    ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!hMapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // The view keeps the mapping and file alive after the handles are closed
+    m_view = MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+    if (!m_view)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    m_viewSize = static_cast<size_t>(fileInfo.EndOfFile.QuadPart);
+#else // !WIN32
+    const int fd = open(std::filesystem::path(szFile).c_str(), O_RDONLY);
+    if (fd < 0)
+        return E_FAIL;
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return E_FAIL;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return E_FAIL;
+
+    m_view = view;
+    m_viewSize = static_cast<size_t>(st.st_size);
+#endif
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT MappedImage::SetupImages(const TexMetadata& mdata, size_t offset, CP_FLAGS flags) noexcept
+{
+    if (!m_view)
+        return E_UNEXPECTED;
+
+    if (!IsValid(mdata.format) || IsPalettized(mdata.format))
+        return E_INVALIDARG;
+
+    if (!mdata.width || !mdata.height || !mdata.depth || !mdata.arraySize || !mdata.mipLevels)
+        return E_INVALIDARG;
+
+    if (offset > m_viewSize)
+        return E_INVALIDARG;
+
+    delete[] m_image;
+    m_image = nullptr;
+    m_nimages = 0;
+    m_memory = nullptr;
+    m_size = 0;
+    memset(&m_metadata, 0, sizeof(m_metadata));
+
+    size_t pixelSize, nimages;
+    if (!_DetermineImageArray(mdata, flags, nimages, pixelSize))
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+    if (pixelSize > (m_viewSize - offset))
+        return HRESULT_E_HANDLE_EOF;
+
+    m_image = new (std::nothrow) Image[nimages];
+    if (!m_image)
+        return E_OUTOFMEMORY;
+
+    memset(m_image, 0, sizeof(Image) * nimages);
+
+    // Image::pixels is not const, but the pages are mapped read-only
+    auto pixels = const_cast<uint8_t*>(static_cast<const uint8_t*>(m_view) + offset);
+    if (!_SetupImageArray(pixels, pixelSize, mdata, flags, m_image, nimages))
+    {
+        delete[] m_image;
+        m_image = nullptr;
+        return E_FAIL;
+    }
+
+    m_nimages = nimages;
+    m_memory = pixels;
+    m_size = pixelSize;
+    m_metadata = mdata;
+
+    return S_OK;
+}
+
+void MappedImage::Release() noexcept
+{
+    m_nimages = 0;
+    m_size = 0;
+    m_memory = nullptr;
+
+    if (m_image)
+    {
+        delete[] m_image;
+        m_image = nullptr;
+    }
+
+    if (m_view)
+    {
+#ifdef WIN32
+        std::ignore = UnmapViewOfFile(m_view);
+#else
+        munmap(m_view, m_viewSize);
+#endif
+        m_view = nullptr;
+        m_viewSize = 0;
+    }
+
+    memset(&m_metadata, 0, sizeof(m_metadata));
+}
+
+_Use_decl_annotations_
+const Image* MappedImage::GetImage(size_t mip, size_t item, size_t slice) const noexcept
+{
+    size_t index;
+    if (!m_image || !GetImageIndex(m_metadata, mip, item, slice, index))
+        return nullptr;
+
+    return &m_image[index];
+}
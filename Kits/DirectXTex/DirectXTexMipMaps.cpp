@@ -680,6 +680,8 @@ namespace
             break;
 
         case TEX_FILTER_TRIANGLE:
+        case TEX_FILTER_LANCZOS:
+        case TEX_FILTER_MITCHELL:
             // WIC does not implement this filter
             return false;
         }
@@ -1008,6 +1010,7 @@ namespace
             if (height <= 1)
             {
                 urow1 = urow0;
+                urow3 = urow2;
             }
 
             if (width <= 1)
@@ -1364,6 +1367,29 @@ namespace
     }
 
 
+    //--- 2D Lanczos / Mitchell Filter ---
+    HRESULT Generate2DMipsSeparableFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    {
+        if (!mipChain.GetImages())
+            return E_INVALIDARG;
+
+        // Resample each level from the one above it (rows are banded when TEX_FILTER_PARALLEL is set)
+        for (size_t level = 1; level < levels; ++level)
+        {
+            const Image* src = mipChain.GetImage(level - 1, item, 0);
+            const Image* dest = mipChain.GetImage(level, item, 0);
+            if (!src || !dest)
+                return E_POINTER;
+
+            HRESULT hr = _ResizeSeparable(*src, filter, *dest);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+
     //--- 2D Triangle Filter ---
     HRESULT Generate2DMipsTriangleFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
     {
@@ -1578,6 +1604,450 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // Parallel mip-map generation
+    //
+    // Each level is filtered from the one above it, so levels are still generated in order,
+    // but the rows of a level are split into bands (across all array items or volume slices)
+    // that are filtered concurrently. Every band computes its output rows exactly as the
+    // serial filters do, so the results are identical.
+    //-------------------------------------------------------------------------------------
+    size_t CountMipBands(size_t nwidth, size_t nheight) noexcept
+    {
+        // A few bands per worker for load balancing, but enough pixels to amortize the scanline allocation
+        constexpr size_t MIN_BAND_PIXELS = 16384;
+
+        size_t bands = std::min(nheight, _GetParallelWorkerCount() * 4);
+        bands = std::min(bands, (nwidth * nheight) / MIN_BAND_PIXELS);
+        return std::max<size_t>(1, bands);
+    }
+
+    inline size_t BandStart(size_t band, size_t bands, size_t nheight) noexcept
+    {
+        return (nheight * band) / bands;
+    }
+
+
+    //--- 2D Point Filter (rows y0 to y1 - 1 of one level) ---
+    HRESULT Generate2DMipsPointBand(const Image& src, const Image& dest, size_t y0, size_t y1) noexcept
+    {
+        const size_t width = src.width;
+        const size_t height = src.height;
+        const size_t nwidth = dest.width;
+        const size_t nheight = dest.height;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* target = scanline.get();
+
+        XMVECTOR* row = target + width;
+
+        const uint8_t* pSrc = src.pixels;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * y0;
+
+        const size_t rowPitch = src.rowPitch;
+
+        const size_t xinc = (width << 16) / nwidth;
+        const size_t yinc = (height << 16) / nheight;
+
+        size_t lasty = size_t(-1);
+
+        size_t sy = yinc * y0;
+        for (size_t y = y0; y < y1; ++y)
+        {
+            if ((lasty ^ sy) >> 16)
+            {
+                if (!_LoadScanline(row, width, pSrc + (rowPitch * (sy >> 16)), rowPitch, src.format))
+                    return E_FAIL;
+                lasty = sy;
+            }
+
+            size_t sx = 0;
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                target[x] = row[sx >> 16];
+                sx += xinc;
+            }
+
+            if (!_StoreScanline(pDest, dest.rowPitch, dest.format, target, nwidth))
+                return E_FAIL;
+            pDest += dest.rowPitch;
+
+            sy += yinc;
+        }
+
+        return S_OK;
+    }
+
+
+    //--- 2D Box Filter (rows y0 to y1 - 1 of one level) ---
+    HRESULT Generate2DMipsBoxBand(const Image& src, const Image& dest, size_t y0, size_t y1, TEX_FILTER_FLAGS filter) noexcept
+    {
+        const size_t width = src.width;
+        const size_t nwidth = dest.width;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 3);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* target = scanline.get();
+
+        XMVECTOR* urow0 = target + width;
+        XMVECTOR* urow1 = (src.height > 1) ? target + width * 2 : urow0;
+
+        const XMVECTOR* urow2 = (width > 1) ? urow0 + 1 : urow0;
+        const XMVECTOR* urow3 = (width > 1) ? urow1 + 1 : urow1;
+
+        const size_t rowPitch = src.rowPitch;
+
+        const uint8_t* pSrc = src.pixels + rowPitch * ((urow0 != urow1) ? y0 * 2 : y0);
+        uint8_t* pDest = dest.pixels + dest.rowPitch * y0;
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            if (!_LoadScanlineLinear(urow0, width, pSrc, rowPitch, src.format, filter))
+                return E_FAIL;
+            pSrc += rowPitch;
+
+            if (urow0 != urow1)
+            {
+                if (!_LoadScanlineLinear(urow1, width, pSrc, rowPitch, src.format, filter))
+                    return E_FAIL;
+                pSrc += rowPitch;
+            }
+
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                size_t x2 = x << 1;
+
+                AVERAGE4(target[x], urow0[x2], urow1[x2], urow2[x2], urow3[x2])
+            }
+
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
+        }
+
+        return S_OK;
+    }
+
+
+    //--- 2D Linear Filter (rows y0 to y1 - 1 of one level) ---
+    HRESULT Generate2DMipsLinearBand(const Image& src, const Image& dest, size_t y0, size_t y1, TEX_FILTER_FLAGS filter,
+        _In_reads_(dest.width) const LinearFilter* lfX, _In_reads_(dest.height) const LinearFilter* lfY) noexcept
+    {
+        const size_t width = src.width;
+        const size_t nwidth = dest.width;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 3);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* target = scanline.get();
+
+        XMVECTOR* row0 = target + width;
+        XMVECTOR* row1 = target + width * 2;
+
+        const uint8_t* pSrc = src.pixels;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * y0;
+
+        const size_t rowPitch = src.rowPitch;
+
+        size_t u0 = size_t(-1);
+        size_t u1 = size_t(-1);
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            auto& toY = lfY[y];
+
+            if (toY.u0 != u0)
+            {
+                if (toY.u0 != u1)
+                {
+                    u0 = toY.u0;
+
+                    if (!_LoadScanlineLinear(row0, width, pSrc + (rowPitch * u0), rowPitch, src.format, filter))
+                        return E_FAIL;
+                }
+                else
+                {
+                    u0 = u1;
+                    u1 = size_t(-1);
+
+                    std::swap(row0, row1);
+                }
+            }
+
+            if (toY.u1 != u1)
+            {
+                u1 = toY.u1;
+
+                if (!_LoadScanlineLinear(row1, width, pSrc + (rowPitch * u1), rowPitch, src.format, filter))
+                    return E_FAIL;
+            }
+
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                auto& toX = lfX[x];
+
+                BILINEAR_INTERPOLATE(target[x], toX, toY, row0, row1)
+            }
+
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
+        }
+
+        return S_OK;
+    }
+
+
+    //--- 2D Cubic Filter (rows y0 to y1 - 1 of one level) ---
+    HRESULT Generate2DMipsCubicBand(const Image& src, const Image& dest, size_t y0, size_t y1, TEX_FILTER_FLAGS filter,
+        _In_reads_(dest.width) const CubicFilter* cfX, _In_reads_(dest.height) const CubicFilter* cfY) noexcept
+    {
+        const size_t width = src.width;
+        const size_t nwidth = dest.width;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 5);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* target = scanline.get();
+
+        XMVECTOR* row0 = target + width;
+        XMVECTOR* row1 = target + width * 2;
+        XMVECTOR* row2 = target + width * 3;
+        XMVECTOR* row3 = target + width * 4;
+
+        const uint8_t* pSrc = src.pixels;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * y0;
+
+        const size_t rowPitch = src.rowPitch;
+
+        size_t u0 = size_t(-1);
+        size_t u1 = size_t(-1);
+        size_t u2 = size_t(-1);
+        size_t u3 = size_t(-1);
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            auto& toY = cfY[y];
+
+            // Scanline 1
+            if (toY.u0 != u0)
+            {
+                if (toY.u0 != u1 && toY.u0 != u2 && toY.u0 != u3)
+                {
+                    u0 = toY.u0;
+
+                    if (!_LoadScanlineLinear(row0, width, pSrc + (rowPitch * u0), rowPitch, src.format, filter))
+                        return E_FAIL;
+                }
+                else if (toY.u0 == u1)
+                {
+                    u0 = u1;
+                    u1 = size_t(-1);
+
+                    std::swap(row0, row1);
+                }
+                else if (toY.u0 == u2)
+                {
+                    u0 = u2;
+                    u2 = size_t(-1);
+
+                    std::swap(row0, row2);
+                }
+                else if (toY.u0 == u3)
+                {
+                    u0 = u3;
+                    u3 = size_t(-1);
+
+                    std::swap(row0, row3);
+                }
+            }
+
+            // Scanline 2
+            if (toY.u1 != u1)
+            {
+                if (toY.u1 != u2 && toY.u1 != u3)
+                {
+                    u1 = toY.u1;
+
+                    if (!_LoadScanlineLinear(row1, width, pSrc + (rowPitch * u1), rowPitch, src.format, filter))
+                        return E_FAIL;
+                }
+                else if (toY.u1 == u2)
+                {
+                    u1 = u2;
+                    u2 = size_t(-1);
+
+                    std::swap(row1, row2);
+                }
+                else if (toY.u1 == u3)
+                {
+                    u1 = u3;
+                    u3 = size_t(-1);
+
+                    std::swap(row1, row3);
+                }
+            }
+
+            // Scanline 3
+            if (toY.u2 != u2)
+            {
+                if (toY.u2 != u3)
+                {
+                    u2 = toY.u2;
+
+                    if (!_LoadScanlineLinear(row2, width, pSrc + (rowPitch * u2), rowPitch, src.format, filter))
+                        return E_FAIL;
+                }
+                else
+                {
+                    u2 = u3;
+                    u3 = size_t(-1);
+
+                    std::swap(row2, row3);
+                }
+            }
+
+            // Scanline 4
+            if (toY.u3 != u3)
+            {
+                u3 = toY.u3;
+
+                if (!_LoadScanlineLinear(row3, width, pSrc + (rowPitch * u3), rowPitch, src.format, filter))
+                    return E_FAIL;
+            }
+
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                auto& toX = cfX[x];
+
+                XMVECTOR C0, C1, C2, C3;
+
+                CUBIC_INTERPOLATE(C0, toX.x, row0[toX.u0], row0[toX.u1], row0[toX.u2], row0[toX.u3])
+                CUBIC_INTERPOLATE(C1, toX.x, row1[toX.u0], row1[toX.u1], row1[toX.u2], row1[toX.u3])
+                CUBIC_INTERPOLATE(C2, toX.x, row2[toX.u0], row2[toX.u1], row2[toX.u2], row2[toX.u3])
+                CUBIC_INTERPOLATE(C3, toX.x, row3[toX.u0], row3[toX.u1], row3[toX.u2], row3[toX.u3])
+
+                CUBIC_INTERPOLATE(target[x], toY.x, C0, C1, C2, C3)
+            }
+
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
+        }
+
+        return S_OK;
+    }
+
+
+    //--- 2D point, box, linear, and cubic filters for all array items ---
+    HRESULT Generate2DMipsParallel(size_t levels, unsigned long filter_select, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        if (!mipChain.GetImages())
+            return E_INVALIDARG;
+
+        // This assumes that the base images are already placed into the mipChain at the top level... (see _Setup2DMips)
+
+        assert(levels > 1);
+
+        const size_t items = mipChain.GetMetadata().arraySize;
+        size_t width = mipChain.GetMetadata().width;
+        size_t height = mipChain.GetMetadata().height;
+
+        std::unique_ptr<LinearFilter[]> lf;
+        std::unique_ptr<CubicFilter[]> cf;
+
+        switch (filter_select)
+        {
+        case TEX_FILTER_POINT:
+            break;
+
+        case TEX_FILTER_BOX:
+            if (!ispow2(width) || !ispow2(height))
+                return E_FAIL;
+            break;
+
+        case TEX_FILTER_LINEAR:
+            lf.reset(new (std::nothrow) LinearFilter[width + height]);
+            if (!lf)
+                return E_OUTOFMEMORY;
+            break;
+
+        case TEX_FILTER_CUBIC:
+            cf.reset(new (std::nothrow) CubicFilter[width + height]);
+            if (!cf)
+                return E_OUTOFMEMORY;
+            break;
+
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        LinearFilter* lfX = lf.get();
+        LinearFilter* lfY = lf.get() + width;
+        CubicFilter* cfX = cf.get();
+        CubicFilter* cfY = cf.get() + width;
+
+        for (size_t level = 1; level < levels; ++level)
+        {
+            const size_t nwidth = (width > 1) ? (width >> 1) : 1;
+            const size_t nheight = (height > 1) ? (height >> 1) : 1;
+
+            if (lf)
+            {
+                _CreateLinearFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
+                _CreateLinearFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
+            }
+            else if (cf)
+            {
+                _CreateCubicFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
+                _CreateCubicFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
+            }
+
+            const size_t bands = CountMipBands(nwidth, nheight);
+
+            HRESULT hr = _ParallelFor(items * bands, [&](size_t index) -> HRESULT
+                {
+                    const size_t item = index / bands;
+                    const size_t band = index % bands;
+
+                    const Image* src = mipChain.GetImage(level - 1, item, 0);
+                    const Image* dest = mipChain.GetImage(level, item, 0);
+
+                    if (!src || !dest)
+                        return E_POINTER;
+
+                    const size_t y0 = BandStart(band, bands, nheight);
+                    const size_t y1 = BandStart(band + 1, bands, nheight);
+
+                    switch (filter_select)
+                    {
+                    case TEX_FILTER_POINT:  return Generate2DMipsPointBand(*src, *dest, y0, y1);
+                    case TEX_FILTER_BOX:    return Generate2DMipsBoxBand(*src, *dest, y0, y1, filter);
+                    case TEX_FILTER_LINEAR: return Generate2DMipsLinearBand(*src, *dest, y0, y1, filter, lfX, lfY);
+                    default:                return Generate2DMipsCubicBand(*src, *dest, y0, y1, filter, cfX, cfY);
+                    }
+                });
+            if (FAILED(hr))
+                return hr;
+
+            if (height > 1)
+                height >>= 1;
+
+            if (width > 1)
+                width >>= 1;
+        }
+
+        return S_OK;
+    }
+
+
     //-------------------------------------------------------------------------------------
     // Generate volume mip-map helpers
     //-------------------------------------------------------------------------------------
@@ -1820,7 +2290,9 @@ namespace
             if (height <= 1)
             {
                 urow1 = urow0;
+                urow3 = urow2;
                 vrow1 = vrow0;
+                vrow3 = vrow2;
             }
 
             if (width <= 1)
@@ -2766,6 +3238,153 @@ namespace
 
         return S_OK;
     }
+
+    //--- 3D Box Filter (rows y0 to y1 - 1 of one output slice) ---
+    HRESULT Generate3DMipsBoxBand(const Image& srca, const Image& srcb, const Image& dest, size_t y0, size_t y1, TEX_FILTER_FLAGS filter) noexcept
+    {
+        const size_t width = srca.width;
+        const size_t nwidth = dest.width;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 5);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* target = scanline.get();
+
+        const bool twoRows = (srca.height > 1);
+
+        XMVECTOR* urow0 = target + width;
+        XMVECTOR* urow1 = twoRows ? target + width * 2 : urow0;
+        XMVECTOR* vrow0 = target + width * 3;
+        XMVECTOR* vrow1 = twoRows ? target + width * 4 : vrow0;
+
+        const XMVECTOR* urow2 = (width > 1) ? urow0 + 1 : urow0;
+        const XMVECTOR* urow3 = (width > 1) ? urow1 + 1 : urow1;
+        const XMVECTOR* vrow2 = (width > 1) ? vrow0 + 1 : vrow0;
+        const XMVECTOR* vrow3 = (width > 1) ? vrow1 + 1 : vrow1;
+
+        const size_t aRowPitch = srca.rowPitch;
+        const size_t bRowPitch = srcb.rowPitch;
+
+        const size_t srcRow = twoRows ? y0 * 2 : y0;
+        const uint8_t* pSrc1 = srca.pixels + aRowPitch * srcRow;
+        const uint8_t* pSrc2 = srcb.pixels + bRowPitch * srcRow;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * y0;
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            if (!_LoadScanlineLinear(urow0, width, pSrc1, aRowPitch, srca.format, filter))
+                return E_FAIL;
+            pSrc1 += aRowPitch;
+
+            if (urow0 != urow1)
+            {
+                if (!_LoadScanlineLinear(urow1, width, pSrc1, aRowPitch, srca.format, filter))
+                    return E_FAIL;
+                pSrc1 += aRowPitch;
+            }
+
+            if (!_LoadScanlineLinear(vrow0, width, pSrc2, bRowPitch, srcb.format, filter))
+                return E_FAIL;
+            pSrc2 += bRowPitch;
+
+            if (vrow0 != vrow1)
+            {
+                if (!_LoadScanlineLinear(vrow1, width, pSrc2, bRowPitch, srcb.format, filter))
+                    return E_FAIL;
+                pSrc2 += bRowPitch;
+            }
+
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                size_t x2 = x << 1;
+
+                AVERAGE8(target[x], urow0[x2], urow1[x2], urow2[x2], urow3[x2],
+                    vrow0[x2], vrow1[x2], vrow2[x2], vrow3[x2])
+            }
+
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
+        }
+
+        return S_OK;
+    }
+
+
+    //--- 3D Box Filter for all slices ---
+    HRESULT Generate3DMipsBoxParallel(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        if (!depth || !mipChain.GetImages())
+            return E_INVALIDARG;
+
+        // This assumes that the base images are already placed into the mipChain at the top level... (see _Setup3DMips)
+
+        assert(levels > 1);
+
+        size_t width = mipChain.GetMetadata().width;
+        size_t height = mipChain.GetMetadata().height;
+
+        if (!ispow2(width) || !ispow2(height) || !ispow2(depth))
+            return E_FAIL;
+
+        for (size_t level = 1; level < levels; ++level)
+        {
+            const size_t nwidth = (width > 1) ? (width >> 1) : 1;
+            const size_t nheight = (height > 1) ? (height >> 1) : 1;
+            const size_t ndepth = (depth > 1) ? (depth >> 1) : 1;
+            const size_t sdepth = depth;
+
+            const size_t bands = CountMipBands(nwidth, nheight);
+
+            HRESULT hr = _ParallelFor(ndepth * bands, [&](size_t index) -> HRESULT
+                {
+                    const size_t slice = index / bands;
+                    const size_t band = index % bands;
+
+                    const size_t y0 = BandStart(band, bands, nheight);
+                    const size_t y1 = BandStart(band + 1, bands, nheight);
+
+                    const Image* dest = mipChain.GetImage(level, 0, slice);
+                    if (!dest)
+                        return E_POINTER;
+
+                    if (sdepth > 1)
+                    {
+                        const size_t slicea = std::min<size_t>(slice * 2, sdepth - 1);
+                        const size_t sliceb = std::min<size_t>(slicea + 1, sdepth - 1);
+
+                        const Image* srca = mipChain.GetImage(level - 1, 0, slicea);
+                        const Image* srcb = mipChain.GetImage(level - 1, 0, sliceb);
+                        if (!srca || !srcb)
+                            return E_POINTER;
+
+                        return Generate3DMipsBoxBand(*srca, *srcb, *dest, y0, y1, filter);
+                    }
+                    else
+                    {
+                        const Image* src = mipChain.GetImage(level - 1, 0, 0);
+                        if (!src)
+                            return E_POINTER;
+
+                        return Generate2DMipsBoxBand(*src, *dest, y0, y1, filter);
+                    }
+                });
+            if (FAILED(hr))
+                return hr;
+
+            if (height > 1)
+                height >>= 1;
+
+            if (width > 1)
+                width >>= 1;
+
+            if (depth > 1)
+                depth >>= 1;
+        }
+
+        return S_OK;
+    }
 }
 
 
@@ -2917,7 +3536,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsBoxFilter(levels, filter, mipChain, 0);
+            hr = (filter & TEX_FILTER_PARALLEL)
+                ? Generate2DMipsParallel(levels, TEX_FILTER_BOX, filter, mipChain)
+                : Generate2DMipsBoxFilter(levels, filter, mipChain, 0);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2927,7 +3548,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsPointFilter(levels, mipChain, 0);
+            hr = (filter & TEX_FILTER_PARALLEL)
+                ? Generate2DMipsParallel(levels, TEX_FILTER_POINT, filter, mipChain)
+                : Generate2DMipsPointFilter(levels, mipChain, 0);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2937,7 +3560,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsLinearFilter(levels, filter, mipChain, 0);
+            hr = (filter & TEX_FILTER_PARALLEL)
+                ? Generate2DMipsParallel(levels, TEX_FILTER_LINEAR, filter, mipChain)
+                : Generate2DMipsLinearFilter(levels, filter, mipChain, 0);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2947,7 +3572,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsCubicFilter(levels, filter, mipChain, 0);
+            hr = (filter & TEX_FILTER_PARALLEL)
+                ? Generate2DMipsParallel(levels, TEX_FILTER_CUBIC, filter, mipChain)
+                : Generate2DMipsCubicFilter(levels, filter, mipChain, 0);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2962,12 +3589,117 @@ HRESULT DirectX::GenerateMipMaps(
                 mipChain.Release();
             return hr;
 
+        case TEX_FILTER_LANCZOS:
+        case TEX_FILTER_MITCHELL:
+            hr = Setup2DMips(&baseImage, 1, mdata, mipChain);
+            if (FAILED(hr))
+                return hr;
+
+            hr = Generate2DMipsSeparableFilter(levels, filter, mipChain, 0);
+            if (FAILED(hr))
+                mipChain.Release();
+            return hr;
+
         default:
             return HRESULT_E_NOT_SUPPORTED;
         }
     }
 }
 
+//-------------------------------------------------------------------------------------
+// Generate one mip level from the level above it
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GenerateMipLevel(
+    const Image& srcImage,
+    TEX_FILTER_FLAGS filter,
+    const Image& destImage) noexcept
+{
+    if (!IsValid(srcImage.format) || srcImage.format != destImage.format)
+        return E_INVALIDARG;
+
+    if (!srcImage.pixels || !destImage.pixels)
+        return E_POINTER;
+
+    if (IsCompressed(srcImage.format) || IsTypeless(srcImage.format) || IsPlanar(srcImage.format) || IsPalettized(srcImage.format))
+    {
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    if ((srcImage.width > UINT32_MAX) || (srcImage.height > UINT32_MAX)
+        || destImage.width != std::max<size_t>(1, srcImage.width >> 1)
+        || destImage.height != std::max<size_t>(1, srcImage.height >> 1))
+        return E_INVALIDARG;
+
+    unsigned long filter_select = (filter & TEX_FILTER_MODE_MASK);
+    if (!filter_select)
+    {
+        // Default filter choice (GenerateMipMaps picks this from the base level, so callers should pass an explicit mode)
+        filter_select = (ispow2(srcImage.width) && ispow2(srcImage.height)) ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
+    }
+
+    const size_t width = srcImage.width;
+    const size_t height = srcImage.height;
+    const size_t nwidth = destImage.width;
+    const size_t nheight = destImage.height;
+
+    std::unique_ptr<LinearFilter[]> lf;
+    std::unique_ptr<CubicFilter[]> cf;
+
+    switch (filter_select)
+    {
+    case TEX_FILTER_POINT:
+        break;
+
+    case TEX_FILTER_BOX:
+        if (!ispow2(width) || !ispow2(height))
+            return E_FAIL;
+        break;
+
+    case TEX_FILTER_LINEAR:
+        lf.reset(new (std::nothrow) LinearFilter[width + height]);
+        if (!lf)
+            return E_OUTOFMEMORY;
+
+        _CreateLinearFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, lf.get());
+        _CreateLinearFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, lf.get() + width);
+        break;
+
+    case TEX_FILTER_CUBIC:
+        cf.reset(new (std::nothrow) CubicFilter[width + height]);
+        if (!cf)
+            return E_OUTOFMEMORY;
+
+        _CreateCubicFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cf.get());
+        _CreateCubicFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cf.get() + width);
+        break;
+
+    case TEX_FILTER_LANCZOS:
+    case TEX_FILTER_MITCHELL:
+        return _ResizeSeparable(srcImage, filter, destImage);
+
+    default:
+        // The triangle filter accumulates across the whole chain
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    const size_t bands = (filter & TEX_FILTER_PARALLEL) ? CountMipBands(nwidth, nheight) : 1;
+
+    return _ParallelFor(bands, [&](size_t band) -> HRESULT
+        {
+            const size_t y0 = BandStart(band, bands, nheight);
+            const size_t y1 = BandStart(band + 1, bands, nheight);
+
+            switch (filter_select)
+            {
+            case TEX_FILTER_POINT:  return Generate2DMipsPointBand(srcImage, destImage, y0, y1);
+            case TEX_FILTER_BOX:    return Generate2DMipsBoxBand(srcImage, destImage, y0, y1, filter);
+            case TEX_FILTER_LINEAR: return Generate2DMipsLinearBand(srcImage, destImage, y0, y1, filter, lf.get(), lf.get() + width);
+            default:                return Generate2DMipsCubicBand(srcImage, destImage, y0, y1, filter, cf.get(), cf.get() + width);
+            }
+        });
+}
+
 _Use_decl_annotations_
 HRESULT DirectX::GenerateMipMaps(
     const Image* srcImages,
@@ -3132,6 +3864,14 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
+            if (filter & TEX_FILTER_PARALLEL)
+            {
+                hr = Generate2DMipsParallel(levels, TEX_FILTER_BOX, filter, mipChain);
+                if (FAILED(hr))
+                    mipChain.Release();
+                return hr;
+            }
+
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
                 hr = Generate2DMipsBoxFilter(levels, filter, mipChain, item);
@@ -3145,6 +3885,14 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
+            if (filter & TEX_FILTER_PARALLEL)
+            {
+                hr = Generate2DMipsParallel(levels, TEX_FILTER_POINT, filter, mipChain);
+                if (FAILED(hr))
+                    mipChain.Release();
+                return hr;
+            }
+
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
                 hr = Generate2DMipsPointFilter(levels, mipChain, item);
@@ -3158,6 +3906,14 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
+            if (filter & TEX_FILTER_PARALLEL)
+            {
+                hr = Generate2DMipsParallel(levels, TEX_FILTER_LINEAR, filter, mipChain);
+                if (FAILED(hr))
+                    mipChain.Release();
+                return hr;
+            }
+
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
                 hr = Generate2DMipsLinearFilter(levels, filter, mipChain, item);
@@ -3171,6 +3927,14 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
+            if (filter & TEX_FILTER_PARALLEL)
+            {
+                hr = Generate2DMipsParallel(levels, TEX_FILTER_CUBIC, filter, mipChain);
+                if (FAILED(hr))
+                    mipChain.Release();
+                return hr;
+            }
+
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
                 hr = Generate2DMipsCubicFilter(levels, filter, mipChain, item);
@@ -3184,6 +3948,18 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
+            if (filter & TEX_FILTER_PARALLEL)
+            {
+                // The triangle filter accumulates into whole levels, so only array items run concurrently
+                hr = _ParallelFor(metadata.arraySize, [&](size_t item) -> HRESULT
+                    {
+                        return Generate2DMipsTriangleFilter(levels, filter, mipChain, item);
+                    });
+                if (FAILED(hr))
+                    mipChain.Release();
+                return hr;
+            }
+
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
                 hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, item);
@@ -3192,6 +3968,23 @@ HRESULT DirectX::GenerateMipMaps(
             }
             return hr;
 
+        case TEX_FILTER_LANCZOS:
+        case TEX_FILTER_MITCHELL:
+            hr = Setup2DMips(&baseImages[0], metadata.arraySize, mdata2, mipChain);
+            if (FAILED(hr))
+                return hr;
+
+            for (size_t item = 0; item < metadata.arraySize; ++item)
+            {
+                hr = Generate2DMipsSeparableFilter(levels, filter, mipChain, item);
+                if (FAILED(hr))
+                {
+                    mipChain.Release();
+                    return hr;
+                }
+            }
+            return hr;
+
         default:
             return HRESULT_E_NOT_SUPPORTED;
         }
@@ -3259,7 +4052,9 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsBoxFilter(depth, levels, filter, mipChain);
+        hr = (filter & TEX_FILTER_PARALLEL)
+            ? Generate3DMipsBoxParallel(depth, levels, filter, mipChain)
+            : Generate3DMipsBoxFilter(depth, levels, filter, mipChain);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3375,7 +4170,9 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsBoxFilter(metadata.depth, levels, filter, mipChain);
+        hr = (filter & TEX_FILTER_PARALLEL)
+            ? Generate3DMipsBoxParallel(metadata.depth, levels, filter, mipChain)
+            : Generate3DMipsBoxFilter(metadata.depth, levels, filter, mipChain);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -23,25 +23,8 @@ namespace
     const XMVECTORF32 g_Gamma22 = { { { 2.2f, 2.2f, 2.2f, 1.f } } };
 
     //-------------------------------------------------------------------------------------
-    HRESULT ComputeMSE_(
-        const Image& image1,
-        const Image& image2,
-        float& mse,
-        _Out_writes_opt_(4) float* mseV,
-        CMSE_FLAGS flags) noexcept
+    CMSE_FLAGS GetImpliedFlags(const Image& image1, const Image& image2, CMSE_FLAGS flags) noexcept
     {
-        if (!image1.pixels || !image2.pixels)
-            return E_POINTER;
-
-        assert(image1.width == image2.width && image1.height == image2.height);
-        assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
-
-        const size_t width = image1.width;
-
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
-        if (!scanline)
-            return E_OUTOFMEMORY;
-
         // Flags implied from image formats
         switch (image1.format)
         {
@@ -89,86 +72,506 @@ namespace
             break;
         }
 
-        const uint8_t *pSrc1 = image1.pixels;
-        const size_t rowPitch1 = image1.rowPitch;
+        return flags;
+    }
 
-        const uint8_t *pSrc2 = image2.pixels;
-        const size_t rowPitch2 = image2.rowPitch;
+    //-------------------------------------------------------------------------------------
+    // Loads a scanline of either image, applying the gamma and bias from the flags
+    //-------------------------------------------------------------------------------------
+    bool LoadCompareScanline(
+        _Out_writes_(width) XMVECTOR* pDestination,
+        size_t width,
+        const Image& image,
+        size_t y,
+        bool srgb,
+        bool x2bias) noexcept
+    {
+        if (!_LoadScanline(pDestination, width, image.pixels + image.rowPitch * y, image.rowPitch, image.format))
+            return false;
+
+        if (srgb || x2bias)
+        {
+            for (size_t i = 0; i < width; ++i)
+            {
+                XMVECTOR v = pDestination[i];
+                if (srgb)
+                {
+                    v = XMVectorPow(v, g_Gamma22);
+                }
+                if (x2bias)
+                {
+                    v = XMVectorMultiplyAdd(v, g_XMTwo, g_XMNegativeOne);
+                }
+                pDestination[i] = v;
+            }
+        }
+
+        return true;
+    }
+
+    // Selects the compared channels with a bitwise AND, so the inner loops need no per-pixel tests
+    inline XMVECTOR GetChannelMask(CMSE_FLAGS flags) noexcept
+    {
+        return XMVectorSelectControl(
+            (flags & CMSE_IGNORE_RED) ? 0u : 1u,
+            (flags & CMSE_IGNORE_GREEN) ? 0u : 1u,
+            (flags & CMSE_IGNORE_BLUE) ? 0u : 1u,
+            (flags & CMSE_IGNORE_ALPHA) ? 0u : 1u);
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Splits the rows into bands, compared concurrently with CMSE_PARALLEL
+    //-------------------------------------------------------------------------------------
+    size_t CountBands(CMSE_FLAGS flags, size_t rows, size_t pixelsPerRow) noexcept
+    {
+        // A few bands per worker for load balancing, but enough pixels to amortize the scanline allocation
+        constexpr size_t MIN_BAND_PIXELS = 16384;
+
+        size_t bands = 1;
+        if (flags & CMSE_PARALLEL)
+        {
+            bands = std::min(rows, _GetParallelWorkerCount() * 4);
+            bands = std::min(bands, (rows * pixelsPerRow) / MIN_BAND_PIXELS);
+            bands = std::max<size_t>(1, bands);
+        }
+
+        return bands;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // sum[ (I1 - I2)^2 ] for rows y0 to y1 - 1
+    //-------------------------------------------------------------------------------------
+    HRESULT SquaredErrorBand(
+        const Image& image1,
+        const Image& image2,
+        CMSE_FLAGS flags,
+        size_t y0,
+        size_t y1,
+        XMVECTOR& sum) noexcept
+    {
+        const size_t width = image1.width;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* ptr1 = scanline.get();
+        XMVECTOR* ptr2 = scanline.get() + width;
+
+        const XMVECTOR mask = GetChannelMask(flags);
 
         XMVECTOR acc = g_XMZero;
-        static XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
 
-        for (size_t h = 0; h < image1.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
-            XMVECTOR* ptr1 = scanline.get();
-            if (!_LoadScanline(ptr1, width, pSrc1, rowPitch1, image1.format))
+            if (!LoadCompareScanline(ptr1, width, image1, h, (flags & CMSE_IMAGE1_SRGB) != 0, (flags & CMSE_IMAGE1_X2_BIAS) != 0))
                 return E_FAIL;
 
-            XMVECTOR* ptr2 = scanline.get() + width;
-            if (!_LoadScanline(ptr2, width, pSrc2, rowPitch2, image2.format))
+            if (!LoadCompareScanline(ptr2, width, image2, h, (flags & CMSE_IMAGE2_SRGB) != 0, (flags & CMSE_IMAGE2_X2_BIAS) != 0))
                 return E_FAIL;
 
             for (size_t i = 0; i < width; ++i)
             {
-                XMVECTOR v1 = *(ptr1++);
-                if (flags & CMSE_IMAGE1_SRGB)
-                {
-                    v1 = XMVectorPow(v1, g_Gamma22);
-                }
-                if (flags & CMSE_IMAGE1_X2_BIAS)
-                {
-                    v1 = XMVectorMultiplyAdd(v1, two, g_XMNegativeOne);
-                }
+                const XMVECTOR v = XMVectorAndInt(XMVectorSubtract(ptr1[i], ptr2[i]), mask);
+                acc = XMVectorMultiplyAdd(v, v, acc);
+            }
+        }
 
-                XMVECTOR v2 = *(ptr2++);
-                if (flags & CMSE_IMAGE2_SRGB)
+        sum = acc;
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    HRESULT ComputeMSE_(
+        const Image& image1,
+        const Image& image2,
+        float& mse,
+        _Out_writes_opt_(4) float* mseV,
+        CMSE_FLAGS flags) noexcept
+    {
+        if (!image1.pixels || !image2.pixels)
+            return E_POINTER;
+
+        assert(image1.width == image2.width && image1.height == image2.height);
+        assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
+
+        flags = GetImpliedFlags(image1, image2, flags);
+
+        const size_t bands = CountBands(flags, image1.height, image1.width);
+
+        XMVECTOR acc = g_XMZero;
+        if (bands <= 1)
+        {
+            HRESULT hr = SquaredErrorBand(image1, image2, flags, 0, image1.height, acc);
+            if (FAILED(hr))
+                return hr;
+        }
+        else
+        {
+            auto partial = make_AlignedArrayXMVECTOR(bands);
+            if (!partial)
+                return E_OUTOFMEMORY;
+
+            HRESULT hr = _ParallelFor(bands, [&](size_t band) -> HRESULT
                 {
-                    v2 = XMVectorPow(v2, g_Gamma22);
-                }
-                if (flags & CMSE_IMAGE2_X2_BIAS)
+                    return SquaredErrorBand(image1, image2, flags,
+                        (image1.height * band) / bands, (image1.height * (band + 1)) / bands, partial[band]);
+                });
+            if (FAILED(hr))
+                return hr;
+
+            // Bands are combined in order so the result does not depend on scheduling
+            for (size_t band = 0; band < bands; ++band)
+            {
+                acc = XMVectorAdd(acc, partial[band]);
+            }
+        }
+
+        // MSE = sum[ (I1 - I2)^2 ] / w*h
+        XMVECTOR d = XMVectorReplicate(float(image1.width * image1.height));
+        XMVECTOR v = XMVectorDivide(acc, d);
+        if (mseV)
+        {
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(mseV), v);
+            mse = mseV[0] + mseV[1] + mseV[2] + mseV[3];
+        }
+        else
+        {
+            XMFLOAT4 _mseV;
+            XMStoreFloat4(&_mseV, v);
+            mse = _mseV.x + _mseV.y + _mseV.z + _mseV.w;
+        }
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Image quality metrics
+    //
+    // SSIM sums each channel over 4x4 blocks, then evaluates 8x8 windows at a stride of 4
+    // from each 2x2 group of blocks. Bands are made of whole block rows, and each band also
+    // sums the block row above its first so windows that straddle bands are counted once.
+    // Rows and columns past the last whole block only contribute to the MSE.
+    //-------------------------------------------------------------------------------------
+    constexpr size_t SSIM_BLOCK = 4;
+
+    // Stabilizing constants (0.01 * L)^2 and (0.03 * L)^2 for a dynamic range of L = 1
+    const XMVECTORF32 g_SSIMC1 = { { { 0.0001f, 0.0001f, 0.0001f, 0.0001f } } };
+    const XMVECTORF32 g_SSIMC2 = { { { 0.0009f, 0.0009f, 0.0009f, 0.0009f } } };
+
+    // Sums are s1 = sum[x], s2 = sum[y], ss = sum[x^2 + y^2], and s12 = sum[x*y]
+    inline XMVECTOR ComputeSSIM(FXMVECTOR s1, FXMVECTOR s2, FXMVECTOR ss, GXMVECTOR s12, float count) noexcept
+    {
+        const XMVECTOR invN = XMVectorReplicate(1.f / count);
+
+        const XMVECTOR mu1 = XMVectorMultiply(s1, invN);
+        const XMVECTOR mu2 = XMVectorMultiply(s2, invN);
+        const XMVECTOR mu11 = XMVectorMultiply(mu1, mu1);
+        const XMVECTOR mu22 = XMVectorMultiply(mu2, mu2);
+        const XMVECTOR mu12 = XMVectorMultiply(mu1, mu2);
+
+        // sigma1^2 + sigma2^2 and sigma12
+        const XMVECTOR var = XMVectorSubtract(XMVectorMultiply(ss, invN), XMVectorAdd(mu11, mu22));
+        const XMVECTOR cov = XMVectorSubtract(XMVectorMultiply(s12, invN), mu12);
+
+        const XMVECTOR num = XMVectorMultiply(
+            XMVectorMultiplyAdd(g_XMTwo, mu12, g_SSIMC1),
+            XMVectorMultiplyAdd(g_XMTwo, cov, g_SSIMC2));
+        const XMVECTOR den = XMVectorMultiply(
+            XMVectorAdd(XMVectorAdd(mu11, mu22), g_SSIMC1),
+            XMVectorAdd(var, g_SSIMC2));
+
+        return XMVectorDivide(num, den);
+    }
+
+    struct MetricsPartial
+    {
+        XMVECTOR    sqerr;
+        XMVECTOR    ssim;
+        size_t      windows;
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Block rows r0 to r1 - 1 (plus any trailing rows when tail is set)
+    //-------------------------------------------------------------------------------------
+    HRESULT MetricsBand(
+        const Image& image1,
+        const Image& image2,
+        CMSE_FLAGS flags,
+        size_t r0,
+        size_t r1,
+        bool tail,
+        MetricsPartial& result) noexcept
+    {
+        const size_t width = image1.width;
+        const size_t blocksX = width / SSIM_BLOCK;
+
+        // Scanlines for one block row of each image, then block sums for the previous and current block row
+        auto scratch = make_AlignedArrayXMVECTOR(uint64_t(width) * SSIM_BLOCK * 2 + uint64_t(blocksX) * 8);
+        if (!scratch)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* rows1 = scratch.get();
+        XMVECTOR* rows2 = rows1 + width * SSIM_BLOCK;
+        XMVECTOR* prev = rows2 + width * SSIM_BLOCK;
+        XMVECTOR* curr = prev + blocksX * 4;
+
+        const bool srgb1 = (flags & CMSE_IMAGE1_SRGB) != 0;
+        const bool srgb2 = (flags & CMSE_IMAGE2_SRGB) != 0;
+        const bool bias1 = (flags & CMSE_IMAGE1_X2_BIAS) != 0;
+        const bool bias2 = (flags & CMSE_IMAGE2_X2_BIAS) != 0;
+
+        const XMVECTOR mask = GetChannelMask(flags);
+
+        XMVECTOR sqerr = g_XMZero;
+        XMVECTOR ssim = g_XMZero;
+        size_t windows = 0;
+
+        const size_t first = (r0 > 0) ? (r0 - 1) : 0;
+        for (size_t r = first; r < r1; ++r)
+        {
+            for (size_t k = 0; k < SSIM_BLOCK; ++k)
+            {
+                const size_t y = r * SSIM_BLOCK + k;
+                if (!LoadCompareScanline(rows1 + width * k, width, image1, y, srgb1, bias1)
+                    || !LoadCompareScanline(rows2 + width * k, width, image2, y, srgb2, bias2))
+                    return E_FAIL;
+            }
+
+            if (r >= r0)
+            {
+                for (size_t i = 0; i < width * SSIM_BLOCK; ++i)
                 {
-                    v2 = XMVectorMultiplyAdd(v2, two, g_XMNegativeOne);
+                    const XMVECTOR v = XMVectorAndInt(XMVectorSubtract(rows1[i], rows2[i]), mask);
+                    sqerr = XMVectorMultiplyAdd(v, v, sqerr);
                 }
+            }
 
-                // sum[ (I1 - I2)^2 ]
-                XMVECTOR v = XMVectorSubtract(v1, v2);
-                if (flags & CMSE_IGNORE_RED)
+            for (size_t bx = 0; bx < blocksX; ++bx)
+            {
+                XMVECTOR s1 = g_XMZero;
+                XMVECTOR s2 = g_XMZero;
+                XMVECTOR ss = g_XMZero;
+                XMVECTOR s12 = g_XMZero;
+
+                for (size_t k = 0; k < SSIM_BLOCK; ++k)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskX);
+                    const XMVECTOR* p1 = rows1 + width * k + bx * SSIM_BLOCK;
+                    const XMVECTOR* p2 = rows2 + width * k + bx * SSIM_BLOCK;
+                    for (size_t i = 0; i < SSIM_BLOCK; ++i)
+                    {
+                        s1 = XMVectorAdd(s1, p1[i]);
+                        s2 = XMVectorAdd(s2, p2[i]);
+                        ss = XMVectorMultiplyAdd(p1[i], p1[i], ss);
+                        ss = XMVectorMultiplyAdd(p2[i], p2[i], ss);
+                        s12 = XMVectorMultiplyAdd(p1[i], p2[i], s12);
+                    }
                 }
-                if (flags & CMSE_IGNORE_GREEN)
+
+                XMVECTOR* block = curr + bx * 4;
+                block[0] = s1;
+                block[1] = s2;
+                block[2] = ss;
+                block[3] = s12;
+            }
+
+            if (r > first)
+            {
+                for (size_t bx = 0; bx + 1 < blocksX; ++bx)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskY);
+                    const XMVECTOR* a = prev + bx * 4;
+                    const XMVECTOR* b = curr + bx * 4;
+
+                    XMVECTOR sums[4];
+                    for (size_t j = 0; j < 4; ++j)
+                    {
+                        sums[j] = XMVectorAdd(XMVectorAdd(a[j], a[j + 4]), XMVectorAdd(b[j], b[j + 4]));
+                    }
+
+                    ssim = XMVectorAdd(ssim, ComputeSSIM(sums[0], sums[1], sums[2], sums[3], float(SSIM_BLOCK * SSIM_BLOCK * 4)));
+                    ++windows;
                 }
-                if (flags & CMSE_IGNORE_BLUE)
+            }
+
+            std::swap(prev, curr);
+        }
+
+        if (tail)
+        {
+            for (size_t y = r1 * SSIM_BLOCK; y < image1.height; ++y)
+            {
+                if (!LoadCompareScanline(rows1, width, image1, y, srgb1, bias1)
+                    || !LoadCompareScanline(rows2, width, image2, y, srgb2, bias2))
+                    return E_FAIL;
+
+                for (size_t i = 0; i < width; ++i)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskZ);
+                    const XMVECTOR v = XMVectorAndInt(XMVectorSubtract(rows1[i], rows2[i]), mask);
+                    sqerr = XMVectorMultiplyAdd(v, v, sqerr);
                 }
-                if (flags & CMSE_IGNORE_ALPHA)
+            }
+        }
+
+        result.sqerr = sqerr;
+        result.ssim = ssim;
+        result.windows = windows;
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Images too small for two blocks in each direction use a single whole-image window
+    //-------------------------------------------------------------------------------------
+    HRESULT MetricsSmall(
+        const Image& image1,
+        const Image& image2,
+        CMSE_FLAGS flags,
+        MetricsPartial& result) noexcept
+    {
+        const size_t width = image1.width;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* ptr1 = scanline.get();
+        XMVECTOR* ptr2 = scanline.get() + width;
+
+        const XMVECTOR mask = GetChannelMask(flags);
+
+        XMVECTOR sqerr = g_XMZero;
+        XMVECTOR s1 = g_XMZero;
+        XMVECTOR s2 = g_XMZero;
+        XMVECTOR ss = g_XMZero;
+        XMVECTOR s12 = g_XMZero;
+
+        for (size_t h = 0; h < image1.height; ++h)
+        {
+            if (!LoadCompareScanline(ptr1, width, image1, h, (flags & CMSE_IMAGE1_SRGB) != 0, (flags & CMSE_IMAGE1_X2_BIAS) != 0)
+                || !LoadCompareScanline(ptr2, width, image2, h, (flags & CMSE_IMAGE2_SRGB) != 0, (flags & CMSE_IMAGE2_X2_BIAS) != 0))
+                return E_FAIL;
+
+            for (size_t i = 0; i < width; ++i)
+            {
+                const XMVECTOR v = XMVectorAndInt(XMVectorSubtract(ptr1[i], ptr2[i]), mask);
+                sqerr = XMVectorMultiplyAdd(v, v, sqerr);
+
+                s1 = XMVectorAdd(s1, ptr1[i]);
+                s2 = XMVectorAdd(s2, ptr2[i]);
+                ss = XMVectorMultiplyAdd(ptr1[i], ptr1[i], ss);
+                ss = XMVectorMultiplyAdd(ptr2[i], ptr2[i], ss);
+                s12 = XMVectorMultiplyAdd(ptr1[i], ptr2[i], s12);
+            }
+        }
+
+        result.sqerr = sqerr;
+        result.ssim = ComputeSSIM(s1, s2, ss, s12, float(width * image1.height));
+        result.windows = 1;
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    HRESULT ComputeImageMetrics_(
+        const Image& image1,
+        const Image& image2,
+        ImageMetrics& metrics,
+        CMSE_FLAGS flags) noexcept
+    {
+        if (!image1.pixels || !image2.pixels)
+            return E_POINTER;
+
+        assert(image1.width == image2.width && image1.height == image2.height);
+        assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
+
+        flags = GetImpliedFlags(image1, image2, flags);
+
+        const size_t blocksX = image1.width / SSIM_BLOCK;
+        const size_t blocksY = image1.height / SSIM_BLOCK;
+
+        XMVECTOR sqerr = g_XMZero;
+        XMVECTOR ssim = g_XMZero;
+        size_t windows = 0;
+
+        if (blocksX < 2 || blocksY < 2)
+        {
+            MetricsPartial result = {};
+            HRESULT hr = MetricsSmall(image1, image2, flags, result);
+            if (FAILED(hr))
+                return hr;
+
+            sqerr = result.sqerr;
+            ssim = result.ssim;
+            windows = result.windows;
+        }
+        else
+        {
+            const size_t bands = CountBands(flags, blocksY, image1.width * SSIM_BLOCK);
+
+            std::unique_ptr<MetricsPartial[]> partial(new (std::nothrow) MetricsPartial[bands]);
+            if (!partial)
+                return E_OUTOFMEMORY;
+
+            auto band = [&](size_t index) -> HRESULT
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskW);
-                }
+                    return MetricsBand(image1, image2, flags,
+                        (blocksY * index) / bands, (blocksY * (index + 1)) / bands, (index + 1) == bands, partial[index]);
+                };
 
-                acc = XMVectorMultiplyAdd(v, v, acc);
+            HRESULT hr = (bands > 1) ? _ParallelFor(bands, band) : band(0);
+            if (FAILED(hr))
+                return hr;
+
+            // Bands are combined in order so the result does not depend on scheduling
+            for (size_t index = 0; index < bands; ++index)
+            {
+                sqerr = XMVectorAdd(sqerr, partial[index].sqerr);
+                ssim = XMVectorAdd(ssim, partial[index].ssim);
+                windows += partial[index].windows;
             }
+        }
+
+        const XMVECTOR mse = XMVectorDivide(sqerr, XMVectorReplicate(float(image1.width * image1.height)));
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(metrics.mseV), mse);
+        metrics.mse = metrics.mseV[0] + metrics.mseV[1] + metrics.mseV[2] + metrics.mseV[3];
+
+        XMFLOAT4 ssimV;
+        XMStoreFloat4(&ssimV, XMVectorDivide(ssim, XMVectorReplicate(float(windows))));
+        metrics.ssimV[0] = ssimV.x;
+        metrics.ssimV[1] = ssimV.y;
+        metrics.ssimV[2] = ssimV.z;
+        metrics.ssimV[3] = ssimV.w;
+
+        // PSNR is infinite for identical channels
+        constexpr float inf = std::numeric_limits<float>::infinity();
 
-            pSrc1 += rowPitch1;
-            pSrc2 += rowPitch2;
+        const CMSE_FLAGS ignore[4] = { CMSE_IGNORE_RED, CMSE_IGNORE_GREEN, CMSE_IGNORE_BLUE, CMSE_IGNORE_ALPHA };
+
+        size_t channels = 0;
+        float ssimSum = 0.f;
+        for (size_t j = 0; j < 4; ++j)
+        {
+            metrics.psnrV[j] = (metrics.mseV[j] > 0.f) ? (10.f * log10f(1.f / metrics.mseV[j])) : inf;
+
+            if (flags & ignore[j])
+            {
+                metrics.ssimV[j] = 1.f;
+            }
+            else
+            {
+                ssimSum += metrics.ssimV[j];
+                ++channels;
+            }
         }
 
-        // MSE = sum[ (I1 - I2)^2 ] / w*h
-        XMVECTOR d = XMVectorReplicate(float(image1.width * image1.height));
-        XMVECTOR v = XMVectorDivide(acc, d);
-        if (mseV)
+        if (channels > 0)
         {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(mseV), v);
-            mse = mseV[0] + mseV[1] + mseV[2] + mseV[3];
+            const float meanMSE = metrics.mse / float(channels);
+            metrics.psnr = (meanMSE > 0.f) ? (10.f * log10f(1.f / meanMSE)) : inf;
+            metrics.ssim = ssimSum / float(channels);
         }
         else
         {
-            XMFLOAT4 _mseV;
-            XMStoreFloat4(&_mseV, v);
-            mse = _mseV.x + _mseV.y + _mseV.z + _mseV.w;
+            metrics.psnr = inf;
+            metrics.ssim = 1.f;
         }
 
         return S_OK;
@@ -467,6 +870,66 @@ HRESULT DirectX::ComputeMSE(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Computes MSE, PSNR, and SSIM between two images in a single pass
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ComputeImageMetrics(
+    const Image& image1,
+    const Image& image2,
+    ImageMetrics& metrics,
+    CMSE_FLAGS flags) noexcept
+{
+    metrics = {};
+
+    if (!image1.pixels || !image2.pixels)
+        return E_POINTER;
+
+    if (image1.width != image2.width || image1.height != image2.height)
+        return E_INVALIDARG;
+
+    if (!image1.width || !image1.height)
+        return E_INVALIDARG;
+
+    if (!IsValid(image1.format) || !IsValid(image2.format))
+        return E_INVALIDARG;
+
+    if (IsPlanar(image1.format) || IsPlanar(image2.format)
+        || IsPalettized(image1.format) || IsPalettized(image2.format)
+        || IsTypeless(image1.format) || IsTypeless(image2.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    // Compressed images are expanded to RGBA32F as for ComputeMSE
+    ScratchImage temp1;
+    const Image* img1 = &image1;
+    if (IsCompressed(image1.format))
+    {
+        HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, temp1);
+        if (FAILED(hr))
+            return hr;
+
+        img1 = temp1.GetImage(0, 0, 0);
+        if (!img1)
+            return E_POINTER;
+    }
+
+    ScratchImage temp2;
+    const Image* img2 = &image2;
+    if (IsCompressed(image2.format))
+    {
+        HRESULT hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, temp2);
+        if (FAILED(hr))
+            return hr;
+
+        img2 = temp2.GetImage(0, 0, 0);
+        if (!img2)
+            return E_POINTER;
+    }
+
+    return ComputeImageMetrics_(*img1, *img2, metrics, flags);
+}
+
+
 //-------------------------------------------------------------------------------------
 // Evaluates a user-supplied function for all the pixels in the image
 //-------------------------------------------------------------------------------------
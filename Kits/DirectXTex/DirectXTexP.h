@@ -123,19 +123,22 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <ctime>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <thread>
 #include <tuple>
 
 #ifndef WIN32
 #include <fstream>
 #include <filesystem>
-#include <thread>
 #endif
 
 #define _XM_NO_XMVECTOR_OVERLOADS_
@@ -398,6 +401,19 @@ namespace DirectX
         _Inout_updates_all_(count) XMVECTOR* pBuffer, _In_ size_t count,
         _In_ DXGI_FORMAT outFormat, _In_ DXGI_FORMAT inFormat, _In_ TEX_FILTER_FLAGS flags) noexcept;
 
+    //---------------------------------------------------------------------------------
+    // Resize helper functions
+    HRESULT __cdecl _ResizeSeparable(_In_ const Image& srcImage, _In_ TEX_FILTER_FLAGS filter, _In_ const Image& destImage) noexcept;
+        // Lanczos / Mitchell resampling of one image into another of the same format (TEX_FILTER_PARALLEL splits rows into bands)
+
+    //---------------------------------------------------------------------------------
+    // Multithreading helper functions
+    HRESULT __cdecl _ParallelFor(_In_ size_t count, _In_ const std::function<HRESULT __cdecl(size_t index)>& func) noexcept;
+        // Invokes func for every index in [0, count) using the work-stealing scheduler, stopping at the first failure
+
+    size_t __cdecl _GetParallelWorkerCount() noexcept;
+        // Number of workers _ParallelFor will use for a large enough count
+
     //---------------------------------------------------------------------------------
     // DDS helper functions
     HRESULT __cdecl _EncodeDDSHeader(
@@ -257,6 +257,37 @@ HRESULT DirectX::PremultiplyAlpha(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Converts to/from premultiplied alpha in place (each scanline is loaded before it is stored)
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::PremultiplyAlpha(
+    const Image& image,
+    TEX_PMALPHA_FLAGS flags) noexcept
+{
+    if (!image.pixels)
+        return E_POINTER;
+
+    if (IsCompressed(image.format)
+        || IsPlanar(image.format)
+        || IsPalettized(image.format)
+        || IsTypeless(image.format)
+        || !HasAlpha(image.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if ((image.width > UINT32_MAX) || (image.height > UINT32_MAX))
+        return E_INVALIDARG;
+
+    if (flags & TEX_PMALPHA_REVERSE)
+    {
+        return (flags & TEX_PMALPHA_IGNORE_SRGB) ? DemultiplyAlpha(image, image) : DemultiplyAlphaLinear(image, flags, image);
+    }
+    else
+    {
+        return (flags & TEX_PMALPHA_IGNORE_SRGB) ? PremultiplyAlpha_(image, image) : PremultiplyAlphaLinear(image, flags, image);
+    }
+}
+
 //-------------------------------------------------------------------------------------
 // Converts to/from a premultiplied alpha version of the texture (complex)
 //-------------------------------------------------------------------------------------
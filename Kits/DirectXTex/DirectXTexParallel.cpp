@@ -0,0 +1,289 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexParallel.cpp
+//
+// DirectX Texture Library - Multithreaded work scheduling
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+using namespace DirectX;
+
+namespace
+{
+    std::atomic<size_t> g_ThreadCount(0);
+
+    std::mutex g_ExecutorLock;
+    std::shared_ptr<ParallelExecutor> g_Executor;
+
+    //-------------------------------------------------------------------------------------
+    // Work-stealing range scheduler
+    //
+    // Each worker starts with an equal contiguous share of the work items packed into a
+    // single 64-bit word as [begin:32|end:32]. The owner pops items from the front, and
+    // once it runs dry it steals the back half of another worker's remaining range.
+    //-------------------------------------------------------------------------------------
+    constexpr uint64_t PackRange(uint32_t begin, uint32_t end) noexcept
+    {
+        return (uint64_t(begin) << 32) | uint64_t(end);
+    }
+
+    constexpr uint32_t RangeBegin(uint64_t range) noexcept { return static_cast<uint32_t>(range >> 32); }
+    constexpr uint32_t RangeEnd(uint64_t range) noexcept { return static_cast<uint32_t>(range & 0xFFFFFFFF); }
+
+    struct alignas(64) WorkRange
+    {
+        std::atomic<uint64_t> range;
+    };
+
+    class WorkStealingScheduler
+    {
+    public:
+        WorkStealingScheduler(size_t count, size_t workers, const std::function<HRESULT __cdecl(size_t)>& func) :
+            m_workers(workers),
+            m_ranges(new WorkRange[workers]),
+            m_func(func),
+            m_result(S_OK)
+        {
+            assert(count <= UINT32_MAX);
+            assert(workers > 0);
+
+            const size_t share = count / workers;
+            const size_t extra = count % workers;
+
+            size_t begin = 0;
+            for (size_t j = 0; j < workers; ++j)
+            {
+                const size_t end = begin + share + ((j < extra) ? 1u : 0u);
+                m_ranges[j].range.store(PackRange(static_cast<uint32_t>(begin), static_cast<uint32_t>(end)), std::memory_order_relaxed);
+                begin = end;
+            }
+        }
+
+        WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+        WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+        void Run(size_t worker) noexcept
+        {
+            if (worker >= m_workers)
+                return;
+
+            for (;;)
+            {
+                size_t index;
+                while (Pop(worker, index))
+                {
+                    if (FAILED(m_result.load(std::memory_order_relaxed)))
+                        return;
+
+                    HRESULT hr;
+                    try
+                    {
+                        hr = m_func(index);
+                    }
+                    catch (const std::bad_alloc&)
+                    {
+                        hr = E_OUTOFMEMORY;
+                    }
+                    catch (...)
+                    {
+                        hr = E_FAIL;
+                    }
+
+                    if (FAILED(hr))
+                    {
+                        HRESULT expected = S_OK;
+                        m_result.compare_exchange_strong(expected, hr);
+                        return;
+                    }
+                }
+
+                if (!Steal(worker))
+                    return;
+            }
+        }
+
+        HRESULT GetResult() const noexcept { return m_result.load(); }
+
+    private:
+        bool Pop(size_t worker, size_t& index) noexcept
+        {
+            auto& range = m_ranges[worker].range;
+            uint64_t current = range.load(std::memory_order_acquire);
+            for (;;)
+            {
+                const uint32_t begin = RangeBegin(current);
+                const uint32_t end = RangeEnd(current);
+                if (begin >= end)
+                    return false;
+
+                if (range.compare_exchange_weak(current, PackRange(begin + 1, end), std::memory_order_acq_rel))
+                {
+                    index = begin;
+                    return true;
+                }
+            }
+        }
+
+        bool Steal(size_t thief) noexcept
+        {
+            for (size_t k = 1; k < m_workers; ++k)
+            {
+                auto& victim = m_ranges[(thief + k) % m_workers].range;
+                uint64_t current = victim.load(std::memory_order_acquire);
+                for (;;)
+                {
+                    const uint32_t begin = RangeBegin(current);
+                    const uint32_t end = RangeEnd(current);
+                    if (begin >= end)
+                        break;
+
+                    // Victim keeps [begin, mid), thief takes [mid, end)
+                    const uint32_t mid = begin + (end - begin) / 2;
+                    if (victim.compare_exchange_weak(current, PackRange(begin, mid), std::memory_order_acq_rel))
+                    {
+                        // Thief's own range is empty, so nobody else can be updating it
+                        m_ranges[thief].range.store(PackRange(mid, end), std::memory_order_release);
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        size_t                                          m_workers;
+        std::unique_ptr<WorkRange[]>                    m_ranges;
+        const std::function<HRESULT __cdecl(size_t)>&   m_func;
+        std::atomic<HRESULT>                            m_result;
+    };
+
+    size_t EffectiveThreadCount() noexcept
+    {
+        size_t threads = g_ThreadCount.load();
+        if (!threads)
+        {
+            threads = std::thread::hardware_concurrency();
+        }
+        return std::max<size_t>(1, threads);
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+_Use_decl_annotations_
+void DirectX::SetParallelThreadCount(size_t threads) noexcept
+{
+    g_ThreadCount.store(threads);
+}
+
+size_t DirectX::GetParallelThreadCount() noexcept
+{
+    return g_ThreadCount.load();
+}
+
+_Use_decl_annotations_
+void DirectX::SetParallelExecutor(ParallelExecutor executor)
+{
+    std::shared_ptr<ParallelExecutor> ptr;
+    if (executor)
+    {
+        ptr = std::make_shared<ParallelExecutor>(std::move(executor));
+    }
+
+    std::lock_guard<std::mutex> lock(g_ExecutorLock);
+    g_Executor = std::move(ptr);
+}
+
+size_t DirectX::_GetParallelWorkerCount() noexcept
+{
+    return EffectiveThreadCount();
+}
+
+
+//-------------------------------------------------------------------------------------
+// Runs func(0) .. func(count - 1) across worker threads, stopping at the first failure
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::_ParallelFor(size_t count, const std::function<HRESULT __cdecl(size_t)>& func) noexcept
+{
+    if (!count)
+        return S_OK;
+
+    if (count > UINT32_MAX)
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+    const size_t workers = std::min(EffectiveThreadCount(), count);
+
+    std::shared_ptr<ParallelExecutor> executor;
+    {
+        std::lock_guard<std::mutex> lock(g_ExecutorLock);
+        executor = g_Executor;
+    }
+
+    try
+    {
+        if (workers <= 1)
+        {
+            for (size_t index = 0; index < count; ++index)
+            {
+                HRESULT hr = func(index);
+                if (FAILED(hr))
+                    return hr;
+            }
+            return S_OK;
+        }
+
+        WorkStealingScheduler scheduler(count, workers, func);
+
+        if (executor)
+        {
+            (*executor)(workers, [&](size_t worker) { scheduler.Run(worker); });
+        }
+        else
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(workers - 1);
+            try
+            {
+                for (size_t j = 1; j < workers; ++j)
+                {
+                    threads.emplace_back([&scheduler, j]() { scheduler.Run(j); });
+                }
+            }
+            catch (const std::exception&)
+            {
+                // Ranges owned by workers that failed to start are stolen by the others. Any failure to
+                // start a thread (system_error, bad_alloc) must land here, as the threads that did start
+                // are still joinable.
+            }
+
+            scheduler.Run(0);
+
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        }
+
+        // Sweep up anything left behind by an executor that did not run every worker
+        scheduler.Run(0);
+
+        return scheduler.GetResult();
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+    catch (...)
+    {
+        return E_FAIL;
+    }
+}
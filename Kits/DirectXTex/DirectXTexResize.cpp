@@ -235,6 +235,8 @@ namespace
             break;
 
         case TEX_FILTER_TRIANGLE:
+        case TEX_FILTER_LANCZOS:
+        case TEX_FILTER_MITCHELL:
             // WIC does not implement this filter
             return false;
         }
@@ -365,26 +367,43 @@ namespace
     }
 
 
-    //--- Linear Filter ---
-    HRESULT ResizeLinearFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    //--- Splits the destination rows into bands, filtered concurrently with TEX_FILTER_PARALLEL ---
+    HRESULT ResizeBands(
+        TEX_FILTER_FLAGS filter,
+        const Image& destImage,
+        const std::function<HRESULT __cdecl(size_t y0, size_t y1)>& func) noexcept
     {
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
+        // A few bands per worker for load balancing, but enough pixels to amortize the scanline allocation
+        constexpr size_t MIN_BAND_PIXELS = 16384;
 
-        // Allocate temporary space (3 scanlines, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 2 + destImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        size_t bands = 1;
+        if (filter & TEX_FILTER_PARALLEL)
+        {
+            bands = std::min(destImage.height, _GetParallelWorkerCount() * 4);
+            bands = std::min(bands, (destImage.width * destImage.height) / MIN_BAND_PIXELS);
+            bands = std::max<size_t>(1, bands);
+        }
 
-        std::unique_ptr<LinearFilter[]> lf(new (std::nothrow) LinearFilter[destImage.width + destImage.height]);
-        if (!lf)
-            return E_OUTOFMEMORY;
+        if (bands <= 1)
+            return func(0, destImage.height);
 
-        LinearFilter* lfX = lf.get();
-        LinearFilter* lfY = lf.get() + destImage.width;
+        // Every band computes its rows exactly as the serial filter does, so results are identical
+        return _ParallelFor(bands, [&](size_t band) -> HRESULT
+            {
+                return func((destImage.height * band) / bands, (destImage.height * (band + 1)) / bands);
+            });
+    }
 
-        _CreateLinearFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
-        _CreateLinearFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
+
+    //--- Linear Filter (rows y0 to y1 - 1) ---
+    HRESULT ResizeLinearBand(
+        const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        const LinearFilter* lfX, const LinearFilter* lfY, size_t y0, size_t y1) noexcept
+    {
+        // Allocate temporary space (3 scanlines)
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 2 + destImage.width);
+        if (!scanline)
+            return E_OUTOFMEMORY;
 
         XMVECTOR* target = scanline.get();
 
@@ -397,14 +416,14 @@ namespace
 #endif
 
         const uint8_t* pSrc = srcImage.pixels;
-        uint8_t* pDest = destImage.pixels;
+        uint8_t* pDest = destImage.pixels + destImage.rowPitch * y0;
 
         size_t rowPitch = srcImage.rowPitch;
 
         size_t u0 = size_t(-1);
         size_t u1 = size_t(-1);
 
-        for (size_t y = 0; y < destImage.height; ++y)
+        for (size_t y = y0; y < y1; ++y)
         {
             auto& toY = lfY[y];
 
@@ -450,27 +469,16 @@ namespace
     }
 
 
-    //--- Cubic Filter ---
-    HRESULT ResizeCubicFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    //--- Cubic Filter (rows y0 to y1 - 1) ---
+    HRESULT ResizeCubicBand(
+        const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        const CubicFilter* cfX, const CubicFilter* cfY, size_t y0, size_t y1) noexcept
     {
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
-
-        // Allocate temporary space (5 scanlines, plus X and Y filters)
+        // Allocate temporary space (5 scanlines)
         auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 4 + destImage.width);
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[destImage.width + destImage.height]);
-        if (!cf)
-            return E_OUTOFMEMORY;
-
-        CubicFilter* cfX = cf.get();
-        CubicFilter* cfY = cf.get() + destImage.width;
-
-        _CreateCubicFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
-        _CreateCubicFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
-
         XMVECTOR* target = scanline.get();
 
         XMVECTOR* row0 = target + destImage.width;
@@ -486,7 +494,7 @@ namespace
 #endif
 
         const uint8_t* pSrc = srcImage.pixels;
-        uint8_t* pDest = destImage.pixels;
+        uint8_t* pDest = destImage.pixels + destImage.rowPitch * y0;
 
         size_t rowPitch = srcImage.rowPitch;
 
@@ -495,7 +503,7 @@ namespace
         size_t u2 = size_t(-1);
         size_t u3 = size_t(-1);
 
-        for (size_t y = 0; y < destImage.height; ++y)
+        for (size_t y = y0; y < y1; ++y)
         {
             auto& toY = cfY[y];
 
@@ -609,6 +617,161 @@ namespace
     }
 
 
+    HRESULT ResizeLinearFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    {
+        assert(srcImage.pixels && destImage.pixels);
+        assert(srcImage.format == destImage.format);
+
+        // Allocate X and Y filters
+        std::unique_ptr<LinearFilter[]> lf(new (std::nothrow) LinearFilter[destImage.width + destImage.height]);
+        if (!lf)
+            return E_OUTOFMEMORY;
+
+        LinearFilter* lfX = lf.get();
+        LinearFilter* lfY = lf.get() + destImage.width;
+
+        _CreateLinearFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
+        _CreateLinearFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
+
+        return ResizeBands(filter, destImage, [&](size_t y0, size_t y1) -> HRESULT
+            {
+                return ResizeLinearBand(srcImage, filter, destImage, lfX, lfY, y0, y1);
+            });
+    }
+
+
+    HRESULT ResizeCubicFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    {
+        assert(srcImage.pixels && destImage.pixels);
+        assert(srcImage.format == destImage.format);
+
+        // Allocate X and Y filters
+        std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[destImage.width + destImage.height]);
+        if (!cf)
+            return E_OUTOFMEMORY;
+
+        CubicFilter* cfX = cf.get();
+        CubicFilter* cfY = cf.get() + destImage.width;
+
+        _CreateCubicFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
+        _CreateCubicFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
+
+        return ResizeBands(filter, destImage, [&](size_t y0, size_t y1) -> HRESULT
+            {
+                return ResizeCubicBand(srcImage, filter, destImage, cfX, cfY, y0, y1);
+            });
+    }
+
+
+    //--- Separable Lanczos / Mitchell Filter (rows y0 to y1 - 1) ---
+    HRESULT ResizeSeparableBand(
+        const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        const SeparableFilter::Filter& sfX, const SeparableFilter::Filter& sfY, size_t y0, size_t y1) noexcept
+    {
+        const size_t tapsX = sfX.taps;
+        const size_t tapsY = sfY.taps;
+
+        // Allocate temporary space (source scanline, target scanline, plus one horizontally filtered row per vertical tap)
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) + uint64_t(destImage.width) * (uint64_t(tapsY) + 1));
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        // Ring buffer of horizontally filtered rows keyed by unaddressed source position, so the
+        // 'taps' consecutive positions of a destination row always land in distinct slots
+        std::unique_ptr<ptrdiff_t[]> slotPos(new (std::nothrow) ptrdiff_t[tapsY]);
+        if (!slotPos)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* row = scanline.get();
+        XMVECTOR* target = row + srcImage.width;
+        XMVECTOR* slots = target + destImage.width;
+
+        for (size_t j = 0; j < tapsY; ++j)
+        {
+            slotPos[j] = PTRDIFF_MIN;
+        }
+
+        const uint8_t* pSrc = srcImage.pixels;
+        uint8_t* pDest = destImage.pixels + destImage.rowPitch * y0;
+
+        const size_t rowPitch = srcImage.rowPitch;
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            const size_t* indexY = sfY.index.get() + y * tapsY;
+            const float* weightY = sfY.weight.get() + y * tapsY;
+            const ptrdiff_t firstY = sfY.first[y];
+
+            // Slot of the first tap; the rest follow it around the ring
+            const size_t firstSlot = size_t(((firstY % ptrdiff_t(tapsY)) + ptrdiff_t(tapsY)) % ptrdiff_t(tapsY));
+
+            // Filter only the rows not still cached from the rows above
+            for (size_t k = 0; k < tapsY; ++k)
+            {
+                const ptrdiff_t pos = firstY + ptrdiff_t(k);
+                const size_t slot = (firstSlot + k) % tapsY;
+                if (slotPos[slot] == pos)
+                    continue;
+
+                slotPos[slot] = pos;
+
+                XMVECTOR* hrow = slots + slot * destImage.width;
+
+                // Clamped or mirrored edges repeat a source row, so copy the neighbouring tap's result
+                const size_t v = indexY[k];
+                if (k > 0 && indexY[k - 1] == v)
+                {
+                    memcpy(hrow, slots + ((firstSlot + k - 1) % tapsY) * destImage.width, sizeof(XMVECTOR) * destImage.width);
+                    continue;
+                }
+
+                if (!_LoadScanlineLinear(row, srcImage.width, pSrc + (rowPitch * v), rowPitch, srcImage.format, filter))
+                    return E_FAIL;
+
+                // Horizontal pass
+                for (size_t x = 0; x < destImage.width; ++x)
+                {
+                    const size_t* indexX = sfX.index.get() + x * tapsX;
+                    const float* weightX = sfX.weight.get() + x * tapsX;
+
+                    XMVECTOR acc = g_XMZero;
+                    for (size_t t = 0; t < tapsX; ++t)
+                    {
+                        acc = XMVectorMultiplyAdd(row[indexX[t]], XMVectorReplicate(weightX[t]), acc);
+                    }
+                    hrow[x] = acc;
+                }
+            }
+
+            // Vertical pass
+            {
+                const XMVECTOR w = XMVectorReplicate(weightY[0]);
+                const XMVECTOR* hrow = slots + firstSlot * destImage.width;
+                for (size_t x = 0; x < destImage.width; ++x)
+                {
+                    target[x] = XMVectorMultiply(hrow[x], w);
+                }
+            }
+
+            for (size_t k = 1; k < tapsY; ++k)
+            {
+                const XMVECTOR w = XMVectorReplicate(weightY[k]);
+                const XMVECTOR* hrow = slots + ((firstSlot + k) % tapsY) * destImage.width;
+                for (size_t x = 0; x < destImage.width; ++x)
+                {
+                    target[x] = XMVectorMultiplyAdd(hrow[x], w, target[x]);
+                }
+            }
+
+            if (!_StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
+                return E_FAIL;
+            pDest += destImage.rowPitch;
+        }
+
+        return S_OK;
+    }
+
+
     //--- Triangle Filter ---
     HRESULT ResizeTriangleFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
     {
@@ -822,6 +985,10 @@ namespace
         case TEX_FILTER_TRIANGLE:
             return ResizeTriangleFilter(srcImage, filter, destImage);
 
+        case TEX_FILTER_LANCZOS:
+        case TEX_FILTER_MITCHELL:
+            return _ResizeSeparable(srcImage, filter, destImage);
+
         default:
             return HRESULT_E_NOT_SUPPORTED;
         }
@@ -829,6 +996,47 @@ namespace
 }
 
 
+//-------------------------------------------------------------------------------------
+// Separable Lanczos / Mitchell resize
+//
+// The per-column and per-row weight tables are built once, then each band of output
+// rows filters the source rows it needs horizontally (keeping one cached row per
+// vertical tap) and combines them vertically.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::_ResizeSeparable(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+{
+    if (!srcImage.pixels || !destImage.pixels)
+        return E_POINTER;
+
+    assert(srcImage.format == destImage.format);
+
+    SeparableFilter::KERNEL kernel;
+    switch (filter & TEX_FILTER_MODE_MASK)
+    {
+    case TEX_FILTER_LANCZOS:    kernel = SeparableFilter::KERNEL_LANCZOS3; break;
+    case TEX_FILTER_MITCHELL:   kernel = SeparableFilter::KERNEL_MITCHELL; break;
+    default:                    return E_INVALIDARG;
+    }
+
+    SeparableFilter::Filter sfX, sfY;
+    HRESULT hr = SeparableFilter::_Create(srcImage.width, destImage.width,
+        (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, kernel, sfX);
+    if (FAILED(hr))
+        return hr;
+
+    hr = SeparableFilter::_Create(srcImage.height, destImage.height,
+        (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, kernel, sfY);
+    if (FAILED(hr))
+        return hr;
+
+    return ResizeBands(filter, destImage, [&](size_t y0, size_t y1) -> HRESULT
+        {
+            return ResizeSeparableBand(srcImage, filter, destImage, sfX, sfY, y0, y1);
+        });
+}
+
+
 //=====================================================================================
 // Entry-points
 //=====================================================================================
@@ -279,20 +279,68 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    // Uncompress pixel data from a TGA into the target image
+    // Alpha range of a literal packet (written as flat loops so they vectorize)
     //-------------------------------------------------------------------------------------
-    HRESULT UncompressPixels(
+    inline void ScanAlpha5551(
+        _In_reads_(count) const uint16_t* pPixels,
+        size_t count,
+        _Inout_ uint32_t& minalpha,
+        _Inout_ uint32_t& maxalpha) noexcept
+    {
+        uint32_t any = 0;
+        uint32_t all = 0x8000;
+        for (size_t j = 0; j < count; ++j)
+        {
+            any |= pPixels[j];
+            all &= pPixels[j];
+        }
+
+        if (any & 0x8000)
+            maxalpha = 255;
+        if (!(all & 0x8000))
+            minalpha = 0;
+    }
+
+    inline void ScanAlpha32(
+        _In_reads_bytes_(count * 4) const uint8_t* pSource,
+        size_t count,
+        _Inout_ uint32_t& minalpha,
+        _Inout_ uint32_t& maxalpha) noexcept
+    {
+        uint32_t lo = minalpha;
+        uint32_t hi = maxalpha;
+        for (size_t j = 0; j < count; ++j)
+        {
+            const uint32_t alpha = pSource[j * 4 + 3];
+            lo = std::min(lo, alpha);
+            hi = std::max(hi, alpha);
+        }
+
+        minalpha = lo;
+        maxalpha = hi;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Uncompress scanlines [y0, y1) of RLE pixel data from a TGA into the target image
+    //-------------------------------------------------------------------------------------
+    HRESULT UncompressScanlines(
         _In_reads_bytes_(size) const void* pSource,
         size_t size,
-        TGA_FLAGS flags,
         _In_ const Image* image,
-        _In_ uint32_t convFlags) noexcept
+        _In_ uint32_t convFlags,
+        size_t y0,
+        size_t y1,
+        _Inout_ uint32_t& minalpha,
+        _Inout_ uint32_t& maxalpha) noexcept
     {
         assert(pSource && size > 0);
 
         if (!image || !image->pixels)
             return E_POINTER;
 
+        assert(y0 <= y1 && y1 <= image->height);
+
         // Compute TGA image data pitch
         size_t rowPitch, slicePitch;
         HRESULT hr = ComputePitch(image->format, image->width, image->height, rowPitch, slicePitch,
@@ -303,13 +351,11 @@ namespace
         auto sPtr = static_cast<const uint8_t*>(pSource);
         const uint8_t* endPtr = sPtr + size;
 
-        bool opaquealpha = false;
-
         switch (image->format)
         {
         //--------------------------------------------------------------------------- 8-bit
         case DXGI_FORMAT_R8_UNORM:
-            for (size_t y = 0; y < image->height; ++y)
+            for (size_t y = y0; y < y1; ++y)
             {
                 size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
                 assert(offset < rowPitch);
@@ -330,6 +376,17 @@ namespace
                         if (++sPtr >= endPtr)
                             return E_FAIL;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            memset(dPtr, *sPtr, j);
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -354,6 +411,18 @@ namespace
                         if (sPtr + j > endPtr)
                             return E_FAIL;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            memcpy(dPtr, sPtr, j);
+                            sPtr += j;
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -374,10 +443,7 @@ namespace
         //-------------------------------------------------------------------------- 16-bit
         case DXGI_FORMAT_B5G5R5A1_UNORM:
         {
-            uint32_t minalpha = 255;
-            uint32_t maxalpha = 0;
-
-            for (size_t y = 0; y < image->height; ++y)
+            for (size_t y = y0; y < y1; ++y)
             {
                 size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
                 assert(offset * 2 < rowPitch);
@@ -408,6 +474,17 @@ namespace
 
                         sPtr += 2;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            std::fill_n(dPtr, j, t);
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -430,6 +507,19 @@ namespace
                         if (sPtr + (j * 2) > endPtr)
                             return E_FAIL;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            memcpy(dPtr, sPtr, j * 2);
+                            ScanAlpha5551(dPtr, j, minalpha, maxalpha);
+                            sPtr += j * 2;
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -452,29 +542,13 @@ namespace
                     }
                 }
             }
-
-            // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-            if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-            {
-                opaquealpha = true;
-                hr = SetAlphaChannelToOpaque(image);
-                if (FAILED(hr))
-                    return hr;
-            }
-            else if (minalpha == 255)
-            {
-                opaquealpha = true;
-            }
         }
         break;
 
         //------------------------------------------------------ 24/32-bit (with swizzling)
         case DXGI_FORMAT_R8G8B8A8_UNORM:
         {
-            uint32_t minalpha = 255;
-            uint32_t maxalpha = 0;
-
-            for (size_t y = 0; y < image->height; ++y)
+            for (size_t y = y0; y < y1; ++y)
             {
                 size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
 
@@ -524,6 +598,17 @@ namespace
                             sPtr += 4;
                         }
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            std::fill_n(dPtr, j, t);
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -552,6 +637,20 @@ namespace
                         {
                             if (sPtr + (j * 4) > endPtr)
                                 return E_FAIL;
+
+                            if (!(convFlags & CONV_FLAGS_INVERTX))
+                            {
+                                if (x + j > image->width)
+                                    return E_FAIL;
+
+                                // BGRA -> RGBA
+                                _SwizzleScanline(dPtr, j * 4, sPtr, j * 4, DXGI_FORMAT_R8G8B8A8_UNORM, TEXP_SCANLINE_NONE);
+                                ScanAlpha32(sPtr, j, minalpha, maxalpha);
+                                sPtr += j * 4;
+                                dPtr += j;
+                                x += j;
+                                j = 0;
+                            }
                         }
 
                         for (; j > 0; --j, ++x)
@@ -597,19 +696,6 @@ namespace
                     }
                 }
             }
-
-            // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-            if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-            {
-                opaquealpha = true;
-                hr = SetAlphaChannelToOpaque(image);
-                if (FAILED(hr))
-                    return hr;
-            }
-            else if (minalpha == 255)
-            {
-                opaquealpha = true;
-            }
         }
         break;
 
@@ -618,10 +704,7 @@ namespace
         {
             assert((convFlags & CONV_FLAGS_EXPAND) == 0);
 
-            uint32_t minalpha = 255;
-            uint32_t maxalpha = 0;
-
-            for (size_t y = 0; y < image->height; ++y)
+            for (size_t y = y0; y < y1; ++y)
             {
                 size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
 
@@ -654,6 +737,17 @@ namespace
 
                         sPtr += 4;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            std::fill_n(dPtr, j, t);
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -676,6 +770,19 @@ namespace
                         if (sPtr + (j * 4) > endPtr)
                             return E_FAIL;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            memcpy(dPtr, sPtr, j * 4);
+                            ScanAlpha32(sPtr, j, minalpha, maxalpha);
+                            sPtr += j * 4;
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -702,19 +809,6 @@ namespace
                     }
                 }
             }
-
-            // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-            if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-            {
-                opaquealpha = true;
-                hr = SetAlphaChannelToOpaque(image);
-                if (FAILED(hr))
-                    return hr;
-            }
-            else if (minalpha == 255)
-            {
-                opaquealpha = true;
-            }
         }
         break;
 
@@ -723,7 +817,7 @@ namespace
         {
             assert((convFlags & CONV_FLAGS_EXPAND) != 0);
 
-            for (size_t y = 0; y < image->height; ++y)
+            for (size_t y = y0; y < y1; ++y)
             {
                 size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
 
@@ -750,6 +844,17 @@ namespace
                         uint32_t t = uint32_t(*sPtr) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2) << 16);
                         sPtr += 3;
 
+                        if (!(convFlags & CONV_FLAGS_INVERTX))
+                        {
+                            if (x + j > image->width)
+                                return E_FAIL;
+
+                            std::fill_n(dPtr, j, t);
+                            dPtr += j;
+                            x += j;
+                            j = 0;
+                        }
+
                         for (; j > 0; --j, ++x)
                         {
                             if (x >= image->width)
@@ -801,7 +906,158 @@ namespace
             return E_FAIL;
         }
 
-        return opaquealpha ? S_FALSE : S_OK;
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Finds where each RLE scanline starts (the decoder rejects packets that span scanlines)
+    //-------------------------------------------------------------------------------------
+    HRESULT IndexScanlines(
+        _In_reads_bytes_(size) const uint8_t* pSource,
+        size_t size,
+        size_t width,
+        size_t height,
+        size_t bpp,
+        _Out_writes_(height + 1) size_t* offsets) noexcept
+    {
+        const uint8_t* sPtr = pSource;
+        const uint8_t* endPtr = pSource + size;
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            offsets[y] = size_t(sPtr - pSource);
+
+            for (size_t x = 0; x < width; )
+            {
+                if (sPtr >= endPtr)
+                    return E_FAIL;
+
+                const size_t j = size_t(*sPtr & 0x7F) + 1;
+                const size_t bytes = (*sPtr & 0x80) ? bpp : (j * bpp);
+                ++sPtr;
+
+                if (x + j > width || bytes > size_t(endPtr - sPtr))
+                    return E_FAIL;
+
+                sPtr += bytes;
+                x += j;
+            }
+        }
+
+        offsets[height] = size_t(sPtr - pSource);
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Uncompress pixel data from a TGA into the target image
+    //-------------------------------------------------------------------------------------
+    HRESULT UncompressPixels(
+        _In_reads_bytes_(size) const void* pSource,
+        size_t size,
+        TGA_FLAGS flags,
+        _In_ const Image* image,
+        _In_ uint32_t convFlags) noexcept
+    {
+        assert(pSource && size > 0);
+
+        if (!image || !image->pixels)
+            return E_POINTER;
+
+        // A few bands per worker for load balancing, but enough pixels to amortize the index pass
+        constexpr size_t MIN_BAND_PIXELS = 16384;
+
+        size_t bands = 1;
+        if (flags & TGA_FLAGS_PARALLEL)
+        {
+            bands = std::min(image->height, _GetParallelWorkerCount() * 4);
+            bands = std::min(bands, (image->width * image->height) / MIN_BAND_PIXELS);
+            bands = std::max<size_t>(1, bands);
+        }
+
+        uint32_t minalpha = 255;
+        uint32_t maxalpha = 0;
+
+        if (bands <= 1)
+        {
+            HRESULT hr = UncompressScanlines(pSource, size, image, convFlags, 0, image->height, minalpha, maxalpha);
+            if (FAILED(hr))
+                return hr;
+        }
+        else
+        {
+            size_t bpp;
+            switch (image->format)
+            {
+            case DXGI_FORMAT_R8_UNORM:          bpp = 1; break;
+            case DXGI_FORMAT_B5G5R5A1_UNORM:    bpp = 2; break;
+            case DXGI_FORMAT_R8G8B8A8_UNORM:    bpp = (convFlags & CONV_FLAGS_EXPAND) ? 3 : 4; break;
+            case DXGI_FORMAT_B8G8R8A8_UNORM:    bpp = 4; break;
+            case DXGI_FORMAT_B8G8R8X8_UNORM:    bpp = 3; break;
+            default:
+                return E_FAIL;
+            }
+
+            // First pass walks only the packet headers, then bands of scanlines decode concurrently
+            std::unique_ptr<size_t[]> offsets(new (std::nothrow) size_t[image->height + 1]);
+            std::unique_ptr<uint32_t[]> alpha(new (std::nothrow) uint32_t[bands * 2]);
+            if (!offsets || !alpha)
+                return E_OUTOFMEMORY;
+
+            auto sPtr = static_cast<const uint8_t*>(pSource);
+
+            HRESULT hr = IndexScanlines(sPtr, size, image->width, image->height, bpp, offsets.get());
+            if (FAILED(hr))
+                return hr;
+
+            hr = _ParallelFor(bands, [&](size_t band) -> HRESULT
+                {
+                    const size_t y0 = (image->height * band) / bands;
+                    const size_t y1 = (image->height * (band + 1)) / bands;
+
+                    uint32_t* range = &alpha[band * 2];
+                    range[0] = 255;
+                    range[1] = 0;
+
+                    return UncompressScanlines(sPtr + offsets[y0], offsets[y1] - offsets[y0],
+                        image, convFlags, y0, y1, range[0], range[1]);
+                });
+            if (FAILED(hr))
+                return hr;
+
+            for (size_t band = 0; band < bands; ++band)
+            {
+                minalpha = std::min(minalpha, alpha[band * 2]);
+                maxalpha = std::max(maxalpha, alpha[band * 2 + 1]);
+            }
+        }
+
+        switch (image->format)
+        {
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
+            if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
+            {
+                HRESULT hr = SetAlphaChannelToOpaque(image);
+                if (FAILED(hr))
+                    return hr;
+
+                return S_FALSE;
+            }
+            else if (minalpha == 255)
+            {
+                return S_FALSE;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        return S_OK;
     }
 
 
@@ -81,6 +81,28 @@ namespace Xbox
         uint8_t*                memory;
     };
 
+    //---------------------------------------------------------------------------------
+    // Tiling address computation
+
+    class ITileAddressComputer
+    {
+    public:
+        virtual ~ITileAddressComputer() = default;
+
+        // Byte offset from the start of the resource for element (x,y) of a mip level in the
+        // given array item (or volume slice), or size_t(-1) if the element is out of range
+        virtual size_t __cdecl GetElementOffsetBytes(uint32_t level, uint64_t x, uint32_t y, uint32_t zOrItem) = 0;
+    };
+
+    enum XBOX_TILE_FLAGS : uint32_t
+    {
+        XBOX_TILE_DEFAULT = 0,
+
+        XBOX_TILE_BY_ELEMENT = 0x1,
+            // Queries the address computer for every element (reference path) rather than
+            // copying whole micro-tiles using a precomputed address pattern
+    };
+
     //---------------------------------------------------------------------------------
     // Image I/O
 
@@ -103,12 +125,26 @@ namespace Xbox
     //---------------------------------------------------------------------------------
     // Xbox One Texture Tiling / Detiling (requires XG DLL to be present at runtime)
 
-    HRESULT Tile(_In_ const DirectX::Image& srcImage, _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid);
+    HRESULT Tile(
+        _In_ const DirectX::Image& srcImage, _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid,
+        _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_DEFAULT);
+    HRESULT Tile(
+        _In_ const DirectX::Image* srcImages, _In_ size_t nimages, _In_ const DirectX::TexMetadata& metadata,
+        _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid,
+        _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_DEFAULT);
+
+    HRESULT Detile(_In_ const XboxImage& xbox, _Out_ DirectX::ScratchImage& image, _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_DEFAULT);
+
+    // Tiling / detiling with a caller-provided address computer and layout (does not call into the XG DLL)
+    //   The xbox image must already be initialized to match layout
     HRESULT Tile(
         _In_ const DirectX::Image* srcImages, _In_ size_t nimages, _In_ const DirectX::TexMetadata& metadata,
-        _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid);
+        _In_ ITileAddressComputer* computer, _In_ const XG_RESOURCE_LAYOUT& layout,
+        _Inout_ XboxImage& xbox, _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_DEFAULT);
 
-    HRESULT Detile(_In_ const XboxImage& xbox, _Out_ DirectX::ScratchImage& image);
+    HRESULT Detile(
+        _In_ const XboxImage& xbox, _In_ ITileAddressComputer* computer, _In_ const XG_RESOURCE_LAYOUT& layout,
+        _Out_ DirectX::ScratchImage& image, _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_DEFAULT);
 
     //---------------------------------------------------------------------------------
     // Direct3D 11.X functions
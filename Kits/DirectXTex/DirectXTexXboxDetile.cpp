@@ -8,7 +8,7 @@
 //--------------------------------------------------------------------------------------
 
 #include "DirectXTexP.h"
-#include "DirectXTexXbox.h"
+#include "DirectXTexXboxP.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -20,17 +20,23 @@ namespace
     inline HRESULT DetileByElement1D(
         const XboxImage& xbox,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         _In_reads_(nimages) const Image** result,
         size_t nimages,
         size_t bpp,
         size_t w,
-        bool packed)
+        bool packed,
+        XBOX_TILE_FLAGS flags)
     {
         const uint8_t* sptr = xbox.GetPointer();
         const uint8_t* endPtr = sptr + layout.SizeBytes;
 
+        // Packed formats hold two pixels per element, so they always use the per-element path
+        TilePattern pattern;
+        const bool initialized = !packed && !(flags & XBOX_TILE_BY_ELEMENT)
+            && pattern.Initialize(computer, level, w, 1, bpp);
+
         for (uint32_t item = 0; item < nimages; ++item)
         {
             const Image* img = result[item];
@@ -42,16 +48,25 @@ namespace
             assert(img->rowPitch == result[0]->rowPitch);
             assert(img->format == result[0]->format);
 
+            if (initialized && pattern.Rebase(computer, item))
+            {
+                HRESULT hr = pattern.CopyFromTiled(sptr, endPtr, img->pixels, img->rowPitch);
+                if (FAILED(hr))
+                    return hr;
+
+                continue;
+            }
+
             uint8_t* dptr = img->pixels;
 
             for (size_t x = 0; x < w; ++x)
             {
 #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
                 UINT64 element = (packed) ? (x >> 1) : x;
-                size_t offset = computer->GetTexelElementOffsetBytes(0, level, element, 0, item, 0, nullptr);
 #else
-                size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, 0, item, 0);
+                UINT64 element = x;
 #endif
+                size_t offset = computer->GetElementOffsetBytes(level, element, 0, item);
                 if (offset == size_t(-1))
                     return E_FAIL;
 
@@ -75,18 +90,24 @@ namespace
     inline HRESULT DetileByElement2D(
         const XboxImage& xbox,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         _In_reads_(nimages) const Image** result,
         size_t nimages,
         size_t bpp,
         size_t w,
         size_t h,
-        bool packed)
+        bool packed,
+        XBOX_TILE_FLAGS flags)
     {
         const uint8_t* sptr = xbox.GetPointer();
         const uint8_t* endPtr = sptr + layout.SizeBytes;
 
+        // Packed formats hold two pixels per element, so they always use the per-element path
+        TilePattern pattern;
+        const bool initialized = !packed && !(flags & XBOX_TILE_BY_ELEMENT)
+            && pattern.Initialize(computer, level, w, h, bpp);
+
         for (uint32_t item = 0; item < nimages; ++item)
         {
             const Image* img = result[item];
@@ -98,6 +119,15 @@ namespace
             assert(img->rowPitch == result[0]->rowPitch);
             assert(img->format == result[0]->format);
 
+            if (initialized && pattern.Rebase(computer, item))
+            {
+                HRESULT hr = pattern.CopyFromTiled(sptr, endPtr, img->pixels, img->rowPitch);
+                if (FAILED(hr))
+                    return hr;
+
+                continue;
+            }
+
             uint8_t* dptr = img->pixels;
 
             for (uint32_t y = 0; y < h; ++y)
@@ -108,10 +138,10 @@ namespace
                 {
 #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
                     UINT64 element = (packed) ? (x >> 1) : x;
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, element, y, item, 0, nullptr);
 #else
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, item, 0);
+                    UINT64 element = x;
 #endif
+                    size_t offset = computer->GetElementOffsetBytes(level, element, y, item);
                     if (offset == size_t(-1))
                         return E_FAIL;
 
@@ -139,21 +169,37 @@ namespace
         const XboxImage& xbox,
         uint32_t level,
         uint32_t slices,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         const Image& result,
         size_t bpp,
         size_t w,
         size_t h,
-        bool packed)
+        bool packed,
+        XBOX_TILE_FLAGS flags)
     {
         const uint8_t* sptr = xbox.GetPointer();
         const uint8_t* endPtr = sptr + layout.SizeBytes;
 
+        // Packed formats hold two pixels per element, and thick layouts have no 2D pattern, so both use the per-element path
+        TilePattern pattern;
+        const bool initialized = !packed && !(flags & XBOX_TILE_BY_ELEMENT)
+            && pattern.Initialize(computer, level, w, h, bpp);
+
         uint8_t* dptr = result.pixels;
 
         for (uint32_t z = 0; z < slices; ++z)
         {
+            if (initialized && pattern.Rebase(computer, z))
+            {
+                HRESULT hr = pattern.CopyFromTiled(sptr, endPtr, dptr, result.rowPitch);
+                if (FAILED(hr))
+                    return hr;
+
+                dptr += result.slicePitch;
+                continue;
+            }
+
             uint8_t* rptr = dptr;
 
             for (uint32_t y = 0; y < h; ++y)
@@ -164,10 +210,10 @@ namespace
                 {
 #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
                     UINT64 element = (packed) ? (x >> 1) : x;
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, element, y, z, 0, nullptr);
 #else
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, z, 0);
+                    UINT64 element = x;
 #endif
+                    size_t offset = computer->GetElementOffsetBytes(level, element, y, z);
                     if (offset == size_t(-1))
                         return E_FAIL;
 
@@ -198,10 +244,11 @@ namespace
     HRESULT Detile1D(
         const XboxImage& xbox,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         _In_reads_(nimages) const Image** result,
-        size_t nimages)
+        size_t nimages,
+        XBOX_TILE_FLAGS flags)
     {
         if (!nimages)
             return E_INVALIDARG;
@@ -232,7 +279,7 @@ namespace
             size_t w = result[0]->width;
             assert(((w + 1) / 2) == layout.Plane[0].MipLayout[level].WidthElements);
 
-            return DetileByElement1D(xbox, level, computer, layout, result, nimages, bpp, w, true);
+            return DetileByElement1D(xbox, level, computer, layout, result, nimages, bpp, w, true, flags);
         }
         else if (byelement)
         {
@@ -243,7 +290,7 @@ namespace
             size_t w = result[0]->width;
             assert(w == layout.Plane[0].MipLayout[level].WidthElements);
 
-            return DetileByElement1D(xbox, level, computer, layout, result, nimages, bpp, w, false);
+            return DetileByElement1D(xbox, level, computer, layout, result, nimages, bpp, w, false, flags);
         }
         else
         {
@@ -269,6 +316,10 @@ namespace
             if (!_LoadScanline(tiled, tiledPixels, xbox.GetPointer() + mip.OffsetBytes, mip.SizeBytes, xbox.GetMetadata().format))
                 return E_FAIL;
 
+            TilePattern pattern;
+            const bool initialized = !(flags & XBOX_TILE_BY_ELEMENT)
+                && pattern.Initialize(computer, level, result[0]->width, result[0]->height, layout.Plane[0].BytesPerElement);
+
             // Perform detiling
             for (uint32_t item = 0; item < nimages; ++item)
             {
@@ -281,13 +332,11 @@ namespace
                 assert(img->rowPitch == result[0]->rowPitch);
                 assert(img->format == result[0]->format);
 
+                const bool usePattern = initialized && pattern.Rebase(computer, item);
+
                 for (size_t x = 0; x < img->width; ++x)
                 {
-#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, 0, item, 0, nullptr);
-#else
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, 0, item, 0);
-#endif
+                    size_t offset = (usePattern) ? pattern.GetOffset(x, 0) : computer->GetElementOffsetBytes(level, x, 0, item);
                     if (offset == size_t(-1))
                         return E_FAIL;
 
@@ -315,10 +364,11 @@ namespace
     HRESULT Detile2D(
         const XboxImage& xbox,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         _In_reads_(nimages) const Image** result,
-        size_t nimages)
+        size_t nimages,
+        XBOX_TILE_FLAGS flags)
     {
         if (!nimages)
             return E_INVALIDARG;
@@ -357,7 +407,7 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
-            return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpb, nbw, nbh, false);
+            return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpb, nbw, nbh, false, flags);
         }
         else if (IsPacked(format))
         {
@@ -370,7 +420,7 @@ namespace
             assert(((w + 1) / 2) == layout.Plane[0].MipLayout[level].WidthElements);
             assert(h == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpp, w, h, true);
+            return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpp, w, h, true, flags);
         }
         else if (byelement)
         {
@@ -384,7 +434,7 @@ namespace
             assert(w == layout.Plane[0].MipLayout[level].WidthElements);
             assert(h == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpp, w, h, false);
+            return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpp, w, h, false, flags);
         }
         else
         {
@@ -410,6 +460,10 @@ namespace
             if (!_LoadScanline(tiled, tiledPixels, xbox.GetPointer() + mip.OffsetBytes, mip.SizeBytes, xbox.GetMetadata().format))
                 return E_FAIL;
 
+            TilePattern pattern;
+            const bool initialized = !(flags & XBOX_TILE_BY_ELEMENT)
+                && pattern.Initialize(computer, level, result[0]->width, result[0]->height, layout.Plane[0].BytesPerElement);
+
             // Perform detiling
             for (uint32_t item = 0; item < nimages; ++item)
             {
@@ -422,16 +476,14 @@ namespace
                 assert(img->rowPitch == result[0]->rowPitch);
                 assert(img->format == result[0]->format);
 
+                const bool usePattern = initialized && pattern.Rebase(computer, item);
+
                 auto dptr = reinterpret_cast<uint8_t * __restrict>(img->pixels);
                 for (uint32_t y = 0; y < img->height; ++y)
                 {
                     for (size_t x = 0; x < img->width; ++x)
                     {
-#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, item, 0, nullptr);
-#else
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, item, 0);
-#endif
+                        size_t offset = (usePattern) ? pattern.GetOffset(x, y) : computer->GetElementOffsetBytes(level, x, y, item);
                         if (offset == size_t(-1))
                             return E_FAIL;
 
@@ -463,9 +515,10 @@ namespace
         const XboxImage& xbox,
         uint32_t level,
         uint32_t slices,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const Image& result)
+        const Image& result,
+        XBOX_TILE_FLAGS flags)
     {
         if (!computer || !xbox.GetPointer() || !result.pixels)
             return E_POINTER;
@@ -496,7 +549,7 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
-            return DetileByElement3D(xbox, level, slices, computer, layout, result, bpb, nbw, nbh, false);
+            return DetileByElement3D(xbox, level, slices, computer, layout, result, bpb, nbw, nbh, false, flags);
         }
         else if (IsPacked(result.format))
         {
@@ -507,7 +560,7 @@ namespace
             assert(((result.width + 1) / 2) == layout.Plane[0].MipLayout[level].WidthElements);
             assert(result.height == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return DetileByElement3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, true);
+            return DetileByElement3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, true, flags);
         }
         else if (byelement)
         {
@@ -518,7 +571,7 @@ namespace
             assert(result.width == layout.Plane[0].MipLayout[level].WidthElements);
             assert(result.height == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return DetileByElement3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, false);
+            return DetileByElement3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, false, flags);
         }
         else
         {
@@ -566,21 +619,23 @@ namespace
                 tptr += size_t(mip.PaddedHeightElements) * size_t(mip.PaddedWidthElements);
             }
 
+            TilePattern pattern;
+            const bool initialized = !(flags & XBOX_TILE_BY_ELEMENT)
+                && pattern.Initialize(computer, level, result.width, result.height, layout.Plane[0].BytesPerElement);
+
             // Perform detiling
             uint8_t* dptr = reinterpret_cast<uint8_t*>(result.pixels);
             for (uint32_t z = 0; z < slices; ++z)
             {
+                const bool usePattern = initialized && pattern.Rebase(computer, z);
+
                 uint8_t* rptr = dptr;
 
                 for (uint32_t y = 0; y < result.height; ++y)
                 {
                     for (size_t x = 0; x < result.width; ++x)
                     {
-#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, z, 0, nullptr);
-#else
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, z, 0);
-#endif
+                        size_t offset = (usePattern) ? pattern.GetOffset(x, y) : computer->GetElementOffsetBytes(level, x, y, z);
                         if (offset == size_t(-1))
                             return E_FAIL;
 
@@ -605,6 +660,74 @@ namespace
 
         return S_OK;
     }
+
+
+    //-------------------------------------------------------------------------------------
+    // Detiles all mip levels and array items into an initialized scratch image
+    //-------------------------------------------------------------------------------------
+    HRESULT DetileLevels(
+        const XboxImage& xbox,
+        _In_ ITileAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        const ScratchImage& image,
+        XBOX_TILE_FLAGS flags)
+    {
+        auto& metadata = xbox.GetMetadata();
+
+        switch (metadata.dimension)
+        {
+        case TEX_DIMENSION_TEXTURE1D:
+        case TEX_DIMENSION_TEXTURE2D:
+            for (uint32_t level = 0; level < metadata.mipLevels; ++level)
+            {
+                std::vector<const Image*> images;
+                images.reserve(metadata.arraySize);
+                for (uint32_t item = 0; item < metadata.arraySize; ++item)
+                {
+                    const Image* img = image.GetImage(level, item, 0);
+                    if (!img)
+                        return E_FAIL;
+
+                    images.push_back(img);
+                }
+
+                HRESULT hr = (metadata.dimension == TEX_DIMENSION_TEXTURE1D)
+                    ? Detile1D(xbox, level, computer, layout, &images[0], images.size(), flags)
+                    : Detile2D(xbox, level, computer, layout, &images[0], images.size(), flags);
+                if (FAILED(hr))
+                    return hr;
+            }
+            break;
+
+        case TEX_DIMENSION_TEXTURE3D:
+            {
+                uint32_t d = static_cast<uint32_t>(metadata.depth);
+
+                size_t index = 0;
+                for (uint32_t level = 0; level < metadata.mipLevels; ++level)
+                {
+                    if ((index + d) > image.GetImageCount())
+                        return E_FAIL;
+
+                    // Relies on the fact that slices are contiguous
+                    HRESULT hr = Detile3D(xbox, level, d, computer, layout, image.GetImages()[index], flags);
+                    if (FAILED(hr))
+                        return hr;
+
+                    index += d;
+
+                    if (d > 1)
+                        d >>= 1;
+                }
+            }
+            break;
+
+        default:
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
 }
 
 //=====================================================================================
@@ -617,7 +740,8 @@ namespace
 _Use_decl_annotations_
 HRESULT Xbox::Detile(
     const XboxImage& xbox,
-    DirectX::ScratchImage& image)
+    DirectX::ScratchImage& image,
+    XBOX_TILE_FLAGS flags)
 {
     if (!xbox.GetSize() || !xbox.GetPointer() || xbox.GetTileMode() == c_XboxTileModeInvalid)
         return E_INVALIDARG;
@@ -645,6 +769,7 @@ HRESULT Xbox::Detile(
     }
 
     XG_RESOURCE_LAYOUT layout = {};
+    ComPtr<XGTextureAddressComputer> computer;
 
     switch (metadata.dimension)
     {
@@ -664,7 +789,6 @@ HRESULT Xbox::Detile(
         desc.TileMode = xbox.GetTileMode();
 #endif
 
-        ComPtr<XGTextureAddressComputer> computer;
         HRESULT hr = XGCreateTexture1DComputer(&desc, computer.GetAddressOf());
         if (FAILED(hr))
             return hr;
@@ -679,49 +803,6 @@ HRESULT Xbox::Detile(
         if (layout.SizeBytes != xbox.GetSize()
             || layout.BaseAlignmentBytes != xbox.GetAlignment())
             return E_UNEXPECTED;
-
-        hr = image.Initialize(metadata);
-        if (FAILED(hr))
-            return hr;
-
-        for (uint32_t level = 0; level < metadata.mipLevels; ++level)
-        {
-            if (metadata.arraySize > 1)
-            {
-                std::vector<const Image*> images;
-                images.reserve(metadata.arraySize);
-                for (uint32_t item = 0; item < metadata.arraySize; ++item)
-                {
-                    const Image* img = image.GetImage(level, item, 0);
-                    if (!img)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    images.push_back(img);
-                }
-
-                hr = Detile1D(xbox, level, computer.Get(), layout, &images[0], images.size());
-            }
-            else
-            {
-                const Image* img = image.GetImage(level, 0, 0);
-                if (!img)
-                {
-                    image.Release();
-                    return E_FAIL;
-                }
-
-                hr = Detile1D(xbox, level, computer.Get(), layout, &img, 1);
-            }
-
-            if (FAILED(hr))
-            {
-                image.Release();
-                return hr;
-            }
-        }
     }
     break;
 
@@ -743,7 +824,6 @@ HRESULT Xbox::Detile(
         desc.TileMode = xbox.GetTileMode();
 #endif
 
-        ComPtr<XGTextureAddressComputer> computer;
         HRESULT hr = XGCreateTexture2DComputer(&desc, computer.GetAddressOf());
         if (FAILED(hr))
             return hr;
@@ -758,49 +838,6 @@ HRESULT Xbox::Detile(
         if (layout.SizeBytes != xbox.GetSize()
             || layout.BaseAlignmentBytes != xbox.GetAlignment())
             return E_UNEXPECTED;
-
-        hr = image.Initialize(metadata);
-        if (FAILED(hr))
-            return hr;
-
-        for (uint32_t level = 0; level < metadata.mipLevels; ++level)
-        {
-            if (metadata.arraySize > 1)
-            {
-                std::vector<const Image*> images;
-                images.reserve(metadata.arraySize);
-                for (uint32_t item = 0; item < metadata.arraySize; ++item)
-                {
-                    const Image* img = image.GetImage(level, item, 0);
-                    if (!img)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    images.push_back(img);
-                }
-
-                hr = Detile2D(xbox, level, computer.Get(), layout, &images[0], images.size());
-            }
-            else
-            {
-                const Image* img = image.GetImage(level, 0, 0);
-                if (!img)
-                {
-                    image.Release();
-                    return E_FAIL;
-                }
-
-                hr = Detile2D(xbox, level, computer.Get(), layout, &img, 1);
-            }
-
-            if (FAILED(hr))
-            {
-                image.Release();
-                return hr;
-            }
-        }
     }
     break;
 
@@ -820,7 +857,6 @@ HRESULT Xbox::Detile(
         desc.TileMode = xbox.GetTileMode();
 #endif
 
-        ComPtr<XGTextureAddressComputer> computer;
         HRESULT hr = XGCreateTexture3DComputer(&desc, computer.GetAddressOf());
         if (FAILED(hr))
             return hr;
@@ -835,40 +871,70 @@ HRESULT Xbox::Detile(
         if (layout.SizeBytes != xbox.GetSize()
             || layout.BaseAlignmentBytes != xbox.GetAlignment())
             return E_UNEXPECTED;
+    }
+    break;
 
-        hr = image.Initialize(metadata);
-        if (FAILED(hr))
-            return hr;
+    default:
+        return E_FAIL;
+    }
 
-        uint32_t d = static_cast<uint32_t>(metadata.depth);
+    HRESULT hr = image.Initialize(metadata);
+    if (FAILED(hr))
+        return hr;
 
-        size_t index = 0;
-        for (uint32_t level = 0; level < metadata.mipLevels; ++level)
-        {
-            if ((index + d) > image.GetImageCount())
-            {
-                image.Release();
-                return E_FAIL;
-            }
+    XGTileAddressComputer adapter(computer.Get());
 
-            // Relies on the fact that slices are contiguous
-            hr = Detile3D(xbox, level, d, computer.Get(), layout, image.GetImages()[index]);
-            if (FAILED(hr))
-            {
-                image.Release();
-                return hr;
-            }
+    hr = DetileLevels(xbox, &adapter, layout, image, flags);
+    if (FAILED(hr))
+    {
+        image.Release();
+        return hr;
+    }
 
-            index += d;
+    return S_OK;
+}
 
-            if (d > 1)
-                d >>= 1;
-        }
+
+//-------------------------------------------------------------------------------------
+// Detile image using a caller-provided address computer
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT Xbox::Detile(
+    const XboxImage& xbox,
+    ITileAddressComputer* computer,
+    const XG_RESOURCE_LAYOUT& layout,
+    DirectX::ScratchImage& image,
+    XBOX_TILE_FLAGS flags)
+{
+    if (!computer || !xbox.GetSize() || !xbox.GetPointer())
+        return E_INVALIDARG;
+
+    image.Release();
+
+    auto& metadata = xbox.GetMetadata();
+
+    if (metadata.format == DXGI_FORMAT_R1_UNORM
+        || IsVideo(metadata.format))
+    {
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
     }
-    break;
 
-    default:
-        return E_FAIL;
+    if (layout.Planes != 1)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    if (layout.SizeBytes != xbox.GetSize()
+        || layout.MipLevels != metadata.mipLevels)
+        return E_UNEXPECTED;
+
+    HRESULT hr = image.Initialize(metadata);
+    if (FAILED(hr))
+        return hr;
+
+    hr = DetileLevels(xbox, computer, layout, image, flags);
+    if (FAILED(hr))
+    {
+        image.Release();
+        return hr;
     }
 
     return S_OK;
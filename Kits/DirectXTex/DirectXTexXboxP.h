@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXTexXboxP.h
+//
+// DirectXTex Auxillary functions for Xbox One texture processing (internal)
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DirectXTexXbox.h"
+
+#include <vector>
+
+namespace Xbox
+{
+    //---------------------------------------------------------------------------------
+    // Address computer backed by the XG library
+    //---------------------------------------------------------------------------------
+    class XGTileAddressComputer final : public ITileAddressComputer
+    {
+    public:
+        explicit XGTileAddressComputer(_In_ XGTextureAddressComputer* computer) noexcept : m_computer(computer) {}
+
+        size_t __cdecl GetElementOffsetBytes(uint32_t level, uint64_t x, uint32_t y, uint32_t zOrItem) override
+        {
+#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
+            return m_computer->GetTexelElementOffsetBytes(0, level, x, y, zOrItem, 0, nullptr);
+#else
+            return m_computer->GetTexelElementOffsetBytes(0, level, x, y, zOrItem, 0);
+#endif
+        }
+
+    private:
+        XGTextureAddressComputer* m_computer;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Precomputed element addressing for one mip level
+    //
+    // Tiled layouts store each micro-tile as a contiguous run of memory with the same
+    // element order, so the offset of element (x,y) is the micro-tile base plus an
+    // intra-tile offset. The pattern is read once from the first micro-tile, after which
+    // each micro-tile costs a query for its base and one to verify its far corner.
+    // Layouts that do not fit this model (thick modes, mips smaller than a micro-tile)
+    // fail to initialize, and callers use the per-element path instead.
+    //---------------------------------------------------------------------------------
+    class TilePattern
+    {
+    public:
+        TilePattern() noexcept;
+
+        TilePattern(const TilePattern&) = delete;
+        TilePattern& operator=(const TilePattern&) = delete;
+
+        // Derives the micro-tile shape and intra-tile offsets from item/slice zero
+        bool Initialize(_In_ ITileAddressComputer* computer, uint32_t level, size_t width, size_t height, size_t bpe);
+
+        // Computes the micro-tile base offsets for an array item (or volume slice)
+        bool Rebase(_In_ ITileAddressComputer* computer, uint32_t zOrItem);
+
+        size_t GetOffset(size_t x, size_t y) const noexcept
+        {
+            assert(x < m_width && y < m_height);
+            return m_bases[(y >> m_shiftH) * m_tilesX + (x >> m_shiftW)]
+                + size_t(m_intra[((y & m_maskH) << m_shiftW) + (x & m_maskW)]);
+        }
+
+        // Copies a linear image to/from tiled memory one contiguous run at a time
+        HRESULT CopyToTiled(
+            _In_ const uint8_t* src, size_t rowPitch,
+            _Inout_ uint8_t* tiled, _In_ const uint8_t* endPtr) const noexcept;
+        HRESULT CopyFromTiled(
+            _In_ const uint8_t* tiled, _In_ const uint8_t* endPtr,
+            _Inout_ uint8_t* dst, size_t rowPitch) const noexcept;
+
+    private:
+        struct Run
+        {
+            uint32_t    x;
+            uint32_t    y;
+            uint32_t    count;
+            ptrdiff_t   offset;
+        };
+
+        bool TryShape(_In_ ITileAddressComputer* computer, size_t tileW, size_t tileH);
+        bool VerifyTile(_In_ ITileAddressComputer* computer, uint32_t zOrItem, size_t x0, size_t y0, size_t base, bool full) const;
+
+        uint32_t                m_level;
+        size_t                  m_width;
+        size_t                  m_height;
+        size_t                  m_bpe;
+        uint32_t                m_shiftW;
+        uint32_t                m_shiftH;
+        size_t                  m_maskW;
+        size_t                  m_maskH;
+        size_t                  m_tilesX;
+        size_t                  m_tilesY;
+        std::vector<ptrdiff_t>  m_intra;
+        std::vector<Run>        m_runs;
+        std::vector<size_t>     m_bases;
+    };
+}
@@ -8,7 +8,7 @@
 //--------------------------------------------------------------------------------------
 
 #include "DirectXTexP.h"
-#include "DirectXTexXbox.h"
+#include "DirectXTexXboxP.h"
 
 //#define VERBOSE
 
@@ -23,16 +23,22 @@ namespace
         _In_reads_(nimages) const Image** images,
         size_t nimages,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         _In_ const XG_RESOURCE_LAYOUT& layout,
         const XboxImage& xbox,
         size_t bpp,
         size_t w,
-        bool packed)
+        bool packed,
+        XBOX_TILE_FLAGS flags)
     {
         uint8_t* dptr = xbox.GetPointer();
         const uint8_t* endPtr = dptr + layout.SizeBytes;
 
+        // Packed formats hold two pixels per element, so they always use the per-element path
+        TilePattern pattern;
+        const bool initialized = !packed && !(flags & XBOX_TILE_BY_ELEMENT)
+            && pattern.Initialize(computer, level, w, 1, bpp);
+
         for (uint32_t item = 0; item < nimages; ++item)
         {
             const Image* img = images[item];
@@ -45,16 +51,25 @@ namespace
             assert(img->rowPitch == images[0]->rowPitch);
             assert(img->format == images[0]->format);
 
+            if (initialized && pattern.Rebase(computer, item))
+            {
+                HRESULT hr = pattern.CopyToTiled(img->pixels, img->rowPitch, dptr, endPtr);
+                if (FAILED(hr))
+                    return hr;
+
+                continue;
+            }
+
             const uint8_t* sptr = img->pixels;
 
             for (size_t x = 0; x < w; ++x)
             {
 #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
                 UINT64 element = (packed) ? (x >> 1) : x;
-                size_t offset = computer->GetTexelElementOffsetBytes(0, level, element, 0, item, 0, nullptr);
 #else
-                size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, 0, item, 0);
+                UINT64 element = x;
 #endif
+                size_t offset = computer->GetElementOffsetBytes(level, element, 0, item);
                 if (offset == size_t(-1))
                     return E_FAIL;
 
@@ -79,17 +94,23 @@ namespace
         _In_reads_(nimages) const Image** images,
         size_t nimages,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         const XboxImage& xbox,
         size_t bpp,
         size_t w,
         size_t h,
-        bool packed)
+        bool packed,
+        XBOX_TILE_FLAGS flags)
     {
         uint8_t* dptr = xbox.GetPointer();
         const uint8_t* endPtr = dptr + layout.SizeBytes;
 
+        // Packed formats hold two pixels per element, so they always use the per-element path
+        TilePattern pattern;
+        const bool initialized = !packed && !(flags & XBOX_TILE_BY_ELEMENT)
+            && pattern.Initialize(computer, level, w, h, bpp);
+
         for (uint32_t item = 0; item < nimages; ++item)
         {
             const Image* img = images[item];
@@ -102,6 +123,15 @@ namespace
             assert(img->rowPitch == images[0]->rowPitch);
             assert(img->format == images[0]->format);
 
+            if (initialized && pattern.Rebase(computer, item))
+            {
+                HRESULT hr = pattern.CopyToTiled(img->pixels, img->rowPitch, dptr, endPtr);
+                if (FAILED(hr))
+                    return hr;
+
+                continue;
+            }
+
             const uint8_t* sptr = img->pixels;
             for (uint32_t y = 0; y < h; ++y)
             {
@@ -111,10 +141,10 @@ namespace
                 {
 #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
                     UINT64 element = (packed) ? (x >> 1) : x;
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, element, y, item, 0, nullptr);
 #else
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, item, 0);
+                    UINT64 element = x;
 #endif
+                    size_t offset = computer->GetElementOffsetBytes(level, element, y, item);
                     if (offset == size_t(-1))
                         return E_FAIL;
 
@@ -142,20 +172,36 @@ namespace
         const Image& image,
         uint32_t level,
         uint32_t slices,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         const XboxImage& xbox,
         size_t bpp,
         size_t w,
         size_t h,
-        bool packed)
+        bool packed,
+        XBOX_TILE_FLAGS flags)
     {
         uint8_t* dptr = xbox.GetPointer();
         const uint8_t* endPtr = dptr + layout.SizeBytes;
 
+        // Packed formats hold two pixels per element, and thick layouts have no 2D pattern, so both use the per-element path
+        TilePattern pattern;
+        const bool initialized = !packed && !(flags & XBOX_TILE_BY_ELEMENT)
+            && pattern.Initialize(computer, level, w, h, bpp);
+
         const uint8_t* sptr = image.pixels;
         for (uint32_t z = 0; z < slices; ++z)
         {
+            if (initialized && pattern.Rebase(computer, z))
+            {
+                HRESULT hr = pattern.CopyToTiled(sptr, image.rowPitch, dptr, endPtr);
+                if (FAILED(hr))
+                    return hr;
+
+                sptr += image.slicePitch;
+                continue;
+            }
+
             const uint8_t* rptr = sptr;
 
             for (uint32_t y = 0; y < h; ++y)
@@ -166,10 +212,10 @@ namespace
                 {
 #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
                     UINT64 element = (packed) ? (x >> 1) : x;
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, element, y, z, 0, nullptr);
 #else
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, z, 0);
+                    UINT64 element = x;
 #endif
+                    size_t offset = computer->GetElementOffsetBytes(level, element, y, z);
                     if (offset == size_t(-1))
                         return E_FAIL;
 
@@ -284,9 +330,10 @@ namespace
         _In_reads_(nimages) const Image** images,
         size_t nimages,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const XboxImage& xbox)
+        const XboxImage& xbox,
+        XBOX_TILE_FLAGS flags)
     {
         if (!nimages)
             return E_INVALIDARG;
@@ -317,7 +364,7 @@ namespace
             size_t w = images[0]->width;
             assert(((w + 1) / 2) == layout.Plane[0].MipLayout[level].WidthElements);
 
-            return TileByElement1D(images, nimages, level, computer, layout, xbox, bpp, w, true);
+            return TileByElement1D(images, nimages, level, computer, layout, xbox, bpp, w, true, flags);
         }
         else if (byelement)
         {
@@ -328,7 +375,7 @@ namespace
             size_t w = images[0]->width;
             assert(w == layout.Plane[0].MipLayout[level].WidthElements);
 
-            return TileByElement1D(images, nimages, level, computer, layout, xbox, bpp, w, false);
+            return TileByElement1D(images, nimages, level, computer, layout, xbox, bpp, w, false, flags);
         }
         else
         {
@@ -348,6 +395,10 @@ namespace
 
             memset(tiled, 0, sizeof(XMVECTOR) * tiledPixels);
 
+            TilePattern pattern;
+            const bool initialized = !(flags & XBOX_TILE_BY_ELEMENT)
+                && pattern.Initialize(computer, level, images[0]->width, images[0]->height, layout.Plane[0].BytesPerElement);
+
             // Perform tiling
             for (uint32_t item = 0; item < nimages; ++item)
             {
@@ -361,16 +412,14 @@ namespace
                 assert(img->rowPitch == images[0]->rowPitch);
                 assert(img->format == images[0]->format);
 
+                const bool usePattern = initialized && pattern.Rebase(computer, item);
+
                 if (!_LoadScanline(row, img->width, img->pixels, img->rowPitch, img->format))
                     return E_FAIL;
 
                 for (size_t x = 0; x < img->width; ++x)
                 {
-#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, 0, item, 0, nullptr);
-#else
-                    size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, 0, item, 0);
-#endif
+                    size_t offset = (usePattern) ? pattern.GetOffset(x, 0) : computer->GetElementOffsetBytes(level, x, 0, item);
                     if (offset == size_t(-1))
                         return E_FAIL;
 
@@ -401,9 +450,10 @@ namespace
         _In_reads_(nimages) const Image** images,
         size_t nimages,
         uint32_t level,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const XboxImage& xbox)
+        const XboxImage& xbox,
+        XBOX_TILE_FLAGS flags)
     {
         if (!nimages)
             return E_INVALIDARG;
@@ -440,7 +490,7 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
-            return TileByElement2D(images, nimages, level, computer, layout, xbox, bpb, nbw, nbh, false);
+            return TileByElement2D(images, nimages, level, computer, layout, xbox, bpb, nbw, nbh, false, flags);
         }
         else if (IsPacked(format))
         {
@@ -453,7 +503,7 @@ namespace
             assert(((w + 1) / 2) == layout.Plane[0].MipLayout[level].WidthElements);
             assert(h == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return TileByElement2D(images, nimages, level, computer, layout, xbox, bpp, w, h, true);
+            return TileByElement2D(images, nimages, level, computer, layout, xbox, bpp, w, h, true, flags);
         }
         else if (byelement)
         {
@@ -467,7 +517,7 @@ namespace
             assert(w == layout.Plane[0].MipLayout[level].WidthElements);
             assert(h == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return TileByElement2D(images, nimages, level, computer, layout, xbox, bpp, w, h, false);
+            return TileByElement2D(images, nimages, level, computer, layout, xbox, bpp, w, h, false, flags);
         }
         else
         {
@@ -487,6 +537,10 @@ namespace
 
             memset(tiled, 0, sizeof(XMVECTOR) * tiledPixels);
 
+            TilePattern pattern;
+            const bool initialized = !(flags & XBOX_TILE_BY_ELEMENT)
+                && pattern.Initialize(computer, level, images[0]->width, images[0]->height, layout.Plane[0].BytesPerElement);
+
             // Perform tiling
             for (uint32_t item = 0; item < nimages; ++item)
             {
@@ -500,6 +554,8 @@ namespace
                 assert(img->rowPitch == images[0]->rowPitch);
                 assert(img->format == images[0]->format);
 
+                const bool usePattern = initialized && pattern.Rebase(computer, item);
+
                 auto sptr = reinterpret_cast<const uint8_t * __restrict>(img->pixels);
                 for (uint32_t y = 0; y < img->height; ++y)
                 {
@@ -510,11 +566,7 @@ namespace
 
                     for (size_t x = 0; x < img->width; ++x)
                     {
-#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, item, 0, nullptr);
-#else
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, item, 0);
-#endif
+                        size_t offset = (usePattern) ? pattern.GetOffset(x, y) : computer->GetElementOffsetBytes(level, x, y, item);
                         if (offset == size_t(-1))
                             return E_FAIL;
 
@@ -546,9 +598,10 @@ namespace
         const Image& image,
         uint32_t level,
         uint32_t slices,
-        _In_ XGTextureAddressComputer* computer,
+        _In_ ITileAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const XboxImage& xbox)
+        const XboxImage& xbox,
+        XBOX_TILE_FLAGS flags)
     {
         if (!image.pixels || !computer || !xbox.GetPointer())
             return E_POINTER;
@@ -581,7 +634,7 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
-            return TileByElement3D(image, level, slices, computer, layout, xbox, bpb, nbw, nbh, false);
+            return TileByElement3D(image, level, slices, computer, layout, xbox, bpb, nbw, nbh, false, flags);
         }
         else if (IsPacked(image.format))
         {
@@ -592,7 +645,7 @@ namespace
             assert(((image.width + 1) / 2) == layout.Plane[0].MipLayout[level].WidthElements);
             assert(image.height == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return TileByElement3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, true);
+            return TileByElement3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, true, flags);
         }
         else if (byelement)
         {
@@ -603,7 +656,7 @@ namespace
             assert(image.width == layout.Plane[0].MipLayout[level].WidthElements);
             assert(image.height == layout.Plane[0].MipLayout[level].HeightElements);
 
-            return TileByElement3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, false);
+            return TileByElement3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, false, flags);
         }
         else
         {
@@ -624,10 +677,16 @@ namespace
 
             memset(tiled, 0, sizeof(XMVECTOR) * tiledPixels);
 
+            TilePattern pattern;
+            const bool initialized = !(flags & XBOX_TILE_BY_ELEMENT)
+                && pattern.Initialize(computer, level, image.width, image.height, layout.Plane[0].BytesPerElement);
+
             // Perform tiling
             const uint8_t* sptr = reinterpret_cast<const uint8_t*>(image.pixels);
             for (uint32_t z = 0; z < slices; ++z)
             {
+                const bool usePattern = initialized && pattern.Rebase(computer, z);
+
                 const uint8_t* rptr = sptr;
 
                 for (uint32_t y = 0; y < image.height; ++y)
@@ -639,11 +698,7 @@ namespace
 
                     for (size_t x = 0; x < image.width; ++x)
                     {
-#if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, z, 0, nullptr);
-#else
-                        size_t offset = computer->GetTexelElementOffsetBytes(0, level, x, y, z, 0);
-#endif
+                        size_t offset = (usePattern) ? pattern.GetOffset(x, y) : computer->GetElementOffsetBytes(level, x, y, z);
                         if (offset == size_t(-1))
                             return E_FAIL;
 
@@ -688,6 +743,74 @@ namespace
 
         return S_OK;
     }
+
+
+    //-------------------------------------------------------------------------------------
+    // Tiles all mip levels and array items into an initialized xbox image
+    //-------------------------------------------------------------------------------------
+    HRESULT TileLevels(
+        _In_reads_(nimages) const Image* srcImages,
+        size_t nimages,
+        const TexMetadata& metadata,
+        _In_ ITileAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        const XboxImage& xbox,
+        XBOX_TILE_FLAGS flags)
+    {
+        switch (metadata.dimension)
+        {
+        case TEX_DIMENSION_TEXTURE1D:
+        case TEX_DIMENSION_TEXTURE2D:
+            for (uint32_t level = 0; level < metadata.mipLevels; ++level)
+            {
+                std::vector<const Image*> images;
+                images.reserve(metadata.arraySize);
+                for (uint32_t item = 0; item < metadata.arraySize; ++item)
+                {
+                    size_t index = metadata.ComputeIndex(level, item, 0);
+                    if (index >= nimages)
+                        return E_FAIL;
+
+                    images.push_back(&srcImages[index]);
+                }
+
+                HRESULT hr = (metadata.dimension == TEX_DIMENSION_TEXTURE1D)
+                    ? Tile1D(&images[0], images.size(), level, computer, layout, xbox, flags)
+                    : Tile2D(&images[0], images.size(), level, computer, layout, xbox, flags);
+                if (FAILED(hr))
+                    return hr;
+            }
+            break;
+
+        case TEX_DIMENSION_TEXTURE3D:
+            {
+                uint32_t d = static_cast<uint32_t>(metadata.depth);
+
+                size_t index = 0;
+                for (uint32_t level = 0; level < metadata.mipLevels; ++level)
+                {
+                    if ((index + d) > nimages)
+                        return E_FAIL;
+
+                    // Relies on the fact that slices are contiguous
+                    HRESULT hr = Tile3D(srcImages[index], level, d, computer, layout, xbox, flags);
+                    if (FAILED(hr))
+                        return hr;
+
+                    index += d;
+
+                    if (d > 1)
+                        d >>= 1;
+                }
+            }
+            break;
+
+        default:
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
 }
 
 
@@ -702,7 +825,8 @@ _Use_decl_annotations_
 HRESULT Xbox::Tile(
     const DirectX::Image& srcImage,
     XboxImage& xbox,
-    XboxTileMode mode)
+    XboxTileMode mode,
+    XBOX_TILE_FLAGS flags)
 {
     if (!srcImage.pixels
         || srcImage.width > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION
@@ -763,8 +887,10 @@ HRESULT Xbox::Tile(
     if (FAILED(hr))
         return hr;
 
+    XGTileAddressComputer adapter(computer.Get());
+
     const Image* images = &srcImage;
-    hr = Tile2D(&images, 1, 0, computer.Get(), layout, xbox);
+    hr = Tile2D(&images, 1, 0, &adapter, layout, xbox, flags);
     if (FAILED(hr))
     {
         xbox.Release();
@@ -784,7 +910,8 @@ HRESULT Xbox::Tile(
     size_t nimages,
     const DirectX::TexMetadata& metadata,
     XboxImage& xbox,
-    XboxTileMode mode)
+    XboxTileMode mode,
+    XBOX_TILE_FLAGS flags)
 {
     if (!srcImages
         || !nimages
@@ -832,6 +959,7 @@ HRESULT Xbox::Tile(
     }
 
     XG_RESOURCE_LAYOUT layout = {};
+    ComPtr<XGTextureAddressComputer> computer;
 
     switch (metadata.dimension)
     {
@@ -855,7 +983,6 @@ HRESULT Xbox::Tile(
         DebugPrintDesc(desc);
 #endif
 
-        ComPtr<XGTextureAddressComputer> computer;
         HRESULT hr = XGCreateTexture1DComputer(&desc, computer.GetAddressOf());
         if (FAILED(hr))
             return hr;
@@ -874,46 +1001,6 @@ HRESULT Xbox::Tile(
         hr = xbox.Initialize(desc, layout, metadata.miscFlags2);
         if (FAILED(hr))
             return hr;
-
-        for (uint32_t level = 0; level < metadata.mipLevels; ++level)
-        {
-            if (metadata.arraySize > 1)
-            {
-                std::vector<const Image*> images;
-                images.reserve(metadata.arraySize);
-                for (uint32_t item = 0; item < metadata.arraySize; ++item)
-                {
-                    size_t index = metadata.ComputeIndex(level, item, 0);
-                    if (index >= nimages)
-                    {
-                        xbox.Release();
-                        return E_FAIL;
-                    }
-
-                    images.push_back(&srcImages[index]);
-                }
-
-                hr = Tile1D(&images[0], images.size(), level, computer.Get(), layout, xbox);
-            }
-            else
-            {
-                size_t index = metadata.ComputeIndex(level, 0, 0);
-                if (index >= nimages)
-                {
-                    xbox.Release();
-                    return E_FAIL;
-                }
-
-                const Image* images = &srcImages[index];
-                hr = Tile1D(&images, 1, level, computer.Get(), layout, xbox);
-            }
-
-            if (FAILED(hr))
-            {
-                xbox.Release();
-                return hr;
-            }
-        }
     }
     break;
 
@@ -939,7 +1026,6 @@ HRESULT Xbox::Tile(
         DebugPrintDesc(desc);
 #endif
 
-        ComPtr<XGTextureAddressComputer> computer;
         HRESULT hr = XGCreateTexture2DComputer(&desc, computer.GetAddressOf());
         if (FAILED(hr))
             return hr;
@@ -958,46 +1044,6 @@ HRESULT Xbox::Tile(
         hr = xbox.Initialize(desc, layout, metadata.miscFlags2);
         if (FAILED(hr))
             return hr;
-
-        for (uint32_t level = 0; level < metadata.mipLevels; ++level)
-        {
-            if (metadata.arraySize > 1)
-            {
-                std::vector<const Image*> images;
-                images.reserve(metadata.arraySize);
-                for (uint32_t item = 0; item < metadata.arraySize; ++item)
-                {
-                    size_t index = metadata.ComputeIndex(level, item, 0);
-                    if (index >= nimages)
-                    {
-                        xbox.Release();
-                        return E_FAIL;
-                    }
-
-                    images.push_back(&srcImages[index]);
-                }
-
-                hr = Tile2D(&images[0], images.size(), level, computer.Get(), layout, xbox);
-            }
-            else
-            {
-                size_t index = metadata.ComputeIndex(level, 0, 0);
-                if (index >= nimages)
-                {
-                    xbox.Release();
-                    return E_FAIL;
-                }
-
-                const Image* images = &srcImages[index];
-                hr = Tile2D(&images, 1, level, computer.Get(), layout, xbox);
-            }
-
-            if (FAILED(hr))
-            {
-                xbox.Release();
-                return hr;
-            }
-        }
     }
     break;
 
@@ -1021,7 +1067,6 @@ HRESULT Xbox::Tile(
         DebugPrintDesc(desc);
 #endif
 
-        ComPtr<XGTextureAddressComputer> computer;
         HRESULT hr = XGCreateTexture3DComputer(&desc, computer.GetAddressOf());
         if (FAILED(hr))
             return hr;
@@ -1040,31 +1085,6 @@ HRESULT Xbox::Tile(
         hr = xbox.Initialize(desc, layout, metadata.miscFlags2);
         if (FAILED(hr))
             return hr;
-
-        uint32_t d = static_cast<uint32_t>(metadata.depth);
-
-        size_t index = 0;
-        for (uint32_t level = 0; level < metadata.mipLevels; ++level)
-        {
-            if ((index + d) > nimages)
-            {
-                xbox.Release();
-                return E_FAIL;
-            }
-
-            // Relies on the fact that slices are contiguous
-            hr = Tile3D(srcImages[index], level, d, computer.Get(), layout, xbox);
-            if (FAILED(hr))
-            {
-                xbox.Release();
-                return hr;
-            }
-
-            index += d;
-
-            if (d > 1)
-                d >>= 1;
-        }
     }
     break;
 
@@ -1072,5 +1092,58 @@ HRESULT Xbox::Tile(
         return E_FAIL;
     }
 
+    XGTileAddressComputer adapter(computer.Get());
+
+    HRESULT hr = TileLevels(srcImages, nimages, metadata, &adapter, layout, xbox, flags);
+    if (FAILED(hr))
+    {
+        xbox.Release();
+        return hr;
+    }
+
     return S_OK;
 }
+
+
+//-------------------------------------------------------------------------------------
+// Tile image (complex) using a caller-provided address computer
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT Xbox::Tile(
+    const DirectX::Image* srcImages,
+    size_t nimages,
+    const DirectX::TexMetadata& metadata,
+    ITileAddressComputer* computer,
+    const XG_RESOURCE_LAYOUT& layout,
+    XboxImage& xbox,
+    XBOX_TILE_FLAGS flags)
+{
+    if (!srcImages || !nimages || !computer)
+        return E_INVALIDARG;
+
+    if (!xbox.GetPointer())
+        return E_POINTER;
+
+    if (layout.Planes != 1)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    auto& mdata = xbox.GetMetadata();
+    if (layout.SizeBytes != xbox.GetSize()
+        || layout.MipLevels != metadata.mipLevels
+        || mdata.format != metadata.format
+        || mdata.dimension != metadata.dimension
+        || mdata.width != metadata.width
+        || mdata.height != metadata.height
+        || mdata.depth != metadata.depth
+        || mdata.arraySize != metadata.arraySize
+        || mdata.mipLevels != metadata.mipLevels)
+        return E_INVALIDARG;
+
+    if (metadata.format == DXGI_FORMAT_R1_UNORM
+        || IsVideo(metadata.format))
+    {
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+    }
+
+    return TileLevels(srcImages, nimages, metadata, computer, layout, xbox, flags);
+}
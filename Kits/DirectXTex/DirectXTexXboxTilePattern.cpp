@@ -0,0 +1,332 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXTexXboxTilePattern.cpp
+//
+// DirectXTex Auxillary functions for precomputed Xbox One tiling address patterns
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+#include "DirectXTexXboxP.h"
+
+using namespace DirectX;
+using namespace Xbox;
+
+namespace
+{
+    // Micro-tiles are the unit of element swizzling within a tiled surface
+    constexpr size_t c_MicroTileBytes = 256;
+
+    // Row segments (linear layouts) are tried up to this size, and only if at least this many elements long
+    constexpr size_t c_MaxRowBytes = 4096;
+    constexpr size_t c_MinRowElements = 16;
+
+    inline uint32_t FloorLog2(size_t value) noexcept
+    {
+        uint32_t result = 0;
+        while ((size_t(1) << (result + 1)) <= value)
+            ++result;
+        return result;
+    }
+}
+
+TilePattern::TilePattern() noexcept :
+    m_level(0),
+    m_width(0),
+    m_height(0),
+    m_bpe(0),
+    m_shiftW(0),
+    m_shiftH(0),
+    m_maskW(0),
+    m_maskH(0),
+    m_tilesX(0),
+    m_tilesY(0)
+{
+}
+
+
+//-------------------------------------------------------------------------------------
+// Pattern detection
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool TilePattern::Initialize(ITileAddressComputer* computer, uint32_t level, size_t width, size_t height, size_t bpe)
+{
+    m_intra.clear();
+    m_runs.clear();
+    m_bases.clear();
+
+    if (!computer || !width || !height || !bpe || (bpe & (bpe - 1)) || bpe > c_MicroTileBytes)
+        return false;
+
+    m_level = level;
+    m_width = width;
+    m_height = height;
+    m_bpe = bpe;
+
+    // Candidates are a square-ish micro-tile, an 8x8 element micro-tile, and a row segment
+    const uint32_t tileBits = FloorLog2(c_MicroTileBytes / bpe);
+    const size_t rowElements = size_t(1) << FloorLog2(std::min(width, c_MaxRowBytes / bpe));
+
+    const size_t shapes[3][2] =
+    {
+        { size_t(1) << ((tileBits + 1) / 2), size_t(1) << (tileBits / 2) },
+        { 8, 8 },
+        { rowElements, 1 },
+    };
+
+    for (size_t j = 0; j < 3; ++j)
+    {
+        const size_t tileW = shapes[j][0];
+        const size_t tileH = shapes[j][1];
+
+        if (tileW > width || tileH > height)
+            continue;
+
+        if (tileH == 1 && tileW < c_MinRowElements)
+            continue;
+
+        if (j > 0 && tileW == shapes[0][0] && tileH == shapes[0][1])
+            continue;
+
+        if (TryShape(computer, tileW, tileH))
+            return true;
+    }
+
+    return false;
+}
+
+_Use_decl_annotations_
+bool TilePattern::TryShape(ITileAddressComputer* computer, size_t tileW, size_t tileH)
+{
+    const size_t count = tileW * tileH;
+
+    const size_t origin = computer->GetElementOffsetBytes(m_level, 0, 0, 0);
+    if (origin == size_t(-1))
+        return false;
+
+    std::vector<ptrdiff_t> intra(count);
+    ptrdiff_t lo = 0;
+    for (size_t y = 0; y < tileH; ++y)
+    {
+        for (size_t x = 0; x < tileW; ++x)
+        {
+            const size_t offset = computer->GetElementOffsetBytes(m_level, x, static_cast<uint32_t>(y), 0);
+            if (offset == size_t(-1))
+                return false;
+
+            const auto rel = static_cast<ptrdiff_t>(offset - origin);
+            intra[y * tileW + x] = rel;
+            lo = std::min(lo, rel);
+        }
+    }
+
+    // The micro-tile must be a dense permutation of its elements
+    std::vector<bool> seen(count, false);
+    for (auto rel : intra)
+    {
+        const auto pos = static_cast<size_t>(rel - lo);
+        if (pos % m_bpe)
+            return false;
+
+        const size_t index = pos / m_bpe;
+        if (index >= count || seen[index])
+            return false;
+
+        seen[index] = true;
+    }
+
+    m_shiftW = FloorLog2(tileW);
+    m_shiftH = FloorLog2(tileH);
+    m_maskW = tileW - 1;
+    m_maskH = tileH - 1;
+    m_tilesX = (m_width + m_maskW) >> m_shiftW;
+    m_tilesY = (m_height + m_maskH) >> m_shiftH;
+
+    // Split each row of the micro-tile into runs that are contiguous in memory
+    m_runs.clear();
+    for (size_t y = 0; y < tileH; ++y)
+    {
+        const ptrdiff_t* row = &intra[y * tileW];
+
+        size_t x = 0;
+        while (x < tileW)
+        {
+            const size_t start = x++;
+            while (x < tileW && row[x] == row[x - 1] + static_cast<ptrdiff_t>(m_bpe))
+                ++x;
+
+            Run run = { static_cast<uint32_t>(start), static_cast<uint32_t>(y), static_cast<uint32_t>(x - start), row[start] };
+            m_runs.push_back(run);
+        }
+    }
+
+    // Visit runs in memory order so each micro-tile is written or read sequentially
+    std::sort(m_runs.begin(), m_runs.end(), [](const Run& a, const Run& b) { return a.offset < b.offset; });
+
+    m_intra = std::move(intra);
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Micro-tile base offsets
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool TilePattern::Rebase(ITileAddressComputer* computer, uint32_t zOrItem)
+{
+    if (!computer || m_intra.empty())
+        return false;
+
+    m_bases.resize(m_tilesX * m_tilesY);
+
+    for (size_t ty = 0; ty < m_tilesY; ++ty)
+    {
+        const size_t y0 = ty << m_shiftH;
+
+        for (size_t tx = 0; tx < m_tilesX; ++tx)
+        {
+            const size_t x0 = tx << m_shiftW;
+
+            const size_t base = computer->GetElementOffsetBytes(m_level, x0, static_cast<uint32_t>(y0), zOrItem);
+            if (base == size_t(-1))
+                return false;
+
+            // The first row (and, for 2D micro-tiles, column) is checked element by element, the rest by the far corner
+#ifdef _DEBUG
+            const bool full = true;
+#else
+            const bool full = !ty || (!tx && m_maskH);
+#endif
+            if (!VerifyTile(computer, zOrItem, x0, y0, base, full))
+                return false;
+
+            m_bases[ty * m_tilesX + tx] = base;
+        }
+    }
+
+    return true;
+}
+
+_Use_decl_annotations_
+bool TilePattern::VerifyTile(ITileAddressComputer* computer, uint32_t zOrItem, size_t x0, size_t y0, size_t base, bool full) const
+{
+    const size_t x1 = std::min(x0 + m_maskW + 1, m_width);
+    const size_t y1 = std::min(y0 + m_maskH + 1, m_height);
+
+    const size_t startY = (full) ? y0 : (y1 - 1);
+    const size_t startX = (full) ? x0 : (x1 - 1);
+
+    for (size_t y = startY; y < y1; ++y)
+    {
+        for (size_t x = startX; x < x1; ++x)
+        {
+            const size_t expected = base + size_t(m_intra[((y - y0) << m_shiftW) + (x - x0)]);
+            if (computer->GetElementOffsetBytes(m_level, x, static_cast<uint32_t>(y), zOrItem) != expected)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Copy by micro-tile
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT TilePattern::CopyToTiled(const uint8_t* src, size_t rowPitch, uint8_t* tiled, const uint8_t* endPtr) const noexcept
+{
+    if (!src || !tiled || !endPtr)
+        return E_POINTER;
+
+    if (m_bases.size() != m_tilesX * m_tilesY)
+        return E_UNEXPECTED;
+
+    for (size_t ty = 0; ty < m_tilesY; ++ty)
+    {
+        const size_t y0 = ty << m_shiftH;
+
+        for (size_t tx = 0; tx < m_tilesX; ++tx)
+        {
+            const size_t x0 = tx << m_shiftW;
+            const bool interior = (x0 + m_maskW < m_width) && (y0 + m_maskH < m_height);
+
+            uint8_t* tile = tiled + m_bases[ty * m_tilesX + tx];
+
+            for (const auto& run : m_runs)
+            {
+                const size_t x = x0 + run.x;
+                const size_t y = y0 + run.y;
+
+                size_t count = run.count;
+                if (!interior)
+                {
+                    if (x >= m_width || y >= m_height)
+                        continue;
+
+                    count = std::min(count, m_width - x);
+                }
+
+                uint8_t* dest = tile + run.offset;
+                const size_t bytes = count * m_bpe;
+
+                if ((dest + bytes) > endPtr)
+                    return E_FAIL;
+
+                memcpy(dest, src + y * rowPitch + x * m_bpe, bytes);
+            }
+        }
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT TilePattern::CopyFromTiled(const uint8_t* tiled, const uint8_t* endPtr, uint8_t* dst, size_t rowPitch) const noexcept
+{
+    if (!tiled || !endPtr || !dst)
+        return E_POINTER;
+
+    if (m_bases.size() != m_tilesX * m_tilesY)
+        return E_UNEXPECTED;
+
+    for (size_t ty = 0; ty < m_tilesY; ++ty)
+    {
+        const size_t y0 = ty << m_shiftH;
+
+        for (size_t tx = 0; tx < m_tilesX; ++tx)
+        {
+            const size_t x0 = tx << m_shiftW;
+            const bool interior = (x0 + m_maskW < m_width) && (y0 + m_maskH < m_height);
+
+            const uint8_t* tile = tiled + m_bases[ty * m_tilesX + tx];
+
+            for (const auto& run : m_runs)
+            {
+                const size_t x = x0 + run.x;
+                const size_t y = y0 + run.y;
+
+                size_t count = run.count;
+                if (!interior)
+                {
+                    if (x >= m_width || y >= m_height)
+                        continue;
+
+                    count = std::min(count, m_width - x);
+                }
+
+                const uint8_t* source = tile + run.offset;
+                const size_t bytes = count * m_bpe;
+
+                if ((source + bytes) > endPtr)
+                    return E_FAIL;
+
+                memcpy(dst + y * rowPitch + x * m_bpe, source, bytes);
+            }
+        }
+    }
+
+    return S_OK;
+}
@@ -420,4 +420,117 @@ namespace TriangleFilter
 
 } // namespace TriangleFilter
 
+//-------------------------------------------------------------------------------------
+// Separable windowed filtering helpers (Lanczos, Mitchell-Netravali)
+//-------------------------------------------------------------------------------------
+
+namespace SeparableFilter
+{
+    enum KERNEL
+    {
+        KERNEL_LANCZOS3,
+        KERNEL_MITCHELL,
+    };
+
+    // Radius of the kernel in source texels at a 1:1 scale
+    inline float _Support(_In_ KERNEL kernel) noexcept
+    {
+        return (kernel == KERNEL_LANCZOS3) ? 3.f : 2.f;
+    }
+
+    inline float _Evaluate(_In_ KERNEL kernel, _In_ float x) noexcept
+    {
+        x = fabsf(x);
+
+        if (kernel == KERNEL_LANCZOS3)
+        {
+            if (x < 1e-5f)
+                return 1.f;
+
+            if (x >= 3.f)
+                return 0.f;
+
+            const float px = XM_PI * x;
+            return 3.f * sinf(px) * sinf(px / 3.f) / (px * px);
+        }
+
+        // Mitchell-Netravali with B = C = 1/3
+        constexpr float B = 1.f / 3.f;
+        constexpr float C = 1.f / 3.f;
+
+        if (x < 1.f)
+            return ((12.f - 9.f * B - 6.f * C) * x * x * x + (-18.f + 12.f * B + 6.f * C) * x * x + (6.f - 2.f * B)) / 6.f;
+
+        if (x < 2.f)
+            return ((-B - 6.f * C) * x * x * x + (6.f * B + 30.f * C) * x * x + (-12.f * B - 48.f * C) * x + (8.f * B + 24.f * C)) / 6.f;
+
+        return 0.f;
+    }
+
+    // 'taps' addressed source indices and normalized weights for every destination texel, plus the
+    // unaddressed source position of its first tap (tap k sits at first + k before wrap/mirror/clamp)
+    struct Filter
+    {
+        size_t                          taps;
+        std::unique_ptr<size_t[]>       index;
+        std::unique_ptr<float[]>        weight;
+        std::unique_ptr<ptrdiff_t[]>    first;
+
+        Filter() noexcept : taps(0) {}
+    };
+
+    inline HRESULT _Create(_In_ size_t source, _In_ size_t dest, _In_ bool wrap, _In_ bool mirror, _In_ KERNEL kernel, _Inout_ Filter& sf) noexcept
+    {
+        assert(source > 0);
+        assert(dest > 0);
+
+        const float scale = float(source) / float(dest);
+
+        // When minifying the kernel is stretched over the source so it also acts as the low-pass filter
+        const float filterScale = std::max(1.f, scale);
+        const float support = _Support(kernel) * filterScale;
+
+        const size_t taps = size_t(ceilf(support * 2.f)) + 1;
+
+        sf.taps = taps;
+        sf.index.reset(new (std::nothrow) size_t[dest * taps]);
+        sf.weight.reset(new (std::nothrow) float[dest * taps]);
+        sf.first.reset(new (std::nothrow) ptrdiff_t[dest]);
+        if (!sf.index || !sf.weight || !sf.first)
+            return E_OUTOFMEMORY;
+
+        for (size_t u = 0; u < dest; ++u)
+        {
+            const float center = (float(u) + 0.5f) * scale;
+            const auto start = ptrdiff_t(floorf(center - support));
+
+            size_t* index = sf.index.get() + u * taps;
+            float* weight = sf.weight.get() + u * taps;
+            sf.first[u] = start;
+
+            float total = 0.f;
+            for (size_t k = 0; k < taps; ++k)
+            {
+                const ptrdiff_t isrc = start + ptrdiff_t(k);
+                const float w = _Evaluate(kernel, (float(isrc) + 0.5f - center) / filterScale);
+
+                index[k] = size_t(bounduvw(isrc, ptrdiff_t(source) - 1, wrap, mirror));
+                weight[k] = w;
+                total += w;
+            }
+
+            if (total != 0.f)
+            {
+                const float norm = 1.f / total;
+                for (size_t k = 0; k < taps; ++k)
+                {
+                    weight[k] *= norm;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+} // namespace SeparableFilter
+
 } // namespace DirectX
@@ -11,6 +11,11 @@
 // Undefine to use the (much slower) C codepath
 #define USE_SSE2
 
+// Scarlett (and any other AVX2 build) encodes two blocks per register; Xbox One stays on SSE2
+#if defined(USE_SSE2) && (defined(_GAMING_XBOX_SCARLETT) || defined(__AVX2__))
+#define USE_AVX2
+#endif
+
 namespace
 {
 #pragma pack(push,1)
@@ -47,6 +52,13 @@ namespace
     };
 
     static_assert(sizeof(BC5U) == 16, "Mismatch block size");
+
+    struct BC7
+    {
+        uint8_t bits[16];   // mode 6 only
+    };
+
+    static_assert(sizeof(BC7) == 16, "Mismatch block size");
 #pragma pack(pop)
 
     inline uint16_t ColorTo565(uint32_t color)
@@ -487,208 +499,651 @@ namespace
             resulta = _mm_or_si128( t1, t2 );                                                               \
             resulta = _mm_or_si128( resulta, t );
 
-    void CompressBC1(const Image& src, Image& dst)
+    //-----------------------------------------------------------------------------
+    // Per-block encoders (pSrc is the top-left pixel of a 16-byte aligned 4x4 block)
+    //-----------------------------------------------------------------------------
+    inline void StoreAlphaIndices(__m128i resulta, uint8_t bitmap[6])
     {
-        const uint8_t* pSource = src.pixels;
-        uint8_t* pDestination = dst.pixels;
+        auto abits = uint32_t(_mm_cvtsi128_si32(resulta));
+        bitmap[0] = abits & 0xff;
+        bitmap[1] = (abits >> 8) & 0xff;
+        bitmap[2] = (abits >> 16) & 0xff;
+
+        resulta = _mm_shuffle_epi32(resulta, _MM_SHUFFLE(1, 0, 3, 2));
+        abits = uint32_t(_mm_cvtsi128_si32(resulta));
+        bitmap[3] = abits & 0xff;
+        bitmap[4] = (abits >> 8) & 0xff;
+        bitmap[5] = (abits >> 16) & 0xff;
+    }
 
-        for (size_t j = 0; j < src.height; j += 4)
-        {
-            const uint8_t* pSrc = pSource;
-            uint8_t* pDst = pDestination;
+    void EncodeBC1Block(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        EXTRACT_BLOCK(pSrc, rowPitch)
 
-            for (size_t i = 0; i < src.width; i += 4)
-            {
-                EXTRACT_BLOCK(pSrc, src.rowPitch)
+        GET_MIN_MAX_BBOX()
 
-                GET_MIN_MAX_BBOX()
+        INSET_BC1_BBOX()
 
-                INSET_BC1_BBOX()
+        auto pBC = reinterpret_cast<BC1*>(pDst);
+        pBC->rgb[0] = ColorTo565(uint32_t(_mm_cvtsi128_si32(maxColor)));
+        pBC->rgb[1] = ColorTo565(uint32_t(_mm_cvtsi128_si32(minColor)));
 
-                auto pBC = reinterpret_cast<BC1*>(pDst);
-                pBC->rgb[0] = ColorTo565(uint32_t(_mm_cvtsi128_si32(maxColor)));
-                pBC->rgb[1] = ColorTo565(uint32_t(_mm_cvtsi128_si32(minColor)));
+        EMIT_COLOR_INDICES()
 
-                EMIT_COLOR_INDICES()
+        pBC->bitmap = uint32_t(_mm_cvtsi128_si32(result));
+    }
 
-                pBC->bitmap = uint32_t(_mm_cvtsi128_si32(result));
+    void EncodeBC3Block(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        EXTRACT_BLOCK(pSrc, rowPitch)
 
-                pSrc += 16; // 4*4 pixels
-                pDst += 8; // 8 Bytes per block
-            }
+        GET_MIN_MAX_BBOX()
 
-            pSource += src.rowPitch * 4;
-            pDestination += dst.rowPitch;
-        }
+        INSET_BC1_BBOX()
+
+        auto pBC = reinterpret_cast<BC3*>(pDst);
+
+        auto maxc = uint32_t(_mm_cvtsi128_si32(maxColor));
+        auto minc = uint32_t(_mm_cvtsi128_si32(minColor));
+
+        pBC->bc1.rgb[0] = ColorTo565(maxc);
+        uint8_t maxAlpha = (maxc >> 24) & 0xff;
+
+        pBC->bc1.rgb[1] = ColorTo565(minc);
+        uint8_t minAlpha = (minc >> 24) & 0xff;
+
+        assert(maxAlpha >= minAlpha);
+        pBC->alpha[0] = maxAlpha;
+        pBC->alpha[1] = minAlpha;
+
+        EMIT_COLOR_INDICES()
+
+        pBC->bc1.bitmap = uint32_t(_mm_cvtsi128_si32(result));
+
+        __m128i alpha0 = _mm_srli_epi32(pixels0, 24);
+        __m128i alpha1 = _mm_srli_epi32(pixels1, 24);
+        t1 = _mm_packus_epi16(alpha0, alpha1);
+
+        __m128i alpha2 = _mm_srli_epi32(pixels2, 24);
+        __m128i alpha3 = _mm_srli_epi32(pixels3, 24);
+        t2 = _mm_packus_epi16(alpha2, alpha3);
+
+        __m128i alpha = _mm_packus_epi16(t1, t2);
+
+        EMIT_ALPHA_INDICES_VARS()
+        EMIT_ALPHA_INDICES(alpha)
+
+        StoreAlphaIndices(resulta, pBC->bitmap);
     }
 
-    void CompressBC3(const Image& src, Image& dst)
+    void EncodeBC4UBlock(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
     {
-        const uint8_t* pSource = src.pixels;
-        uint8_t* pDestination = dst.pixels;
+        __declspec(align(16)) static const uint32_t s_mask[4] = { 0xff, 0xff, 0xff, 0xff };
 
-        for (size_t j = 0; j < src.height; j += 4)
-        {
-            const uint8_t* pSrc = pSource;
-            uint8_t* pDst = pDestination;
+        EXTRACT_BLOCK(pSrc, rowPitch)
 
-            for (size_t i = 0; i < src.width; i += 4)
-            {
-                EXTRACT_BLOCK(pSrc, src.rowPitch)
+        GET_MIN_MAX_BBOX()
 
-                GET_MIN_MAX_BBOX()
+        INSET_BC5_BBOX()
 
-                INSET_BC1_BBOX()
+        auto pBC = reinterpret_cast<BC4U*>(pDst);
 
-                auto pBC = reinterpret_cast<BC3*>(pDst);
-                memset(pBC, 0, sizeof(BC3));
+        // Red channel (uses the same inset as the BC5 channels)
+        uint8_t maxAlpha = uint32_t(_mm_cvtsi128_si32(maxColor)) & 0xff;
+        uint8_t minAlpha = uint32_t(_mm_cvtsi128_si32(minColor)) & 0xff;
 
-                auto maxc = uint32_t(_mm_cvtsi128_si32(maxColor));
-                auto minc = uint32_t(_mm_cvtsi128_si32(minColor));
+        assert(maxAlpha >= minAlpha);
+        pBC->red_0 = maxAlpha;
+        pBC->red_1 = minAlpha;
 
-                pBC->bc1.rgb[0] = ColorTo565(maxc);
-                uint8_t maxAlpha = (maxc >> 24) & 0xff;
+        __m128i alpha0 = _mm_and_si128(pixels0, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        __m128i alpha1 = _mm_and_si128(pixels1, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        t1 = _mm_packus_epi16(alpha0, alpha1);
 
-                pBC->bc1.rgb[1] = ColorTo565(minc);
-                uint8_t minAlpha = (minc >> 24) & 0xff;
+        __m128i alpha2 = _mm_and_si128(pixels2, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        __m128i alpha3 = _mm_and_si128(pixels3, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        t2 = _mm_packus_epi16(alpha2, alpha3);
 
-                assert(maxAlpha >= minAlpha);
-                pBC->alpha[0] = maxAlpha;
-                pBC->alpha[1] = minAlpha;
+        __m128i alpha = _mm_packus_epi16(t1, t2);
 
-                EMIT_COLOR_INDICES()
+        __m128i t;
+        EMIT_ALPHA_INDICES_VARS()
+        EMIT_ALPHA_INDICES(alpha)
 
-                pBC->bc1.bitmap = uint32_t(_mm_cvtsi128_si32(result));
+        StoreAlphaIndices(resulta, pBC->indices);
+    }
 
-                __m128i alpha0 = _mm_srli_epi32(pixels0, 24);
-                __m128i alpha1 = _mm_srli_epi32(pixels1, 24);
-                t1 = _mm_packus_epi16(alpha0, alpha1);
+    void EncodeBC5UBlock(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        __declspec(align(16)) static const uint32_t s_mask[4] = { 0xff, 0xff, 0xff, 0xff };
 
-                __m128i alpha2 = _mm_srli_epi32(pixels2, 24);
-                __m128i alpha3 = _mm_srli_epi32(pixels3, 24);
-                t2 = _mm_packus_epi16(alpha2, alpha3);
+        EXTRACT_BLOCK(pSrc, rowPitch)
 
-                __m128i alpha = _mm_packus_epi16(t1, t2);
+        GET_MIN_MAX_BBOX()
 
-                EMIT_ALPHA_INDICES_VARS()
-                EMIT_ALPHA_INDICES(alpha)
+        INSET_BC5_BBOX()
 
-                auto abits = uint32_t(_mm_cvtsi128_si32(resulta));
-                pBC->bitmap[0] = abits & 0xff;
-                pBC->bitmap[1] = (abits >> 8) & 0xff;
-                pBC->bitmap[2] = (abits >> 16) & 0xff;
+        auto pBC = reinterpret_cast<BC5U*>(pDst);
 
-                resulta = _mm_shuffle_epi32(resulta, _MM_SHUFFLE(1, 0, 3, 2));
-                abits = uint32_t(_mm_cvtsi128_si32(resulta));
-                pBC->bitmap[3] = abits & 0xff;
-                pBC->bitmap[4] = (abits >> 8) & 0xff;
-                pBC->bitmap[5] = (abits >> 16) & 0xff;
+        auto maxc = uint32_t(_mm_cvtsi128_si32(maxColor));
+        auto minc = uint32_t(_mm_cvtsi128_si32(minColor));
 
-                pSrc += 16; // 4*4 pixels
-                pDst += 16; // 16 Bytes per block
-            }
+        // X channel
+        uint8_t maxAlpha = maxc & 0xff;
+        uint8_t minAlpha = minc & 0xff;
 
-            pSource += src.rowPitch * 4;
-            pDestination += dst.rowPitch;
+        assert(maxAlpha >= minAlpha);
+        pBC->x.red_0 = maxAlpha;
+        pBC->x.red_1 = minAlpha;
+
+        __m128i alpha0 = _mm_and_si128(pixels0, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        __m128i alpha1 = _mm_and_si128(pixels1, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        t1 = _mm_packus_epi16(alpha0, alpha1);
+
+        __m128i alpha2 = _mm_and_si128(pixels2, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        __m128i alpha3 = _mm_and_si128(pixels3, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        t2 = _mm_packus_epi16(alpha2, alpha3);
+
+        __m128i alpha = _mm_packus_epi16(t1, t2);
+
+        __m128i t;
+        EMIT_ALPHA_INDICES_VARS()
+        EMIT_ALPHA_INDICES(alpha)
+
+        StoreAlphaIndices(resulta, pBC->x.indices);
+
+        // Y channel
+        maxAlpha = (maxc >> 8) & 0xff;
+        minAlpha = (minc >> 8) & 0xff;
+
+        assert(maxAlpha >= minAlpha);
+        pBC->y.red_0 = maxAlpha;
+        pBC->y.red_1 = minAlpha;
+
+        alpha0 = _mm_srli_epi32(pixels0, 8);
+        alpha1 = _mm_srli_epi32(pixels1, 8);
+        alpha0 = _mm_and_si128(alpha0, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        alpha1 = _mm_and_si128(alpha1, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        t1 = _mm_packus_epi16(alpha0, alpha1);
+
+        alpha2 = _mm_srli_epi32(pixels2, 8);
+        alpha3 = _mm_srli_epi32(pixels3, 8);
+        alpha2 = _mm_and_si128(alpha2, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        alpha3 = _mm_and_si128(alpha3, reinterpret_cast<const __m128i*>(s_mask)[0]);
+        t2 = _mm_packus_epi16(alpha2, alpha3);
+
+        alpha = _mm_packus_epi16(t1, t2);
+
+        EMIT_ALPHA_INDICES(alpha)
+
+        StoreAlphaIndices(resulta, pBC->y.indices);
+    }
+
+#ifdef USE_AVX2
+
+    //-----------------------------------------------------------------------------
+    // AVX2 version (two blocks per register)
+    //
+    // Every step of the SSE2 encoder above stays within a 128-bit lane, so running it
+    // with each lane of a 256-bit register holding its own 4x4 block produces
+    // bit-identical output for two blocks at a time.
+    //-----------------------------------------------------------------------------
+    struct BlockPair
+    {
+        __m256i pixels[4];
+        __m256i minColor;
+        __m256i maxColor;
+    };
+
+    inline void LoadBlockPair(const uint8_t* pSrc, size_t rowPitch, BlockPair& pair)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            pair.pixels[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + j * rowPitch));
         }
+
+        __m256i minColor = _mm256_min_epu8(pair.pixels[0], pair.pixels[1]);
+        __m256i maxColor = _mm256_max_epu8(pair.pixels[0], pair.pixels[1]);
+
+        minColor = _mm256_min_epu8(minColor, pair.pixels[2]);
+        maxColor = _mm256_max_epu8(maxColor, pair.pixels[2]);
+
+        minColor = _mm256_min_epu8(minColor, pair.pixels[3]);
+        maxColor = _mm256_max_epu8(maxColor, pair.pixels[3]);
+
+        __m256i t1 = _mm256_shuffle_epi32(minColor, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256i t2 = _mm256_shuffle_epi32(maxColor, _MM_SHUFFLE(3, 2, 3, 2));
+        minColor = _mm256_min_epu8(minColor, t1);
+        maxColor = _mm256_max_epu8(maxColor, t2);
+
+        t1 = _mm256_shufflelo_epi16(minColor, _MM_SHUFFLE(3, 2, 3, 2));
+        t2 = _mm256_shufflelo_epi16(maxColor, _MM_SHUFFLE(3, 2, 3, 2));
+        pair.minColor = _mm256_min_epu8(minColor, t1);
+        pair.maxColor = _mm256_max_epu8(maxColor, t2);
     }
 
-    void CompressBC5U(const Image& src, Image& dst)
+    inline void InsetBC1Pair(BlockPair& pair)
     {
-        __declspec(align(16)) static const uint32_t s_mask[4] = { 0xff, 0xff, 0xff, 0xff };
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i minColor = _mm256_unpacklo_epi8(pair.minColor, zero);
+        __m256i maxColor = _mm256_unpacklo_epi8(pair.maxColor, zero);
 
-        const uint8_t* pSource = src.pixels;
-        uint8_t* pDestination = dst.pixels;
+        const __m256i inset = _mm256_srli_epi16(_mm256_sub_epi16(maxColor, minColor), 4);
 
-        for (size_t j = 0; j < src.height; j += 4)
+        minColor = _mm256_add_epi16(minColor, inset);
+        maxColor = _mm256_sub_epi16(maxColor, inset);
+
+        pair.minColor = _mm256_packus_epi16(minColor, minColor);
+        pair.maxColor = _mm256_packus_epi16(maxColor, maxColor);
+    }
+
+    inline void InsetBC5Pair(BlockPair& pair)
+    {
+        const __m256i round = _mm256_setr_epi16(15, 15, 0, 0, 0, 0, 0, 0, 15, 15, 0, 0, 0, 0, 0, 0);
+        const __m256i mask = _mm256_setr_epi16(-1, -1, 0, 0, 0, 0, 0, 0, -1, -1, 0, 0, 0, 0, 0, 0);
+        const __m256i shiftUp = _mm256_setr_epi16(32, 32, 1, 1, 1, 1, 1, 1, 32, 32, 1, 1, 1, 1, 1, 1);
+        const __m256i shiftDown = _mm256_setr_epi16(2048, 2048, 0, 0, 0, 0, 0, 0, 2048, 2048, 0, 0, 0, 0, 0, 0);
+
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i minColor = _mm256_unpacklo_epi8(pair.minColor, zero);
+        __m256i maxColor = _mm256_unpacklo_epi8(pair.maxColor, zero);
+
+        __m256i t = _mm256_sub_epi16(maxColor, minColor);
+        t = _mm256_sub_epi16(t, round);
+        t = _mm256_and_si256(t, mask);
+
+        minColor = _mm256_mullo_epi16(minColor, shiftUp);
+        maxColor = _mm256_mullo_epi16(maxColor, shiftUp);
+
+        minColor = _mm256_add_epi16(minColor, t);
+        maxColor = _mm256_add_epi16(maxColor, t);
+
+        minColor = _mm256_mulhi_epi16(minColor, shiftDown);
+        maxColor = _mm256_mulhi_epi16(maxColor, shiftDown);
+
+        minColor = _mm256_max_epi16(minColor, zero);
+        maxColor = _mm256_max_epi16(maxColor, zero);
+
+        pair.minColor = _mm256_packus_epi16(minColor, minColor);
+        pair.maxColor = _mm256_packus_epi16(maxColor, maxColor);
+    }
+
+    // Expands the 565-quantized endpoint back to 8:8:8 as 16-bit words
+    inline __m256i ExpandColorPair(__m256i color)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i colorMask = _mm256_set1_epi64x(0x00F8FCF8);
+
+        color = _mm256_and_si256(color, colorMask);
+        color = _mm256_unpacklo_epi8(color, zero);
+        __m256i t1 = _mm256_shufflelo_epi16(color, _MM_SHUFFLE(3, 2, 3, 0));
+        __m256i t2 = _mm256_shufflelo_epi16(color, _MM_SHUFFLE(3, 3, 1, 3));
+        t1 = _mm256_srli_epi16(t1, 5);
+        t2 = _mm256_srli_epi16(t2, 6);
+        color = _mm256_or_si256(color, t1);
+        return _mm256_or_si256(color, t2);
+    }
+
+    // Sums of absolute differences between the pixels of one block row and each palette color
+    inline void RowDistancesPair(__m256i row, const __m256i colors[4], __m256i d[4])
+    {
+        const __m256i zero = _mm256_setzero_si256();
+
+        __m256i c1 = _mm256_unpacklo_epi64(row, zero);
+        __m256i c2 = _mm256_unpackhi_epi64(row, zero);
+
+        c1 = _mm256_shuffle_epi32(c1, _MM_SHUFFLE(3, 1, 2, 0));
+        c2 = _mm256_shuffle_epi32(c2, _MM_SHUFFLE(3, 1, 2, 0));
+
+        for (size_t k = 0; k < 4; ++k)
         {
-            const uint8_t* pSrc = pSource;
-            uint8_t* pDst = pDestination;
+            d[k] = _mm256_packs_epi32(_mm256_sad_epu8(c1, colors[k]), _mm256_sad_epu8(c2, colors[k]));
+        }
+    }
 
-            for (size_t i = 0; i < src.width; i += 4)
+    // 2-bit indices for two block rows, with the second row in the upper byte of each dword
+    inline __m256i RowIndicesPair(__m256i rowA, __m256i rowB, const __m256i colors[4])
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i word1 = _mm256_set1_epi16(1);
+        const __m256i word2 = _mm256_set1_epi16(2);
+
+        __m256i d[4];
+        __m256i e[4];
+        RowDistancesPair(rowA, colors, d);
+        RowDistancesPair(rowB, colors, e);
+
+        const __m256i d0 = _mm256_packs_epi32(d[0], e[0]);
+        const __m256i d1 = _mm256_packs_epi32(d[1], e[1]);
+        const __m256i d2 = _mm256_packs_epi32(d[2], e[2]);
+        const __m256i d3 = _mm256_packs_epi32(d[3], e[3]);
+
+        const __m256i b0 = _mm256_cmpgt_epi16(d0, d3);
+        const __m256i b1 = _mm256_cmpgt_epi16(d1, d2);
+        const __m256i b2 = _mm256_cmpgt_epi16(d0, d2);
+        const __m256i b3 = _mm256_cmpgt_epi16(d1, d3);
+        const __m256i b4 = _mm256_cmpgt_epi16(d2, d3);
+
+        const __m256i x0 = _mm256_and_si256(b2, b1);
+        const __m256i x1 = _mm256_and_si256(b3, b0);
+        const __m256i x2 = _mm256_and_si256(b4, b0);
+
+        __m256i r = _mm256_or_si256(x0, x1);
+        __m256i t1 = _mm256_and_si256(x2, word1);
+        __m256i t2 = _mm256_and_si256(r, word2);
+        r = _mm256_or_si256(t1, t2);
+
+        t1 = _mm256_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2));
+
+        r = _mm256_unpacklo_epi16(r, zero);
+        t1 = _mm256_unpacklo_epi16(t1, zero);
+        t1 = _mm256_slli_epi32(t1, 8);
+
+        return _mm256_or_si256(t1, r);
+    }
+
+    // Returns the BC1 bitmap of each block in the low dword of its lane
+    inline __m256i EmitColorIndicesPair(const BlockPair& pair)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i div3 = _mm256_set1_epi16((1 << 16) / 3 + 1);
+
+        const __m256i maxColor = ExpandColorPair(pair.maxColor);
+        const __m256i minColor = ExpandColorPair(pair.minColor);
+
+        __m256i colors[4];
+        colors[0] = _mm256_shuffle_epi32(_mm256_packus_epi16(maxColor, zero), _MM_SHUFFLE(1, 0, 1, 0));
+        colors[1] = _mm256_shuffle_epi32(_mm256_packus_epi16(minColor, zero), _MM_SHUFFLE(1, 0, 1, 0));
+
+        __m256i color2 = _mm256_add_epi16(maxColor, maxColor);
+        color2 = _mm256_add_epi16(color2, minColor);
+        color2 = _mm256_mulhi_epi16(color2, div3);
+        colors[2] = _mm256_shuffle_epi32(_mm256_packus_epi16(color2, zero), _MM_SHUFFLE(1, 0, 1, 0));
+
+        __m256i color3 = _mm256_add_epi16(minColor, minColor);
+        color3 = _mm256_add_epi16(color3, maxColor);
+        color3 = _mm256_mulhi_epi16(color3, div3);
+        colors[3] = _mm256_shuffle_epi32(_mm256_packus_epi16(color3, zero), _MM_SHUFFLE(1, 0, 1, 0));
+
+        __m256i result = _mm256_slli_epi32(RowIndicesPair(pair.pixels[2], pair.pixels[3], colors), 16);
+        result = _mm256_or_si256(result, RowIndicesPair(pair.pixels[0], pair.pixels[1], colors));
+
+        __m256i t = _mm256_shuffle_epi32(result, _MM_SHUFFLE(0, 3, 2, 1));
+        __m256i t1 = _mm256_shuffle_epi32(result, _MM_SHUFFLE(1, 0, 3, 2));
+        __m256i t2 = _mm256_shuffle_epi32(result, _MM_SHUFFLE(2, 1, 0, 3));
+
+        t = _mm256_slli_epi32(t, 2);
+        t1 = _mm256_slli_epi32(t1, 4);
+        t2 = _mm256_slli_epi32(t2, 6);
+
+        result = _mm256_or_si256(result, t);
+        result = _mm256_or_si256(result, t1);
+        return _mm256_or_si256(result, t2);
+    }
+
+    // Gathers one 8-bit channel of both blocks as 16 bytes per lane
+    inline __m256i ExtractChannelPair(const BlockPair& pair, int shift)
+    {
+        const __m256i mask = _mm256_set1_epi32(0xff);
+
+        const __m256i c0 = _mm256_and_si256(_mm256_srli_epi32(pair.pixels[0], shift), mask);
+        const __m256i c1 = _mm256_and_si256(_mm256_srli_epi32(pair.pixels[1], shift), mask);
+        const __m256i c2 = _mm256_and_si256(_mm256_srli_epi32(pair.pixels[2], shift), mask);
+        const __m256i c3 = _mm256_and_si256(_mm256_srli_epi32(pair.pixels[3], shift), mask);
+
+        return _mm256_packus_epi16(_mm256_packus_epi16(c0, c1), _mm256_packus_epi16(c2, c3));
+    }
+
+    // Broadcasts one byte of each lane's endpoint color to all 16-bit words of that lane
+    inline __m256i BroadcastChannelPair(__m256i color, char channel)
+    {
+        const char z = char(0x80);
+        const __m256i control = _mm256_setr_epi8(
+            channel, z, channel, z, channel, z, channel, z, channel, z, channel, z, channel, z, channel, z,
+            channel, z, channel, z, channel, z, channel, z, channel, z, channel, z, channel, z, channel, z);
+        return _mm256_shuffle_epi8(color, control);
+    }
+
+    // Returns the 3-bit indices of each block as 24 bits in dwords 0 and 2 of its lane
+    inline __m256i EmitAlphaIndicesPair(__m256i alpha, __m256i mina, __m256i maxa)
+    {
+        const __m256i byte1 = _mm256_set1_epi8(1);
+        const __m256i byte2 = _mm256_set1_epi8(2);
+        const __m256i byte7 = _mm256_set1_epi8(7);
+        const __m256i div7 = _mm256_set1_epi16((1 << 16) / 7 + 1);
+        const __m256i div14 = _mm256_set1_epi16((1 << 16) / 14 + 1);
+        const __m256i scaleA = _mm256_setr_epi16(6, 6, 5, 5, 4, 4, 0, 0, 6, 6, 5, 5, 4, 4, 0, 0);
+        const __m256i scaleB = _mm256_setr_epi16(1, 1, 2, 2, 3, 3, 0, 0, 1, 1, 2, 2, 3, 3, 0, 0);
+
+        const __m256i mid = _mm256_sub_epi16(maxa, mina);
+        const __m256i mid_div_14 = _mm256_mulhi_epi16(mid, div14);
+
+        __m256i ab[8];
+        ab[1] = _mm256_add_epi16(mid_div_14, mina);
+        ab[1] = _mm256_packus_epi16(ab[1], ab[1]);
+
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(maxa, scaleA), _mm256_mullo_epi16(mina, scaleB));
+        t = _mm256_mulhi_epi16(t, div7);
+        t = _mm256_add_epi16(t, mid_div_14);
+
+        ab[2] = _mm256_shuffle_epi32(t, _MM_SHUFFLE(0, 0, 0, 0));
+        ab[3] = _mm256_shuffle_epi32(t, _MM_SHUFFLE(1, 1, 1, 1));
+        ab[4] = _mm256_shuffle_epi32(t, _MM_SHUFFLE(2, 2, 2, 2));
+
+        t = _mm256_add_epi16(_mm256_mullo_epi16(maxa, scaleB), _mm256_mullo_epi16(mina, scaleA));
+        t = _mm256_mulhi_epi16(t, div7);
+        t = _mm256_add_epi16(t, mid_div_14);
+
+        ab[5] = _mm256_shuffle_epi32(t, _MM_SHUFFLE(2, 2, 2, 2));
+        ab[6] = _mm256_shuffle_epi32(t, _MM_SHUFFLE(1, 1, 1, 1));
+        ab[7] = _mm256_shuffle_epi32(t, _MM_SHUFFLE(0, 0, 0, 0));
+
+        for (size_t k = 1; k < 8; ++k)
+        {
+            if (k > 1)
             {
-                EXTRACT_BLOCK(pSrc, src.rowPitch)
+                ab[k] = _mm256_packus_epi16(ab[k], ab[k]);
+            }
 
-                GET_MIN_MAX_BBOX()
+            ab[k] = _mm256_min_epu8(ab[k], alpha);
+            ab[k] = _mm256_cmpeq_epi8(ab[k], alpha);
+            ab[k] = _mm256_and_si256(ab[k], byte1);
+        }
 
-                INSET_BC5_BBOX()
+        __m256i t1 = _mm256_adds_epu8(ab[1], byte1);
+        __m256i t2 = _mm256_adds_epu8(ab[2], ab[3]);
+        t = _mm256_adds_epu8(t1, t2);
 
-                auto pBC = reinterpret_cast<BC5U*>(pDst);
-                memset(pBC, 0, sizeof(BC5U));
+        t1 = _mm256_adds_epu8(ab[4], ab[5]);
+        t2 = _mm256_adds_epu8(ab[6], ab[7]);
+        __m256i resulta = _mm256_adds_epu8(t1, t2);
 
-                auto maxc = uint32_t(_mm_cvtsi128_si32(maxColor));
-                auto minc = uint32_t(_mm_cvtsi128_si32(minColor));
+        resulta = _mm256_adds_epu8(resulta, t);
+        resulta = _mm256_and_si256(resulta, byte7);
 
-                // X channel
-                uint8_t maxAlpha = maxc & 0xff;
-                uint8_t minAlpha = minc & 0xff;
+        t = _mm256_cmpgt_epi8(byte2, resulta);
+        t = _mm256_and_si256(t, byte1);
 
-                assert(maxAlpha >= minAlpha);
-                pBC->x.red_0 = maxAlpha;
-                pBC->x.red_1 = minAlpha;
+        resulta = _mm256_xor_si256(resulta, t);
 
-                __m128i alpha0 = _mm_and_si128(pixels0, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                __m128i alpha1 = _mm_and_si128(pixels1, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                t1 = _mm_packus_epi16(alpha0, alpha1);
+        // Pack the eight 3-bit indices in each 64-bit half into its low 24 bits
+        __m256i bits = _mm256_and_si256(resulta, _mm256_set1_epi64x(7));
+        bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 8 - 3), _mm256_set1_epi64x(7 << 3)));
+        bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 16 - 6), _mm256_set1_epi64x(7 << 6)));
+        bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 24 - 9), _mm256_set1_epi64x(7 << 9)));
+        bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 32 - 12), _mm256_set1_epi64x(7 << 12)));
+        bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 40 - 15), _mm256_set1_epi64x(7 << 15)));
+        bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 48 - 18), _mm256_set1_epi64x(7 << 18)));
+        return _mm256_or_si256(bits, _mm256_and_si256(_mm256_srli_epi64(resulta, 56 - 21), _mm256_set1_epi64x(7 << 21)));
+    }
 
-                __m128i alpha2 = _mm_and_si128(pixels2, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                __m128i alpha3 = _mm_and_si128(pixels3, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                t2 = _mm_packus_epi16(alpha2, alpha3);
+    inline void StoreAlphaIndices(const uint32_t abits[8], size_t lane, uint8_t bitmap[6])
+    {
+        const uint32_t lo = abits[lane * 4];
+        const uint32_t hi = abits[lane * 4 + 2];
+
+        bitmap[0] = lo & 0xff;
+        bitmap[1] = (lo >> 8) & 0xff;
+        bitmap[2] = (lo >> 16) & 0xff;
+        bitmap[3] = hi & 0xff;
+        bitmap[4] = (hi >> 8) & 0xff;
+        bitmap[5] = (hi >> 16) & 0xff;
+    }
 
-                __m128i alpha = _mm_packus_epi16(t1, t2);
+    //-----------------------------------------------------------------------------
+    // Pair encoders (pSrc is the top-left pixel of two horizontally adjacent blocks)
+    //-----------------------------------------------------------------------------
+    void EncodeBC1Pair(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        BlockPair pair;
+        LoadBlockPair(pSrc, rowPitch, pair);
+        InsetBC1Pair(pair);
+
+        alignas(32) uint32_t maxc[8];
+        alignas(32) uint32_t minc[8];
+        alignas(32) uint32_t bitmap[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxc), pair.maxColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(minc), pair.minColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(bitmap), EmitColorIndicesPair(pair));
+
+        auto pBC = reinterpret_cast<BC1*>(pDst);
+        for (size_t lane = 0; lane < 2; ++lane, ++pBC)
+        {
+            pBC->rgb[0] = ColorTo565(maxc[lane * 4]);
+            pBC->rgb[1] = ColorTo565(minc[lane * 4]);
+            pBC->bitmap = bitmap[lane * 4];
+        }
+    }
 
-                __m128i t;
-                EMIT_ALPHA_INDICES_VARS()
-                EMIT_ALPHA_INDICES(alpha)
+    void EncodeBC3Pair(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        BlockPair pair;
+        LoadBlockPair(pSrc, rowPitch, pair);
+        InsetBC1Pair(pair);
+
+        const __m256i alpha = ExtractChannelPair(pair, 24);
+        const __m256i resulta = EmitAlphaIndicesPair(alpha, BroadcastChannelPair(pair.minColor, 3), BroadcastChannelPair(pair.maxColor, 3));
+
+        alignas(32) uint32_t maxc[8];
+        alignas(32) uint32_t minc[8];
+        alignas(32) uint32_t bitmap[8];
+        alignas(32) uint32_t abits[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxc), pair.maxColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(minc), pair.minColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(bitmap), EmitColorIndicesPair(pair));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(abits), resulta);
+
+        auto pBC = reinterpret_cast<BC3*>(pDst);
+        for (size_t lane = 0; lane < 2; ++lane, ++pBC)
+        {
+            pBC->bc1.rgb[0] = ColorTo565(maxc[lane * 4]);
+            pBC->bc1.rgb[1] = ColorTo565(minc[lane * 4]);
+            pBC->bc1.bitmap = bitmap[lane * 4];
 
-                auto abits = uint32_t(_mm_cvtsi128_si32(resulta));
-                pBC->x.indices[0] = abits & 0xff;
-                pBC->x.indices[1] = (abits >> 8) & 0xff;
-                pBC->x.indices[2] = (abits >> 16) & 0xff;
+            pBC->alpha[0] = (maxc[lane * 4] >> 24) & 0xff;
+            pBC->alpha[1] = (minc[lane * 4] >> 24) & 0xff;
+            StoreAlphaIndices(abits, lane, pBC->bitmap);
+        }
+    }
 
-                resulta = _mm_shuffle_epi32(resulta, _MM_SHUFFLE(1, 0, 3, 2));
-                abits = uint32_t(_mm_cvtsi128_si32(resulta));
-                pBC->x.indices[3] = abits & 0xff;
-                pBC->x.indices[4] = (abits >> 8) & 0xff;
-                pBC->x.indices[5] = (abits >> 16) & 0xff;
+    void EncodeBC4UPair(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        BlockPair pair;
+        LoadBlockPair(pSrc, rowPitch, pair);
+        InsetBC5Pair(pair);
+
+        const __m256i red = ExtractChannelPair(pair, 0);
+        const __m256i resulta = EmitAlphaIndicesPair(red, BroadcastChannelPair(pair.minColor, 0), BroadcastChannelPair(pair.maxColor, 0));
+
+        alignas(32) uint32_t maxc[8];
+        alignas(32) uint32_t minc[8];
+        alignas(32) uint32_t abits[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxc), pair.maxColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(minc), pair.minColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(abits), resulta);
+
+        auto pBC = reinterpret_cast<BC4U*>(pDst);
+        for (size_t lane = 0; lane < 2; ++lane, ++pBC)
+        {
+            pBC->red_0 = maxc[lane * 4] & 0xff;
+            pBC->red_1 = minc[lane * 4] & 0xff;
+            StoreAlphaIndices(abits, lane, pBC->indices);
+        }
+    }
 
-                // Y channel
-                maxAlpha = (maxc >> 8) & 0xff;
-                minAlpha = (minc >> 8) & 0xff;
+    void EncodeBC5UPair(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        BlockPair pair;
+        LoadBlockPair(pSrc, rowPitch, pair);
+        InsetBC5Pair(pair);
+
+        const __m256i x = ExtractChannelPair(pair, 0);
+        const __m256i y = ExtractChannelPair(pair, 8);
+
+        alignas(32) uint32_t maxc[8];
+        alignas(32) uint32_t minc[8];
+        alignas(32) uint32_t xbits[8];
+        alignas(32) uint32_t ybits[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxc), pair.maxColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(minc), pair.minColor);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(xbits),
+            EmitAlphaIndicesPair(x, BroadcastChannelPair(pair.minColor, 0), BroadcastChannelPair(pair.maxColor, 0)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(ybits),
+            EmitAlphaIndicesPair(y, BroadcastChannelPair(pair.minColor, 1), BroadcastChannelPair(pair.maxColor, 1)));
+
+        auto pBC = reinterpret_cast<BC5U*>(pDst);
+        for (size_t lane = 0; lane < 2; ++lane, ++pBC)
+        {
+            pBC->x.red_0 = maxc[lane * 4] & 0xff;
+            pBC->x.red_1 = minc[lane * 4] & 0xff;
+            StoreAlphaIndices(xbits, lane, pBC->x.indices);
 
-                assert(maxAlpha >= minAlpha);
-                pBC->y.red_0 = maxAlpha;
-                pBC->y.red_1 = minAlpha;
+            pBC->y.red_0 = (maxc[lane * 4] >> 8) & 0xff;
+            pBC->y.red_1 = (minc[lane * 4] >> 8) & 0xff;
+            StoreAlphaIndices(ybits, lane, pBC->y.indices);
+        }
+    }
 
-                alpha0 = _mm_srli_epi32(pixels0, 8);
-                alpha1 = _mm_srli_epi32(pixels1, 8);
-                alpha0 = _mm_and_si128(alpha0, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                alpha1 = _mm_and_si128(alpha1, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                t1 = _mm_packus_epi16(alpha0, alpha1);
+    //-----------------------------------------------------------------------------
+    // Encodes 8 blocks (four register pairs) per iteration, finishing the row with
+    // single pairs and then the SSE2 encoder for an odd final block.
+    //-----------------------------------------------------------------------------
+    template<size_t BlockSize,
+        void(*EncodePair)(const uint8_t*, size_t, uint8_t*),
+        void(*EncodeBlock)(const uint8_t*, size_t, uint8_t*)>
+    void CompressBlockPairs(const Image& src, Image& dst)
+    {
+        const uint8_t* pSource = src.pixels;
+        uint8_t* pDestination = dst.pixels;
 
-                alpha2 = _mm_srli_epi32(pixels2, 8);
-                alpha3 = _mm_srli_epi32(pixels3, 8);
-                alpha2 = _mm_and_si128(alpha2, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                alpha3 = _mm_and_si128(alpha3, reinterpret_cast<const __m128i*>(s_mask)[0]);
-                t2 = _mm_packus_epi16(alpha2, alpha3);
+        for (size_t j = 0; j < src.height; j += 4)
+        {
+            const uint8_t* pSrc = pSource;
+            uint8_t* pDst = pDestination;
 
-                alpha = _mm_packus_epi16(t1, t2);
+            size_t i = 0;
+            for (; i + 32 <= src.width; i += 32)
+            {
+                EncodePair(pSrc, src.rowPitch, pDst);
+                EncodePair(pSrc + 32, src.rowPitch, pDst + BlockSize * 2);
+                EncodePair(pSrc + 64, src.rowPitch, pDst + BlockSize * 4);
+                EncodePair(pSrc + 96, src.rowPitch, pDst + BlockSize * 6);
 
-                EMIT_ALPHA_INDICES(alpha)
+                pSrc += 128; // 8 blocks of 4*4 pixels
+                pDst += BlockSize * 8;
+            }
 
-                abits = uint32_t(_mm_cvtsi128_si32(resulta));
-                pBC->y.indices[0] = abits & 0xff;
-                pBC->y.indices[1] = (abits >> 8) & 0xff;
-                pBC->y.indices[2] = (abits >> 16) & 0xff;
+            for (; i + 8 <= src.width; i += 8)
+            {
+                EncodePair(pSrc, src.rowPitch, pDst);
 
-                resulta = _mm_shuffle_epi32(resulta, _MM_SHUFFLE(1, 0, 3, 2));
-                abits = uint32_t(_mm_cvtsi128_si32(resulta));
-                pBC->y.indices[3] = abits & 0xff;
-                pBC->y.indices[4] = (abits >> 8) & 0xff;
-                pBC->y.indices[5] = (abits >> 16) & 0xff;
+                pSrc += 32;
+                pDst += BlockSize * 2;
+            }
 
-                pSrc += 16; // 4*4 pixels
-                pDst += 16; // 16 Bytes per block
+            if (i < src.width)
+            {
+                EncodeBlock(pSrc, src.rowPitch, pDst);
             }
 
             pSource += src.rowPitch * 4;
@@ -696,6 +1151,8 @@ namespace
         }
     }
 
+#endif // USE_AVX2
+
 #else // !USE_SSE2
 
     //-----------------------------------------------------------------------------
@@ -887,86 +1344,252 @@ namespace
     }
 
     //-----------------------------------------------------------------------------
-    void CompressBC1(const Image& src, Image& dst)
+    void EncodeBC1Block(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
     {
         uint8_t pixels[16 * 4];
+        ExtractBlock(pSrc, rowPitch, pixels);
 
-        const uint8_t* pSource = src.pixels;
-        uint8_t* pDestination = dst.pixels;
+        uint32_t minColor, maxColor;
+        GetMinMaxColors(pixels, minColor, maxColor);
 
-        for (size_t j = 0; j < src.height; j += 4)
-        {
-            const uint8_t* pSrc = pSource;
-            uint8_t* pDst = pDestination;
+        auto pBC = reinterpret_cast<BC1*>(pDst);
+        pBC->rgb[0] = ColorTo565(maxColor);
+        pBC->rgb[1] = ColorTo565(minColor);
 
-            for (size_t i = 0; i < src.width; i += 4)
-            {
-                ExtractBlock(pSrc, src.rowPitch, pixels);
+        pBC->bitmap = EmitColorIndices(pixels, minColor, maxColor);
+    }
 
-                uint32_t minColor, maxColor;
-                GetMinMaxColors(pixels, minColor, maxColor);
+    //-----------------------------------------------------------------------------
+    void EncodeBC3Block(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        uint8_t pixels[16 * 4];
+        ExtractBlock(pSrc, rowPitch, pixels);
 
-                auto pBC = reinterpret_cast<BC1*>(pDst);
-                pBC->rgb[0] = ColorTo565(maxColor);
-                pBC->rgb[1] = ColorTo565(minColor);
+        uint32_t minColor, maxColor;
+        GetMinMaxColors(pixels, minColor, maxColor);
 
-                pBC->bitmap = EmitColorIndices(pixels, minColor, maxColor);
+        auto pBC = reinterpret_cast<BC3*>(pDst);
+        pBC->bc1.rgb[0] = ColorTo565(maxColor);
+        pBC->bc1.rgb[1] = ColorTo565(minColor);
+        pBC->bc1.bitmap = EmitColorIndices(pixels, minColor, maxColor);
 
-                pSrc += 16; // 4*4 pixels
-                pDst += 8; // 8 Bytes per block
-            }
+        uint8_t minAlpha = (minColor >> 24) & 0xff;
+        uint8_t maxAlpha = (maxColor >> 24) & 0xff;
 
-            pSource += src.rowPitch * 4;
-            pDestination += dst.rowPitch;
-        }
+        pBC->alpha[0] = maxAlpha;
+        pBC->alpha[1] = minAlpha;
+        EmitAlphaIndices(pixels, 3, minAlpha, maxAlpha, pBC->bitmap);
     }
 
     //-----------------------------------------------------------------------------
-    void CompressBC3(const Image& src, Image& dst)
+    void EncodeBC4UBlock(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
     {
         uint8_t pixels[16 * 4];
+        ExtractBlock(pSrc, rowPitch, pixels);
 
-        const uint8_t* pSource = src.pixels;
-        uint8_t* pDestination = dst.pixels;
+        uint8_t minX, minY, maxX, maxY;
+        GetMinMaxNormals(pixels, minX, maxX, minY, maxY);
 
-        for (size_t j = 0; j < src.height; j += 4)
+        auto pBC = reinterpret_cast<BC4U*>(pDst);
+        pBC->red_0 = maxX;
+        pBC->red_1 = minX;
+        EmitAlphaIndices(pixels, 0, minX, maxX, pBC->indices);
+    }
+
+    //-----------------------------------------------------------------------------
+    void EncodeBC5UBlock(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        uint8_t pixels[16 * 4];
+        ExtractBlock(pSrc, rowPitch, pixels);
+
+        uint8_t minX, minY, maxX, maxY;
+        GetMinMaxNormals(pixels, minX, maxX, minY, maxY);
+
+        auto pBC = reinterpret_cast<BC5U*>(pDst);
+        pBC->x.red_0 = maxX;
+        pBC->x.red_1 = minX;
+        EmitAlphaIndices(pixels, 0, minX, maxX, pBC->x.indices);
+
+        pBC->y.red_0 = maxY;
+        pBC->y.red_1 = minY;
+        EmitAlphaIndices(pixels, 1, minY, maxY, pBC->y.indices);
+    }
+
+#endif // !USE_SSE2
+
+    //-----------------------------------------------------------------------------
+    // BC7 (mode 6 only)
+    //
+    // Mode 6 is a single RGBA line with 7-bit endpoints, a p-bit per endpoint and
+    // 4-bit indices, so it encodes with the same inset bounding-box fit as BC1/BC3.
+    // The box diagonal is chosen from the sign of each channel's covariance with the
+    // channel of largest range.
+    //-----------------------------------------------------------------------------
+    void PutBits(uint64_t bits[2], size_t& pos, uint32_t value, size_t count)
+    {
+        if (pos < 64)
         {
-            const uint8_t* pSrc = pSource;
-            uint8_t* pDst = pDestination;
+            bits[0] |= uint64_t(value) << pos;
+            if (pos + count > 64)
+            {
+                bits[1] |= uint64_t(value) >> (64 - pos);
+            }
+        }
+        else
+        {
+            bits[1] |= uint64_t(value) << (pos - 64);
+        }
 
-            for (size_t i = 0; i < src.width; i += 4)
+        pos += count;
+    }
+
+    void EncodeBC7Block(const uint8_t* pSrc, size_t rowPitch, uint8_t* pDst)
+    {
+        // Inset bounding-box
+        static const int INSET_SHIFT = 4;
+
+        int pixels[16][4];
+        int minc[4] = { 255, 255, 255, 255 };
+        int maxc[4] = { 0, 0, 0, 0 };
+        int sum[4] = { 0, 0, 0, 0 };
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const uint8_t* row = pSrc + j * rowPitch;
+            for (size_t i = 0; i < 16; ++i)
             {
-                ExtractBlock(pSrc, src.rowPitch, pixels);
+                const int value = row[i];
+                const size_t c = i & 3;
+                pixels[j * 4 + (i >> 2)][c] = value;
+                minc[c] = std::min(minc[c], value);
+                maxc[c] = std::max(maxc[c], value);
+                sum[c] += value;
+            }
+        }
 
-                uint32_t minColor, maxColor;
-                GetMinMaxColors(pixels, minColor, maxColor);
+        size_t axis = 0;
+        for (size_t c = 1; c < 4; ++c)
+        {
+            if ((maxc[c] - minc[c]) > (maxc[axis] - minc[axis]))
+                axis = c;
+        }
 
-                auto pBC = reinterpret_cast<BC3*>(pDst);
-                pBC->bc1.rgb[0] = ColorTo565(maxColor);
-                pBC->bc1.rgb[1] = ColorTo565(minColor);
-                pBC->bc1.bitmap = EmitColorIndices(pixels, minColor, maxColor);
+        int cov[4] = { 0, 0, 0, 0 };
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const int da = pixels[i][axis] * 16 - sum[axis];
+            for (size_t c = 0; c < 4; ++c)
+            {
+                cov[c] += (pixels[i][c] * 16 - sum[c]) * da;
+            }
+        }
 
-                uint8_t minAlpha = (minColor >> 24) & 0xff;
-                uint8_t maxAlpha = (maxColor >> 24) & 0xff;
+        int endpoints[2][4];
+        for (size_t c = 0; c < 4; ++c)
+        {
+            const int inset = (maxc[c] - minc[c]) >> INSET_SHIFT;
+            endpoints[0][c] = (cov[c] < 0) ? (maxc[c] - inset) : (minc[c] + inset);
+            endpoints[1][c] = (cov[c] < 0) ? (minc[c] + inset) : (maxc[c] - inset);
+        }
 
-                pBC->alpha[0] = maxAlpha;
-                pBC->alpha[1] = minAlpha;
-                EmitAlphaIndices(pixels, 3, minAlpha, maxAlpha, pBC->bitmap);
+        // Quantize to 7 bits plus whichever p-bit is closer
+        uint32_t quant[2][4];
+        uint32_t pbit[2];
+        int recon[2][4];
+        for (size_t e = 0; e < 2; ++e)
+        {
+            int bestError = INT32_MAX;
+            for (int p = 0; p < 2; ++p)
+            {
+                int error = 0;
+                int q[4];
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    q[c] = std::min(std::max((endpoints[e][c] - p + 1) >> 1, 0), 127);
+                    const int d = ((q[c] << 1) | p) - endpoints[e][c];
+                    error += d * d;
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    pbit[e] = uint32_t(p);
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        quant[e][c] = uint32_t(q[c]);
+                        recon[e][c] = (q[c] << 1) | p;
+                    }
+                }
+            }
+        }
 
-                pSrc += 16; // 4*4 pixels
-                pDst += 16; // 16 Bytes per block
+        // Indices by projection onto the endpoint line (the 4-bit weights are near-uniform)
+        int dir[4];
+        int length = 0;
+        for (size_t c = 0; c < 4; ++c)
+        {
+            dir[c] = recon[1][c] - recon[0][c];
+            length += dir[c] * dir[c];
+        }
+
+        uint32_t indices[16] = {};
+        if (length > 0)
+        {
+            for (size_t i = 0; i < 16; ++i)
+            {
+                int dot = 0;
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    dot += (pixels[i][c] - recon[0][c]) * dir[c];
+                }
+
+                const int index = (dot <= 0) ? 0 : (dot * 30 + length) / (length * 2);
+                indices[i] = uint32_t(std::min(index, 15));
             }
+        }
 
-            pSource += src.rowPitch * 4;
-            pDestination += dst.rowPitch;
+        // The anchor index has an implicit high bit of zero, which the weight table's
+        // symmetry lets us ensure by swapping the endpoints
+        if (indices[0] & 0x8)
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                std::swap(quant[0][c], quant[1][c]);
+            }
+            std::swap(pbit[0], pbit[1]);
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+                indices[i] = 15 - indices[i];
+            }
+        }
+
+        uint64_t bits[2] = {};
+        size_t pos = 0;
+        PutBits(bits, pos, 1u << 6, 7); // mode 6
+        for (size_t c = 0; c < 4; ++c)
+        {
+            PutBits(bits, pos, quant[0][c], 7);
+            PutBits(bits, pos, quant[1][c], 7);
         }
+        PutBits(bits, pos, pbit[0], 1);
+        PutBits(bits, pos, pbit[1], 1);
+        PutBits(bits, pos, indices[0], 3);
+        for (size_t i = 1; i < 16; ++i)
+        {
+            PutBits(bits, pos, indices[i], 4);
+        }
+        assert(pos == 128);
+
+        memcpy(pDst, bits, sizeof(BC7));
     }
 
     //-----------------------------------------------------------------------------
-    void CompressBC5U(const Image& src, Image& dst)
+    // Encodes a band of whole block rows one block at a time
+    //-----------------------------------------------------------------------------
+    template<size_t BlockSize, void(*EncodeBlock)(const uint8_t*, size_t, uint8_t*)>
+    void CompressBlocks(const Image& src, Image& dst)
     {
-        uint8_t pixels[16 * 4];
-
         const uint8_t* pSource = src.pixels;
         uint8_t* pDestination = dst.pixels;
 
@@ -977,22 +1600,10 @@ namespace
 
             for (size_t i = 0; i < src.width; i += 4)
             {
-                ExtractBlock(pSrc, src.rowPitch, pixels);
-
-                uint8_t minX, minY, maxX, maxY;
-                GetMinMaxNormals(pixels, minX, maxX, minY, maxY);
-
-                auto pBC = reinterpret_cast<BC5U*>(pDst);
-                pBC->x.red_0 = maxX;
-                pBC->x.red_1 = minX;
-                EmitAlphaIndices(pixels, 0, minX, maxX, pBC->x.indices);
-
-                pBC->y.red_0 = maxY;
-                pBC->y.red_1 = minY;
-                EmitAlphaIndices(pixels, 1, minY, maxY, pBC->y.indices);
+                EncodeBlock(pSrc, src.rowPitch, pDst);
 
                 pSrc += 16; // 4*4 pixels
-                pDst += 16; // 16 Bytes per block
+                pDst += BlockSize;
             }
 
             pSource += src.rowPitch * 4;
@@ -1000,13 +1611,175 @@ namespace
         }
     }
 
-#endif // !USE_SSE2 
+    typedef void(*CompressFunc)(const Image& src, Image& dst);
+
+    CompressFunc GetCompressFunc(DXGI_FORMAT bcFormat)
+    {
+        switch (bcFormat)
+        {
+#ifdef USE_AVX2
+        case DXGI_FORMAT_BC1_UNORM: return CompressBlockPairs<sizeof(BC1), EncodeBC1Pair, EncodeBC1Block>;
+        case DXGI_FORMAT_BC3_UNORM: return CompressBlockPairs<sizeof(BC3), EncodeBC3Pair, EncodeBC3Block>;
+        case DXGI_FORMAT_BC4_UNORM: return CompressBlockPairs<sizeof(BC4U), EncodeBC4UPair, EncodeBC4UBlock>;
+        case DXGI_FORMAT_BC5_UNORM: return CompressBlockPairs<sizeof(BC5U), EncodeBC5UPair, EncodeBC5UBlock>;
+#else
+        case DXGI_FORMAT_BC1_UNORM: return CompressBlocks<sizeof(BC1), EncodeBC1Block>;
+        case DXGI_FORMAT_BC3_UNORM: return CompressBlocks<sizeof(BC3), EncodeBC3Block>;
+        case DXGI_FORMAT_BC4_UNORM: return CompressBlocks<sizeof(BC4U), EncodeBC4UBlock>;
+        case DXGI_FORMAT_BC5_UNORM: return CompressBlocks<sizeof(BC5U), EncodeBC5UBlock>;
+#endif
+        case DXGI_FORMAT_BC7_UNORM: return CompressBlocks<sizeof(BC7), EncodeBC7Block>;
+        default: return nullptr;
+        }
+    }
+
+    // Each task encodes at least this many blocks, so the tail mips are one task apiece
+    const uint32_t c_MinBlocksPerTask = 512;
 }
 
-CompressorCPU::CompressorCPU()
+//-----------------------------------------------------------------------------
+// Worker pool
+//
+// The threads are created once and parked between calls, since starting threads
+// on every Compress would cost more than encoding the smaller mips.
+//-----------------------------------------------------------------------------
+class CompressorCPU::WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned int threads) :
+        m_func(nullptr),
+        m_count(0),
+        m_next(0),
+        m_active(0),
+        m_generation(0),
+        m_exit(false)
+    {
+        try
+        {
+            m_threads.reserve(threads);
+            for (unsigned int j = 1; j < threads; ++j)
+            {
+                m_threads.emplace_back([this]() { WorkerThread(); });
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Carry on with the workers that did start (possibly none), since Run sizes
+            // each call by m_threads and the destructor joins whatever is there
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+    // Runs func(0) .. func(count - 1) on the pool, with the calling thread taking part
+    void Run(size_t count, const std::function<void(size_t)>& func)
+    {
+        if (m_threads.empty() || count <= 1)
+        {
+            for (size_t index = 0; index < count; ++index)
+            {
+                func(index);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_func = &func;
+            m_count = count;
+            m_next.store(0);
+            m_active = m_threads.size();
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        Execute(func, count);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_active == 0; });
+        m_func = nullptr;
+    }
+
+private:
+    void Execute(const std::function<void(size_t)>& func, size_t count)
+    {
+        for (size_t index = m_next.fetch_add(1); index < count; index = m_next.fetch_add(1))
+        {
+            func(index);
+        }
+    }
+
+    void WorkerThread()
+    {
+        uint64_t generation = 0;
+
+        for (;;)
+        {
+            const std::function<void(size_t)>* func;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]() { return m_exit || m_generation != generation; });
+                if (m_exit)
+                    return;
+
+                generation = m_generation;
+                func = m_func;
+                count = m_count;
+            }
+
+            Execute(*func, count);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_active;
+            }
+            m_done.notify_one();
+        }
+    }
+
+    std::mutex                                  m_mutex;
+    std::condition_variable                     m_wake;
+    std::condition_variable                     m_done;
+    std::vector<std::thread>                    m_threads;
+    const std::function<void(size_t)>*          m_func;
+    size_t                                      m_count;
+    std::atomic<size_t>                         m_next;
+    size_t                                      m_active;
+    uint64_t                                    m_generation;
+    bool                                        m_exit;
+};
+
+CompressorCPU::CompressorCPU(unsigned int threads)
 {
+    if (!threads)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers = std::make_unique<WorkerPool>(threads);
 }
 
+CompressorCPU::~CompressorCPU() = default;
+
+CompressorCPU::CompressorCPU(CompressorCPU&&) noexcept = default;
+CompressorCPU& CompressorCPU::operator=(CompressorCPU&&) noexcept = default;
+
 HRESULT CompressorCPU::Prepare(
     uint32_t texSize,
     DXGI_FORMAT bcFormat,
@@ -1028,7 +1801,9 @@ HRESULT CompressorCPU::Prepare(
     {
     case DXGI_FORMAT_BC1_UNORM:
     case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC4_UNORM:
     case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
         break;
 
     default:
@@ -1099,6 +1874,23 @@ HRESULT CompressorCPU::Compress(
     if (!subresources || !bcSubresources)
         return E_INVALIDARG;
 
+    auto compress = GetCompressFunc(bcFormat);
+    if (!compress)
+        return E_INVALIDARG;
+
+    Image srcLevels[D3D12_REQ_MIP_LEVELS];
+    Image dstLevels[D3D12_REQ_MIP_LEVELS];
+
+    // Split each level into bands of block rows, so all the mips are encoded in one parallel pass
+    struct Band
+    {
+        uint32_t level;
+        uint32_t row;
+        uint32_t rows;
+    };
+
+    std::vector<Band> bands;
+
     for (uint32_t level = 0; level < mipLevels; ++level)
     {
         // Input memory must be 16-byte aligned
@@ -1107,38 +1899,43 @@ HRESULT CompressorCPU::Compress(
 
         uint32_t mipSize = std::max(texSize >> level, 4u);
 
-        Image src;
+        Image& src = srcLevels[level];
         src.format = DXGI_FORMAT_R8G8B8A8_UNORM;
         src.width = src.height = mipSize;
         src.pixels = reinterpret_cast<uint8_t*>(const_cast<void*>(subresources[level].pData));
         src.rowPitch = size_t(subresources[level].RowPitch);
         src.slicePitch = size_t(subresources[level].SlicePitch);
 
-        Image dst;
+        Image& dst = dstLevels[level];
         dst.format = bcFormat;
-        dst.width = src.height = mipSize;
+        dst.width = dst.height = mipSize;
         dst.pixels = reinterpret_cast<uint8_t*>(const_cast<void*>(bcSubresources[level].pData));
         dst.rowPitch = size_t(bcSubresources[level].RowPitch);
         dst.slicePitch = size_t(bcSubresources[level].SlicePitch);
 
-        switch (bcFormat)
+        const uint32_t blockRows = mipSize / 4;
+        const uint32_t rowsPerBand = std::max(1u, c_MinBlocksPerTask / blockRows);
+
+        for (uint32_t row = 0; row < blockRows; row += rowsPerBand)
         {
-        case DXGI_FORMAT_BC1_UNORM:
-            CompressBC1(src, dst);
-            break;
+            bands.push_back({ level, row, std::min(rowsPerBand, blockRows - row) });
+        }
+    }
 
-        case DXGI_FORMAT_BC3_UNORM:
-            CompressBC3(src, dst);
-            break;
+    m_workers->Run(bands.size(), [&](size_t index)
+    {
+        const Band& band = bands[index];
 
-        case DXGI_FORMAT_BC5_UNORM:
-            CompressBC5U(src, dst);
-            break;
+        Image src = srcLevels[band.level];
+        src.pixels += size_t(band.row) * 4 * src.rowPitch;
+        src.height = size_t(band.rows) * 4;
 
-        default:
-            return E_INVALIDARG;
-        }
-    }
+        Image dst = dstLevels[band.level];
+        dst.pixels += size_t(band.row) * dst.rowPitch;
+        dst.height = src.height;
+
+        compress(src, dst);
+    });
 
     return S_OK;
 }
@@ -10,13 +10,17 @@
 class CompressorCPU
 {
 public:
-    CompressorCPU();
+    // threads includes the calling thread; 0 uses one per hardware thread
+    explicit CompressorCPU(unsigned int threads = 0);
+    ~CompressorCPU();
 
     CompressorCPU(const CompressorCPU&) = delete;
     CompressorCPU& operator=(const CompressorCPU&) = delete;
 
-    CompressorCPU(CompressorCPU&&) = default;
-    CompressorCPU& operator=(CompressorCPU&&) = default;
+    CompressorCPU(CompressorCPU&&) noexcept;
+    CompressorCPU& operator=(CompressorCPU&&) noexcept;
+
+    // Supported formats are BC1, BC3, BC4, BC5, and BC7 (mode 6 only) in UNORM
 
     HRESULT Prepare(uint32_t texSize, DXGI_FORMAT bcFormat, uint32_t mipLevels, std::unique_ptr<uint8_t, aligned_deleter>&result, std::vector<D3D12_SUBRESOURCE_DATA>& subresources);
 
@@ -24,9 +28,13 @@ public:
     // pixels here must be in DXGI_FORMAT_R8G8B8A8_UNORM format
     // each miplevel must start on a 16-byte aligned boundary
     // the 2x2 and 1x1 miplevels must be 4x4 in size created through replication of pixels
+    // all miplevels are encoded in one pass split across the worker threads
     //
     HRESULT Compress(uint32_t texSize, uint32_t mipLevels, _In_reads_(mipLevels) const D3D12_SUBRESOURCE_DATA* subresources, DXGI_FORMAT bcFormat, _In_reads_(mipLevels) const D3D12_SUBRESOURCE_DATA* bcSubresources);
 
 private:
+    class WorkerPool;
+
+    std::unique_ptr<WorkerPool> m_workers;
 };
 
@@ -711,6 +711,25 @@ void Sample::Render()
             swprintf_s(buff, L"Time (Top) %1.3f ms; (All) %1.3f ms", m_cpuTimer.GetElapsedMS(0), m_cpuTimer.GetElapsedMS(1));
             m_font->DrawString(m_batch.get(), buff, pos, ATG::Colors::LightGrey);
             pos.y += ysize;
+
+            {
+                // Throughput in source pixels encoded per second
+                const double topPixels = double(img->m_desc.Width) * double(img->m_desc.Height);
+                double allPixels = 0;
+                for (uint32_t level = 0; level < img->m_desc.MipLevels; ++level)
+                {
+                    const double mipSize = double(std::max<uint64_t>(img->m_desc.Width >> level, 1));
+                    allPixels += mipSize * mipSize;
+                }
+
+                const double topMS = m_cpuTimer.GetElapsedMS(0);
+                const double allMS = m_cpuTimer.GetElapsedMS(1);
+                swprintf_s(buff, L"Throughput (Top) %1.1f MPix/s; (All) %1.1f MPix/s",
+                    (topMS > 0) ? topPixels / (topMS * 1000.0) : 0.0,
+                    (allMS > 0) ? allPixels / (allMS * 1000.0) : 0.0);
+                m_font->DrawString(m_batch.get(), buff, pos, ATG::Colors::LightGrey);
+                pos.y += ysize;
+            }
 #endif
             break;
         }
@@ -32,6 +32,11 @@ void FbxTransformer::Initialize(FbxScene* pScene)
     }
 }
 
+void FbxTransformer::InitializeYUp()
+{
+    m_maxConversion = false;
+}
+
 void FbxTransformer::TransformMatrix(XMFLOAT4X4* pDestMatrix, const XMFLOAT4X4* pSrcMatrix) const
 {
     XMFLOAT4X4 SrcMatrix;
@@ -27,6 +27,11 @@ namespace ATG
 
         void  Initialize(fbxsdk::FbxScene* pScene);
 
+        // Initializes the transformer for meshes loaded without the Fbx SDK (OBJ and raw mesh files). These have no
+        // axis system of their own, so like the Fbx SDK's OBJ reader they're taken to be Y up, which Initialize
+        // converts scenes to. The unit scale and Z flip apply as they do to Fbx scenes.
+        void  InitializeYUp();
+
         void  TransformMatrix(DirectX::XMFLOAT4X4* pDestMatrix, const DirectX::XMFLOAT4X4* pSrcMatrix) const;
         void  TransformPosition(DirectX::XMFLOAT3* pDestPosition, const DirectX::XMFLOAT3* pSrcPosition) const;
         void  TransformDirection(DirectX::XMFLOAT3* pDestDirection, const DirectX::XMFLOAT3* pSrcDirection) const;
@@ -8,20 +8,208 @@
 
 #include "MeshProcessor.h"
 #include "FbxTransformer.h"
+#include "ObjImporter.h"
+#include "RawMeshImporter.h"
 
 #include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cstring>
 #include <fbxsdk.h>
 #include <iostream>
 #include <queue>
+#include <thread>
 
 using namespace ATG;
 using namespace DirectX;
 
+namespace
+{
+    enum class FileFormat
+    {
+        Fbx,
+        Obj,
+        RawMesh,
+    };
+
+    bool HasExtension(const char* filename, const char* extension)
+    {
+        const char* dot = std::strrchr(filename, '.');
+        if (!dot || std::strlen(dot) != std::strlen(extension))
+            return false;
+
+        for (size_t i = 0; dot[i]; ++i)
+        {
+            if (std::tolower(static_cast<unsigned char>(dot[i])) != extension[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    FileFormat GetFileFormat(const char* filename)
+    {
+        if (HasExtension(filename, ".obj"))
+            return FileFormat::Obj;
+
+        if (HasExtension(filename, ".rawmesh"))
+            return FileFormat::RawMesh;
+
+        return FileFormat::Fbx;
+    }
+
+    // Reports how well the meshlets are filled and how often their vertices are shared between primitives
+    void PrintStatistics(const std::vector<MeshletSet>& meshlets)
+    {
+        size_t meshletCount = 0;
+        uint32_t lodCount = 0;
+        size_t vertCapacity = 0;
+        size_t primCapacity = 0;
+        size_t vertCount = 0;
+        size_t primCount = 0;
+
+        for (auto& set : meshlets)
+        {
+            meshletCount += set.meshlets.size();
+            lodCount = (std::max)(lodCount, set.lodCount);
+            vertCapacity += set.meshlets.size() * set.maxVerts;
+            primCapacity += set.meshlets.size() * set.maxPrims;
+
+            for (auto& meshlet : set.meshlets)
+            {
+                vertCount += meshlet.VertCount;
+                primCount += meshlet.PrimCount;
+            }
+        }
+
+        if (!meshletCount)
+            return;
+
+        std::cout << "Generated " << meshletCount << " meshlets - Vertex fill: " << 100.0 * vertCount / vertCapacity
+            << "%   Primitive fill: " << 100.0 * primCount / primCapacity
+            << "%   Vertex reuse: " << 3.0 * primCount / vertCount << " corners per vertex" << std::endl;
+
+        if (lodCount > 1)
+        {
+            std::cout << "Generated up to " << lodCount << " levels of detail per mesh." << std::endl;
+        }
+    }
+
+    // Imports OBJ and raw mesh files with the native parsers, bypassing the Fbx SDK.
+    // Each OBJ group becomes a mesh; a raw mesh file holds a single mesh. Sets useFbx and returns
+    // false if the file uses OBJ features only the Fbx SDK imports.
+    bool ImportNativeFile(const char* filename, FileFormat format, const ImportOptions& options, std::vector<MeshletSet>& meshlets, bool& useFbx)
+    {
+        useFbx = false;
+
+        MappedFile file;
+        if (!file.Open(filename))
+        {
+            std::cout << "Error opening file \"" << filename << "\"" << std::endl;
+            return false;
+        }
+
+        std::cout << "Processing file \"" << filename << "\"" << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<TriangleStream> meshes;
+        bool parsed;
+        if (format == FileFormat::Obj)
+        {
+            parsed = ParseObj(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), options.TriangulateMeshes, meshes, useFbx);
+        }
+        else
+        {
+            meshes.resize(1);
+            parsed = ParseRawMesh(file.GetData(), file.GetSize(), meshes[0]);
+        }
+
+        if (!parsed)
+        {
+            if (useFbx)
+            {
+                std::cout << "Importing file \"" << filename << "\" through the Fbx SDK instead." << std::endl;
+            }
+            else
+            {
+                std::cout << "Error during parsing of file \"" << filename << "\"" << std::endl;
+            }
+            return false;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double megabytes = double(file.GetSize()) / (1024.0 * 1024.0);
+
+        std::cout << "Parsed " << megabytes << " MB in " << seconds * 1000.0 << " ms ("
+            << megabytes / (std::max)(seconds, 1e-6) << " MB/s)." << std::endl;
+
+        file.Close();
+
+        size_t triangleCount = 0;
+        for (auto& mesh : meshes)
+        {
+            triangleCount += mesh.GetTriangleCount();
+        }
+
+        if (!triangleCount)
+        {
+            std::cout << "No triangles found in file \"" << filename << "\"" << std::endl;
+            return false;
+        }
+
+        std::cout << "Found " << meshes.size() << " meshes with " << triangleCount << " triangles." << std::endl;
+
+        meshlets.clear();
+
+        FbxTransformer transformer(options.UnitScale, options.FlipZ);
+        transformer.InitializeYUp();
+
+        // Weld and meshletize the meshes in parallel, releasing each mesh's triangles once it's processed
+        std::vector<MeshletSet> results(meshes.size());
+
+        ParallelFor(meshes.size(), [&](size_t i)
+        {
+            MeshProcessor processor;
+            processor.SetTriangles(std::move(meshes[i]));
+
+            processor.GenerateMeshlets(
+                transformer,
+                options.MeshletMaxVerts,
+                options.MeshletMaxPrims,
+                options.FlipTriangles,
+                options.Force32BitIndices,
+                options.ReorderTriangles,
+                options.SplitSubsets,
+                options.LodCount,
+                results[i]);
+        });
+
+        for (auto& result : results)
+        {
+            meshlets.emplace_back(std::move(result));
+        }
+
+        PrintStatistics(meshlets);
+
+        return true;
+    }
+}
+
 bool ATG::ImportFile(const char* filename, const ImportOptions& options, std::vector<MeshletSet>& meshlets)
 {
     if (!filename)
         return false;
 
+    const FileFormat format = GetFileFormat(filename);
+    if (format != FileFormat::Fbx)
+    {
+        bool useFbx;
+        const bool imported = ImportNativeFile(filename, format, options, meshlets, useFbx);
+        if (!useFbx)
+            return imported;
+    }
+
     FbxManager* manager   = FbxManager::Create();
     FbxScene* scene       = FbxScene::Create(manager, "");
     FbxImporter* importer = FbxImporter::Create(manager, "");
@@ -90,27 +278,60 @@ bool ATG::ImportFile(const char* filename, const ImportOptions& options, std::ve
     FbxTransformer transformer(options.UnitScale, options.FlipZ);
     transformer.Initialize(scene);
 
-    MeshProcessor processor;
-    for (auto& node : meshNodes)
+    // The Fbx SDK must only be accessed from this thread, so nodes are extracted here in batches of one per
+    // worker and each batch is welded and meshletized in parallel. Only one batch of triangle streams is
+    // held at a time, so peak memory is bounded by the batch rather than the whole scene.
+    const size_t batchSize = (std::max<size_t>)(1, std::thread::hardware_concurrency());
+
+    std::vector<MeshProcessor> processors((std::min)(batchSize, meshNodes.size()));
+    std::vector<MeshletSet> results(processors.size());
+    std::vector<bool> extracted(processors.size());
+
+    for (size_t batchStart = 0; batchStart < meshNodes.size(); batchStart += batchSize)
     {
-        MeshletSet result;
-        if (processor.GenerateMeshlets(
-            node,
-            transformer,
-            options.MeshletMaxVerts,
-            options.MeshletMaxPrims,
-            options.FlipTriangles,
-            options.Force32BitIndices,
-            result))
+        const size_t count = (std::min)(batchSize, meshNodes.size() - batchStart);
+
+        for (size_t i = 0; i < count; ++i)
         {
-            meshlets.emplace_back(std::move(result));
+            extracted[i] = processors[i].Extract(meshNodes[batchStart + i]);
         }
-        else
+
+        ParallelFor(count, [&](size_t i)
         {
-            std::cout << "Failed to process mesh node with name \"" << node->GetNameOnly().Buffer() << "\"" << std::endl;
+            if (extracted[i])
+            {
+                processors[i].GenerateMeshlets(
+                    transformer,
+                    options.MeshletMaxVerts,
+                    options.MeshletMaxPrims,
+                    options.FlipTriangles,
+                    options.Force32BitIndices,
+                    options.ReorderTriangles,
+                    options.SplitSubsets,
+                    options.LodCount,
+                    results[i]);
+            }
+
+            // Release the node's working set before the next batch is extracted
+            processors[i] = MeshProcessor();
+        });
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (extracted[i])
+            {
+                meshlets.emplace_back(std::move(results[i]));
+                results[i] = MeshletSet();
+            }
+            else
+            {
+                std::cout << "Failed to process mesh node with name \"" << meshNodes[batchStart + i]->GetNameOnly().Buffer() << "\"" << std::endl;
+            }
         }
     }
 
+    PrintStatistics(meshlets);
+
     // Cleanup
     importer->Destroy();
     scene->Destroy();
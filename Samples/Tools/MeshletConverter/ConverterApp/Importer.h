@@ -20,6 +20,9 @@ namespace ATG
         bool        FlipTriangles;
         bool        Force32BitIndices;
         bool        TriangulateMeshes;
+        bool        ReorderTriangles;
+        bool        SplitSubsets;
+        uint32_t    LodCount;
 
         ImportOptions(void)
             : MeshletMaxVerts(128)
@@ -29,9 +32,14 @@ namespace ATG
             , FlipTriangles(false)
             , Force32BitIndices(false)
             , TriangulateMeshes(false)
+            , ReorderTriangles(false)
+            , SplitSubsets(false)
+            , LodCount(1)
         { }
     };
 
-    // Imports an FBX or OBJ file. Returns whether any meshes were processed.
+    // Imports an FBX, OBJ or raw binary mesh (.rawmesh) file. Returns whether any meshes were processed.
+    // OBJ and raw mesh files are parsed natively rather than through the Fbx SDK, with the same axis and unit
+    // conversion; OBJ files using features the native parser doesn't support are imported through the Fbx SDK.
     bool ImportFile(const char* filename, const ImportOptions& options, std::vector<MeshletSet>& meshlets);
 }
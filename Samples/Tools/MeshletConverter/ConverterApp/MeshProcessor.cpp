@@ -7,9 +7,12 @@
 #include "MeshProcessor.h"
 
 #include "FbxTransformer.h"
+#include "MeshSimplifier.h"
 
 #include <cassert>
 #include <algorithm>
+#include <cfloat>
+#include <climits>
 #include <d3d12.h>
 #include <DirectXMesh.h>
 #include <fbxsdk.h>
@@ -27,50 +30,410 @@ namespace
             throw std::exception("Failed HRESULT!");
         }
     }
+
+    // Control points transformed per task when extracting a mesh
+    constexpr size_t c_ControlPointsPerTask = 1 << 16;
+
+    // Subsets with more faces than this are split into pieces that are meshletized in parallel
+    constexpr size_t c_MaxFacesPerTask = 1 << 16;
+
+    // Faces of a subset, or of a piece of one, and the meshlets generated from them
+    struct MeshletTask
+    {
+        size_t                          faceOffset;
+        size_t                          faceCount;
+
+        std::vector<Meshlet>            meshlets;
+        std::vector<uint32_t>           uniqueVertexIndices;
+        std::vector<MeshletTriangle>    primitiveIndices;
+        std::vector<CullData>           cullData;
+    };
+
+    // Spreads the low 10 bits of v out to every third bit
+    inline uint32_t Part1By2(uint32_t v)
+    {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    // Clamps a grid coordinate to [0, 1023]; NaNs land in the first cell
+    inline uint32_t QuantizeCell(float v)
+    {
+        return v > 0.0f ? static_cast<uint32_t>(std::min<float>(v, 1023.0f)) : 0;
+    }
+
+    // Returns the points' indices sorted along a Morton curve, in the low 32 bits of each key
+    void SortPointsSpatially(const std::vector<XMFLOAT3>& points, std::vector<uint64_t>& keys)
+    {
+        XMVECTOR vMin = g_XMFltMax;
+        XMVECTOR vMax = XMVectorNegate(g_XMFltMax);
+
+        for (auto& point : points)
+        {
+            vMin = XMVectorMin(vMin, XMLoadFloat3(&point));
+            vMax = XMVectorMax(vMax, XMLoadFloat3(&point));
+        }
+
+        // Quantize the points to a 1024^3 grid over their bounds
+        XMVECTOR extent = XMVectorSubtract(vMax, vMin);
+        XMVECTOR scale = XMVectorSelect(
+            XMVectorDivide(XMVectorReplicate(1023.0f), extent),
+            XMVectorZero(),
+            XMVectorLessOrEqual(extent, XMVectorZero()));
+
+        keys.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            XMFLOAT3 cell;
+            XMStoreFloat3(&cell, XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&points[i]), vMin), scale));
+
+            uint32_t morton = Part1By2(QuantizeCell(cell.x))
+                | (Part1By2(QuantizeCell(cell.y)) << 1)
+                | (Part1By2(QuantizeCell(cell.z)) << 2);
+
+            keys[i] = (uint64_t(morton) << 32) | i;
+        }
+
+        std::sort(keys.begin(), keys.end());
+    }
+
+    // Sorts faces along a Morton curve through their centroids
+    template <typename T>
+    void SortFacesSpatially(T* indices, size_t nFaces, const XMFLOAT3* positions)
+    {
+        if (nFaces < 2)
+            return;
+
+        std::vector<XMFLOAT3> centroids(nFaces);
+        for (size_t i = 0; i < nFaces; ++i)
+        {
+            XMVECTOR v0 = XMLoadFloat3(&positions[indices[i * 3]]);
+            XMVECTOR v1 = XMLoadFloat3(&positions[indices[i * 3 + 1]]);
+            XMVECTOR v2 = XMLoadFloat3(&positions[indices[i * 3 + 2]]);
+
+            XMStoreFloat3(&centroids[i], XMVectorScale(XMVectorAdd(XMVectorAdd(v0, v1), v2), 1.0f / 3.0f));
+        }
+
+        std::vector<uint64_t> keys;
+        SortPointsSpatially(centroids, keys);
+
+        std::vector<T> sorted(nFaces * 3);
+        for (size_t i = 0; i < nFaces; ++i)
+        {
+            size_t face = static_cast<size_t>(keys[i] & 0xFFFFFFFF);
+            std::copy_n(indices + face * 3, 3, &sorted[i * 3]);
+        }
+
+        std::copy(sorted.begin(), sorted.end(), indices);
+    }
+
+    // Reorders faces to improve post-transform vertex cache reuse
+    template <typename T>
+    void OptimizeFacesForReuse(T* indices, size_t nFaces)
+    {
+        std::vector<uint32_t> faceRemap(nFaces);
+        ThrowIfFailed(OptimizeFacesLRU(indices, nFaces, faceRemap.data()));
+
+        // Degenerate faces are left out of the remap; keep them at the end
+        std::vector<bool> placed(nFaces);
+        std::vector<T> reordered;
+        reordered.reserve(nFaces * 3);
+
+        for (uint32_t face : faceRemap)
+        {
+            if (face != UNUSED32)
+            {
+                placed[face] = true;
+                reordered.insert(reordered.end(), indices + face * 3, indices + face * 3 + 3);
+            }
+        }
+
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            if (!placed[face])
+            {
+                reordered.insert(reordered.end(), indices + face * 3, indices + face * 3 + 3);
+            }
+        }
+
+        std::copy(reordered.begin(), reordered.end(), indices);
+    }
+
+    // Meshletizes a task's faces in isolation. Vertices are remapped to a compact local range
+    // (preserving their order) so the cost only depends on the size of the task.
+    template <typename T>
+    void MeshletizeTask(const T* indices, const XMFLOAT3* positions, uint32_t maxVerts, uint32_t maxPrims, MeshletTask& task)
+    {
+        const T* taskIndices = indices + task.faceOffset * 3;
+        const size_t indexCount = task.faceCount * 3;
+
+        std::vector<uint32_t> vertices(taskIndices, taskIndices + indexCount);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+        std::vector<XMFLOAT3> localPositions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            localPositions[i] = positions[vertices[i]];
+        }
+
+        std::vector<uint32_t> localIndices(indexCount);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            localIndices[i] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), uint32_t(taskIndices[i])) - vertices.begin());
+        }
+
+        std::vector<uint8_t> uniqueVertexIB;
+        ThrowIfFailed(ComputeMeshlets(
+            localIndices.data(), task.faceCount,
+            localPositions.data(), localPositions.size(),
+            nullptr,
+            task.meshlets,
+            uniqueVertexIB,
+            task.primitiveIndices,
+            maxVerts,
+            maxPrims
+        ));
+
+        const auto localUnique = reinterpret_cast<const uint32_t*>(uniqueVertexIB.data());
+        const size_t uniqueCount = uniqueVertexIB.size() / sizeof(uint32_t);
+
+        task.cullData.resize(task.meshlets.size());
+        ThrowIfFailed(ComputeCullData(
+            localPositions.data(), localPositions.size(),
+            task.meshlets.data(), task.meshlets.size(),
+            localUnique, uniqueCount,
+            task.primitiveIndices.data(), task.primitiveIndices.size(),
+            task.cullData.data(),
+            MESHLET_DEFAULT
+        ));
+
+        // Map the meshlet vertices back to the mesh's vertex indices
+        task.uniqueVertexIndices.resize(uniqueCount);
+        for (size_t i = 0; i < uniqueCount; ++i)
+        {
+            task.uniqueVertexIndices[i] = vertices[localUnique[i]];
+        }
+    }
+
+    // Appends a task's meshlets to the set, rebasing their vertex and primitive offsets
+    template <typename T>
+    void AppendTask(const MeshletTask& task, MeshletSet& m)
+    {
+        const auto vertOffset = static_cast<uint32_t>(m.uniqueVertexIndices.size() / sizeof(T));
+        const auto primOffset = static_cast<uint32_t>(m.primitiveIndices.size());
+
+        for (auto meshlet : task.meshlets)
+        {
+            meshlet.VertOffset += vertOffset;
+            meshlet.PrimOffset += primOffset;
+            m.meshlets.push_back(meshlet);
+        }
+
+        m.primitiveIndices.insert(m.primitiveIndices.end(), task.primitiveIndices.begin(), task.primitiveIndices.end());
+        m.cullData.insert(m.cullData.end(), task.cullData.begin(), task.cullData.end());
+
+        const size_t byteOffset = m.uniqueVertexIndices.size();
+        m.uniqueVertexIndices.resize(byteOffset + task.uniqueVertexIndices.size() * sizeof(T));
+
+        T* dest = reinterpret_cast<T*>(m.uniqueVertexIndices.data() + byteOffset);
+        for (size_t i = 0; i < task.uniqueVertexIndices.size(); ++i)
+        {
+            dest[i] = static_cast<T>(task.uniqueVertexIndices[i]);
+        }
+    }
+
+    // Meshlets simplified together into the next level of detail
+    constexpr size_t c_MeshletsPerLodGroup = 4;
+
+    // A subset stops being simplified once a level keeps more than this fraction of its triangles
+    constexpr double c_MaxLodTriangleRatio = 0.85;
+
+    // A meshlet's triangles in mesh vertex indices, as input to the next level of detail
+    struct LodCluster
+    {
+        uint32_t                meshlet;
+        XMFLOAT3                center;
+        std::vector<uint32_t>   indices;
+    };
+
+    // Clusters of a subset that are simplified together, and the meshlets built from the result
+    struct LodGroup
+    {
+        size_t                  subset;
+        size_t                  firstCluster;
+        size_t                  clusterCount;
+
+        XMFLOAT4                bounds;
+        float                   error;
+        MeshletTask             task;
+    };
+
+    template <typename T>
+    LodCluster MakeLodCluster(const MeshletSet& m, uint32_t meshletIndex)
+    {
+        const Meshlet& meshlet = m.meshlets[meshletIndex];
+        const T* vertexIndices = reinterpret_cast<const T*>(m.uniqueVertexIndices.data()) + meshlet.VertOffset;
+
+        LodCluster cluster;
+        cluster.meshlet = meshletIndex;
+        cluster.center = m.cullData[meshletIndex].BoundingSphere.Center;
+        cluster.indices.resize(meshlet.PrimCount * 3);
+
+        for (uint32_t i = 0; i < meshlet.PrimCount; ++i)
+        {
+            const MeshletTriangle& prim = m.primitiveIndices[meshlet.PrimOffset + i];
+            cluster.indices[i * 3] = vertexIndices[prim.i0];
+            cluster.indices[i * 3 + 1] = vertexIndices[prim.i1];
+            cluster.indices[i * 3 + 2] = vertexIndices[prim.i2];
+        }
+
+        return cluster;
+    }
+
+    void SortClustersSpatially(std::vector<LodCluster>& clusters)
+    {
+        std::vector<XMFLOAT3> centers(clusters.size());
+        for (size_t i = 0; i < clusters.size(); ++i)
+        {
+            centers[i] = clusters[i].center;
+        }
+
+        std::vector<uint64_t> keys;
+        SortPointsSpatially(centers, keys);
+
+        std::vector<LodCluster> sorted(clusters.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            sorted[i] = std::move(clusters[static_cast<size_t>(keys[i] & 0xFFFFFFFF)]);
+        }
+
+        clusters.swap(sorted);
+    }
+
+    // Sphere enclosing a set of spheres
+    XMFLOAT4 MergeSpheres(const std::vector<XMFLOAT4>& spheres)
+    {
+        XMVECTOR center = XMVectorZero();
+        for (auto& sphere : spheres)
+        {
+            center = XMVectorAdd(center, XMLoadFloat4(&sphere));
+        }
+        center = XMVectorScale(center, 1.0f / spheres.size());
+
+        float radius = 0.0f;
+        for (auto& sphere : spheres)
+        {
+            float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat4(&sphere), center)));
+            radius = std::max<float>(radius, distance + sphere.w);
+        }
+
+        XMFLOAT4 result;
+        XMStoreFloat4(&result, XMVectorSetW(center, radius));
+        return result;
+    }
+
+    // Simplifies a group's clusters to half their triangles and meshletizes the result. The group's error
+    // and bounds enclose those of its clusters, so a coarser level never projects to a smaller error.
+    void SimplifyLodGroup(
+        const std::vector<LodCluster>& clusters,
+        const std::vector<MeshletLod>& lodData,
+        const XMFLOAT3* positions,
+        const std::vector<bool>& lockedVertices,
+        uint32_t maxVerts,
+        uint32_t maxPrims,
+        LodGroup& group)
+    {
+        std::vector<uint32_t> indices;
+        std::vector<XMFLOAT4> childBounds;
+        float childError = 0.0f;
+
+        for (size_t i = group.firstCluster; i < group.firstCluster + group.clusterCount; ++i)
+        {
+            indices.insert(indices.end(), clusters[i].indices.begin(), clusters[i].indices.end());
+            childBounds.push_back(lodData[clusters[i].meshlet].Bounds);
+            childError = std::max<float>(childError, lodData[clusters[i].meshlet].Error);
+        }
+
+        // Simplify over a compact local vertex range
+        std::vector<uint32_t> vertices(indices);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+        std::vector<XMFLOAT3> localPositions(vertices.size());
+        std::vector<bool> localLocked(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            localPositions[i] = positions[vertices[i]];
+            localLocked[i] = lockedVertices[vertices[i]];
+        }
+
+        for (auto& index : indices)
+        {
+            index = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), index) - vertices.begin());
+        }
+
+        float error = SimplifyTriangles(indices, localPositions.data(), localPositions.size(), localLocked, indices.size() / 6);
+
+        for (auto& index : indices)
+        {
+            index = vertices[index];
+        }
+
+        group.bounds = MergeSpheres(childBounds);
+        group.error = std::max<float>(error, childError);
+
+        group.task.faceOffset = 0;
+        group.task.faceCount = indices.size() / 3;
+
+        if (group.task.faceCount)
+        {
+            MeshletizeTask(indices.data(), positions, maxVerts, maxPrims, group.task);
+        }
+    }
 }
 
 void MeshProcessor::Reset()
 {
-    m_dccVertexCount = 0;
-    m_triAllocator.ClearAllTriangles();
-    m_rawTriangles.clear();
-    m_subsets.clear();
-
-    m_indexData.clear();
-    m_vertexData.clear();
+    m_triangles.Clear();
+    m_vertices.cornerIndices.clear();
+    m_vertices.vertexCorners.clear();
 }
 
-bool MeshProcessor::GenerateMeshlets(
-    FbxNode* node,
+void MeshProcessor::GenerateMeshlets(
     const FbxTransformer& transformer,
     uint32_t meshletMaxVerts,
     uint32_t meshletMaxPrims,
     bool flipTriangles,
     bool force32BitIndices,
+    bool reorderTriangles,
+    bool splitSubsets,
+    uint32_t lodCount,
     MeshletSet& meshlet)
 {
-    if (!Extract(node))
-    {
-        return false;
-    }
-
     Optimize(transformer, force32BitIndices);
     if (m_indexBuffer.GetIndexSize() == 4)
     {
-        Meshletize<uint32_t>(meshletMaxVerts, meshletMaxPrims, meshlet);
+        Meshletize<uint32_t>(meshletMaxVerts, meshletMaxPrims, reorderTriangles, splitSubsets, meshlet);
+        GenerateLods<uint32_t>(meshletMaxVerts, meshletMaxPrims, lodCount, meshlet);
     }
     else
     {
-        Meshletize<uint16_t>(meshletMaxVerts, meshletMaxPrims, meshlet);
+        Meshletize<uint16_t>(meshletMaxVerts, meshletMaxPrims, reorderTriangles, splitSubsets, meshlet);
+        GenerateLods<uint16_t>(meshletMaxVerts, meshletMaxPrims, lodCount, meshlet);
     }
 
     Reset();
-
-    return true;
 }
 
 bool MeshProcessor::Extract(FbxNode* node)
 {
+    Reset();
+
     if (!node || !node->GetMesh())
         return false;
 
@@ -120,11 +483,17 @@ bool MeshProcessor::Extract(FbxNode* node)
         normMatrix = normMatrix.Inverse();
         normMatrix = normMatrix.Transpose();
     }
-    
-    // Loop over polygons.
-    for (int polyIndex = 0; polyIndex < mesh->GetPolygonCount(); ++polyIndex)
+
+    const int polygonCount = mesh->GetPolygonCount();
+    const int controlPointCount = mesh->GetControlPointsCount();
+
+    // Find the material subset of each polygon.
+    std::vector<int> polygonSubsets(static_cast<size_t>(polygonCount));
+    int minSubset = INT_MAX;
+    int maxSubset = INT_MIN;
+
+    for (int polyIndex = 0; polyIndex < polygonCount; ++polyIndex)
     {
-        // Triangulate each polygon into one or more triangles.
         int polySize = mesh->GetPolygonSize(polyIndex);
         if (polySize != 3)
         {
@@ -152,203 +521,401 @@ bool MeshProcessor::Extract(FbxNode* node)
             }
         }
 
-        int cornerIndices[3] =
-        {
-            mesh->GetPolygonVertex(polyIndex, 0),
-            mesh->GetPolygonVertex(polyIndex, 1),
-            mesh->GetPolygonVertex(polyIndex, 2)
-        };
+        polygonSubsets[polyIndex] = materialIndex;
+        minSubset = std::min<int>(minSubset, materialIndex);
+        maxSubset = std::max<int>(maxSubset, materialIndex);
+    }
 
-        FbxVector4 vNormals[3];
-        std::memset(vNormals, 0, 3 * sizeof(FbxVector4));
+    if (!polygonCount)
+        return true;
 
-        mesh->GetPolygonVertexNormal(polyIndex, 0, vNormals[0]);
-        mesh->GetPolygonVertexNormal(polyIndex, 1, vNormals[1]);
-        mesh->GetPolygonVertexNormal(polyIndex, 2, vNormals[2]);
+    // Apply a AttributeSort optimization with a counting sort over the subsets.
+    // Triangles keep their polygon order within each subset.
+    std::vector<size_t> subsetOffsets(static_cast<size_t>(int64_t(maxSubset) - minSubset + 1), 0);
+    for (int subset : polygonSubsets)
+    {
+        ++subsetOffsets[subset - minSubset];
+    }
 
-        // Build the raw triangle.
-        auto tri = m_triAllocator.GetNewTriangle();
+    size_t triOffset = 0;
+    for (auto& subsetOffset : subsetOffsets)
+    {
+        size_t triCount = subsetOffset;
+        if (triCount)
+        {
+            m_triangles.subsets.emplace_back(triOffset, triCount);
+        }
 
-        // Store polygon index
-        tri->PolygonIndex = static_cast<int>(polyIndex);
+        subsetOffset = triOffset;
+        triOffset += triCount;
+    }
 
-        // Store material subset index
-        tri->SubsetIndex = materialIndex;
+    // Transform each control point once, rather than once per corner.
+    // The workers only read the control point array and do matrix math, which is safe off the main thread.
+    const FbxVector4* controlPoints = mesh->GetControlPoints();
+    m_triangles.dccPositions.resize(static_cast<size_t>(controlPointCount));
 
-        for (uint32_t cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+    const size_t pointTaskCount = (m_triangles.dccPositions.size() + c_ControlPointsPerTask - 1) / c_ControlPointsPerTask;
+    ParallelFor(pointTaskCount, [&](size_t task)
+    {
+        size_t end = std::min<size_t>(m_triangles.dccPositions.size(), (task + 1) * c_ControlPointsPerTask);
+        for (size_t i = task * c_ControlPointsPerTask; i < end; ++i)
         {
-            const uint32_t& dccIndex = cornerIndices[cornerIndex];
+            auto finalPos = vertMatrix.MultT(controlPoints[i]);
 
-            // Store DCC vertex index (this helps the mesh reduction/VB generation code)
-            tri->Vertex[cornerIndex].DCCVertexIndex = dccIndex;
+            m_triangles.dccPositions[i].x = (float)finalPos.mData[0];
+            m_triangles.dccPositions[i].y = (float)finalPos.mData[1];
+            m_triangles.dccPositions[i].z = (float)finalPos.mData[2];
+        }
+    });
 
-            // Store vertex position
-            auto vertPositions = mesh->GetControlPoints();
-            auto finalPos = vertMatrix.MultT(vertPositions[dccIndex]);
+    // Store the corners of each triangle in its sorted position.
+    m_triangles.cornerDCCIndices.resize(static_cast<size_t>(polygonCount) * 3);
+    m_triangles.cornerNormals.resize(static_cast<size_t>(polygonCount) * 3);
 
-            tri->Vertex[cornerIndex].Position.x = (float)finalPos.mData[0];
-            tri->Vertex[cornerIndex].Position.y = (float)finalPos.mData[1];
-            tri->Vertex[cornerIndex].Position.z = (float)finalPos.mData[2];
+    for (int polyIndex = 0; polyIndex < polygonCount; ++polyIndex)
+    {
+        size_t triIndex = subsetOffsets[polygonSubsets[polyIndex] - minSubset]++;
+
+        for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+        {
+            const size_t corner = triIndex * 3 + cornerIndex;
+
+            int dccIndex = mesh->GetPolygonVertex(polyIndex, cornerIndex);
+            if (dccIndex < 0 || dccIndex >= controlPointCount)
+            {
+                std::cout << "Mesh references a control point that doesn't exist." << std::endl;
+                return false;
+            }
+
+            // Store DCC vertex index (this helps the mesh reduction/VB generation code)
+            m_triangles.cornerDCCIndices[corner] = static_cast<uint32_t>(dccIndex);
+            m_triangles.dccVertexCount = std::max<uint32_t>(m_triangles.dccVertexCount, static_cast<uint32_t>(dccIndex) + 1);
 
             // Store vertex normal
-            auto finalNorm = vNormals[cornerIndex];
+            FbxVector4 finalNorm(0.0, 0.0, 0.0, 0.0);
+            mesh->GetPolygonVertexNormal(polyIndex, cornerIndex, finalNorm);
+
             finalNorm.mData[3] = 0.0;
             finalNorm = normMatrix.MultT(finalNorm);
             finalNorm.Normalize();
 
-            tri->Vertex[cornerIndex].Normal.x = (float)finalNorm.mData[0];
-            tri->Vertex[cornerIndex].Normal.y = (float)finalNorm.mData[1];
-            tri->Vertex[cornerIndex].Normal.z = (float)finalNorm.mData[2];
+            m_triangles.cornerNormals[corner].x = (float)finalNorm.mData[0];
+            m_triangles.cornerNormals[corner].y = (float)finalNorm.mData[1];
+            m_triangles.cornerNormals[corner].z = (float)finalNorm.mData[2];
         }
-
-        // Add raw triangle to the mesh.
-        m_rawTriangles.push_back(tri);
-
-        m_dccVertexCount = max(m_dccVertexCount, tri->Vertex[0].DCCVertexIndex + 1);
-        m_dccVertexCount = max(m_dccVertexCount, tri->Vertex[1].DCCVertexIndex + 1);
-        m_dccVertexCount = max(m_dccVertexCount, tri->Vertex[2].DCCVertexIndex + 1);
     }
 
     return true;
 }
 
+void MeshProcessor::SetTriangles(TriangleStream&& triangles)
+{
+    Reset();
+    m_triangles = std::move(triangles);
+}
+
 void MeshProcessor::Optimize(const FbxTransformer& transformer, bool force32BitIndices)
 {
-    if (m_rawTriangles.empty())
+    if (!m_triangles.GetTriangleCount())
         return;
 
-    // Apply a AttributeSort optimization
-    std::stable_sort(m_rawTriangles.begin(), m_rawTriangles.end(), [](Triangle* a, Triangle* b) { return a->SubsetIndex < b->SubsetIndex; });
-
-    int currentSubsetIndex = -1;
-
-    m_indexData.reserve(m_rawTriangles.size() * 3);
-    m_vertexData.resize(m_dccVertexCount, nullptr);
-
-    // loop through raw triangles
-    for (size_t triIndex = 0; triIndex < m_rawTriangles.size(); ++triIndex)
-    {
-        Triangle* tri = m_rawTriangles[triIndex];
-
-        // Create a new subset if one is encountered.
-        // Note: Subset index will be monotonically increasing.
-        if (tri->SubsetIndex > currentSubsetIndex)
-        {
-            m_subsets.emplace_back();
-            m_subsets.back().first = m_indexData.size() / 3;
-            m_subsets.back().second = 0;
+    // Collapse the triangle verts into the final vertex list.
+    // This removes unnecessary duplicates, and retains necessary duplicates.
+    WeldVertices(m_triangles, m_vertices);
 
-            currentSubsetIndex = tri->SubsetIndex;
-        }
+    const size_t vertexCount = m_vertices.GetVertexCount();
+    const size_t indexCount = m_vertices.cornerIndices.size();
 
-        // Collapse the triangle verts into the final vertex list.
-        // This removes unnecessary duplicates, and retains necessary duplicates.
-        uint32_t indexA = FindOrAddVertex(m_vertexData, &tri->Vertex[0]);
-        uint32_t indexB = FindOrAddVertex(m_vertexData, &tri->Vertex[1]);
-        uint32_t indexC = FindOrAddVertex(m_vertexData, &tri->Vertex[2]);
+    // Create real index buffer from the welded corners
+    bool use32BitIndex = (vertexCount > 65535) || force32BitIndices;
 
-        // record final indices into the index list
-        m_indexData.push_back(indexA);
-        if (true)
-        {
-            m_indexData.push_back(indexC);
-            m_indexData.push_back(indexB);
-        }
-        else
-        {
-            m_indexData.push_back(indexB);
-            m_indexData.push_back(indexC);
-        }
-
-        m_subsets.back().second++;
-    }
-
-
-    // Create real index buffer from index list
-    bool use32BitIndex = (m_vertexData.size() > 65535) || force32BitIndices;
-
-    m_indexBuffer.SetIndexCount((uint32_t)m_indexData.size());
+    m_indexBuffer.SetIndexCount((uint32_t)indexCount);
     m_indexBuffer.SetIndexSize(use32BitIndex ? 4 : 2);
     m_indexBuffer.Allocate();
 
-    for (size_t i = 0; i < m_indexData.size(); i++)
+    const uint32_t* cornerIndices = m_vertices.cornerIndices.data();
+    for (size_t i = 0; i < indexCount; i += 3)
     {
-        m_indexBuffer.SetIndex(i, m_indexData[i]);
+        // Corners B & C are swapped to reverse the winding order
+        m_indexBuffer.SetIndex(i, cornerIndices[i]);
+        m_indexBuffer.SetIndex(i + 1, cornerIndices[i + 2]);
+        m_indexBuffer.SetIndex(i + 2, cornerIndices[i + 1]);
     }
 
 
     // Create vertex buffer and allocate storage.
-    m_vertexBuffer.SetVertexCount((uint32_t)m_vertexData.size());
+    m_vertexBuffer.SetVertexCount((uint32_t)vertexCount);
     m_vertexBuffer.SetVertexSize(24); // Position & Normal - (XMFLOAT3 + XMFLOAT3) = 24 bytes
     m_vertexBuffer.Allocate();
 
-    // Copy raw vertex data into the packed vertex buffer.
-    for (size_t vertIndex = 0; vertIndex < m_vertexData.size(); ++vertIndex)
+    // Copy welded vertex data into the packed vertex buffer.
+    for (size_t vertIndex = 0; vertIndex < vertexCount; ++vertIndex)
     {
-        auto destVertex = m_vertexBuffer.GetVertex(vertIndex);
-
-        auto srcVertex = m_vertexData[vertIndex];
-        if (!srcVertex)
+        uint32_t corner = m_vertices.vertexCorners[vertIndex];
+        if (corner == UINT32_MAX)
         {
             continue;
         }
 
-        auto dest = reinterpret_cast<XMFLOAT3*>(destVertex);
-        transformer.TransformPosition(dest, &srcVertex->Position);
+        auto dest = reinterpret_cast<XMFLOAT3*>(m_vertexBuffer.GetVertex(vertIndex));
+        transformer.TransformPosition(dest, &m_triangles.dccPositions[m_triangles.cornerDCCIndices[corner]]);
 
         ++dest;
-        transformer.TransformDirection(dest, &srcVertex->Normal);
+        transformer.TransformDirection(dest, &m_triangles.cornerNormals[corner]);
+    }
+}
+
+void MeshProcessor::GetPositions(std::vector<XMFLOAT3>& positions) const
+{
+    positions.resize(m_vertexBuffer.GetVertexCount());
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        positions[i] = *reinterpret_cast<const XMFLOAT3*>(m_vertexBuffer.GetVertex(i));
     }
 }
 
 template <typename T>
-void MeshProcessor::Meshletize(uint32_t meshletMaxVerts, uint32_t meshletMaxPrims, MeshletSet& m)
+void MeshProcessor::Meshletize(uint32_t meshletMaxVerts, uint32_t meshletMaxPrims, bool reorderTriangles, bool splitSubsets, MeshletSet& m)
 {
     m.maxVerts = meshletMaxVerts;
     m.maxPrims = meshletMaxPrims;
     m.indexSize = sizeof(T);
 
-    // Create a position-only buffer
     std::vector<XMFLOAT3> positions;
-    positions.resize(m_vertexBuffer.GetVertexCount());
+    GetPositions(positions);
 
-    for (size_t i = 0; i < positions.size(); ++i)
+    T* indices = reinterpret_cast<T*>(m_indexBuffer.GetIndexData());
+    const auto& subsets = m_triangles.subsets;
+
+    // Order each subset's triangles along a space-filling curve, which also makes any split of it spatially coherent
+    if (reorderTriangles || splitSubsets)
     {
-        positions[i] = *reinterpret_cast<XMFLOAT3*>(m_vertexBuffer.GetVertex(i));
+        ParallelFor(subsets.size(), [&](size_t i)
+        {
+            SortFacesSpatially(indices + subsets[i].first * 3, subsets[i].second, positions.data());
+        });
     }
 
-    std::vector<std::pair<size_t, size_t>> meshletSubsets;
-    meshletSubsets.resize(m_subsets.size());
+    // One task per subset, or per piece of a large subset when splitting
+    std::vector<MeshletTask> tasks;
+    std::vector<size_t> subsetTaskCounts(subsets.size());
+
+    for (size_t i = 0; i < subsets.size(); ++i)
+    {
+        size_t pieceCount = splitSubsets ? (subsets[i].second + c_MaxFacesPerTask - 1) / c_MaxFacesPerTask : 1;
+        pieceCount = std::max<size_t>(pieceCount, 1);
+
+        for (size_t piece = 0; piece < pieceCount; ++piece)
+        {
+            tasks.emplace_back();
+            tasks.back().faceOffset = subsets[i].first + subsets[i].second * piece / pieceCount;
+            tasks.back().faceCount = subsets[i].first + subsets[i].second * (piece + 1) / pieceCount - tasks.back().faceOffset;
+        }
+
+        subsetTaskCounts[i] = pieceCount;
+    }
 
     // Meshletize our mesh and generate per-meshlet culling data
-    ThrowIfFailed(ComputeMeshlets(
-        reinterpret_cast<T*>(m_indexBuffer.GetIndexData()), m_indexBuffer.GetIndexCount() / 3,
-        positions.data(), positions.size(),
-        m_subsets.data(), m_subsets.size(),
-        nullptr,
-        m.meshlets,
-        m.uniqueVertexIndices,
-        m.primitiveIndices,
-        meshletSubsets.data(),
-        meshletMaxVerts,
-        meshletMaxPrims
-    ));
-
-    m.cullData.resize(m.meshlets.size());
-
-    ThrowIfFailed(ComputeCullData(
-        positions.data(), positions.size(),
-        m.meshlets.data(), m.meshlets.size(),
-        reinterpret_cast<T*>(m.uniqueVertexIndices.data()), m.uniqueVertexIndices.size(),
-        m.primitiveIndices.data(), m.primitiveIndices.size(),
-        m.cullData.data(),
-        MESHLET_DEFAULT
-    ));
-
-    m.subsets.resize(meshletSubsets.size());
-    for (size_t i = 0; i < meshletSubsets.size(); ++i)
-    {
-        m.subsets[i].Offset = static_cast<uint32_t>(meshletSubsets[i].first);
-        m.subsets[i].Count = static_cast<uint32_t>(meshletSubsets[i].second);
+    ParallelFor(tasks.size(), [&](size_t i)
+    {
+        MeshletTask& task = tasks[i];
+        if (reorderTriangles)
+        {
+            OptimizeFacesForReuse(indices + task.faceOffset * 3, task.faceCount);
+        }
+
+        MeshletizeTask(indices, positions.data(), meshletMaxVerts, meshletMaxPrims, task);
+    });
+
+    // Merge the tasks' meshlets in subset order
+    size_t taskIndex = 0;
+    m.subsets.resize(subsets.size());
+
+    for (size_t i = 0; i < subsets.size(); ++i)
+    {
+        m.subsets[i].Offset = static_cast<uint32_t>(m.meshlets.size());
+
+        for (size_t piece = 0; piece < subsetTaskCounts[i]; ++piece, ++taskIndex)
+        {
+            AppendTask<T>(tasks[taskIndex], m);
+            tasks[taskIndex] = MeshletTask();
+        }
+
+        m.subsets[i].Count = static_cast<uint32_t>(m.meshlets.size()) - m.subsets[i].Offset;
+    }
+}
+
+template <typename T>
+void MeshProcessor::GenerateLods(uint32_t meshletMaxVerts, uint32_t meshletMaxPrims, uint32_t lodCount, MeshletSet& m)
+{
+    const size_t subsetCount = m.subsets.size();
+
+    m.lodCount = 1;
+    m.lodSubsets = m.subsets;
+    m.lodData.resize(m.meshlets.size());
+
+    // Full detail meshlets are bounded by their culling spheres and have no error
+    for (size_t i = 0; i < m.meshlets.size(); ++i)
+    {
+        const auto& sphere = m.cullData[i].BoundingSphere;
+        const XMFLOAT4 bounds(sphere.Center.x, sphere.Center.y, sphere.Center.z, sphere.Radius);
+
+        m.lodData[i] = MeshletLod{ bounds, bounds, 0.0f, FLT_MAX };
+    }
+
+    if (lodCount < 2)
+        return;
+
+    std::vector<XMFLOAT3> positions;
+    GetPositions(positions);
+
+    std::vector<std::vector<LodCluster>> clusters(subsetCount);
+    for (size_t i = 0; i < subsetCount; ++i)
+    {
+        for (uint32_t j = 0; j < m.subsets[i].Count; ++j)
+        {
+            clusters[i].push_back(MakeLodCluster<T>(m, m.subsets[i].Offset + j));
+        }
+    }
+
+    std::vector<bool> finishedSubsets(subsetCount, false);
+    std::vector<uint32_t> vertexGroups(positions.size());
+    std::vector<bool> lockedVertices(positions.size());
+
+    for (uint32_t level = 1; level < lodCount; ++level)
+    {
+        // Group each subset's meshlets with their spatial neighbors
+        std::vector<LodGroup> groups;
+        for (size_t i = 0; i < subsetCount; ++i)
+        {
+            if (clusters[i].size() < 2 || finishedSubsets[i])
+                continue;
+
+            SortClustersSpatially(clusters[i]);
+
+            for (size_t first = 0; first < clusters[i].size(); first += c_MeshletsPerLodGroup)
+            {
+                groups.emplace_back();
+                groups.back().subset = i;
+                groups.back().firstCluster = first;
+                groups.back().clusterCount = std::min<size_t>(c_MeshletsPerLodGroup, clusters[i].size() - first);
+            }
+        }
+
+        if (groups.empty())
+            break;
+
+        // Lock the vertices shared between groups so neighboring groups still meet after simplification.
+        // Subsets that aren't simplified any further count as a single group.
+        std::fill(vertexGroups.begin(), vertexGroups.end(), UINT32_MAX);
+        std::fill(lockedVertices.begin(), lockedVertices.end(), false);
+
+        auto claimVertices = [&](const LodCluster& cluster, uint32_t group)
+        {
+            for (uint32_t index : cluster.indices)
+            {
+                if (vertexGroups[index] == UINT32_MAX)
+                {
+                    vertexGroups[index] = group;
+                }
+                else if (vertexGroups[index] != group)
+                {
+                    lockedVertices[index] = true;
+                }
+            }
+        };
+
+        for (uint32_t i = 0; i < groups.size(); ++i)
+        {
+            for (size_t j = groups[i].firstCluster; j < groups[i].firstCluster + groups[i].clusterCount; ++j)
+            {
+                claimVertices(clusters[groups[i].subset][j], i);
+            }
+        }
+
+        for (size_t i = 0; i < subsetCount; ++i)
+        {
+            if (clusters[i].size() < 2 || finishedSubsets[i])
+            {
+                for (auto& cluster : clusters[i])
+                {
+                    claimVertices(cluster, static_cast<uint32_t>(groups.size() + i));
+                }
+            }
+        }
+
+        ParallelFor(groups.size(), [&](size_t i)
+        {
+            SimplifyLodGroup(clusters[groups[i].subset], m.lodData, positions.data(), lockedVertices, meshletMaxVerts, meshletMaxPrims, groups[i]);
+        });
+
+        // Keep the new level of the subsets it simplified enough; the others end with their previous level
+        const size_t previousLevel = m.lodSubsets.size() - subsetCount;
+        bool simplified = false;
+
+        for (size_t i = 0, groupIndex = 0; i < subsetCount; ++i)
+        {
+            const size_t firstGroup = groupIndex;
+            size_t trianglesBefore = 0;
+            size_t trianglesAfter = 0;
+
+            for (; groupIndex < groups.size() && groups[groupIndex].subset == i; ++groupIndex)
+            {
+                const LodGroup& group = groups[groupIndex];
+                for (size_t j = group.firstCluster; j < group.firstCluster + group.clusterCount; ++j)
+                {
+                    trianglesBefore += clusters[i][j].indices.size() / 3;
+                }
+                trianglesAfter += group.task.primitiveIndices.size();
+            }
+
+            Subset range = m.lodSubsets[previousLevel + i];
+
+            if (trianglesAfter == 0 || trianglesAfter > trianglesBefore * c_MaxLodTriangleRatio)
+            {
+                finishedSubsets[i] = true;
+                m.lodSubsets.push_back(range);
+                continue;
+            }
+
+            range.Offset = static_cast<uint32_t>(m.meshlets.size());
+
+            for (size_t g = firstGroup; g < groupIndex; ++g)
+            {
+                LodGroup& group = groups[g];
+
+                for (size_t j = group.firstCluster; j < group.firstCluster + group.clusterCount; ++j)
+                {
+                    MeshletLod& child = m.lodData[clusters[i][j].meshlet];
+                    child.ParentBounds = group.bounds;
+                    child.ParentError = group.error;
+                }
+
+                AppendTask<T>(group.task, m);
+                m.lodData.resize(m.meshlets.size(), MeshletLod{ group.bounds, group.bounds, group.error, FLT_MAX });
+                group.task = MeshletTask();
+            }
+
+            range.Count = static_cast<uint32_t>(m.meshlets.size()) - range.Offset;
+            m.lodSubsets.push_back(range);
+
+            clusters[i].clear();
+            for (uint32_t j = 0; j < range.Count; ++j)
+            {
+                clusters[i].push_back(MakeLodCluster<T>(m, range.Offset + j));
+            }
+
+            simplified = true;
+        }
+
+        if (!simplified)
+        {
+            m.lodSubsets.resize(previousLevel + subsetCount);
+            break;
+        }
+
+        ++m.lodCount;
     }
 }
@@ -7,7 +7,7 @@
 #pragma once
 
 #include "MeshUtilities.h"
-#include "TriangleAllocator.h"
+#include "TriangleStream.h"
 #include "MeshletSet.h"
 
 #include <memory>
@@ -26,39 +26,48 @@ namespace ATG
     class MeshProcessor
     {
     public:
-        MeshProcessor()
-            : m_dccVertexCount(0)
-        { }
+        MeshProcessor() = default;
 
-        // Generates meshlets for the given FbxNode's mesh.
+        // Extracts the triangles of the given FbxNode's mesh.
+        // The Fbx SDK isn't thread-safe, so this must be called on the thread that owns the scene.
         // Returns whether the operation was successful.
-        bool GenerateMeshlets(
-            fbxsdk::FbxNode* node,
+        bool Extract(fbxsdk::FbxNode* node);
+
+        // Takes the triangles of a mesh loaded without the Fbx SDK, in place of Extract.
+        void SetTriangles(TriangleStream&& triangles);
+
+        // Generates meshlets from the extracted triangles. Only touches data owned by this processor,
+        // so processors for different nodes may run concurrently.
+        // Subsets are meshletized in parallel. Large subsets are also split spatially into pieces if splitSubsets
+        // is set, and triangles are reordered for spatial locality and vertex reuse if reorderTriangles is set.
+        // Up to lodCount levels of detail are built by simplifying groups of neighboring meshlets.
+        void GenerateMeshlets(
             const FbxTransformer& transformer,
             uint32_t meshletMaxVerts,
             uint32_t meshletMaxPrims,
             bool flipTriangles,
             bool force32BitIndices,
+            bool reorderTriangles,
+            bool splitSubsets,
+            uint32_t lodCount,
             MeshletSet& meshlet);
 
     private:
         void Reset();
-        bool Extract(fbxsdk::FbxNode* node);
         void Optimize(const FbxTransformer& transformer, bool force32BitIndices);
+        void GetPositions(std::vector<DirectX::XMFLOAT3>& positions) const;
 
         template <typename T>
-        void Meshletize(uint32_t meshletMaxVerts, uint32_t meshletMaxPrims, MeshletSet& set);
+        void Meshletize(uint32_t meshletMaxVerts, uint32_t meshletMaxPrims, bool reorderTriangles, bool splitSubsets, MeshletSet& set);
+
+        template <typename T>
+        void GenerateLods(uint32_t meshletMaxVerts, uint32_t meshletMaxPrims, uint32_t lodCount, MeshletSet& set);
 
     private:
         ExportVB                                m_vertexBuffer;
         ExportIB                                m_indexBuffer;
 
-        uint32_t                                m_dccVertexCount;
-        TriangleAllocator                       m_triAllocator;
-        TriangleArray                           m_rawTriangles;
-        std::vector<std::pair<size_t, size_t>>  m_subsets;
-
-        std::vector<uint32_t>                   m_indexData;
-        VertexArray                             m_vertexData;
+        TriangleStream                          m_triangles;
+        WeldedVertices                          m_vertices;
     };
 }
@@ -0,0 +1,370 @@
+//--------------------------------------------------------------------------------------
+// MeshSimplifier.cpp
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <queue>
+
+using namespace ATG;
+using namespace DirectX;
+
+namespace
+{
+    // Sum of squared distances to a set of planes
+    struct Quadric
+    {
+        double a2, ab, ac, ad;
+        double b2, bc, bd;
+        double c2, cd;
+        double d2;
+
+        Quadric()
+            : a2(0), ab(0), ac(0), ad(0)
+            , b2(0), bc(0), bd(0)
+            , c2(0), cd(0)
+            , d2(0)
+        { }
+
+        void AddPlane(double a, double b, double c, double d)
+        {
+            a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+            b2 += b * b; bc += b * c; bd += b * d;
+            c2 += c * c; cd += c * d;
+            d2 += d * d;
+        }
+
+        Quadric& operator+=(const Quadric& q)
+        {
+            a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+            b2 += q.b2; bc += q.bc; bd += q.bd;
+            c2 += q.c2; cd += q.cd;
+            d2 += q.d2;
+            return *this;
+        }
+
+        double Evaluate(const XMFLOAT3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+
+            double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                + c2 * z * z + 2 * cd * z
+                + d2;
+
+            return std::max(error, 0.0);
+        }
+    };
+
+    // Candidate collapse of one vertex onto another. Stale once either vertex has changed.
+    struct Collapse
+    {
+        double   cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+
+        bool operator>(const Collapse& rhs) const { return cost > rhs.cost; }
+    };
+
+    inline XMVECTOR TriangleNormal(XMVECTOR v0, XMVECTOR v1, XMVECTOR v2)
+    {
+        return XMVector3Cross(XMVectorSubtract(v1, v0), XMVectorSubtract(v2, v0));
+    }
+
+    class Simplifier
+    {
+    public:
+        Simplifier(std::vector<uint32_t>& indices, const XMFLOAT3* positions, size_t vertexCount, const std::vector<bool>& lockedVertices)
+            : m_indices(indices)
+            , m_positions(positions)
+            , m_locked(lockedVertices)
+            , m_removed(vertexCount, false)
+            , m_versions(vertexCount, 0)
+            , m_quadrics(vertexCount)
+            , m_vertexTriangles(vertexCount)
+            , m_aliveCount(0)
+            , m_maxCost(0)
+        { }
+
+        float Run(size_t targetTriangleCount)
+        {
+            const size_t triangleCount = m_indices.size() / 3;
+            m_alive.assign(triangleCount, false);
+
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                const uint32_t* tri = &m_indices[t * 3];
+                if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+                    continue;
+
+                m_alive[t] = true;
+                ++m_aliveCount;
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    m_vertexTriangles[tri[i]].push_back(t);
+                }
+
+                XMVECTOR v0 = XMLoadFloat3(&m_positions[tri[0]]);
+                XMVECTOR n = XMVector3Normalize(TriangleNormal(v0, XMLoadFloat3(&m_positions[tri[1]]), XMLoadFloat3(&m_positions[tri[2]])));
+
+                XMFLOAT3 normal;
+                XMStoreFloat3(&normal, n);
+                if (!(normal.x == normal.x) || (normal.x == 0 && normal.y == 0 && normal.z == 0))
+                    continue;
+
+                Quadric q;
+                q.AddPlane(normal.x, normal.y, normal.z, -XMVectorGetX(XMVector3Dot(n, v0)));
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    m_quadrics[tri[i]] += q;
+                }
+            }
+
+            LockOpenEdges();
+
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                if (!m_alive[t])
+                    continue;
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    PushCollapse(m_indices[t * 3 + i], m_indices[t * 3 + (i + 1) % 3]);
+                    PushCollapse(m_indices[t * 3 + (i + 1) % 3], m_indices[t * 3 + i]);
+                }
+            }
+
+            while (m_aliveCount > targetTriangleCount && !m_queue.empty())
+            {
+                Collapse collapse = m_queue.top();
+                m_queue.pop();
+
+                if (m_removed[collapse.from] || m_removed[collapse.to]
+                    || m_versions[collapse.from] != collapse.fromVersion
+                    || m_versions[collapse.to] != collapse.toVersion)
+                    continue;
+
+                if (!IsCollapseValid(collapse.from, collapse.to))
+                    continue;
+
+                ApplyCollapse(collapse.from, collapse.to);
+                m_maxCost = std::max(m_maxCost, collapse.cost);
+            }
+
+            // Compact the surviving triangles
+            size_t count = 0;
+            for (size_t t = 0; t < triangleCount; ++t)
+            {
+                if (m_alive[t])
+                {
+                    std::copy_n(&m_indices[t * 3], 3, &m_indices[count * 3]);
+                    ++count;
+                }
+            }
+            m_indices.resize(count * 3);
+
+            return static_cast<float>(std::sqrt(m_maxCost));
+        }
+
+    private:
+        void LockOpenEdges()
+        {
+            std::vector<uint64_t> edges;
+            edges.reserve(m_aliveCount * 3);
+
+            for (size_t t = 0; t < m_alive.size(); ++t)
+            {
+                if (!m_alive[t])
+                    continue;
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    uint32_t a = m_indices[t * 3 + i];
+                    uint32_t b = m_indices[t * 3 + (i + 1) % 3];
+                    edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+                }
+            }
+
+            std::sort(edges.begin(), edges.end());
+
+            for (size_t i = 0; i < edges.size(); )
+            {
+                size_t j = i + 1;
+                while (j < edges.size() && edges[j] == edges[i])
+                    ++j;
+
+                if (j - i == 1)
+                {
+                    m_locked[static_cast<size_t>(edges[i] >> 32)] = true;
+                    m_locked[static_cast<size_t>(edges[i] & 0xFFFFFFFF)] = true;
+                }
+
+                i = j;
+            }
+        }
+
+        void PushCollapse(uint32_t from, uint32_t to)
+        {
+            if (m_locked[from])
+                return;
+
+            Quadric q = m_quadrics[from];
+            q += m_quadrics[to];
+
+            m_queue.push(Collapse{ q.Evaluate(m_positions[to]), from, to, m_versions[from], m_versions[to] });
+        }
+
+        void GatherNeighbors(uint32_t v, std::vector<uint32_t>& neighbors) const
+        {
+            neighbors.clear();
+            for (uint32_t t : m_vertexTriangles[v])
+            {
+                if (!m_alive[t])
+                    continue;
+
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    if (m_indices[t * 3 + i] != v)
+                    {
+                        neighbors.push_back(m_indices[t * 3 + i]);
+                    }
+                }
+            }
+
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        }
+
+        bool IsCollapseValid(uint32_t from, uint32_t to)
+        {
+            // The edge must still exist, and the collapse must keep the surface manifold: the vertices may only
+            // share the neighbors opposite the edge
+            size_t sharedTriangles = 0;
+            for (uint32_t t : m_vertexTriangles[from])
+            {
+                if (m_alive[t] && (m_indices[t * 3] == to || m_indices[t * 3 + 1] == to || m_indices[t * 3 + 2] == to))
+                {
+                    ++sharedTriangles;
+                }
+            }
+
+            if (!sharedTriangles)
+                return false;
+
+            GatherNeighbors(from, m_fromNeighbors);
+            GatherNeighbors(to, m_toNeighbors);
+
+            m_sharedNeighbors.clear();
+            std::set_intersection(m_fromNeighbors.begin(), m_fromNeighbors.end(), m_toNeighbors.begin(), m_toNeighbors.end(), std::back_inserter(m_sharedNeighbors));
+
+            if (m_sharedNeighbors.size() != sharedTriangles)
+                return false;
+
+            // Moving the vertex mustn't flip or collapse any of the triangles that survive
+            XMVECTOR target = XMLoadFloat3(&m_positions[to]);
+
+            for (uint32_t t : m_vertexTriangles[from])
+            {
+                if (!m_alive[t])
+                    continue;
+
+                const uint32_t* tri = &m_indices[t * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                    continue;
+
+                XMVECTOR v[3];
+                XMVECTOR moved[3];
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    v[i] = XMLoadFloat3(&m_positions[tri[i]]);
+                    moved[i] = tri[i] == from ? target : v[i];
+                }
+
+                XMVECTOR before = TriangleNormal(v[0], v[1], v[2]);
+                XMVECTOR after = TriangleNormal(moved[0], moved[1], moved[2]);
+
+                float dot = XMVectorGetX(XMVector3Dot(before, after));
+                float lengths = XMVectorGetX(XMVector3Length(before)) * XMVectorGetX(XMVector3Length(after));
+
+                if (!(dot > 1e-3f * lengths) || lengths == 0.0f)
+                    return false;
+            }
+
+            return true;
+        }
+
+        void ApplyCollapse(uint32_t from, uint32_t to)
+        {
+            for (uint32_t t : m_vertexTriangles[from])
+            {
+                if (!m_alive[t])
+                    continue;
+
+                uint32_t* tri = &m_indices[t * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                {
+                    m_alive[t] = false;
+                    --m_aliveCount;
+                    continue;
+                }
+
+                std::replace(tri, tri + 3, from, to);
+                m_vertexTriangles[to].push_back(t);
+            }
+
+            m_vertexTriangles[from].clear();
+            m_quadrics[to] += m_quadrics[from];
+            m_removed[from] = true;
+            ++m_versions[to];
+
+            // Every collapse along an edge of the target vertex now has a different cost
+            GatherNeighbors(to, m_toNeighbors);
+            for (uint32_t n : m_toNeighbors)
+            {
+                PushCollapse(n, to);
+                PushCollapse(to, n);
+            }
+        }
+
+    private:
+        std::vector<uint32_t>&      m_indices;
+        const XMFLOAT3*             m_positions;
+        std::vector<bool>           m_locked;
+        std::vector<bool>           m_removed;
+        std::vector<bool>           m_alive;
+        std::vector<uint32_t>       m_versions;
+        std::vector<Quadric>        m_quadrics;
+
+        std::vector<std::vector<uint32_t>> m_vertexTriangles;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_queue;
+
+        size_t                      m_aliveCount;
+        double                      m_maxCost;
+
+        std::vector<uint32_t>       m_fromNeighbors;
+        std::vector<uint32_t>       m_toNeighbors;
+        std::vector<uint32_t>       m_sharedNeighbors;
+    };
+}
+
+float ATG::SimplifyTriangles(
+    std::vector<uint32_t>& indices,
+    const XMFLOAT3* positions,
+    size_t vertexCount,
+    const std::vector<bool>& lockedVertices,
+    size_t targetTriangleCount)
+{
+    Simplifier simplifier(indices, positions, vertexCount, lockedVertices);
+    return simplifier.Run(targetTriangleCount);
+}
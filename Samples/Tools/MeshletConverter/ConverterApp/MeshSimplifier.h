@@ -0,0 +1,27 @@
+//--------------------------------------------------------------------------------------
+// MeshSimplifier.h
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ATG
+{
+    // Simplifies an indexed triangle list in place with quadric error edge collapses until at most
+    // targetTriangleCount triangles remain, or no collapse is possible.
+    // Vertices are only ever collapsed onto other existing vertices, so the result indexes the same
+    // vertex buffer. Locked vertices and vertices on open edges (including attribute seams) don't move.
+    // Returns the largest object space error introduced.
+    float SimplifyTriangles(
+        std::vector<uint32_t>& indices,
+        const DirectX::XMFLOAT3* positions,
+        size_t vertexCount,
+        const std::vector<bool>& lockedVertices,
+        size_t targetTriangleCount);
+}
@@ -6,6 +6,28 @@
 //--------------------------------------------------------------------------------------
 #include "MeshUtilities.h"
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 using namespace ATG;
 
 uint8_t* ExportVB::GetVertex(size_t uIndex)
@@ -54,3 +76,205 @@ void ExportIB::Allocate()
 
     std::memset(m_indexData.get(), 0, m_bufferSize);
 }
+
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#else
+    , m_file(-1)
+#endif
+{ }
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const char* filename)
+{
+    Close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(m_file, &fileSize))
+    {
+        Close();
+        return false;
+    }
+
+    // Empty files can't be mapped
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    if (!m_size)
+        return true;
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+    {
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    m_file = open(filename, O_RDONLY);
+    if (m_file < 0)
+        return false;
+
+    struct stat status = {};
+    if (fstat(m_file, &status) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    // Empty files can't be mapped
+    m_size = static_cast<size_t>(status.st_size);
+    if (!m_size)
+        return true;
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data != MAP_FAILED)
+    {
+        m_data = static_cast<const uint8_t*>(data);
+    }
+#endif
+
+    if (!m_data)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    if (m_file >= 0)
+    {
+        close(m_file);
+    }
+
+    m_file = -1;
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+namespace
+{
+    // Threads started by the ParallelFor calls in progress. Every call shares one budget of a thread per
+    // hardware thread, so calls nested inside func (the importer's nodes welding and meshletizing their
+    // subsets) only start threads while some are idle and never multiply the thread count.
+    std::atomic<size_t> s_startedThreads(0);
+
+    size_t ReserveThreads(size_t wanted)
+    {
+        // The calling thread of the outermost call is the one thread the budget doesn't count
+        const size_t limit = std::max<unsigned>(1u, std::thread::hardware_concurrency()) - 1;
+
+        size_t started = s_startedThreads;
+        size_t granted;
+        do
+        {
+            granted = (started < limit) ? std::min(wanted, limit - started) : 0;
+            if (!granted)
+                return 0;
+        } while (!s_startedThreads.compare_exchange_weak(started, started + granted));
+
+        return granted;
+    }
+}
+
+void ATG::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+    const size_t threadCount = (count > 1) ? ReserveThreads(count - 1) : 0;
+    if (!threadCount)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count && !failed; i = next++)
+        {
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    try
+    {
+        threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+    }
+    catch (const std::exception&)
+    {
+        // Carry on with the threads that did start
+    }
+
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    s_startedThreads -= threadCount;
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <cassert>
+#include <functional>
 #include <inttypes.h>
 #include <memory>
 
@@ -102,4 +103,39 @@ namespace ATG
         uint32_t                    m_bufferSize;
         std::unique_ptr<uint8_t[]>  m_indexData;
     };
+
+
+    // Read-only memory mapping of an entire file.
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const char* filename);
+        void Close();
+
+        const uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        const uint8_t*  m_data;
+        size_t          m_size;
+#ifdef _WIN32
+        void*           m_file;
+        void*           m_mapping;
+#else
+        int             m_file;
+#endif
+    };
+
+
+    // Calls func for each index in [0, count) across worker threads.
+    // The first exception thrown by func is rethrown on the calling thread.
+    // All calls, including calls nested inside func, share one budget of a thread per hardware thread;
+    // a call that finds no idle threads in the budget runs serially on the calling thread.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& func);
 }
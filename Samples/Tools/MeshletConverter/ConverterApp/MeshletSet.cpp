@@ -1,6 +1,10 @@
 #include "MeshletSet.h"
 
+#include "..\Runtime\MeshletCodec.h"
+
+#include <chrono>
 #include <fstream>
+#include <iostream>
 
 using namespace ATG;
 
@@ -14,7 +18,9 @@ namespace
             MESHLET_VERSION_CULLDATA = 0x1,
             MESHLET_VERSION_CULLDATA_UPDATE = 0x2,
             MESHLET_VERSION_GEN_UPDATE = 0x3,
-            MESHLET_VERSION_CURRENT = MESHLET_VERSION_GEN_UPDATE
+            MESHLET_VERSION_LOD = 0x4,
+            MESHLET_VERSION_COMPRESSED = 0x5,
+            MESHLET_VERSION_CURRENT = MESHLET_VERSION_COMPRESSED
         };
 
         uint32_t Prolog;
@@ -23,7 +29,7 @@ namespace
     };
 }
 
-void MeshletSet::Write(std::ostream& stream) const
+void MeshletSet::WriteMeshlets(std::ostream& stream) const
 {
     stream.write(reinterpret_cast<const char*>(&maxVerts), sizeof(maxVerts));
     stream.write(reinterpret_cast<const char*>(&maxPrims), sizeof(maxPrims));
@@ -42,6 +48,11 @@ void MeshletSet::Write(std::ostream& stream) const
         stream.write(reinterpret_cast<const char*>(&submeshCount), 4);
         stream.write(reinterpret_cast<const char*>(subsets.data()), submeshCount * sizeof(subsets[0]));
     }
+}
+
+void MeshletSet::Write(std::ostream& stream) const
+{
+    WriteMeshlets(stream);
 
     {
         uint32_t indexBytes = indexSize;
@@ -60,7 +71,48 @@ void MeshletSet::Write(std::ostream& stream) const
     }
 }
 
-bool MeshletSet::Write(const wchar_t* filePath, const std::vector<MeshletSet>& meshlets)
+void MeshletSet::EncodeStreams(std::vector<uint8_t>& encoded) const
+{
+    const auto primitives = reinterpret_cast<const uint32_t*>(primitiveIndices.data());
+
+    encoded.clear();
+    if (indexSize == 4)
+    {
+        EncodeMeshletStreams(meshlets.data(), meshlets.size(), reinterpret_cast<const uint32_t*>(uniqueVertexIndices.data()), primitives, encoded);
+    }
+    else
+    {
+        EncodeMeshletStreams(meshlets.data(), meshlets.size(), reinterpret_cast<const uint16_t*>(uniqueVertexIndices.data()), primitives, encoded);
+    }
+}
+
+void MeshletSet::WriteCompressed(std::ostream& stream) const
+{
+    WriteMeshlets(stream);
+
+    std::vector<uint8_t> encoded;
+    EncodeStreams(encoded);
+
+    uint32_t indexBytes = indexSize;
+    uint32_t indexCount = (uint32_t)uniqueVertexIndices.size() / indexBytes;
+    uint32_t primCount = (uint32_t)primitiveIndices.size();
+    uint32_t encodedSize = (uint32_t)encoded.size();
+
+    stream.write(reinterpret_cast<const char*>(&indexBytes), 4);
+    stream.write(reinterpret_cast<const char*>(&indexCount), 4);
+    stream.write(reinterpret_cast<const char*>(&primCount), 4);
+    stream.write(reinterpret_cast<const char*>(&encodedSize), 4);
+    stream.write(reinterpret_cast<const char*>(encoded.data()), encodedSize);
+}
+
+void MeshletSet::WriteLods(std::ostream& stream) const
+{
+    stream.write(reinterpret_cast<const char*>(&lodCount), 4);
+    stream.write(reinterpret_cast<const char*>(lodSubsets.data()), lodSubsets.size() * sizeof(lodSubsets[0]));
+    stream.write(reinterpret_cast<const char*>(lodData.data()), lodData.size() * sizeof(lodData[0]));
+}
+
+bool MeshletSet::Write(const wchar_t* filePath, const std::vector<MeshletSet>& meshlets, bool compressStreams)
 {
     auto file = std::ofstream(filePath, std::ios::binary);
     if (!file.is_open())
@@ -68,26 +120,108 @@ bool MeshletSet::Write(const wchar_t* filePath, const std::vector<MeshletSet>& m
         return false;
     }
 
+    // Files without any simplified levels keep the previous version, so older readers can still load them
+    bool hasLods = false;
+    for (auto& m : meshlets)
+    {
+        hasLods |= m.lodCount > 1;
+    }
+
     MeshletFileHeader header;
     header.Prolog = 'MSHL';
-    header.Version = MeshletFileHeader::MESHLET_VERSION_CURRENT;
+    header.Version = compressStreams ? MeshletFileHeader::MESHLET_VERSION_COMPRESSED
+        : hasLods ? MeshletFileHeader::MESHLET_VERSION_LOD
+        : MeshletFileHeader::MESHLET_VERSION_GEN_UPDATE;
     header.Count = static_cast<uint32_t>(meshlets.size());
 
     file.write(reinterpret_cast<char*>(&header), sizeof(header));
 
     for (auto& m : meshlets)
     {
-        m.Write(file);
+        if (compressStreams)
+        {
+            m.WriteCompressed(file);
+            m.WriteLods(file);
+        }
+        else
+        {
+            m.Write(file);
+
+            if (hasLods)
+            {
+                m.WriteLods(file);
+            }
+        }
     }
 
     return true;
 }
 
-bool MeshletSet::Write(const char* filePath, const std::vector<MeshletSet>& meshlets)
+bool MeshletSet::Write(const char* filePath, const std::vector<MeshletSet>& meshlets, bool compressStreams)
 {
     wchar_t widePath[MAX_PATH] = {};
     size_t size;
     mbstowcs_s(&size, widePath, filePath, strlen(filePath));
 
-    return Write(widePath, meshlets);
+    return Write(widePath, meshlets, compressStreams);
+}
+
+void MeshletSet::BenchmarkCompression(const std::vector<MeshletSet>& meshlets)
+{
+    size_t rawSize = 0;
+    size_t encodedSize = 0;
+    double decodeSeconds = 0;
+
+    for (auto& m : meshlets)
+    {
+        std::vector<uint8_t> encoded;
+        m.EncodeStreams(encoded);
+
+        const size_t size = encoded.size();
+        encoded.resize(size + c_MeshletCodecPadding);
+
+        const size_t indexCount = m.uniqueVertexIndices.size() / m.indexSize;
+        std::vector<uint8_t> indices(m.uniqueVertexIndices.size());
+        std::vector<uint32_t> primitives(m.primitiveIndices.size());
+
+        // Decode repeatedly to get a stable measurement of small meshes
+        constexpr int c_Iterations = 16;
+
+        bool decoded = true;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < c_Iterations; ++i)
+        {
+            if (m.indexSize == 4)
+            {
+                decoded &= DecodeMeshletStreams(m.meshlets.data(), m.meshlets.size(), encoded.data(), size,
+                    reinterpret_cast<uint32_t*>(indices.data()), indexCount, primitives.data(), primitives.size());
+            }
+            else
+            {
+                decoded &= DecodeMeshletStreams(m.meshlets.data(), m.meshlets.size(), encoded.data(), size,
+                    reinterpret_cast<uint16_t*>(indices.data()), indexCount, primitives.data(), primitives.size());
+            }
+        }
+
+        decodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / c_Iterations;
+
+        if (!decoded
+            || indices != m.uniqueVertexIndices
+            || std::memcmp(primitives.data(), m.primitiveIndices.data(), primitives.size() * sizeof(uint32_t)) != 0)
+        {
+            std::cout << "Compressed meshlet streams failed to round trip!" << std::endl;
+            return;
+        }
+
+        rawSize += m.uniqueVertexIndices.size() + m.primitiveIndices.size() * sizeof(m.primitiveIndices[0]);
+        encodedSize += size;
+    }
+
+    if (!encodedSize)
+        return;
+
+    std::cout << "Compressed meshlet index streams from " << rawSize << " to " << encodedSize << " bytes ("
+        << double(rawSize) / encodedSize << ":1), decoded at "
+        << double(rawSize) / (std::max)(decodeSeconds, 1e-9) / 1e9 << " GB/s." << std::endl;
 }
@@ -12,6 +12,16 @@ namespace ATG
         uint32_t Offset;
     };
 
+    // Level of detail metadata of a meshlet. A meshlet belongs to the cut rendered for a given error threshold
+    // when its own projected error is within the threshold and its parent's isn't.
+    struct MeshletLod
+    {
+        DirectX::XMFLOAT4 Bounds;       // xyz = center, w = radius of the group the meshlet was built from
+        DirectX::XMFLOAT4 ParentBounds; // Same for the group simplified from the meshlet
+        float             Error;        // Object space simplification error, 0 for the full detail meshlets
+        float             ParentError;  // FLT_MAX if the meshlet isn't simplified any further
+    };
+
     struct MeshletSet
     {
         uint32_t maxVerts;
@@ -24,8 +34,27 @@ namespace ATG
         std::vector<DirectX::MeshletTriangle>  primitiveIndices;
         std::vector<DirectX::CullData>         cullData;
 
+        // Levels of detail. Meshlets of every level share the arrays above; lodSubsets holds the subset
+        // ranges of each level in turn, starting with level 0 (the same ranges as subsets).
+        uint32_t                               lodCount;
+        std::vector<Subset>                    lodSubsets;
+        std::vector<MeshletLod>                lodData;
+
         void Write(std::ostream& stream) const;
-        static bool Write(const wchar_t* filePath, const std::vector<MeshletSet>& meshlets);
-        static bool Write(const char* filePath, const std::vector<MeshletSet>& meshlets);
+        void WriteCompressed(std::ostream& stream) const;
+        void WriteLods(std::ostream& stream) const;
+
+        // Losslessly compresses the unique vertex index & primitive streams (see MeshletCodec.h)
+        void EncodeStreams(std::vector<uint8_t>& encoded) const;
+
+        // Writes the meshlets, optionally with compressed index & primitive streams
+        static bool Write(const wchar_t* filePath, const std::vector<MeshletSet>& meshlets, bool compressStreams = false);
+        static bool Write(const char* filePath, const std::vector<MeshletSet>& meshlets, bool compressStreams = false);
+
+        // Reports the compression ratio and decode throughput of the compressed streams
+        static void BenchmarkCompression(const std::vector<MeshletSet>& meshlets);
+
+    private:
+        void WriteMeshlets(std::ostream& stream) const;
     };
 }
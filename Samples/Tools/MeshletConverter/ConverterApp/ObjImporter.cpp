@@ -0,0 +1,719 @@
+//--------------------------------------------------------------------------------------
+// ObjImporter.cpp
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#include "ObjImporter.h"
+
+#include "MeshUtilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using namespace ATG;
+using namespace DirectX;
+
+namespace
+{
+    // Inputs with less than this much text per thread are parsed on the calling thread
+    constexpr size_t c_MinChunkSize = 1 << 20;
+
+    // Corners resolved per task when looking up normals
+    constexpr size_t c_CornersPerTask = 1 << 18;
+
+    constexpr uint32_t c_NoNormal = UINT32_MAX;
+    constexpr uint32_t c_NoVertex = UINT32_MAX;
+
+    enum class LineType
+    {
+        Other,
+        Position,
+        Normal,
+        Face,
+        Material,
+        Group,
+        Unsupported,
+    };
+
+    enum class RunStart
+    {
+        Chunk,                      // Continues the material and group of the previous chunk
+        Material,                   // usemtl statement
+        Group,                      // g or o statement
+    };
+
+    // Faces between usemtl, g and o statements within a chunk
+    struct FaceRun
+    {
+        RunStart    start;
+        std::string name;           // Material or group name given by the statement that started the run
+        uint64_t    subset;         // Group index in the high 32 bits, material index in the low 32 bits
+        size_t      triangleCount;
+        size_t      triangleOffset;
+    };
+
+    struct Chunk
+    {
+        const char*                 begin;
+        const char*                 end;
+        size_t                      positionCount;
+        size_t                      normalCount;
+        size_t                      positionBase;
+        size_t                      normalBase;
+        uint32_t                    dccVertexCount;
+        std::vector<FaceRun>        runs;
+        std::string                 error;
+        const char*                 unsupported;    // Description of a feature only the Fbx SDK reads
+    };
+
+    struct Corner
+    {
+        uint32_t position;
+        uint32_t normal;
+    };
+
+    inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline bool IsDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline const char* SkipSpace(const char* p, const char* end)
+    {
+        while (p < end && IsSpace(*p))
+        {
+            ++p;
+        }
+        return p;
+    }
+
+    // Returns the end of the line starting at 'line', and the end of its content in contentEnd.
+    // Comments run from any '#' to the end of the line, so they're excluded from the content of every
+    // kind of line and never reach the token counting or parsing.
+    inline const char* FindLineEnd(const char* line, const char* end, const char*& contentEnd)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', size_t(end - line)));
+        if (!lineEnd)
+        {
+            lineEnd = end;
+        }
+
+        const char* comment = static_cast<const char*>(std::memchr(line, '#', size_t(lineEnd - line)));
+        contentEnd = comment ? comment : lineEnd;
+        return lineEnd;
+    }
+
+    // Free-form geometry statements, which only the Fbx SDK imports
+    bool IsFreeFormKeyword(const char* keyword, size_t length)
+    {
+        static const char* const s_keywords[] =
+        {
+            "vp", "cstype", "deg", "bmat", "step", "curv", "curv2", "surf", "parm", "trim", "hole", "scrv", "sp", "end", "con",
+        };
+
+        for (const char* candidate : s_keywords)
+        {
+            if (std::strlen(candidate) == length && std::memcmp(keyword, candidate, length) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Identifies a line by its keyword, leaving p at the first argument
+    LineType Classify(const char*& p, const char* end)
+    {
+        p = SkipSpace(p, end);
+
+        const char* keyword = p;
+        while (p < end && !IsSpace(*p))
+        {
+            ++p;
+        }
+
+        const size_t length = static_cast<size_t>(p - keyword);
+        p = SkipSpace(p, end);
+
+        if (length == 1 && keyword[0] == 'v')
+            return LineType::Position;
+        if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n')
+            return LineType::Normal;
+        if (length == 1 && keyword[0] == 'f')
+            return LineType::Face;
+        if (length == 6 && std::memcmp(keyword, "usemtl", 6) == 0)
+            return LineType::Material;
+        if (length == 1 && (keyword[0] == 'g' || keyword[0] == 'o'))
+            return LineType::Group;
+        if (IsFreeFormKeyword(keyword, length))
+            return LineType::Unsupported;
+
+        return LineType::Other;
+    }
+
+    const char* ParseInt(const char* p, const char* end, int64_t& value)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = (*p == '-');
+            ++p;
+        }
+
+        if (p == end || !IsDigit(*p))
+            return nullptr;
+
+        int64_t result = 0;
+        for (; p < end && IsDigit(*p); ++p)
+        {
+            if (result > (INT64_MAX / 10))
+                return nullptr;
+
+            result = result * 10 + (*p - '0');
+        }
+
+        value = negative ? -result : result;
+        return p;
+    }
+
+    // Parses a decimal float without the locale handling and null-terminator requirement of strtof
+    const char* ParseFloat(const char* p, const char* end, float& value)
+    {
+        static const double s_powersOf10[] =
+        {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = (*p == '-');
+            ++p;
+        }
+
+        uint64_t mantissa = 0;
+        int digitCount = 0;
+        int exponent = 0;
+        bool anyDigits = false;
+
+        for (; p < end && IsDigit(*p); ++p)
+        {
+            anyDigits = true;
+            if (digitCount < 19)
+            {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                digitCount += (mantissa != 0);
+            }
+            else
+            {
+                ++exponent;
+            }
+        }
+
+        if (p < end && *p == '.')
+        {
+            for (++p; p < end && IsDigit(*p); ++p)
+            {
+                anyDigits = true;
+                if (digitCount < 19)
+                {
+                    mantissa = mantissa * 10 + uint64_t(*p - '0');
+                    digitCount += (mantissa != 0);
+                    --exponent;
+                }
+            }
+        }
+
+        if (!anyDigits)
+            return nullptr;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            int64_t power = 0;
+            p = ParseInt(p + 1, end, power);
+            if (!p)
+                return nullptr;
+
+            exponent += static_cast<int>(std::max<int64_t>(-1000, std::min<int64_t>(power, 1000)));
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (exponent < 0 && exponent >= -22)
+        {
+            result /= s_powersOf10[-exponent];
+        }
+        else if (exponent > 0 && exponent <= 22)
+        {
+            result *= s_powersOf10[exponent];
+        }
+        else if (exponent != 0)
+        {
+            result *= std::pow(10.0, exponent);
+        }
+
+        value = static_cast<float>(negative ? -result : result);
+        return p;
+    }
+
+    // Converts a 1-based or negative (relative) OBJ index to a 0-based index
+    bool ResolveIndex(int64_t index, size_t base, size_t localCount, size_t totalCount, uint32_t& result)
+    {
+        int64_t resolved = (index > 0)
+            ? index - 1
+            : int64_t(base + localCount) + index;
+
+        if (index == 0 || resolved < 0 || uint64_t(resolved) >= totalCount)
+            return false;
+
+        result = static_cast<uint32_t>(resolved);
+        return true;
+    }
+
+    // Parses one v, v/vt, v//vn or v/vt/vn face corner
+    const char* ParseCorner(const char* p, const char* end, int64_t& position, int64_t& normal)
+    {
+        normal = 0;
+
+        p = ParseInt(p, end, position);
+        if (!p)
+            return nullptr;
+
+        if (p < end && *p == '/')
+        {
+            ++p;
+            if (p < end && *p != '/')
+            {
+                int64_t texcoord;
+                p = ParseInt(p, end, texcoord);
+                if (!p)
+                    return nullptr;
+            }
+
+            if (p < end && *p == '/')
+            {
+                p = ParseInt(p + 1, end, normal);
+                if (!p)
+                    return nullptr;
+            }
+        }
+
+        if (p < end && !IsSpace(*p))
+            return nullptr;
+
+        return p;
+    }
+
+    // Counts the elements of a chunk so every chunk knows where its data lands in the output
+    void CountChunk(Chunk& chunk, bool triangulate)
+    {
+        chunk.runs.push_back(FaceRun{ RunStart::Chunk, std::string(), 0, 0, 0 });
+
+        for (const char* line = chunk.begin; line < chunk.end; )
+        {
+            const char* lineEnd;
+            const char* p = line;
+            line = FindLineEnd(line, chunk.end, lineEnd) + 1;
+
+            // Trailing whitespace is dropped so names and token counts only see the content
+            while (lineEnd > p && IsSpace(lineEnd[-1]))
+            {
+                --lineEnd;
+            }
+
+            if (lineEnd > p && lineEnd[-1] == '\\')
+            {
+                chunk.unsupported = "Line continuation";
+                return;
+            }
+
+            switch (Classify(p, lineEnd))
+            {
+            case LineType::Position:
+                ++chunk.positionCount;
+                break;
+
+            case LineType::Normal:
+                ++chunk.normalCount;
+                break;
+
+            case LineType::Face:
+            {
+                size_t cornerCount = 0;
+                while (p < lineEnd)
+                {
+                    ++cornerCount;
+                    while (p < lineEnd && !IsSpace(*p))
+                    {
+                        ++p;
+                    }
+                    p = SkipSpace(p, lineEnd);
+                }
+
+                if (cornerCount < 3)
+                {
+                    chunk.error = "Face with fewer than three corners.";
+                    return;
+                }
+
+                if (cornerCount > 3 && !triangulate)
+                {
+                    chunk.error = "Mesh must first be triangulated to meshletize without modifying vertex data. Use the command line switch '-t' if desired.";
+                    return;
+                }
+
+                chunk.runs.back().triangleCount += cornerCount - 2;
+                break;
+            }
+
+            case LineType::Material:
+                chunk.runs.push_back(FaceRun{ RunStart::Material, std::string(p, lineEnd), 0, 0, 0 });
+                break;
+
+            case LineType::Group:
+                chunk.runs.push_back(FaceRun{ RunStart::Group, std::string(p, lineEnd), 0, 0, 0 });
+                break;
+
+            case LineType::Unsupported:
+                chunk.unsupported = "Free-form geometry";
+                return;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    // Parses a chunk into its reserved ranges of the output arrays
+    void ParseChunk(
+        Chunk& chunk,
+        size_t totalPositions,
+        size_t totalNormals,
+        TriangleStream& triangles,
+        std::vector<XMFLOAT3>& normals,
+        std::vector<uint32_t>& cornerNormalIndices)
+    {
+        std::vector<Corner> corners;
+
+        size_t positionCount = 0;
+        size_t normalCount = 0;
+        size_t runIndex = 0;
+
+        for (const char* line = chunk.begin; line < chunk.end; )
+        {
+            const char* lineEnd;
+            const char* p = line;
+            line = FindLineEnd(line, chunk.end, lineEnd) + 1;
+
+            const LineType type = Classify(p, lineEnd);
+            switch (type)
+            {
+            case LineType::Position:
+            case LineType::Normal:
+            {
+                float values[3];
+                for (float& value : values)
+                {
+                    p = ParseFloat(p, lineEnd, value);
+                    if (!p)
+                    {
+                        chunk.error = "Invalid vertex element.";
+                        return;
+                    }
+                    p = SkipSpace(p, lineEnd);
+                }
+
+                if (type == LineType::Position)
+                {
+                    triangles.dccPositions[chunk.positionBase + positionCount++] = XMFLOAT3(values[0], values[1], values[2]);
+                }
+                else
+                {
+                    // Normals are unit length, as they are when extracted through the Fbx SDK
+                    XMStoreFloat3(&normals[chunk.normalBase + normalCount++],
+                        XMVector3Normalize(XMVectorSet(values[0], values[1], values[2], 0.0f)));
+                }
+                break;
+            }
+
+            case LineType::Face:
+            {
+                corners.clear();
+                while (p < lineEnd)
+                {
+                    int64_t position;
+                    int64_t normal;
+                    p = ParseCorner(p, lineEnd, position, normal);
+
+                    Corner corner = { 0, c_NoNormal };
+                    if (!p
+                        || !ResolveIndex(position, chunk.positionBase, positionCount, totalPositions, corner.position)
+                        || (normal && !ResolveIndex(normal, chunk.normalBase, normalCount, totalNormals, corner.normal)))
+                    {
+                        chunk.error = "Invalid face corner.";
+                        return;
+                    }
+
+                    corners.push_back(corner);
+                    chunk.dccVertexCount = std::max<uint32_t>(chunk.dccVertexCount, corner.position + 1);
+
+                    p = SkipSpace(p, lineEnd);
+                }
+
+                // Fan triangulate the polygon
+                FaceRun& run = chunk.runs[runIndex];
+                for (size_t i = 2; i < corners.size(); ++i)
+                {
+                    const size_t first = 3 * run.triangleOffset++;
+                    const Corner* triCorners[3] = { &corners[0], &corners[i - 1], &corners[i] };
+
+                    for (size_t j = 0; j < 3; ++j)
+                    {
+                        triangles.cornerDCCIndices[first + j] = triCorners[j]->position;
+                        cornerNormalIndices[first + j] = triCorners[j]->normal;
+                    }
+                }
+                break;
+            }
+
+            case LineType::Material:
+            case LineType::Group:
+                ++runIndex;
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+}
+
+bool ATG::ParseObj(const char* data, size_t size, bool triangulate, std::vector<TriangleStream>& meshes, bool& unsupported)
+{
+    meshes.clear();
+    unsupported = false;
+
+    if (!data && size)
+        return false;
+
+    // Split the text into line-aligned chunks
+    const size_t chunkCount = std::max<size_t>(1,
+        std::min<size_t>(size / c_MinChunkSize, std::thread::hardware_concurrency() * 4));
+
+    std::vector<Chunk> chunks(chunkCount);
+
+    const char* end = data + size;
+    const char* chunkBegin = data;
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        const char* chunkEnd = (i + 1 == chunkCount) ? end : data + size * (i + 1) / chunkCount;
+        if (chunkEnd < chunkBegin)
+        {
+            chunkEnd = chunkBegin;
+        }
+
+        const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', size_t(end - chunkEnd)));
+        chunkEnd = newline ? newline + 1 : end;
+
+        chunks[i] = Chunk{ chunkBegin, chunkEnd, 0, 0, 0, 0, 0, {}, {}, nullptr };
+        chunkBegin = chunkEnd;
+    }
+
+    ParallelFor(chunkCount, [&](size_t i) { CountChunk(chunks[i], triangulate); });
+
+    // Place each chunk's vertex elements, and number the groups and materials in order of first use.
+    // Faces before any g, o or usemtl statement belong to group 0 and material 0.
+    std::unordered_map<std::string, uint32_t> groupIndices;
+    std::unordered_map<std::string, uint32_t> materialIndices;
+    std::map<uint64_t, size_t> subsetTriangleCounts;
+
+    groupIndices.emplace(std::string(), 0);
+
+    size_t totalPositions = 0;
+    size_t totalNormals = 0;
+    uint32_t group = 0;
+    uint32_t material = 0;
+
+    for (auto& chunk : chunks)
+    {
+        if (chunk.unsupported)
+        {
+            std::cout << chunk.unsupported << " isn't supported by the native OBJ parser." << std::endl;
+            unsupported = true;
+            return false;
+        }
+
+        if (!chunk.error.empty())
+        {
+            std::cout << chunk.error << std::endl;
+            return false;
+        }
+
+        chunk.positionBase = totalPositions;
+        chunk.normalBase = totalNormals;
+        totalPositions += chunk.positionCount;
+        totalNormals += chunk.normalCount;
+
+        for (auto& run : chunk.runs)
+        {
+            if (run.start == RunStart::Group)
+            {
+                group = groupIndices.emplace(run.name, static_cast<uint32_t>(groupIndices.size())).first->second;
+            }
+            else if (run.start == RunStart::Material)
+            {
+                material = materialIndices.emplace(run.name, static_cast<uint32_t>(materialIndices.size() + 1)).first->second;
+            }
+
+            run.subset = (uint64_t(group) << 32) | material;
+            subsetTriangleCounts[run.subset] += run.triangleCount;
+        }
+    }
+
+    if (totalPositions > UINT32_MAX)
+    {
+        std::cout << "Mesh has too many vertices." << std::endl;
+        return false;
+    }
+
+    // Triangles are grouped by group, then by material within each group, keeping their file order within
+    // each subset. Each group with any triangles becomes a mesh.
+    struct GroupRange
+    {
+        size_t                                  triangleOffset;
+        std::vector<std::pair<size_t, size_t>>  subsets;
+    };
+
+    std::vector<GroupRange> groups;
+    std::map<uint64_t, size_t> subsetOffsets;
+    uint32_t lastGroup = 0;
+    size_t triangleCount = 0;
+
+    for (auto& subset : subsetTriangleCounts)
+    {
+        if (!subset.second)
+            continue;
+
+        const uint32_t subsetGroup = static_cast<uint32_t>(subset.first >> 32);
+        if (groups.empty() || subsetGroup != lastGroup)
+        {
+            lastGroup = subsetGroup;
+            groups.push_back(GroupRange{ triangleCount, {} });
+        }
+
+        GroupRange& range = groups.back();
+        range.subsets.emplace_back(triangleCount - range.triangleOffset, subset.second);
+
+        subsetOffsets[subset.first] = triangleCount;
+        triangleCount += subset.second;
+    }
+
+    for (auto& chunk : chunks)
+    {
+        for (auto& run : chunk.runs)
+        {
+            if (run.triangleCount)
+            {
+                size_t& offset = subsetOffsets[run.subset];
+                run.triangleOffset = offset;
+                offset += run.triangleCount;
+            }
+        }
+    }
+
+    TriangleStream triangles;
+    std::vector<XMFLOAT3> normals(totalNormals);
+    std::vector<uint32_t> cornerNormalIndices(triangleCount * 3);
+
+    triangles.dccPositions.resize(totalPositions);
+    triangles.cornerDCCIndices.resize(triangleCount * 3);
+    triangles.cornerNormals.resize(triangleCount * 3);
+
+    ParallelFor(chunkCount, [&](size_t i)
+    {
+        ParseChunk(chunks[i], totalPositions, totalNormals, triangles, normals, cornerNormalIndices);
+    });
+
+    for (auto& chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            std::cout << chunk.error << std::endl;
+            return false;
+        }
+
+        triangles.dccVertexCount = std::max<uint32_t>(triangles.dccVertexCount, chunk.dccVertexCount);
+    }
+
+    // Faces can reference normals from any chunk, so they're looked up once every chunk is parsed
+    const size_t cornerCount = cornerNormalIndices.size();
+    ParallelFor((cornerCount + c_CornersPerTask - 1) / c_CornersPerTask, [&](size_t task)
+    {
+        const size_t cornerEnd = std::min<size_t>(cornerCount, (task + 1) * c_CornersPerTask);
+        for (size_t i = task * c_CornersPerTask; i < cornerEnd; ++i)
+        {
+            const uint32_t normal = cornerNormalIndices[i];
+            triangles.cornerNormals[i] = (normal == c_NoNormal) ? XMFLOAT3(0.0f, 0.0f, 0.0f) : normals[normal];
+        }
+    });
+
+    if (groups.size() <= 1)
+    {
+        // A single mesh keeps the file's vertex numbering
+        if (!groups.empty())
+        {
+            triangles.subsets = std::move(groups[0].subsets);
+            meshes.emplace_back(std::move(triangles));
+        }
+        return true;
+    }
+
+    // OBJ vertices are shared by the whole file, so each group's mesh takes the vertices its faces
+    // reference, numbered in order of first reference
+    std::vector<uint32_t> dccIndices(totalPositions, c_NoVertex);
+    meshes.resize(groups.size());
+
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        const size_t cornerBegin = 3 * groups[i].triangleOffset;
+        const size_t cornerEnd = (i + 1 < groups.size()) ? 3 * groups[i + 1].triangleOffset : cornerCount;
+
+        TriangleStream& mesh = meshes[i];
+        mesh.subsets = std::move(groups[i].subsets);
+        mesh.cornerDCCIndices.resize(cornerEnd - cornerBegin);
+        mesh.cornerNormals.assign(triangles.cornerNormals.begin() + ptrdiff_t(cornerBegin), triangles.cornerNormals.begin() + ptrdiff_t(cornerEnd));
+
+        for (size_t corner = cornerBegin; corner < cornerEnd; ++corner)
+        {
+            const uint32_t position = triangles.cornerDCCIndices[corner];
+            uint32_t& dccIndex = dccIndices[position];
+            if (dccIndex == c_NoVertex)
+            {
+                dccIndex = static_cast<uint32_t>(mesh.dccPositions.size());
+                mesh.dccPositions.push_back(triangles.dccPositions[position]);
+            }
+
+            mesh.cornerDCCIndices[corner - cornerBegin] = dccIndex;
+        }
+
+        mesh.dccVertexCount = static_cast<uint32_t>(mesh.dccPositions.size());
+
+        // Reset only the entries this group used, so the remap costs time in the corners rather than the vertices
+        for (size_t corner = cornerBegin; corner < cornerEnd; ++corner)
+        {
+            dccIndices[triangles.cornerDCCIndices[corner]] = c_NoVertex;
+        }
+    }
+
+    return true;
+}
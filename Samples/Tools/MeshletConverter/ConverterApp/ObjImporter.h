@@ -0,0 +1,27 @@
+//--------------------------------------------------------------------------------------
+// ObjImporter.h
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include "TriangleStream.h"
+
+namespace ATG
+{
+    // Parses Wavefront OBJ text into triangle streams without the Fbx SDK. The input is split
+    // into line-aligned chunks that are parsed in parallel.
+    //
+    // Each g or o statement starts a group, and each group with faces becomes a mesh, in order of first
+    // use. Faces before any group belong to the first, and naming an earlier group adds to it. A mesh's DCC vertices are the positions its faces
+    // reference, in order of first reference, unless the file only has one mesh, whose DCC vertex
+    // indices are the file's position indices. Each usemtl statement starts a subset, numbered in
+    // order of first use after the faces that precede any usemtl. Normals are normalized, and corners
+    // without a normal get a zero normal. Comments run from any '#' to the end of the line.
+    // Polygons are fan triangulated if triangulate is set, otherwise they're rejected.
+    //
+    // Returns false with unsupported set if the file uses free-form geometry or line continuations,
+    // which only the Fbx SDK imports.
+    bool ParseObj(const char* data, size_t size, bool triangulate, std::vector<TriangleStream>& meshes, bool& unsupported);
+}
@@ -0,0 +1,228 @@
+//--------------------------------------------------------------------------------------
+// RawMeshImporter.cpp
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#include "RawMeshImporter.h"
+
+#include "MeshUtilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+using namespace ATG;
+using namespace DirectX;
+
+namespace
+{
+    // Triangles (or vertices) copied per task
+    constexpr size_t c_ElementsPerTask = 1 << 18;
+
+    inline size_t TaskCount(size_t elementCount)
+    {
+        return (elementCount + c_ElementsPerTask - 1) / c_ElementsPerTask;
+    }
+}
+
+bool ATG::ParseRawMesh(const uint8_t* data, size_t size, TriangleStream& triangles)
+{
+    triangles.Clear();
+
+    RawMeshHeader header;
+    if (!data || size < sizeof(header))
+    {
+        std::cout << "Raw mesh file is too small to hold a header." << std::endl;
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != c_RawMeshMagic || header.version != c_RawMeshVersion)
+    {
+        std::cout << "Raw mesh file has an unknown format or version." << std::endl;
+        return false;
+    }
+
+    const bool hasNormals = (header.flags & RAWMESH_NORMALS) != 0;
+    const bool hasSubsets = (header.flags & RAWMESH_SUBSETS) != 0;
+
+    const size_t vertexCount = header.vertexCount;
+    const size_t triangleCount = header.triangleCount;
+
+    const size_t normalOffset = sizeof(header) + vertexCount * sizeof(XMFLOAT3);
+    const size_t indexOffset = normalOffset + (hasNormals ? vertexCount * sizeof(XMFLOAT3) : 0);
+    const size_t subsetOffset = indexOffset + triangleCount * 3 * sizeof(uint32_t);
+    const size_t expectedSize = subsetOffset + (hasSubsets ? triangleCount * sizeof(uint32_t) : 0);
+
+    if (expectedSize != size)
+    {
+        std::cout << "Raw mesh file size doesn't match its header." << std::endl;
+        return false;
+    }
+
+    const uint8_t* positionData = data + sizeof(header);
+    const uint8_t* normalData = data + normalOffset;
+    const uint8_t* indexData = data + indexOffset;
+    const uint8_t* subsetData = data + subsetOffset;
+
+    // Group triangles by subset with a counting sort, keeping their file order within each subset.
+    // Each task counts its own triangles, so the scatter can run in parallel as well.
+    std::vector<uint32_t> triangleSlots;
+    if (hasSubsets && triangleCount)
+    {
+        const size_t taskCount = TaskCount(triangleCount);
+
+        std::vector<std::pair<uint32_t, uint32_t>> taskRanges(taskCount);
+        ParallelFor(taskCount, [&](size_t task)
+        {
+            const size_t end = std::min(triangleCount, (task + 1) * c_ElementsPerTask);
+
+            uint32_t minSubset = UINT32_MAX;
+            uint32_t maxSubset = 0;
+            for (size_t i = task * c_ElementsPerTask; i < end; ++i)
+            {
+                uint32_t subset;
+                std::memcpy(&subset, subsetData + i * sizeof(uint32_t), sizeof(subset));
+                minSubset = std::min(minSubset, subset);
+                maxSubset = std::max(maxSubset, subset);
+            }
+            taskRanges[task] = std::make_pair(minSubset, maxSubset);
+        });
+
+        uint32_t minSubset = UINT32_MAX;
+        uint32_t maxSubset = 0;
+        for (auto& range : taskRanges)
+        {
+            minSubset = std::min(minSubset, range.first);
+            maxSubset = std::max(maxSubset, range.second);
+        }
+
+        const size_t subsetRange = size_t(maxSubset - minSubset) + 1;
+        if (subsetRange > std::max<size_t>(triangleCount, UINT16_MAX))
+        {
+            std::cout << "Raw mesh subset indices are too sparse." << std::endl;
+            return false;
+        }
+
+        std::vector<size_t> counts(taskCount * subsetRange, 0);
+        ParallelFor(taskCount, [&](size_t task)
+        {
+            const size_t end = std::min(triangleCount, (task + 1) * c_ElementsPerTask);
+            size_t* taskCounts = &counts[task * subsetRange];
+
+            for (size_t i = task * c_ElementsPerTask; i < end; ++i)
+            {
+                uint32_t subset;
+                std::memcpy(&subset, subsetData + i * sizeof(uint32_t), sizeof(subset));
+                ++taskCounts[subset - minSubset];
+            }
+        });
+
+        // Turn the counts into each task's first slot for each subset
+        size_t offset = 0;
+        for (size_t subset = 0; subset < subsetRange; ++subset)
+        {
+            const size_t firstTriangle = offset;
+            for (size_t task = 0; task < taskCount; ++task)
+            {
+                const size_t count = counts[task * subsetRange + subset];
+                counts[task * subsetRange + subset] = offset;
+                offset += count;
+            }
+
+            if (offset != firstTriangle)
+            {
+                triangles.subsets.emplace_back(firstTriangle, offset - firstTriangle);
+            }
+        }
+
+        triangleSlots.resize(triangleCount);
+        ParallelFor(taskCount, [&](size_t task)
+        {
+            const size_t end = std::min(triangleCount, (task + 1) * c_ElementsPerTask);
+            size_t* taskOffsets = &counts[task * subsetRange];
+
+            for (size_t i = task * c_ElementsPerTask; i < end; ++i)
+            {
+                uint32_t subset;
+                std::memcpy(&subset, subsetData + i * sizeof(uint32_t), sizeof(subset));
+                triangleSlots[i] = static_cast<uint32_t>(taskOffsets[subset - minSubset]++);
+            }
+        });
+    }
+    else if (triangleCount)
+    {
+        triangles.subsets.emplace_back(0, triangleCount);
+    }
+
+    triangles.dccPositions.resize(vertexCount);
+    triangles.cornerDCCIndices.resize(triangleCount * 3);
+    triangles.cornerNormals.resize(triangleCount * 3);
+
+    ParallelFor(TaskCount(vertexCount), [&](size_t task)
+    {
+        const size_t begin = task * c_ElementsPerTask;
+        const size_t end = std::min(vertexCount, begin + c_ElementsPerTask);
+
+        std::memcpy(&triangles.dccPositions[begin], positionData + begin * sizeof(XMFLOAT3), (end - begin) * sizeof(XMFLOAT3));
+    });
+
+    std::atomic<uint32_t> dccVertexCount(0);
+    std::atomic<bool> invalidIndex(false);
+
+    ParallelFor(TaskCount(triangleCount), [&](size_t task)
+    {
+        const size_t end = std::min(triangleCount, (task + 1) * c_ElementsPerTask);
+
+        uint32_t maxIndex = 0;
+        for (size_t i = task * c_ElementsPerTask; i < end; ++i)
+        {
+            uint32_t indices[3];
+            std::memcpy(indices, indexData + i * sizeof(indices), sizeof(indices));
+
+            const size_t first = 3 * (hasSubsets ? triangleSlots[i] : i);
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const uint32_t index = indices[j];
+                if (index >= vertexCount)
+                {
+                    invalidIndex = true;
+                    return;
+                }
+
+                maxIndex = std::max(maxIndex, index);
+                triangles.cornerDCCIndices[first + j] = index;
+
+                XMFLOAT3& normal = triangles.cornerNormals[first + j];
+                if (hasNormals)
+                {
+                    // Normals are unit length, as they are when extracted through the Fbx SDK
+                    std::memcpy(&normal, normalData + index * sizeof(XMFLOAT3), sizeof(XMFLOAT3));
+                    XMStoreFloat3(&normal, XMVector3Normalize(XMLoadFloat3(&normal)));
+                }
+                else
+                {
+                    normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+                }
+            }
+        }
+
+        uint32_t current = dccVertexCount;
+        while (current < maxIndex + 1 && !dccVertexCount.compare_exchange_weak(current, maxIndex + 1))
+        {
+        }
+    });
+
+    if (invalidIndex)
+    {
+        std::cout << "Raw mesh references a vertex that doesn't exist." << std::endl;
+        triangles.Clear();
+        return false;
+    }
+
+    triangles.dccVertexCount = dccVertexCount;
+
+    return true;
+}
@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------------------
+// RawMeshImporter.h
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include "TriangleStream.h"
+
+namespace ATG
+{
+    // Raw binary mesh layout (.rawmesh), little-endian with no padding:
+    //
+    //   RawMeshHeader
+    //   float      positions[vertexCount][3]
+    //   float      normals[vertexCount][3]     if flags & RAWMESH_NORMALS
+    //   uint32_t   indices[triangleCount][3]
+    //   uint32_t   subsets[triangleCount]      if flags & RAWMESH_SUBSETS
+    //
+    // Vertices map directly to DCC vertices, so meshlet vertex indices refer to the input vertices.
+    // Normals are normalized on import.
+    enum RAWMESH_FLAGS : uint32_t
+    {
+        RAWMESH_NORMALS = 0x1,
+        RAWMESH_SUBSETS = 0x2,
+    };
+
+    struct RawMeshHeader
+    {
+        uint32_t    magic;          // c_RawMeshMagic
+        uint32_t    version;        // c_RawMeshVersion
+        uint32_t    flags;          // RAWMESH_FLAGS
+        uint32_t    vertexCount;
+        uint32_t    triangleCount;
+    };
+
+    constexpr uint32_t c_RawMeshMagic = 0x48534D52; // "RMSH"
+    constexpr uint32_t c_RawMeshVersion = 1;
+
+    // Parses a raw binary mesh into a triangle stream, copying and validating it in parallel chunks.
+    bool ParseRawMesh(const uint8_t* data, size_t size, TriangleStream& triangles);
+}
@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------------------
+// TriangleStream.cpp
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#include "TriangleStream.h"
+
+#include "MeshUtilities.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace ATG;
+using namespace DirectX;
+
+namespace
+{
+    constexpr uint32_t c_Unused = UINT32_MAX;
+
+    // Meshes with fewer corners than this per thread are welded on the calling thread
+    constexpr size_t c_MinCornersPerTask = 1 << 16;
+
+    inline uint32_t FloatBits(float value)
+    {
+        // -0.0 and +0.0 compare equal, so they must hash the same
+        if (value == 0.0f)
+        {
+            value = 0.0f;
+        }
+
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline size_t HashCorner(uint32_t dccIndex, const XMFLOAT3& normal)
+    {
+        uint64_t hash = dccIndex;
+        hash = (hash * 0x9E3779B97F4A7C15ull) ^ FloatBits(normal.x);
+        hash = (hash * 0x9E3779B97F4A7C15ull) ^ FloatBits(normal.y);
+        hash = (hash * 0x9E3779B97F4A7C15ull) ^ FloatBits(normal.z);
+        hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ull;
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    inline bool Equals(const XMFLOAT3& a, const XMFLOAT3& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    // Open addressing hash table of the first corner of each distinct vertex, with linear probing.
+    // Entries hold the DCC index too, so most mismatches are rejected without touching the corner.
+    class CornerTable
+    {
+    public:
+        struct Entry
+        {
+            uint32_t corner;
+            uint32_t dccIndex;
+        };
+
+        explicit CornerTable(size_t expectedCount)
+            : m_count(0)
+        {
+            size_t size = 16;
+            while (size < expectedCount * 2)
+            {
+                size <<= 1;
+            }
+
+            m_entries.assign(size, Entry{ c_Unused, 0 });
+        }
+
+        // Returns the matching corner already in the table, or adds and returns this corner
+        uint32_t FindOrAdd(uint32_t corner, uint32_t dccIndex, const XMFLOAT3* normals)
+        {
+            const XMFLOAT3& normal = normals[corner];
+            const size_t mask = m_entries.size() - 1;
+
+            for (size_t slot = HashCorner(dccIndex, normal) & mask; ; slot = (slot + 1) & mask)
+            {
+                Entry& entry = m_entries[slot];
+                if (entry.corner == c_Unused)
+                {
+                    entry = Entry{ corner, dccIndex };
+                    if (++m_count * 2 > m_entries.size())
+                    {
+                        Grow(normals);
+                    }
+                    return corner;
+                }
+
+                if (entry.dccIndex == dccIndex && Equals(normals[entry.corner], normal))
+                    return entry.corner;
+            }
+        }
+
+    private:
+        void Grow(const XMFLOAT3* normals)
+        {
+            std::vector<Entry> entries(m_entries.size() * 2, Entry{ c_Unused, 0 });
+            const size_t mask = entries.size() - 1;
+
+            for (const Entry& entry : m_entries)
+            {
+                if (entry.corner == c_Unused)
+                    continue;
+
+                size_t slot = HashCorner(entry.dccIndex, normals[entry.corner]) & mask;
+                while (entries[slot].corner != c_Unused)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                entries[slot] = entry;
+            }
+
+            m_entries.swap(entries);
+        }
+
+        std::vector<Entry>  m_entries;
+        size_t              m_count;
+    };
+}
+
+void TriangleStream::Clear()
+{
+    dccVertexCount = 0;
+    dccPositions.clear();
+    cornerDCCIndices.clear();
+    cornerNormals.clear();
+    subsets.clear();
+}
+
+void ATG::WeldVertices(const TriangleStream& stream, WeldedVertices& result)
+{
+    const size_t cornerCount = stream.cornerDCCIndices.size();
+    const uint32_t* dccIndices = stream.cornerDCCIndices.data();
+    const XMFLOAT3* positions = stream.dccPositions.data();
+    const XMFLOAT3* normals = stream.cornerNormals.data();
+
+    // Find the earliest corner identical to each corner
+    std::vector<uint32_t> firstCorners(cornerCount);
+
+    const size_t taskCount = std::max<size_t>(1,
+        std::min<size_t>(cornerCount / c_MinCornersPerTask, std::thread::hardware_concurrency()));
+
+    // NaN positions never compare equal, so their corners are never welded
+    auto isWeldable = [&](size_t corner)
+    {
+        const XMFLOAT3& position = positions[dccIndices[corner]];
+        return Equals(position, position);
+    };
+
+    if (taskCount == 1)
+    {
+        // Most DCC vertices only need a single vertex, so start with room for one each
+        CornerTable table(stream.dccVertexCount);
+
+        for (size_t corner = 0; corner < cornerCount; ++corner)
+        {
+            firstCorners[corner] = isWeldable(corner)
+                ? table.FindOrAdd(static_cast<uint32_t>(corner), dccIndices[corner], normals)
+                : static_cast<uint32_t>(corner);
+        }
+    }
+    else
+    {
+        // Identical corners always hash the same, so counting sort the corners into one bucket per task
+        // by hash range and have each task weld its own bucket with its own hash table. firstCorners
+        // holds each corner's bucket until the task owning the corner overwrites it.
+        std::vector<size_t> bucketStarts(taskCount + 1, 0);
+
+        for (size_t corner = 0; corner < cornerCount; ++corner)
+        {
+            if (!isWeldable(corner))
+            {
+                firstCorners[corner] = c_Unused;
+                continue;
+            }
+
+            const auto hash = static_cast<uint32_t>(HashCorner(dccIndices[corner], normals[corner]));
+            const auto bucket = static_cast<uint32_t>((uint64_t(hash) * taskCount) >> 32);
+
+            firstCorners[corner] = bucket;
+            ++bucketStarts[bucket + 1];
+        }
+
+        for (size_t bucket = 0; bucket < taskCount; ++bucket)
+        {
+            bucketStarts[bucket + 1] += bucketStarts[bucket];
+        }
+
+        std::vector<uint32_t> sortedCorners(bucketStarts[taskCount]);
+        std::vector<size_t> bucketEnds(bucketStarts.begin(), bucketStarts.end() - 1);
+
+        for (size_t corner = 0; corner < cornerCount; ++corner)
+        {
+            const uint32_t bucket = firstCorners[corner];
+            if (bucket == c_Unused)
+            {
+                firstCorners[corner] = static_cast<uint32_t>(corner);
+                continue;
+            }
+
+            sortedCorners[bucketEnds[bucket]++] = static_cast<uint32_t>(corner);
+        }
+
+        // Each bucket is in increasing corner order, so the first corner of each vertex is the one added
+        ParallelFor(taskCount, [&](size_t task)
+        {
+            CornerTable table(stream.dccVertexCount / taskCount);
+
+            for (size_t j = bucketStarts[task]; j < bucketStarts[task + 1]; ++j)
+            {
+                const uint32_t corner = sortedCorners[j];
+                firstCorners[corner] = table.FindOrAdd(corner, dccIndices[corner], normals);
+            }
+        });
+    }
+
+    // Assign vertex indices in corner order, so duplicates are appended in the order they're first used
+    result.cornerIndices.resize(cornerCount);
+    result.vertexCorners.assign(stream.dccVertexCount, c_Unused);
+
+    for (size_t corner = 0; corner < cornerCount; ++corner)
+    {
+        const uint32_t firstCorner = firstCorners[corner];
+        if (firstCorner != corner)
+        {
+            result.cornerIndices[corner] = result.cornerIndices[firstCorner];
+            continue;
+        }
+
+        uint32_t index = dccIndices[corner];
+        if (result.vertexCorners[index] == c_Unused)
+        {
+            result.vertexCorners[index] = static_cast<uint32_t>(corner);
+        }
+        else
+        {
+            index = static_cast<uint32_t>(result.vertexCorners.size());
+            result.vertexCorners.push_back(static_cast<uint32_t>(corner));
+        }
+
+        result.cornerIndices[corner] = index;
+    }
+}
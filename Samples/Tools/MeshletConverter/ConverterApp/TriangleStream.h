@@ -0,0 +1,50 @@
+//--------------------------------------------------------------------------------------
+// TriangleStream.h
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ATG
+{
+    // Flat, structure-of-arrays triangle list extracted from a mesh.
+    // Corner i of triangle t is element (3 * t + i) of the per-corner arrays, and triangles are
+    // ordered by subset. Positions are stored once per DCC vertex since all its corners share one.
+    struct TriangleStream
+    {
+        uint32_t                                dccVertexCount;     // One past the largest referenced DCC vertex index
+        std::vector<DirectX::XMFLOAT3>          dccPositions;
+        std::vector<uint32_t>                   cornerDCCIndices;
+        std::vector<DirectX::XMFLOAT3>          cornerNormals;
+        std::vector<std::pair<size_t, size_t>>  subsets;            // Triangle offset & count
+
+        TriangleStream()
+            : dccVertexCount(0)
+        { }
+
+        size_t GetTriangleCount() const { return cornerDCCIndices.size() / 3; }
+
+        void Clear();
+    };
+
+    // Result of welding the corners of a triangle stream into a vertex list.
+    struct WeldedVertices
+    {
+        std::vector<uint32_t>   cornerIndices;  // Final vertex index of each corner
+        std::vector<uint32_t>   vertexCorners;  // A corner referencing each vertex, or UINT32_MAX if unused
+
+        size_t GetVertexCount() const { return vertexCorners.size(); }
+    };
+
+    // Collapses corners with an identical DCC vertex, position and normal into a single vertex.
+    // The first vertex of each DCC vertex keeps its DCC index; necessary duplicates are appended
+    // after dccVertexCount in the order they're first referenced.
+    void WeldVertices(const TriangleStream& stream, WeldedVertices& result);
+}
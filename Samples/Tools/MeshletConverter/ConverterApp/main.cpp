@@ -13,18 +13,30 @@ using namespace ATG;
 
 namespace
 {
+    struct OutputOptions
+    {
+        bool CompressStreams;
+        bool Benchmark;
+
+        OutputOptions(void)
+            : CompressStreams(false)
+            , Benchmark(false)
+        { }
+    };
+
     void PrintHelp()
     {
         std::cout << std::endl;
         std::cout << "---------------------------- ATG Meshlet Converter ----------------------------" << std::endl;
-        std::cout << "This tool generates a meshlet structure from meshes in FBX or OBJ file formats." << std::endl;
+        std::cout << "This tool generates a meshlet structure from meshes in FBX, OBJ or raw binary" << std::endl;
+        std::cout << "mesh (.rawmesh) file formats. OBJ and raw mesh files are parsed natively." << std::endl;
         std::cout << "The meshlet structures are packed into a '.bin' file which is placed alongside" << std::endl;
         std::cout << "the input file. No vertex data is modified or exported with the meshlet data, " << std::endl;
         std::cout << "thus the mesh is required to be triangulated." << std::endl;
         std::cout << std::endl;
 
         std::cout << "Usage:" << std::endl;
-        std::cout << "\t<string list> -- Specifies paths to the .fbx or .obj files to process." << std::endl;
+        std::cout << "\t<string list> -- Specifies paths to the .fbx, .obj or .rawmesh files to process." << std::endl;
         std::cout << std::endl;
 
         std::cout << "Switches:" << std::endl;
@@ -35,7 +47,12 @@ namespace
         std::cout << "\t-i            -- Forces vertex indices to be 32 bits, even if only 16 bits are required. Default is false" << std::endl;
         std::cout << "\t-fz           -- Flips the Z axis of the scene geometry. Default is false" << std::endl;
         std::cout << "\t-ft           -- Flips the triangle winding of the scene geometry. Default is false" << std::endl;
-        std::cout << "\t-t            -- Triangulates scene meshes file using FbxGeometryConverter. Default is false" << std::endl;
+        std::cout << "\t-l <int>      -- Specifies the maximum number of levels of detail to generate, including the full detail mesh. Default is 1" << std::endl;
+        std::cout << "\t-c            -- Compresses the meshlet vertex index & primitive streams (lossless). Default is false" << std::endl;
+        std::cout << "\t-bench        -- Reports the compression ratio & decode throughput of the compressed streams. Default is false" << std::endl;
+        std::cout << "\t-ro           -- Reorders triangles for spatial locality and vertex reuse before meshletizing. Default is false" << std::endl;
+        std::cout << "\t-sp           -- Splits large subsets spatially so they're meshletized in parallel. Default is false" << std::endl;
+        std::cout << "\t-t            -- Triangulates scene meshes file using FbxGeometryConverter (OBJ polygons are fan triangulated). Default is false" << std::endl;
         std::cout << std::endl;
 
         std::cout << "Example:" << std::endl;
@@ -43,7 +60,7 @@ namespace
         std::cout << std::endl;
     }
 
-    bool ParseCommandLine(int argc, const char* args[], std::vector<std::string>& files, ImportOptions& options)
+    bool ParseCommandLine(int argc, const char* args[], std::vector<std::string>& files, ImportOptions& options, OutputOptions& output)
     {
         if (argc < 2)
         {
@@ -100,6 +117,27 @@ namespace
 
                 options.MeshletMaxPrims = maxSize;
             }
+            else if (std::strcmp(args[i], "-l") == 0)
+            {
+                if (i + 1 == argc)
+                {
+                    std::cout << "Must provide an integral value for level of detail count if supplying -l switch." << std::endl;
+                    return false;
+                }
+
+                uint32_t lodCount = std::strtoul(args[++i], nullptr, 10);
+                uint32_t adjCount = min(max(lodCount, 1u), 16u);
+
+                if (lodCount != adjCount)
+                {
+                    std::cout << "Level of detail count must be between 1 and 16, inclusively." << std::endl;
+                    std::cout << "Specified: " << lodCount << ", Adjusted: " << adjCount << std::endl;
+
+                    lodCount = adjCount;
+                }
+
+                options.LodCount = lodCount;
+            }
             else if (std::strcmp(args[i], "-s") == 0)
             {
                 if (i + 1 == argc)
@@ -134,6 +172,25 @@ namespace
                 std::cout << "Flipping triangle winding order." << std::endl;
                 options.FlipTriangles = true;
             }
+            else if (std::strcmp(args[i], "-c") == 0)
+            {
+                std::cout << "Compressing meshlet index streams." << std::endl;
+                output.CompressStreams = true;
+            }
+            else if (std::strcmp(args[i], "-bench") == 0)
+            {
+                output.Benchmark = true;
+            }
+            else if (std::strcmp(args[i], "-ro") == 0)
+            {
+                std::cout << "Reordering triangles before meshletizing." << std::endl;
+                options.ReorderTriangles = true;
+            }
+            else if (std::strcmp(args[i], "-sp") == 0)
+            {
+                std::cout << "Splitting large subsets." << std::endl;
+                options.SplitSubsets = true;
+            }
             else
             {
                 files.push_back(args[i]);
@@ -152,7 +209,8 @@ int main(int argc, const char* args[])
     std::vector<std::string> files;
 
     ImportOptions options;
-    ParseCommandLine(argc, args, files, options);
+    OutputOptions output;
+    ParseCommandLine(argc, args, files, options, output);
 
     std::vector<MeshletSet> meshlets;
 
@@ -166,7 +224,12 @@ int main(int argc, const char* args[])
             auto loc = filename.find_last_of(".");
             auto path = filename.substr(0, loc) + ".bin";
 
-            if (MeshletSet::Write(path.c_str(), meshlets))
+            if (output.Benchmark)
+            {
+                MeshletSet::BenchmarkCompression(meshlets);
+            }
+
+            if (MeshletSet::Write(path.c_str(), meshlets, output.CompressStreams))
             {
                 std::cout << "Wrote " << meshlets.size() << " set(s) of meshlets from file \"" << filename << "\"." << std::endl;
             }
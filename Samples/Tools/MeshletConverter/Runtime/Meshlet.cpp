@@ -6,13 +6,20 @@
 //--------------------------------------------------------------------------------------
 #include "Meshlet.h"
 
+#include "MeshletCodec.h"
+
+#include <cfloat>
 #include <fstream>
+#include <stdexcept>
 
 using namespace ATG;
 using namespace DirectX;
 
 namespace
 {
+    // Matches the limit of the converter's -l switch
+    constexpr uint32_t c_MaxLodCount = 16;
+
     template <typename T>
     constexpr T RoundUpDiv(T num, T denom) { return (num + denom - 1) / denom; }
 
@@ -24,6 +31,32 @@ namespace
         return alignedSize;
     }
 
+    // Bytes between the read position and the end of the stream
+    uint64_t GetRemainingSize(std::istream& stream)
+    {
+        const std::streamoff position = stream.tellg();
+        if (position < 0)
+            return 0;
+
+        stream.seekg(0, std::ios::end);
+        const std::streamoff end = stream.tellg();
+        stream.seekg(position);
+
+        return (end < position) ? 0 : uint64_t(end - position);
+    }
+
+    // Error of a bounding sphere projected to a view position, per unit of distance
+    float ProjectError(const XMFLOAT4& bounds, float error, FXMVECTOR viewPosition)
+    {
+        if (error == FLT_MAX)
+            return FLT_MAX;
+
+        XMVECTOR center = XMLoadFloat4(&bounds);
+        float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, viewPosition))) - bounds.w;
+
+        return error / (std::max)(distance, FLT_EPSILON);
+    }
+
     struct MeshletFileHeader
     {
         enum
@@ -32,7 +65,9 @@ namespace
             MESHLET_VERSION_CULLDATA = 0x1,
             MESHLET_VERSION_CULLDATA_UPDATE = 0x2,
             MESHLET_VERSION_GEN_UPDATE = 0x3,
-            MESHLET_VERSION_CURRENT = MESHLET_VERSION_GEN_UPDATE
+            MESHLET_VERSION_LOD = 0x4,
+            MESHLET_VERSION_COMPRESSED = 0x5,
+            MESHLET_VERSION_CURRENT = MESHLET_VERSION_COMPRESSED
         };
 
         uint32_t Prolog;
@@ -61,6 +96,14 @@ void MeshletSet::GetPrimitive(uint32_t index, uint32_t& v0, uint32_t& v1, uint32
     v2 = prim.indices.i2;
 }
 
+bool MeshletSet::IsMeshletInLodCut(uint32_t meshletIndex, FXMVECTOR viewPosition, float errorThreshold) const
+{
+    auto& lod = m_lodData[meshletIndex];
+
+    return ProjectError(lod.Bounds, lod.Error, viewPosition) <= errorThreshold
+        && ProjectError(lod.ParentBounds, lod.ParentError, viewPosition) > errorThreshold;
+}
+
 uint32_t MeshletSet::GetPrimitiveCount() const
 {
     uint32_t count = 0;
@@ -133,6 +176,7 @@ void MeshletSet::CreateResources(ID3D12Device* device, IResourceUploader* upload
     auto indexDesc      = CD3DX12_RESOURCE_DESC::Buffer(m_uniqueIndexData.size());
     auto primitiveDesc  = CD3DX12_RESOURCE_DESC::Buffer(m_primitiveData.size() * sizeof(m_primitiveData[0]));
     auto meshInfoDesc   = CD3DX12_RESOURCE_DESC::Buffer(GetAlignedSize(sizeof(info)));
+    auto lodDataDesc    = CD3DX12_RESOURCE_DESC::Buffer(m_lodData.size() * sizeof(m_lodData[0]));
 
     auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
     device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &meshletDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_meshletBuffer.ReleaseAndGetAddressOf()));
@@ -140,20 +184,23 @@ void MeshletSet::CreateResources(ID3D12Device* device, IResourceUploader* upload
     device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &indexDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_uniqueIndexBuffer.ReleaseAndGetAddressOf()));
     device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &primitiveDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_primitiveBuffer.ReleaseAndGetAddressOf()));
     device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &meshInfoDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_meshInfoBuffer.ReleaseAndGetAddressOf()));
+    device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &lodDataDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_lodDataBuffer.ReleaseAndGetAddressOf()));
 
     uploader->Upload(m_meshletBuffer.Get(), m_meshletData.data(), (uint32_t)meshletDesc.Width);
     uploader->Upload(m_cullDataBuffer.Get(), m_cullData.data(), (uint32_t)cullDataDesc.Width);
     uploader->Upload(m_uniqueIndexBuffer.Get(), m_uniqueIndexData.data(), (uint32_t)indexDesc.Width);
     uploader->Upload(m_meshInfoBuffer.Get(), &info, sizeof(m_meshInfoBuffer));
+    uploader->Upload(m_lodDataBuffer.Get(), m_lodData.data(), (uint32_t)lodDataDesc.Width);
 
     uploader->Transition(m_meshletBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
     uploader->Transition(m_cullDataBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
     uploader->Transition(m_uniqueIndexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
     uploader->Transition(m_primitiveBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
     uploader->Transition(m_meshInfoBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
+    uploader->Transition(m_lodDataBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
-void MeshletSet::Read(std::istream& stream)
+void MeshletSet::ReadMeshletData(std::istream& stream)
 {
     stream.read(reinterpret_cast<char*>(&m_maxVerts), sizeof(m_maxVerts));
     stream.read(reinterpret_cast<char*>(&m_maxPrims), sizeof(m_maxPrims));
@@ -176,6 +223,25 @@ void MeshletSet::Read(std::istream& stream)
         m_submeshes.resize(submeshCount);
         stream.read(reinterpret_cast<char*>(m_submeshes.data()), submeshCount * sizeof(m_submeshes[0]));
     }
+}
+
+void MeshletSet::InitializeLods()
+{
+    // Without level of detail data the meshlets form a single level bounded by their culling spheres
+    m_lodCount = 1;
+    m_lodSubmeshes = m_submeshes;
+    m_lodData.resize(m_meshletData.size());
+
+    for (size_t i = 0; i < m_meshletData.size(); ++i)
+    {
+        auto& bounds = m_cullData[i].BoundingSphere;
+        m_lodData[i] = MeshletLod{ bounds, bounds, 0.0f, FLT_MAX };
+    }
+}
+
+void MeshletSet::Read(std::istream& stream)
+{
+    ReadMeshletData(stream);
 
     {
         uint32_t indexBytes, indexCount;
@@ -195,6 +261,94 @@ void MeshletSet::Read(std::istream& stream)
         m_primitiveData.resize(primCount);
         stream.read(reinterpret_cast<char*>(m_primitiveData.data()), primCount * sizeof(m_primitiveData[0]));
     }
+
+    InitializeLods();
+}
+
+void MeshletSet::ReadCompressed(std::istream& stream)
+{
+    ReadMeshletData(stream);
+
+    uint32_t indexBytes, indexCount, primCount, encodedSize;
+    stream.read(reinterpret_cast<char*>(&indexBytes), 4);
+    stream.read(reinterpret_cast<char*>(&indexCount), 4);
+    stream.read(reinterpret_cast<char*>(&primCount), 4);
+    stream.read(reinterpret_cast<char*>(&encodedSize), 4);
+
+    // The counts come from the file, so they're checked against the meshlet table that indexes the
+    // decoded streams, and the encoded size against what's left of the file, before anything is sized.
+    uint64_t vertEnd = 0;
+    uint64_t primEnd = 0;
+    for (auto& meshlet : m_meshletData)
+    {
+        vertEnd = (std::max)(vertEnd, uint64_t(meshlet.VertOffset) + meshlet.VertCount);
+        primEnd = (std::max)(primEnd, uint64_t(meshlet.PrimOffset) + meshlet.PrimCount);
+    }
+
+    if (!stream
+        || (indexBytes != 2 && indexBytes != 4)
+        || indexCount > vertEnd
+        || primCount > primEnd
+        || encodedSize > GetRemainingSize(stream))
+        throw std::runtime_error("Compressed meshlet data is corrupt.");
+
+    std::vector<uint8_t> encoded(size_t(encodedSize) + c_MeshletCodecPadding);
+    stream.read(reinterpret_cast<char*>(encoded.data()), encodedSize);
+
+    m_indexFormat = indexBytes == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+    m_uniqueIndexData.resize(size_t(indexCount) * BytesPerIndex());
+    m_primitiveData.resize(primCount);
+
+    const auto primitives = reinterpret_cast<uint32_t*>(m_primitiveData.data());
+    bool decoded;
+
+    if (m_indexFormat == DXGI_FORMAT_R32_UINT)
+    {
+        decoded = DecodeMeshletStreams(m_meshletData.data(), m_meshletData.size(), encoded.data(), encodedSize,
+            reinterpret_cast<uint32_t*>(m_uniqueIndexData.data()), indexCount, primitives, primCount);
+    }
+    else
+    {
+        decoded = DecodeMeshletStreams(m_meshletData.data(), m_meshletData.size(), encoded.data(), encodedSize,
+            reinterpret_cast<uint16_t*>(m_uniqueIndexData.data()), indexCount, primitives, primCount);
+    }
+
+    if (!stream || !decoded)
+        throw std::runtime_error("Compressed meshlet data is corrupt.");
+
+    InitializeLods();
+}
+
+void MeshletSet::ReadLods(std::istream& stream)
+{
+    uint32_t lodCount = 0;
+    stream.read(reinterpret_cast<char*>(&lodCount), 4);
+
+    // The level count comes from the file, so it's checked before anything is sized or indexed with it:
+    // the file must hold a submesh range per level and submesh, followed by a record per meshlet.
+    const uint64_t lodSize = uint64_t(lodCount) * m_submeshes.size() * sizeof(Submesh)
+        + uint64_t(m_meshletData.size()) * sizeof(MeshletLod);
+
+    if (!stream || lodCount < 1 || lodCount > c_MaxLodCount || lodSize > GetRemainingSize(stream))
+        throw std::runtime_error("Meshlet level of detail data is corrupt.");
+
+    m_lodSubmeshes.resize(size_t(lodCount) * m_submeshes.size());
+    stream.read(reinterpret_cast<char*>(m_lodSubmeshes.data()), m_lodSubmeshes.size() * sizeof(m_lodSubmeshes[0]));
+
+    m_lodData.resize(m_meshletData.size());
+    stream.read(reinterpret_cast<char*>(m_lodData.data()), m_lodData.size() * sizeof(m_lodData[0]));
+
+    if (!stream)
+        throw std::runtime_error("Meshlet level of detail data is corrupt.");
+
+    // Every level's submeshes index the meshlet arrays
+    for (auto& submesh : m_lodSubmeshes)
+    {
+        if (uint64_t(submesh.Offset) + submesh.Count > m_meshletData.size())
+            throw std::runtime_error("Meshlet level of detail data is corrupt.");
+    }
+
+    m_lodCount = lodCount;
 }
 
 std::vector<MeshletSet> MeshletSet::ReadMeshlets(const wchar_t* filePath)
@@ -209,17 +363,29 @@ std::vector<MeshletSet> MeshletSet::ReadMeshlets(const wchar_t* filePath)
     file.read(reinterpret_cast<char*>(&header), sizeof(header));
 
     if (header.Prolog != 'MSHL')
-        throw std::exception("Opened file is not of the meshlet file format.");
+        throw std::runtime_error("Opened file is not of the meshlet file format.");
 
-    if (header.Version != MeshletFileHeader::MESHLET_VERSION_CURRENT)
-        throw std::exception("Meshlet version is out of date! Please update meshlet runtime code.");
+    if (header.Version < MeshletFileHeader::MESHLET_VERSION_GEN_UPDATE || header.Version > MeshletFileHeader::MESHLET_VERSION_CURRENT)
+        throw std::runtime_error("Meshlet version is out of date! Please update meshlet runtime code.");
 
     std::vector<MeshletSet> meshlets;
     meshlets.resize(header.Count);
 
     for (auto& m : meshlets)
     {
-        m.Read(file);
+        if (header.Version >= MeshletFileHeader::MESHLET_VERSION_COMPRESSED)
+        {
+            m.ReadCompressed(file);
+        }
+        else
+        {
+            m.Read(file);
+        }
+
+        if (header.Version >= MeshletFileHeader::MESHLET_VERSION_LOD)
+        {
+            m.ReadLods(file);
+        }
     }
 
     return meshlets;
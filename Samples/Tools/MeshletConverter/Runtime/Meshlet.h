@@ -39,6 +39,16 @@ namespace ATG
         uint32_t Offset;
     };
 
+    // A meshlet belongs to the cut rendered for a given error threshold when its own projected error is
+    // within the threshold and its parent's isn't. The cut is crack-free for any view position.
+    struct MeshletLod
+    {
+        DirectX::XMFLOAT4 Bounds;       // xyz = center, w = radius of the group the meshlet was built from
+        DirectX::XMFLOAT4 ParentBounds; // Same for the group simplified from the meshlet
+        float             Error;        // Object space simplification error, 0 for the full detail meshlets
+        float             ParentError;  // FLT_MAX if the meshlet isn't simplified any further
+    };
+
     class MeshletSet
     {
     public:
@@ -63,6 +73,14 @@ namespace ATG
         uint32_t        CalcThreadGroupCount(uint32_t groupSize, uint32_t instanceCount) const;
         uint32_t        InstancesPerDispatch(uint32_t groupSize) const;
 
+        // Levels of detail - level 0 holds the same meshlets as the submeshes above
+        uint32_t        GetLodCount() const { return m_lodCount; }
+        const Submesh&  GetLodSubmesh(uint32_t lod, uint32_t submeshIndex) const { return m_lodSubmeshes[lod * GetSubmeshCount() + submeshIndex]; }
+
+        // Whether a meshlet is part of the cut for a view position and error threshold, both in object space.
+        // The threshold is the tolerated error per unit of view distance.
+        bool            IsMeshletInLodCut(uint32_t meshletIndex, DirectX::FXMVECTOR viewPosition, float errorThreshold) const;
+
         // Accessors for vertex index & primitive data
         uint32_t        GetVertexIndex(uint32_t index);
         void            GetPrimitive(uint32_t index, uint32_t& v0, uint32_t& v1, uint32_t& v2);
@@ -75,16 +93,25 @@ namespace ATG
         auto&           GetSubmeshes() const { return m_submeshes; }
         auto&           GetUniqueIndexData() const { return m_uniqueIndexData; }
         auto&           GetPrimitiveData() const { return m_primitiveData; }
+        auto&           GetLodSubmeshes() const { return m_lodSubmeshes; }
+        auto&           GetLodData() const { return m_lodData; }
 
         // Accessors for D3D12 resources
         ID3D12Resource* GetMeshletBuffer() const { return m_meshletBuffer.Get(); }
         ID3D12Resource* GetUniqueIndexBuffer() const { return m_uniqueIndexBuffer.Get(); }
         ID3D12Resource* GetPrimitiveBuffer() const { return m_primitiveBuffer.Get(); }
         ID3D12Resource* GetMeshInfoBuffer() const { return m_meshInfoBuffer.Get(); }
+        ID3D12Resource* GetLodDataBuffer() const { return m_lodDataBuffer.Get(); }
 
         void Read(std::istream& stream);
+        void ReadCompressed(std::istream& stream);
+        void ReadLods(std::istream& stream);
         static std::vector<MeshletSet> ReadMeshlets(const wchar_t* filePath);
 
+    private:
+        void ReadMeshletData(std::istream& stream);
+        void InitializeLods();
+
     private:
         struct MeshInfo
         {
@@ -116,11 +143,16 @@ namespace ATG
         std::vector<uint8_t>        m_uniqueIndexData;
         std::vector<PackedIndices>  m_primitiveData;
 
+        uint32_t                    m_lodCount;
+        std::vector<Submesh>        m_lodSubmeshes;
+        std::vector<MeshletLod>     m_lodData;
+
     private:
         Microsoft::WRL::ComPtr<ID3D12Resource> m_meshletBuffer;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_cullDataBuffer;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_uniqueIndexBuffer;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_primitiveBuffer;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_meshInfoBuffer;
+        Microsoft::WRL::ComPtr<ID3D12Resource> m_lodDataBuffer;
     };
 }
@@ -0,0 +1,260 @@
+//--------------------------------------------------------------------------------------
+// MeshletCodec.h
+//
+// Advanced Technology Group (ATG)
+// Copyright (C) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ATG_MESHLET_CODEC_SSE2
+#endif
+
+namespace ATG
+{
+    // Lossless encoding of the meshlet vertex index and primitive streams, shared by the converter and the runtime.
+    // Each meshlet is encoded in turn, starting at a byte boundary:
+    //  - Its first unique vertex index as 32 bits, then a byte holding the bit width of the remaining
+    //    indices, which are stored as zigzagged deltas from their predecessor.
+    //  - The local indices of its primitives, each with just enough bits to address the meshlet's vertices.
+    // Primitives are passed as packed 10:10:10 words (the layout of DirectX::MeshletTriangle), so a meshlet
+    // addresses at most c_MeshletMaxVerts vertices.
+    // Decoders read whole words, so encoded buffers must be followed by c_MeshletCodecPadding readable bytes.
+    constexpr size_t c_MeshletCodecPadding = 8;
+    constexpr uint32_t c_MeshletMaxVerts = 1024;
+
+    namespace Internal
+    {
+        inline uint32_t BitWidth(uint32_t value)
+        {
+            uint32_t width = 0;
+            for (; value; value >>= 1)
+            {
+                ++width;
+            }
+            return width;
+        }
+
+        inline uint32_t PrimitiveBitWidth(uint32_t vertCount)
+        {
+            uint32_t width = BitWidth(vertCount > 1 ? vertCount - 1 : 0);
+            return width ? width : 1;
+        }
+
+        inline uint32_t ZigZag(uint32_t delta)
+        {
+            return (delta << 1) ^ (0u - (delta >> 31));
+        }
+
+        inline uint64_t LoadBits(const uint8_t* data, size_t bitPosition)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, data + (bitPosition >> 3), sizeof(bits));
+            return bits >> (bitPosition & 7);
+        }
+
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(std::vector<uint8_t>& data)
+                : m_data(data)
+                , m_bits(0)
+                , m_count(0)
+            { }
+
+            void Write(uint32_t value, uint32_t width)
+            {
+                m_bits |= uint64_t(value) << m_count;
+                m_count += width;
+
+                for (; m_count >= 8; m_count -= 8)
+                {
+                    m_data.push_back(static_cast<uint8_t>(m_bits));
+                    m_bits >>= 8;
+                }
+            }
+
+            // Pads to the next byte boundary
+            void Flush()
+            {
+                if (m_count)
+                {
+                    m_data.push_back(static_cast<uint8_t>(m_bits));
+                }
+
+                m_bits = 0;
+                m_count = 0;
+            }
+
+        private:
+            std::vector<uint8_t>&   m_data;
+            uint64_t                m_bits;
+            uint32_t                m_count;
+        };
+    }
+
+    // Appends the encoded streams of the meshlets to 'encoded' (without padding).
+    template <typename TMeshlet, typename TIndex>
+    void EncodeMeshletStreams(
+        const TMeshlet* meshlets, size_t meshletCount,
+        const TIndex* uniqueVertexIndices,
+        const uint32_t* primitives,
+        std::vector<uint8_t>& encoded)
+    {
+        Internal::BitWriter writer(encoded);
+
+        for (size_t i = 0; i < meshletCount; ++i)
+        {
+            const TMeshlet& meshlet = meshlets[i];
+            const TIndex* indices = uniqueVertexIndices + meshlet.VertOffset;
+
+            uint32_t first = meshlet.VertCount ? uint32_t(indices[0]) : 0;
+            uint32_t maxDelta = 0;
+            for (uint32_t j = 1; j < meshlet.VertCount; ++j)
+            {
+                maxDelta |= Internal::ZigZag(uint32_t(indices[j]) - uint32_t(indices[j - 1]));
+            }
+
+            const uint32_t deltaWidth = Internal::BitWidth(maxDelta);
+
+            writer.Write(first & 0xFFFF, 16);
+            writer.Write(first >> 16, 16);
+            writer.Write(deltaWidth, 8);
+
+            for (uint32_t j = 1; j < meshlet.VertCount; ++j)
+            {
+                writer.Write(Internal::ZigZag(uint32_t(indices[j]) - uint32_t(indices[j - 1])), deltaWidth);
+            }
+
+            const uint32_t primWidth = Internal::PrimitiveBitWidth(meshlet.VertCount);
+            for (uint32_t j = 0; j < meshlet.PrimCount; ++j)
+            {
+                const uint32_t prim = primitives[meshlet.PrimOffset + j];
+
+                writer.Write(prim & 0x3FF, primWidth);
+                writer.Write((prim >> 10) & 0x3FF, primWidth);
+                writer.Write((prim >> 20) & 0x3FF, primWidth);
+            }
+
+            writer.Flush();
+        }
+    }
+
+    // Decodes streams written by EncodeMeshletStreams into the locations given by the meshlets' offsets.
+    // Returns false if the stream is truncated, the meshlets reference data outside the output arrays,
+    // a meshlet has more vertices than 10-bit local indices address, or a primitive references a local
+    // vertex past the end of its meshlet.
+    template <typename TMeshlet, typename TIndex>
+    bool DecodeMeshletStreams(
+        const TMeshlet* meshlets, size_t meshletCount,
+        const uint8_t* encoded, size_t encodedSize,
+        TIndex* uniqueVertexIndices, size_t indexCount,
+        uint32_t* primitives, size_t primitiveCount)
+    {
+        size_t position = 0;
+
+        for (size_t i = 0; i < meshletCount; ++i)
+        {
+            const TMeshlet& meshlet = meshlets[i];
+
+            if (meshlet.VertCount > c_MeshletMaxVerts
+                || uint64_t(meshlet.VertOffset) + meshlet.VertCount > indexCount
+                || uint64_t(meshlet.PrimOffset) + meshlet.PrimCount > primitiveCount
+                || encodedSize - position < 5)
+                return false;
+
+            uint32_t previous;
+            std::memcpy(&previous, encoded + position, sizeof(previous));
+
+            const uint32_t deltaWidth = encoded[position + 4];
+            const uint32_t primWidth = Internal::PrimitiveBitWidth(meshlet.VertCount);
+
+            const uint64_t deltaCount = meshlet.VertCount ? meshlet.VertCount - 1 : 0;
+            const uint64_t bitCount = deltaCount * deltaWidth + uint64_t(meshlet.PrimCount) * 3 * primWidth;
+
+            position += 5;
+            if (deltaWidth > 32 || (bitCount + 7) / 8 > encodedSize - position)
+                return false;
+
+            const uint8_t* data = encoded + position;
+            const uint64_t deltaMask = (uint64_t(1) << deltaWidth) - 1;
+            size_t bitPosition = 0;
+
+            TIndex* indices = uniqueVertexIndices + meshlet.VertOffset;
+            if (meshlet.VertCount)
+            {
+                indices[0] = static_cast<TIndex>(previous);
+            }
+
+            uint32_t j = 1;
+
+#ifdef ATG_MESHLET_CODEC_SSE2
+            // Undo the zigzag and prefix sum the deltas four at a time
+            const __m128i one = _mm_set1_epi32(1);
+
+            for (; j + 4 <= meshlet.VertCount; j += 4)
+            {
+                uint32_t deltas[4];
+                for (size_t k = 0; k < 4; ++k, bitPosition += deltaWidth)
+                {
+                    deltas[k] = static_cast<uint32_t>(Internal::LoadBits(data, bitPosition) & deltaMask);
+                }
+
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas));
+                v = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi32(v, _mm_set1_epi32(static_cast<int>(previous)));
+
+                alignas(16) uint32_t values[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(values), v);
+
+                for (size_t k = 0; k < 4; ++k)
+                {
+                    indices[j + k] = static_cast<TIndex>(values[k]);
+                }
+
+                previous = values[3];
+            }
+#endif
+
+            for (; j < meshlet.VertCount; ++j, bitPosition += deltaWidth)
+            {
+                const uint32_t delta = static_cast<uint32_t>(Internal::LoadBits(data, bitPosition) & deltaMask);
+
+                previous += (delta >> 1) ^ (0u - (delta & 1));
+                indices[j] = static_cast<TIndex>(previous);
+            }
+
+            // All three local indices of a primitive fit in a single load. A meshlet's vertex count needn't be a
+            // power of two, so the fields can hold indices past its last vertex, which are rejected.
+            const uint32_t primMask = (1u << primWidth) - 1;
+            uint32_t* prims = primitives + meshlet.PrimOffset;
+
+            for (uint32_t k = 0; k < meshlet.PrimCount; ++k, bitPosition += 3 * primWidth)
+            {
+                const uint64_t bits = Internal::LoadBits(data, bitPosition);
+
+                const uint32_t i0 = static_cast<uint32_t>(bits) & primMask;
+                const uint32_t i1 = static_cast<uint32_t>(bits >> primWidth) & primMask;
+                const uint32_t i2 = static_cast<uint32_t>(bits >> (2 * primWidth)) & primMask;
+
+                if (i0 >= meshlet.VertCount || i1 >= meshlet.VertCount || i2 >= meshlet.VertCount)
+                    return false;
+
+                prims[k] = i0 | (i1 << 10) | (i2 << 20);
+            }
+
+            position += static_cast<size_t>((bitCount + 7) / 8);
+        }
+
+        return position == encodedSize;
+    }
+}
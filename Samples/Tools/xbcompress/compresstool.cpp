@@ -3,7 +3,8 @@
 //
 // A "quick & dirty" compression tool inspired by the classic MS-DOS COMPRESS.EXE and
 // EXPAND.EXE commands. This tool implements a SZDD/KWAJ-style file format, and makes
-// use of the Compression API introduced with Windows 8.
+// use of the Compression API introduced with Windows 8 or the portable LZ codec in
+// lzencoder.h and Kits/ATGTK/LZCodec.h. The file layout is in xbcformat.h.
 //
 // "SZDD" (1990) is the signature of the original MS-DOS COMPRESS.EXE / EXPAND.EXE
 // file format. "KWAJ" (1993) is a similar format which supported additional
@@ -28,17 +29,21 @@
 #include <Windows.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cwchar>
 #include <fstream>
+#include <functional>
 #include <list>
 #include <locale>
 #include <memory>
 #include <set>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #ifndef NTDDI_WIN10_FE
 #undef WINAPI_FAMILY_PARTITION
@@ -52,6 +57,11 @@
 #define WINAPI_FAMILY_PARTITION(Partitions) (Partitions)
 #endif
 
+#include "lzencoder.h"
+#include "xbcformat.h"
+
+using namespace XBCompress;
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -110,11 +120,23 @@ enum OPTIONS : uint32_t
     OPT_NOLOGO,
     OPT_TIMING,
     OPT_FILELIST,
+    OPT_CHUNK,
+    OPT_CODEC,
+    OPT_BENCH,
     OPT_MAX
 };
 
 static_assert(OPT_MAX <= 32, "options is a unsigned int bitfield");
 
+enum CODECS : uint32_t
+{
+    CODEC_LZMS = 1,
+    CODEC_MSZIP,
+    CODEC_LZ,
+    CODEC_LZHC,
+    CODEC_AUTO,
+};
+
 struct SConversion
 {
     wchar_t szSrc[MAX_PATH];
@@ -140,6 +162,19 @@ const SValue g_pOptions[] =
     { L"nologo",    OPT_NOLOGO },
     { L"timing",    OPT_TIMING },
     { L"flist",     OPT_FILELIST },
+    { L"chunk",     OPT_CHUNK },
+    { L"codec",     OPT_CODEC },
+    { L"bench",     OPT_BENCH },
+    { nullptr,      0 }
+};
+
+const SValue g_pCodecs[] =
+{
+    { L"lzms",      CODEC_LZMS },
+    { L"mszip",     CODEC_MSZIP },
+    { L"lz",        CODEC_LZ },
+    { L"lzhc",      CODEC_LZHC },
+    { L"auto",      CODEC_AUTO },
     { nullptr,      0 }
 };
 
@@ -346,12 +381,18 @@ namespace
         wprintf(L"\n");
         wprintf(L"   -r                  wildcard filename search is recursive\n");
         wprintf(L"   -u                  uncompress files rather than compress\n");
-        wprintf(L"   -z                  compress with MSZIP rather than LZMS\n");
+        wprintf(L"   -z                  compress with MSZIP rather than LZMS (same as -codec:mszip)\n");
         wprintf(L"   -l                  force output filename to lower case\n");
         wprintf(L"   -y                  overwrite existing output file (if any)\n");
         wprintf(L"   -nologo             suppress copyright message\n");
-        wprintf(L"   -timing             Display elapsed processing time\n");
-        wprintf(L"   -flist <filename>   use text file with a list of input files (one per line)\n\n");
+        wprintf(L"   -timing             Display elapsed processing time and throughput\n");
+        wprintf(L"   -flist <filename>   use text file with a list of input files (one per line)\n");
+        wprintf(L"   -chunk[:<KB>]       compress as independent chunks that decompress in parallel\n");
+        wprintf(L"                       (defaults to 1024 KB for LZMS, 256 KB otherwise)\n");
+        wprintf(L"   -codec:<name>       lzms (default), mszip, lz (fast portable LZ), lzhc (high-ratio LZ),\n");
+        wprintf(L"                       or auto to pick per file from the ratio of sampled data\n");
+        wprintf(L"   -bench              report compressed size and decode speed of each codec for the\n");
+        wprintf(L"                       files without writing any output\n\n");
     }
 
     const wchar_t* GetErrorDesc(HRESULT hr)
@@ -439,26 +480,62 @@ namespace
 
 namespace
 {
-    // The format used by this tool is the same design as the classic SZDD/KAWJ formats used by MS-DOS.
-    // Files generated by this tool, however, are not compatible with EXPAND.EXE or GnuWin32 MSCOMPRESS.EXE.
+    // Runs worker on up to 'count' threads (including the caller), returning the first failure.
+    // Workers pull chunks from a shared counter, so if a thread can't be created the ones
+    // already running (or just the caller) still finish the job.
+    HRESULT RunOnThreads(size_t count, const std::function<HRESULT()>& worker)
+    {
+        std::vector<HRESULT> results(count, S_OK);
 
-    constexpr uint8_t c_CFileSignatureLen = 8;
-    constexpr uint8_t c_CFileVersion = 0x41;
+        std::vector<std::thread> threads;
+        threads.reserve(count);
 
-    const uint8_t c_Signature[c_CFileSignatureLen] = { 0x41, 0x46, 0x43, 0x57, 0x47, 0x50, 0x53, 0x4d };
+        auto joinAll = [&threads]()
+            {
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+            };
 
-#pragma pack(push,1)
-    struct CFileHeader
-    {
-        uint8_t     magic[c_CFileSignatureLen]; // Must match c_Signature below
-        uint8_t     mode;                       // COMPRESS_ALGORITHM_x enum
-        uint8_t     version;
-        wchar_t     lastChar;
-        uint32_t    uncompressedSize;
-    };
-#pragma pack(pop)
+        try
+        {
+            for (size_t j = 1; j < count; ++j)
+            {
+                threads.emplace_back([&results, &worker, j]() { results[j] = worker(); });
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Carry on with the threads that did start
+        }
+
+        // Joinable threads must never be destroyed, even if the caller's share throws
+        try
+        {
+            results[0] = worker();
+        }
+        catch (...)
+        {
+            joinAll();
+            throw;
+        }
+
+        joinAll();
+
+        for (auto hr : results)
+        {
+            if (FAILED(hr))
+                return hr;
+        }
 
-    static_assert(sizeof(CFileHeader) == 16, "File header size mismatch");
+        return S_OK;
+    }
+
+    size_t GetWorkerCount(size_t chunkCount)
+    {
+        return std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), chunkCount));
+    }
 
     PVOID SimpleAlloc(PVOID, SIZE_T Size)
     {
@@ -470,93 +547,373 @@ namespace
         free(Memory);
     }
 
-    struct compressor_closer { void operator()(void* h) { if (h) CloseCompressor(static_cast<COMPRESSOR_HANDLE>(h)); } };
+    //----------------------------------------------------------------------------------
+    // Codecs
+    //
+    // The 'mode' in the file header selects the decoder: a COMPRESS_ALGORITHM_x value for
+    // the Compression API, or c_CompressModeLZ for the portable codec. Both LZ levels write
+    // the same stream, so they share a mode.
+    //----------------------------------------------------------------------------------
 
-    HRESULT CompressFile(
-        _In_reads_bytes_(dataLen) const void* data,
-        size_t dataLen,
-        DWORD algorithm,
-        wchar_t origChar,
-        const wchar_t* compressFile)
+    struct CodecInfo
     {
-        if (!data || !dataLen || !compressFile)
-            return E_INVALIDARG;
+        uint32_t        codec;                  // CODEC_x enum
+        const wchar_t*  name;
+        uint8_t         mode;
+        uint32_t        defaultChunkSize;
+    };
 
-        if (dataLen > UINT32_MAX)
+    const CodecInfo c_CodecInfo[] =
+    {
+        { CODEC_LZMS,   L"LZMS",    COMPRESS_ALGORITHM_LZMS,    1024 * 1024 },
+        { CODEC_MSZIP,  L"MSZIP",   COMPRESS_ALGORITHM_MSZIP,   256 * 1024 },
+        { CODEC_LZ,     L"LZ",      c_CompressModeLZ,           256 * 1024 },
+        { CODEC_LZHC,   L"LZHC",    c_CompressModeLZ,           256 * 1024 },
+    };
+
+    const CodecInfo* GetCodecInfo(uint32_t codec)
+    {
+        for (auto& info : c_CodecInfo)
         {
-            return E_FAIL;
+            if (info.codec == codec)
+                return &info;
         }
 
-        COMPRESS_ALLOCATION_ROUTINES allocData = { SimpleAlloc, SimpleFree, nullptr };
+        return nullptr;
+    }
+
+    // Codecs keep per-thread state, so each worker creates its own.
+    class Codec
+    {
+    public:
+        virtual ~Codec() = default;
+
+        // Upper bound on the compressed size of srcLen bytes
+        virtual HRESULT GetCompressBound(size_t srcLen, size_t& bound) = 0;
+
+        virtual HRESULT Compress(
+            _In_reads_bytes_(srcLen) const uint8_t* src,
+            size_t srcLen,
+            _Out_writes_bytes_to_(destCapacity, compressedSize) uint8_t* dest,
+            size_t destCapacity,
+            size_t& compressedSize) = 0;
+
+        // Fails unless the data expands to exactly destLen bytes
+        virtual HRESULT Decompress(
+            _In_reads_bytes_(srcLen) const uint8_t* src,
+            size_t srcLen,
+            _Out_writes_bytes_(destLen) uint8_t* dest,
+            size_t destLen) = 0;
+    };
 
-        std::unique_ptr<void, compressor_closer> compressor;
+    struct compressor_closer { void operator()(void* h) { if (h) CloseCompressor(static_cast<COMPRESSOR_HANDLE>(h)); } };
+
+    using ScopedCompressor = std::unique_ptr<void, compressor_closer>;
+
+    struct decompressor_closer { void operator()(void* h) { if (h) CloseDecompressor(static_cast<DECOMPRESSOR_HANDLE>(h)); } };
+
+    using ScopedDecompressor = std::unique_ptr<void, decompressor_closer>;
+
+    // MSZIP and LZMS through the Compression API
+    class SystemCodec : public Codec
+    {
+    public:
+        explicit SystemCodec(DWORD algorithm) noexcept : m_algorithm(algorithm) {}
+
+        HRESULT GetCompressBound(size_t srcLen, size_t& bound) override
+        {
+            HRESULT hr = CreateCompressorHandle();
+            if (FAILED(hr))
+                return hr;
+
+            SIZE_T compressedBufferSize = 0;
+            if (!::Compress(
+                static_cast<COMPRESSOR_HANDLE>(m_compressor.get()),
+                nullptr,
+                srcLen,
+                nullptr,
+                0,
+                &compressedBufferSize))
+            {
+                DWORD errorCode = GetLastError();
+                if (errorCode != ERROR_INSUFFICIENT_BUFFER)
+                {
+                    return HRESULT_FROM_WIN32(errorCode);
+                }
+            }
+
+            bound = compressedBufferSize;
+            return S_OK;
+        }
+
+        HRESULT Compress(
+            const uint8_t* src,
+            size_t srcLen,
+            uint8_t* dest,
+            size_t destCapacity,
+            size_t& compressedSize) override
         {
-            COMPRESSOR_HANDLE h = nullptr;
-            if (!CreateCompressor(
-                algorithm,
-                &allocData,
-                &h))
+            HRESULT hr = CreateCompressorHandle();
+            if (FAILED(hr))
+                return hr;
+
+            SIZE_T outSize;
+            if (!::Compress(
+                static_cast<COMPRESSOR_HANDLE>(m_compressor.get()),
+                src,
+                srcLen,
+                dest,
+                destCapacity,
+                &outSize))
             {
                 return HRESULT_FROM_WIN32(GetLastError());
             }
 
-            compressor.reset(h);
+            compressedSize = outSize;
+            return S_OK;
         }
 
-        if (algorithm == COMPRESS_ALGORITHM_LZMS)
+        HRESULT Decompress(
+            const uint8_t* src,
+            size_t srcLen,
+            uint8_t* dest,
+            size_t destLen) override
         {
-            DWORD blockSize = 1 * 1024 * 1024; // 1 MB recommended for LZMS
+            if (!m_decompressor)
+            {
+                COMPRESS_ALLOCATION_ROUTINES allocData = { SimpleAlloc, SimpleFree, nullptr };
+
+                DECOMPRESSOR_HANDLE h = nullptr;
+                if (!CreateDecompressor(
+                    m_algorithm,
+                    &allocData,
+                    &h))
+                {
+                    return HRESULT_FROM_WIN32(GetLastError());
+                }
+
+                m_decompressor.reset(h);
+            }
 
-            if (!SetCompressorInformation(
-                static_cast<COMPRESSOR_HANDLE>(compressor.get()),
-                COMPRESS_INFORMATION_CLASS_BLOCK_SIZE,
-                &blockSize,
-                sizeof(DWORD)))
+            SIZE_T expandedSize;
+            if (!::Decompress(
+                static_cast<DECOMPRESSOR_HANDLE>(m_decompressor.get()),
+                src,
+                srcLen,
+                dest,
+                destLen,
+                &expandedSize))
             {
                 return HRESULT_FROM_WIN32(GetLastError());
             }
+
+            if (expandedSize != destLen)
+                return E_FAIL;
+
+            return S_OK;
         }
 
-        // Query max compressed size.
-        SIZE_T compressedBufferSize;
-        if (!Compress(
-            static_cast<COMPRESSOR_HANDLE>(compressor.get()),
-            nullptr,
-            dataLen,
-            nullptr,
-            0,
-            &compressedBufferSize))
+    private:
+        HRESULT CreateCompressorHandle()
         {
-            DWORD errorCode = GetLastError();
-            if (errorCode != ERROR_INSUFFICIENT_BUFFER)
+            if (m_compressor)
+                return S_OK;
+
+            COMPRESS_ALLOCATION_ROUTINES allocData = { SimpleAlloc, SimpleFree, nullptr };
+
             {
-                return HRESULT_FROM_WIN32(GetLastError());
+                COMPRESSOR_HANDLE h = nullptr;
+                if (!CreateCompressor(
+                    m_algorithm,
+                    &allocData,
+                    &h))
+                {
+                    return HRESULT_FROM_WIN32(GetLastError());
+                }
+
+                m_compressor.reset(h);
+            }
+
+            if (m_algorithm == COMPRESS_ALGORITHM_LZMS)
+            {
+                DWORD blockSize = 1 * 1024 * 1024; // 1 MB recommended for LZMS
+
+                if (!SetCompressorInformation(
+                    static_cast<COMPRESSOR_HANDLE>(m_compressor.get()),
+                    COMPRESS_INFORMATION_CLASS_BLOCK_SIZE,
+                    &blockSize,
+                    sizeof(DWORD)))
+                {
+                    m_compressor.reset();
+                    return HRESULT_FROM_WIN32(GetLastError());
+                }
             }
+
+            return S_OK;
+        }
+
+        DWORD               m_algorithm;
+        ScopedCompressor    m_compressor;
+        ScopedDecompressor  m_decompressor;
+    };
+
+    // The portable LZ codec, which also builds and runs on non-Windows platforms
+    class SoftwareCodec : public Codec
+    {
+    public:
+        explicit SoftwareCodec(LZ::Level level) noexcept : m_level(level) {}
+
+        HRESULT GetCompressBound(size_t srcLen, size_t& bound) override
+        {
+            bound = LZ::CompressBound(srcLen);
+            return S_OK;
         }
 
+        HRESULT Compress(
+            const uint8_t* src,
+            size_t srcLen,
+            uint8_t* dest,
+            size_t destCapacity,
+            size_t& compressedSize) override
+        {
+            if (!m_encoder)
+            {
+                try
+                {
+                    m_encoder = std::make_unique<LZ::Encoder>(m_level);
+                }
+                catch (const std::bad_alloc&)
+                {
+                    return E_OUTOFMEMORY;
+                }
+            }
+
+            compressedSize = m_encoder->Compress(src, srcLen, dest, destCapacity);
+            if (!compressedSize)
+                return HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+
+            return S_OK;
+        }
+
+        HRESULT Decompress(
+            const uint8_t* src,
+            size_t srcLen,
+            uint8_t* dest,
+            size_t destLen) override
+        {
+            // Data that didn't compress is stored as-is (see CompressFile)
+            if (srcLen == destLen)
+            {
+                memcpy(dest, src, destLen);
+                return S_OK;
+            }
+
+            if (!LZ::Decompress(src, srcLen, dest, destLen))
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            return S_OK;
+        }
+
+    private:
+        LZ::Level                       m_level;
+        std::unique_ptr<LZ::Encoder>    m_encoder;
+    };
+
+    HRESULT CreateCodec(uint32_t codec, std::unique_ptr<Codec>& result)
+    {
+        switch (codec)
+        {
+        case CODEC_LZMS:    result.reset(new (std::nothrow) SystemCodec(COMPRESS_ALGORITHM_LZMS)); break;
+        case CODEC_MSZIP:   result.reset(new (std::nothrow) SystemCodec(COMPRESS_ALGORITHM_MSZIP)); break;
+        case CODEC_LZ:      result.reset(new (std::nothrow) SoftwareCodec(LZ::Level::Fast)); break;
+        case CODEC_LZHC:    result.reset(new (std::nothrow) SoftwareCodec(LZ::Level::High)); break;
+        default:            return E_INVALIDARG;
+        }
+
+        return (result) ? S_OK : E_OUTOFMEMORY;
+    }
+
+    // Creates the decoder for a file header 'mode'
+    HRESULT CreateDecoder(uint8_t mode, std::unique_ptr<Codec>& result)
+    {
+        switch (mode)
+        {
+        case COMPRESS_ALGORITHM_MSZIP:  // https://en.wikipedia.org/wiki/Deflate
+        case COMPRESS_ALGORITHM_LZMS:   // https://en.wikipedia.org/wiki/Quantum_compression
+            result.reset(new (std::nothrow) SystemCodec(mode));
+            break;
+
+        case c_CompressModeLZ:          // LZCodec.h
+            result.reset(new (std::nothrow) SoftwareCodec(LZ::Level::Fast));
+            break;
+
+        default:
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        }
+
+        return (result) ? S_OK : E_OUTOFMEMORY;
+    }
+
+    HRESULT CompressFile(
+        _In_reads_bytes_(dataLen) const void* data,
+        size_t dataLen,
+        uint32_t codec,
+        wchar_t origChar,
+        const wchar_t* compressFile)
+    {
+        if (!data || !dataLen || !compressFile)
+            return E_INVALIDARG;
+
+        const CodecInfo* info = GetCodecInfo(codec);
+        if (!info)
+            return E_INVALIDARG;
+
+        if (dataLen > UINT32_MAX)
+        {
+            return E_FAIL;
+        }
+
+        std::unique_ptr<Codec> compressor;
+        HRESULT hr = CreateCodec(codec, compressor);
+        if (FAILED(hr))
+            return hr;
+
+        // Query max compressed size.
+        size_t compressedBufferSize;
+        hr = compressor->GetCompressBound(dataLen, compressedBufferSize);
+        if (FAILED(hr))
+            return hr;
+
         std::unique_ptr<uint8_t[]> compressedData(new (std::nothrow) uint8_t[compressedBufferSize]);
         if (!compressedData)
         {
             return E_OUTOFMEMORY;
         }
 
-        SIZE_T compressedSize;
-        if (!Compress(
-            static_cast<COMPRESSOR_HANDLE>(compressor.get()),
-            data,
+        size_t compressedSize;
+        hr = compressor->Compress(
+            static_cast<const uint8_t*>(data),
             dataLen,
             compressedData.get(),
             compressedBufferSize,
-            &compressedSize))
-        {
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
+            compressedSize);
+        if (FAILED(hr))
+            return hr;
 
         if (compressedSize > (UINT32_MAX - sizeof(CFileHeader)))
         {
             return E_FAIL;
         }
 
+        // The portable LZ stream has no stored mode of its own, so data it would expand is stored as-is,
+        // as chunks are. The Compression API formats handle this within their own streams.
+        const uint8_t* payload = compressedData.get();
+        if (info->mode == c_CompressModeLZ && compressedSize >= dataLen)
+        {
+            payload = static_cast<const uint8_t*>(data);
+            compressedSize = dataLen;
+        }
+
         // Create compressed file.
         ScopedHandle hFile(safe_handle(CreateFile2(compressFile, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr)));
         if (!hFile)
@@ -569,9 +926,9 @@ namespace
         // Write header.
         CFileHeader fileHeader = {};
         memcpy(fileHeader.magic, c_Signature, c_CFileSignatureLen);
-        fileHeader.mode = static_cast<uint8_t>(algorithm);
+        fileHeader.mode = info->mode;
         fileHeader.version = c_CFileVersion;
-        fileHeader.lastChar = origChar;
+        fileHeader.lastChar = static_cast<uint16_t>(origChar);
         fileHeader.uncompressedSize = static_cast<DWORD>(dataLen);
 
         DWORD bytesWritten;
@@ -582,7 +939,7 @@ namespace
             return E_FAIL;
 
         // Write compressed data.
-        if (!WriteFile(hFile.get(), compressedData.get(), static_cast<DWORD>(compressedSize), &bytesWritten, nullptr))
+        if (!WriteFile(hFile.get(), payload, static_cast<DWORD>(compressedSize), &bytesWritten, nullptr))
             return HRESULT_FROM_WIN32(GetLastError());
 
         if (bytesWritten != static_cast<DWORD>(compressedSize))
@@ -593,7 +950,236 @@ namespace
         return S_OK;
     }
 
-    struct decompressor_closer { void operator()(void* h) { if (h) CloseDecompressor(static_cast<DECOMPRESSOR_HANDLE>(h)); } };
+    HRESULT CompressChunkedFile(
+        _In_reads_bytes_(dataLen) const void* data,
+        size_t dataLen,
+        uint32_t codec,
+        uint32_t chunkSize,
+        wchar_t origChar,
+        const wchar_t* compressFile)
+    {
+        if (!data || !dataLen || !compressFile)
+            return E_INVALIDARG;
+
+        if (chunkSize < c_MinChunkSize || chunkSize > c_MaxChunkSize)
+            return E_INVALIDARG;
+
+        const CodecInfo* info = GetCodecInfo(codec);
+        if (!info)
+            return E_INVALIDARG;
+
+        if (dataLen > UINT32_MAX)
+        {
+            return E_FAIL;
+        }
+
+        const size_t chunkCount = (dataLen + chunkSize - 1) / chunkSize;
+
+        // Query max compressed size of a chunk.
+        size_t chunkBound;
+        {
+            std::unique_ptr<Codec> compressor;
+            HRESULT hr = CreateCodec(codec, compressor);
+            if (FAILED(hr))
+                return hr;
+
+            hr = compressor->GetCompressBound(chunkSize, chunkBound);
+            if (FAILED(hr))
+                return hr;
+
+            chunkBound = std::max<size_t>(chunkBound, chunkSize);
+        }
+
+        std::unique_ptr<uint8_t[]> compressedData(new (std::nothrow) uint8_t[chunkBound * chunkCount]);
+        if (!compressedData)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        std::unique_ptr<CChunkEntry[]> entries(new (std::nothrow) CChunkEntry[chunkCount]);
+        if (!entries)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        // Compress chunks in parallel, each worker with its own compressor.
+        std::atomic<size_t> nextChunk(0);
+
+        HRESULT hr = RunOnThreads(GetWorkerCount(chunkCount), [&]() -> HRESULT
+            {
+                std::unique_ptr<Codec> compressor;
+                HRESULT hrWorker = CreateCodec(codec, compressor);
+                if (FAILED(hrWorker))
+                    return hrWorker;
+
+                for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+                {
+                    const size_t offset = chunk * chunkSize;
+                    const size_t chunkLen = std::min<size_t>(chunkSize, dataLen - offset);
+                    auto src = static_cast<const uint8_t*>(data) + offset;
+                    auto dest = compressedData.get() + chunk * chunkBound;
+
+                    size_t compressedSize;
+                    hrWorker = compressor->Compress(src, chunkLen, dest, chunkBound, compressedSize);
+                    if (FAILED(hrWorker))
+                        return hrWorker;
+
+                    // Chunks that don't compress are stored as-is.
+                    if (compressedSize >= chunkLen)
+                    {
+                        memcpy(dest, src, chunkLen);
+                        compressedSize = chunkLen;
+                    }
+
+                    entries[chunk].compressedSize = static_cast<uint32_t>(compressedSize);
+                }
+
+                return S_OK;
+            });
+        if (FAILED(hr))
+            return hr;
+
+        // Lay out the chunks after the index.
+        uint64_t offset = sizeof(CFileHeader) + sizeof(CChunkHeader) + sizeof(CChunkEntry) * uint64_t(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            if (offset + entries[chunk].compressedSize > UINT32_MAX)
+            {
+                return E_FAIL;
+            }
+
+            entries[chunk].offset = static_cast<uint32_t>(offset);
+            offset += entries[chunk].compressedSize;
+        }
+
+        // Create compressed file.
+        ScopedHandle hFile(safe_handle(CreateFile2(compressFile, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr)));
+        if (!hFile)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        auto_delete_file delonfail(hFile.get());
+
+        // Write header and chunk index.
+        CFileHeader fileHeader = {};
+        memcpy(fileHeader.magic, c_Signature, c_CFileSignatureLen);
+        fileHeader.mode = info->mode;
+        fileHeader.version = c_CFileVersionChunked;
+        fileHeader.lastChar = static_cast<uint16_t>(origChar);
+        fileHeader.uncompressedSize = static_cast<DWORD>(dataLen);
+
+        CChunkHeader chunkHeader = {};
+        chunkHeader.chunkSize = chunkSize;
+        chunkHeader.chunkCount = static_cast<uint32_t>(chunkCount);
+
+        DWORD bytesWritten;
+        if (!WriteFile(hFile.get(), &fileHeader, static_cast<DWORD>(sizeof(CFileHeader)), &bytesWritten, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesWritten != sizeof(CFileHeader))
+            return E_FAIL;
+
+        if (!WriteFile(hFile.get(), &chunkHeader, static_cast<DWORD>(sizeof(CChunkHeader)), &bytesWritten, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesWritten != sizeof(CChunkHeader))
+            return E_FAIL;
+
+        const auto indexSize = static_cast<DWORD>(sizeof(CChunkEntry) * chunkCount);
+        if (!WriteFile(hFile.get(), entries.get(), indexSize, &bytesWritten, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesWritten != indexSize)
+            return E_FAIL;
+
+        // Write compressed chunks.
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            const DWORD compressedSize = entries[chunk].compressedSize;
+            if (!WriteFile(hFile.get(), compressedData.get() + chunk * chunkBound, compressedSize, &bytesWritten, nullptr))
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            if (bytesWritten != compressedSize)
+                return E_FAIL;
+        }
+
+        delonfail.clear();
+
+        return S_OK;
+    }
+
+    // Expands every chunk of a chunked file in parallel, each worker with its own decompressor.
+    HRESULT DecompressChunks(
+        _In_reads_bytes_(dataLen) const uint8_t* data,
+        size_t dataLen,
+        _Out_writes_bytes_(uncompressedSize) uint8_t* expandedData,
+        size_t uncompressedSize)
+    {
+        auto hdr = reinterpret_cast<const CFileHeader*>(data);
+
+        size_t chunkSize;
+        size_t chunkCount;
+        auto entries = GetChunkIndex(data, dataLen, chunkSize, chunkCount);
+        if (!entries || hdr->uncompressedSize != uncompressedSize)
+            return E_FAIL;
+
+        std::atomic<size_t> nextChunk(0);
+
+        return RunOnThreads(GetWorkerCount(chunkCount), [&]() -> HRESULT
+            {
+                std::unique_ptr<Codec> decompressor;
+
+                for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+                {
+                    const size_t offset = chunk * chunkSize;
+                    const size_t chunkLen = std::min(chunkSize, uncompressedSize - offset);
+                    const CChunkEntry& entry = entries[chunk];
+
+                    if (entry.compressedSize == chunkLen)
+                    {
+                        memcpy(expandedData + offset, data + entry.offset, chunkLen);
+                        continue;
+                    }
+
+                    if (!decompressor)
+                    {
+                        HRESULT hr = CreateDecoder(hdr->mode, decompressor);
+                        if (FAILED(hr))
+                            return hr;
+                    }
+
+                    HRESULT hr = decompressor->Decompress(data + entry.offset, entry.compressedSize, expandedData + offset, chunkLen);
+                    if (FAILED(hr))
+                        return hr;
+                }
+
+                return S_OK;
+            });
+    }
+
+    HRESULT WriteExpandedFile(const wchar_t* fileName, _In_reads_bytes_(fileSize) const uint8_t* expandedData, size_t fileSize)
+    {
+        // Create expanded file.
+        ScopedHandle hFile(safe_handle(CreateFile2(fileName, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr)));
+        if (!hFile)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        auto_delete_file delonfail(hFile.get());
+
+        DWORD bytesWritten;
+        if (!WriteFile(hFile.get(), expandedData, static_cast<DWORD>(fileSize), &bytesWritten, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesWritten != fileSize)
+            return E_FAIL;
+
+        delonfail.clear();
+
+        return S_OK;
+    }
 
     HRESULT DecompressFile(
         _In_reads_bytes_(dataLen) const void* data,
@@ -610,102 +1196,335 @@ namespace
         if (memcmp(hdr, c_Signature, c_CFileSignatureLen) != 0)
             return E_FAIL;
 
-        if (hdr->version != c_CFileVersion)
+        if (hdr->version != c_CFileVersion && hdr->version != c_CFileVersionChunked)
             return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 
-        switch (hdr->mode)
+        // Fails for unknown modes, even if every chunk turns out to be stored
+        std::unique_ptr<Codec> decompressor;
+        HRESULT hr = CreateDecoder(hdr->mode, decompressor);
+        if (FAILED(hr))
+            return hr;
+
+        std::unique_ptr<uint8_t[]> expandedData(new (std::nothrow) uint8_t[hdr->uncompressedSize]);
+        if (!expandedData)
         {
-        case COMPRESS_ALGORITHM_MSZIP:  // https://en.wikipedia.org/wiki/Deflate
-        case COMPRESS_ALGORITHM_LZMS:   // https://en.wikipedia.org/wiki/Quantum_compression
-            break;
+            return E_OUTOFMEMORY;
+        }
 
-        default:
-            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        if (hdr->version == c_CFileVersionChunked)
+        {
+            hr = DecompressChunks(static_cast<const uint8_t*>(data), dataLen, expandedData.get(), hdr->uncompressedSize);
+        }
+        else
+        {
+            auto payload = reinterpret_cast<const uint8_t*>(data) + sizeof(CFileHeader);
+            size_t payloadLen = dataLen - sizeof(CFileHeader);
+
+            hr = decompressor->Decompress(payload, payloadLen, expandedData.get(), hdr->uncompressedSize);
         }
+        if (FAILED(hr))
+            return hr;
+
+        return WriteExpandedFile(fileName, expandedData.get(), hdr->uncompressedSize);
+    }
+
+    //----------------------------------------------------------------------------------
+    // Automatic codec choice
+    //
+    // Samples spread across the file are compressed with each candidate, which are listed
+    // fastest to decode first. The first candidate within c_AutoSizeTolerance of the
+    // smallest result is chosen. Samples that don't compress count as stored, as chunks do.
+    //----------------------------------------------------------------------------------
+    constexpr size_t c_AutoSampleSize = 256 * 1024;
+    constexpr size_t c_AutoSampleCount = 4;
+    constexpr double c_AutoSizeTolerance = 1.10;
+
+    const uint32_t c_AutoCandidates[] = { CODEC_LZHC, CODEC_MSZIP, CODEC_LZMS };
+
+    HRESULT SelectCodec(
+        _In_reads_bytes_(dataLen) const uint8_t* data,
+        size_t dataLen,
+        uint32_t& codec)
+    {
+        if (!data || !dataLen)
+            return E_INVALIDARG;
+
+        const size_t sampleSize = std::min(c_AutoSampleSize, dataLen);
+        const size_t sampleCount = std::max<size_t>(1, std::min(c_AutoSampleCount, dataLen / sampleSize));
+        const size_t stride = (sampleCount > 1) ? (dataLen - sampleSize) / (sampleCount - 1) : 0;
 
-        COMPRESS_ALLOCATION_ROUTINES allocData = { SimpleAlloc, SimpleFree, nullptr };
+        uint64_t sizes[_countof(c_AutoCandidates)] = {};
 
-        std::unique_ptr<void, decompressor_closer> decompressor;
+        std::unique_ptr<uint8_t[]> scratch;
+        size_t scratchSize = 0;
+
+        for (size_t j = 0; j < _countof(c_AutoCandidates); ++j)
         {
-            DECOMPRESSOR_HANDLE h = nullptr;
-            if (!CreateDecompressor(
-                static_cast<DWORD>(hdr->mode),
-                &allocData,
-                &h))
+            std::unique_ptr<Codec> compressor;
+            HRESULT hr = CreateCodec(c_AutoCandidates[j], compressor);
+            if (FAILED(hr))
+                return hr;
+
+            size_t bound;
+            hr = compressor->GetCompressBound(sampleSize, bound);
+            if (FAILED(hr))
+                return hr;
+
+            if (bound > scratchSize)
             {
-                return HRESULT_FROM_WIN32(GetLastError());
+                scratch.reset(new (std::nothrow) uint8_t[bound]);
+                if (!scratch)
+                {
+                    return E_OUTOFMEMORY;
+                }
+
+                scratchSize = bound;
             }
 
-            decompressor.reset(h);
+            for (size_t k = 0; k < sampleCount; ++k)
+            {
+                size_t compressedSize;
+                hr = compressor->Compress(data + k * stride, sampleSize, scratch.get(), scratchSize, compressedSize);
+                if (FAILED(hr))
+                    return hr;
+
+                sizes[j] += std::min(compressedSize, sampleSize);
+            }
         }
 
-        // Query decompressed buffer size.
-        auto payload = reinterpret_cast<const void*>(reinterpret_cast<const uint8_t*>(data) + sizeof(CFileHeader));
-        size_t payloadLen = dataLen - sizeof(CFileHeader);
+        const uint64_t smallest = *std::min_element(sizes, sizes + _countof(c_AutoCandidates));
 
-        SIZE_T bufferSize;
-        if (!Decompress(
-            static_cast<DECOMPRESSOR_HANDLE>(decompressor.get()),
-            payload,
-            payloadLen,
-            nullptr,
-            0,
-            &bufferSize))
+        for (size_t j = 0; j < _countof(c_AutoCandidates); ++j)
         {
-            DWORD errorCode = GetLastError();
-            if (errorCode != ERROR_INSUFFICIENT_BUFFER)
+            if (double(sizes[j]) <= double(smallest) * c_AutoSizeTolerance)
             {
-                return HRESULT_FROM_WIN32(GetLastError());
+                codec = c_AutoCandidates[j];
+                break;
             }
         }
 
-        // Ensure our header and the compression API agree.
-        if (hdr->uncompressedSize != bufferSize)
-            return E_FAIL;
+        return S_OK;
+    }
 
-        std::unique_ptr<uint8_t[]> expandedData(new (std::nothrow) uint8_t[bufferSize]);
-        if (!expandedData)
+    //----------------------------------------------------------------------------------
+    // Benchmark
+    //
+    // Each codec compresses the file in memory as chunks of its default size (or -chunk)
+    // and then decodes it on a single thread, so codecs are compared per core. Decoding is
+    // repeated c_BenchRuns times and the fastest run is kept.
+    //----------------------------------------------------------------------------------
+    constexpr uint32_t c_BenchRuns = 3;
+
+    struct BenchResult
+    {
+        uint64_t    uncompressedSize;
+        uint64_t    compressedSize;             // Including the file header and chunk index
+        double      compressSeconds;
+        double      decompressSeconds;
+    };
+
+    double GetElapsedSeconds(const LARGE_INTEGER& qpcStart, const LARGE_INTEGER& qpcFreq)
+    {
+        LARGE_INTEGER qpcEnd = {};
+        (void)QueryPerformanceCounter(&qpcEnd);
+
+        return double(qpcEnd.QuadPart - qpcStart.QuadPart) / double(qpcFreq.QuadPart);
+    }
+
+    HRESULT BenchmarkCodec(
+        _In_reads_bytes_(dataLen) const uint8_t* data,
+        size_t dataLen,
+        uint32_t codec,
+        uint32_t chunkSize,
+        BenchResult& result)
+    {
+        if (!data || !dataLen || dataLen > UINT32_MAX)
+            return E_INVALIDARG;
+
+        const CodecInfo* info = GetCodecInfo(codec);
+        if (!info)
+            return E_INVALIDARG;
+
+        if (!chunkSize)
         {
-            return E_OUTOFMEMORY;
+            chunkSize = info->defaultChunkSize;
         }
 
-        SIZE_T fileSize;
-        if (!Decompress(
-            static_cast<DECOMPRESSOR_HANDLE>(decompressor.get()),
-            payload,
-            payloadLen,
-            expandedData.get(),
-            bufferSize,
-            &fileSize))
+        const size_t chunkCount = (dataLen + chunkSize - 1) / chunkSize;
+
+        std::unique_ptr<Codec> codecImpl;
+        HRESULT hr = CreateCodec(codec, codecImpl);
+        if (FAILED(hr))
+            return hr;
+
+        size_t chunkBound;
+        hr = codecImpl->GetCompressBound(chunkSize, chunkBound);
+        if (FAILED(hr))
+            return hr;
+
+        chunkBound = std::max<size_t>(chunkBound, chunkSize);
+
+        std::unique_ptr<uint8_t[]> compressedData(new (std::nothrow) uint8_t[chunkBound * chunkCount]);
+        std::unique_ptr<size_t[]> compressedSizes(new (std::nothrow) size_t[chunkCount]);
+        std::unique_ptr<uint8_t[]> expandedData(new (std::nothrow) uint8_t[dataLen]);
+        if (!compressedData || !compressedSizes || !expandedData)
         {
-            return HRESULT_FROM_WIN32(GetLastError());
+            return E_OUTOFMEMORY;
         }
 
-        if (fileSize > UINT32_MAX)
+        LARGE_INTEGER qpcFreq = {};
+        (void)QueryPerformanceFrequency(&qpcFreq);
+
+        LARGE_INTEGER qpcStart = {};
+        (void)QueryPerformanceCounter(&qpcStart);
+
+        uint64_t totalCompressed = sizeof(CFileHeader) + sizeof(CChunkHeader) + sizeof(CChunkEntry) * uint64_t(chunkCount);
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
         {
-            return E_FAIL;
+            const size_t offset = chunk * chunkSize;
+            const size_t chunkLen = std::min<size_t>(chunkSize, dataLen - offset);
+
+            size_t compressedSize;
+            hr = codecImpl->Compress(data + offset, chunkLen, compressedData.get() + chunk * chunkBound, chunkBound, compressedSize);
+            if (FAILED(hr))
+                return hr;
+
+            if (compressedSize >= chunkLen)
+            {
+                memcpy(compressedData.get() + chunk * chunkBound, data + offset, chunkLen);
+                compressedSize = chunkLen;
+            }
+
+            compressedSizes[chunk] = compressedSize;
+            totalCompressed += compressedSize;
         }
 
-        // Create expanded file.
-        ScopedHandle hFile(safe_handle(CreateFile2(fileName, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr)));
-        if (!hFile)
+        result.compressSeconds = GetElapsedSeconds(qpcStart, qpcFreq);
+
+        result.decompressSeconds = 0;
+        for (uint32_t run = 0; run < c_BenchRuns; ++run)
         {
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
+            (void)QueryPerformanceCounter(&qpcStart);
 
-        auto_delete_file delonfail(hFile.get());
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                const size_t offset = chunk * chunkSize;
+                const size_t chunkLen = std::min<size_t>(chunkSize, dataLen - offset);
+                const uint8_t* src = compressedData.get() + chunk * chunkBound;
 
-        DWORD bytesWritten;
-        if (!WriteFile(hFile.get(), expandedData.get(), fileSize, &bytesWritten, nullptr))
-            return HRESULT_FROM_WIN32(GetLastError());
+                if (compressedSizes[chunk] == chunkLen)
+                {
+                    memcpy(expandedData.get() + offset, src, chunkLen);
+                    continue;
+                }
 
-        if (bytesWritten != fileSize)
+                hr = codecImpl->Decompress(src, compressedSizes[chunk], expandedData.get() + offset, chunkLen);
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            const double seconds = GetElapsedSeconds(qpcStart, qpcFreq);
+            if (!run || seconds < result.decompressSeconds)
+            {
+                result.decompressSeconds = seconds;
+            }
+        }
+
+        if (memcmp(expandedData.get(), data, dataLen) != 0)
             return E_FAIL;
 
-        delonfail.clear();
+        result.uncompressedSize = dataLen;
+        result.compressedSize = totalCompressed;
 
         return S_OK;
     }
+
+    void PrintBenchResult(const wchar_t* name, const BenchResult& result)
+    {
+        const double megabytes = double(result.uncompressedSize) / (1024.0 * 1024.0);
+
+        wprintf(L"   %-6ls %6.1f%%  compress %8.1f MB/s  decompress %8.1f MB/s\n",
+            name,
+            (result.uncompressedSize > 0) ? 100.0 * double(result.compressedSize) / double(result.uncompressedSize) : 0.0,
+            (result.compressSeconds > 0) ? megabytes / result.compressSeconds : 0.0,
+            (result.decompressSeconds > 0) ? megabytes / result.decompressSeconds : 0.0);
+    }
+
+    int RunBenchmark(const std::list<SConversion>& conversion, const std::vector<uint32_t>& codecs, uint32_t chunkSize)
+    {
+        int retVal = 0;
+        size_t fileCount = 0;
+
+        std::vector<BenchResult> totals(codecs.size(), BenchResult{});
+
+        for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv)
+        {
+            if (pConv != conversion.begin())
+                wprintf(L"\n");
+
+            wprintf(L"benchmarking %ls", pConv->szSrc);
+            fflush(stdout);
+
+            std::unique_ptr<uint8_t[]> blob;
+            size_t blobSize;
+            HRESULT hr = ReadData(pConv->szSrc, blob, blobSize);
+            if (SUCCEEDED(hr) && !blobSize)
+            {
+                hr = E_FAIL;
+            }
+            if (FAILED(hr))
+            {
+                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                retVal = 1;
+                continue;
+            }
+
+            uint32_t autoCodec = CODEC_LZMS;
+            hr = SelectCodec(blob.get(), blobSize, autoCodec);
+            if (FAILED(hr))
+            {
+                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                retVal = 1;
+                continue;
+            }
+
+            wprintf(L" (%.1f MB, auto picks %ls)\n", double(blobSize) / (1024.0 * 1024.0), GetCodecInfo(autoCodec)->name);
+
+            ++fileCount;
+
+            for (size_t j = 0; j < codecs.size(); ++j)
+            {
+                BenchResult result = {};
+                hr = BenchmarkCodec(blob.get(), blobSize, codecs[j], chunkSize, result);
+                if (FAILED(hr))
+                {
+                    wprintf(L"   %-6ls FAILED (%08X%ls)\n", GetCodecInfo(codecs[j])->name, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    retVal = 1;
+                    continue;
+                }
+
+                PrintBenchResult(GetCodecInfo(codecs[j])->name, result);
+
+                totals[j].uncompressedSize += result.uncompressedSize;
+                totals[j].compressedSize += result.compressedSize;
+                totals[j].compressSeconds += result.compressSeconds;
+                totals[j].decompressSeconds += result.decompressSeconds;
+            }
+        }
+
+        if (fileCount > 1)
+        {
+            wprintf(L"\n Total for %zu files:\n", fileCount);
+
+            for (size_t j = 0; j < codecs.size(); ++j)
+            {
+                PrintBenchResult(GetCodecInfo(codecs[j])->name, totals[j]);
+            }
+        }
+
+        return retVal;
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -726,6 +1545,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
     // Process command line
     uint32_t options = 0;
+    uint32_t chunkSize = 0;
+    uint32_t codec = CODEC_LZMS;
     std::list<SConversion> conversion;
 
     for (int iArg = 1; iArg < argc; iArg++)
@@ -755,7 +1576,27 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             // Handle options with additional value parameter
             switch (dwOption)
             {
+            case OPT_CHUNK:
+                // Chunk size is optional, and only accepted as -chunk:<KB> so it can't be mistaken for a file
+                if (*pValue)
+                {
+                    uint32_t chunkKB = 0;
+                    if (swscanf_s(pValue, L"%u", &chunkKB) != 1
+                        || chunkKB < (c_MinChunkSize / 1024)
+                        || chunkKB > (c_MaxChunkSize / 1024))
+                    {
+                        wprintf(L"Invalid value specified with -chunk (%ls), must be %u to %u KB\n\n", pValue,
+                            c_MinChunkSize / 1024, c_MaxChunkSize / 1024);
+                        PrintUsage(argv[0]);
+                        return 1;
+                    }
+
+                    chunkSize = chunkKB * 1024;
+                }
+                break;
+
             case OPT_FILELIST:
+            case OPT_CODEC:
                 if (!*pValue)
                 {
                     if ((iArg + 1 >= argc))
@@ -786,6 +1627,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 ProcessFileList(inFile, conversion);
             }
             break;
+
+            case OPT_CODEC:
+                codec = LookupByName(pValue, g_pCodecs);
+                if (!codec)
+                {
+                    wprintf(L"Invalid value specified with -codec (%ls)\n\n", pValue);
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                break;
             }
         }
         else if (wcspbrk(pArg, L"?*") != nullptr)
@@ -814,9 +1665,47 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         return 0;
     }
 
+    if (options & (1 << OPT_MSZIP))
+    {
+        if (options & (1 << OPT_CODEC))
+        {
+            wprintf(L"ERROR: -z cannot be combined with -codec\n\n");
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        codec = CODEC_MSZIP;
+    }
+
+    if ((options & (1 << OPT_BENCH)) && (options & (1 << OPT_UNCOMPRESS)))
+    {
+        wprintf(L"ERROR: -bench cannot be combined with -u\n\n");
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
     if (~options & (1 << OPT_NOLOGO))
         PrintLogo();
 
+    if (options & (1 << OPT_BENCH))
+    {
+        // Compare every codec unless one was named
+        std::vector<uint32_t> codecs;
+        if (codec != CODEC_AUTO && (options & ((1 << OPT_CODEC) | (1 << OPT_MSZIP))))
+        {
+            codecs.push_back(codec);
+        }
+        else
+        {
+            for (auto& info : c_CodecInfo)
+            {
+                codecs.push_back(info.codec);
+            }
+        }
+
+        return RunBenchmark(conversion, codecs, chunkSize);
+    }
+
     LARGE_INTEGER qpcFreq = {};
     (void)QueryPerformanceFrequency(&qpcFreq);
 
@@ -824,6 +1713,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     (void)QueryPerformanceCounter(&qpcStart);
 
     int retVal = 0;
+    double totalMegabytes = 0;
+    double totalSeconds = 0;
 
     for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv)
     {
@@ -863,8 +1754,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
             }
 
-            wprintf(L"compressing [%ls] %ls",
-                (options& (1 << OPT_MSZIP)) ? L"MSZIP" : L"LZMS",
+            wprintf(L"compressing [%ls%ls] %ls",
+                (codec == CODEC_AUTO) ? L"auto" : GetCodecInfo(codec)->name,
+                (options& (1 << OPT_CHUNK)) ? L", chunked" : L"",
                 pConv->szSrc);
             fflush(stdout);
         }
@@ -900,7 +1792,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 continue;
             }
 
-            if (hdr->version != c_CFileVersion)
+            if (hdr->version != c_CFileVersion && hdr->version != c_CFileVersionChunked)
             {
                 wprintf(L" FAILED - Unknown compress header version (%u).\n", hdr->version);
                 retVal = 1;
@@ -914,7 +1806,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             else if (len >= 3)
             {
                 wcscpy_s(ext2, ext);
-                ext2[len - 1] = hdr->lastChar;
+                ext2[len - 1] = static_cast<wchar_t>(hdr->lastChar);
             }
             else
             {
@@ -954,15 +1846,44 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
         }
 
+        LARGE_INTEGER qpcFileStart = {};
+        (void)QueryPerformanceCounter(&qpcFileStart);
+
+        size_t uncompressedSize = blobSize;
         if (options & (1 << OPT_UNCOMPRESS))
         {
+            uncompressedSize = reinterpret_cast<const CFileHeader*>(blob.get())->uncompressedSize;
             hr = DecompressFile(blob.get(), blobSize, destName);
         }
         else
         {
-            hr = CompressFile(blob.get(), blobSize,
-                (options & (1 << OPT_MSZIP)) ? COMPRESS_ALGORITHM_MSZIP : COMPRESS_ALGORITHM_LZMS,
-                origChar, destName);
+            uint32_t fileCodec = codec;
+            if (fileCodec == CODEC_AUTO)
+            {
+                hr = SelectCodec(blob.get(), blobSize, fileCodec);
+                if (SUCCEEDED(hr))
+                {
+                    wprintf(L" (%ls)", GetCodecInfo(fileCodec)->name);
+                }
+            }
+
+            if (SUCCEEDED(hr))
+            {
+                if (options & (1 << OPT_CHUNK))
+                {
+                    uint32_t fileChunkSize = chunkSize;
+                    if (!fileChunkSize)
+                    {
+                        fileChunkSize = GetCodecInfo(fileCodec)->defaultChunkSize;
+                    }
+
+                    hr = CompressChunkedFile(blob.get(), blobSize, fileCodec, fileChunkSize, origChar, destName);
+                }
+                else
+                {
+                    hr = CompressFile(blob.get(), blobSize, fileCodec, origChar, destName);
+                }
+            }
         }
         if (FAILED(hr))
         {
@@ -971,7 +1892,23 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             continue;
         }
 
-        wprintf(L" done.\n");
+        if (options & (1 << OPT_TIMING))
+        {
+            LARGE_INTEGER qpcFileEnd = {};
+            (void)QueryPerformanceCounter(&qpcFileEnd);
+
+            // Throughput is measured in uncompressed bytes for both directions
+            const double seconds = double(qpcFileEnd.QuadPart - qpcFileStart.QuadPart) / double(qpcFreq.QuadPart);
+            const double megabytes = double(uncompressedSize) / (1024.0 * 1024.0);
+            totalMegabytes += megabytes;
+            totalSeconds += seconds;
+
+            wprintf(L" done (%.1f MB/s).\n", (seconds > 0) ? megabytes / seconds : 0.0);
+        }
+        else
+        {
+            wprintf(L" done.\n");
+        }
     }
 
     if (options & (uint64_t(1) << OPT_TIMING))
@@ -981,6 +1918,13 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
         LONGLONG delta = qpcEnd.QuadPart - qpcStart.QuadPart;
         wprintf(L"\n Processing time: %f seconds\n", double(delta) / double(qpcFreq.QuadPart));
+
+        if (totalSeconds > 0)
+        {
+            wprintf(L" %ls throughput: %.1f MB/s (%.1f MB in %f seconds)\n",
+                (options & (1 << OPT_UNCOMPRESS)) ? L"Decompression" : L"Compression",
+                totalMegabytes / totalSeconds, totalMegabytes, totalSeconds);
+        }
     }
 
     return retVal;
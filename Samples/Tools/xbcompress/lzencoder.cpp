@@ -0,0 +1,320 @@
+//--------------------------------------------------------------------------------------
+// File: lzencoder.cpp
+//
+// Encoder for the portable LZ77 codec used by xbcompress alongside the Compression API.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#include "lzencoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace LZ;
+
+namespace
+{
+    // Matches never start in the last c_MatchSearchLimit bytes, and the last c_LastLiterals bytes are
+    // always literals, so the match finders can read 4 bytes at any position they search.
+    constexpr size_t c_LastLiterals = 5;
+    constexpr size_t c_MatchSearchLimit = 12;
+
+    constexpr uint32_t c_HashBits = 16;
+    constexpr size_t c_HashSize = size_t(1) << c_HashBits;
+    constexpr size_t c_WindowMask = 0xFFFF;
+
+    // Fast mode steps further ahead the longer it goes without a match
+    constexpr uint32_t c_SkipTrigger = 6;
+
+    // High mode limits on how far it walks each hash chain
+    constexpr uint32_t c_MaxChainAttempts = 64;
+    constexpr size_t c_NiceMatchLength = 256;
+
+    constexpr uint32_t c_EmptySlot = UINT32_MAX;
+
+    inline uint32_t Read32(const uint8_t* p) noexcept
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Hash4(const uint8_t* p) noexcept
+    {
+        return (Read32(p) * 2654435761u) >> (32 - c_HashBits);
+    }
+
+    // Length of the common prefix of a and b, reading no further than limit
+    inline size_t CountMatch(const uint8_t* a, const uint8_t* b, const uint8_t* limit) noexcept
+    {
+        const uint8_t* start = a;
+        while (a + sizeof(uint32_t) <= limit && Read32(a) == Read32(b))
+        {
+            a += sizeof(uint32_t);
+            b += sizeof(uint32_t);
+        }
+        while (a < limit && *a == *b)
+        {
+            ++a;
+            ++b;
+        }
+        return static_cast<size_t>(a - start);
+    }
+
+    class SequenceWriter
+    {
+    public:
+        SequenceWriter(uint8_t* dest, size_t destCapacity) noexcept :
+            m_op(dest),
+            m_end(dest + destCapacity),
+            m_start(dest)
+        {
+        }
+
+        // Writes literals followed by a match; an offset of zero ends the stream after the literals
+        bool Write(const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) noexcept
+        {
+            const size_t extra = (offset) ? matchLength - c_MinMatch : 0;
+
+            const size_t required = 1 + (literalCount / 255 + 1) + literalCount + ((offset) ? 2 + extra / 255 + 1 : 0);
+            if (required > static_cast<size_t>(m_end - m_op))
+                return false;
+
+            uint8_t* token = m_op++;
+            *token = static_cast<uint8_t>(std::min<size_t>(literalCount, 15) << 4);
+            if (literalCount >= 15)
+            {
+                WriteLength(literalCount - 15);
+            }
+
+            if (literalCount)
+            {
+                memcpy(m_op, literals, literalCount);
+                m_op += literalCount;
+            }
+
+            if (offset)
+            {
+                *m_op++ = static_cast<uint8_t>(offset & 0xFF);
+                *m_op++ = static_cast<uint8_t>(offset >> 8);
+
+                *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+                if (extra >= 15)
+                {
+                    WriteLength(extra - 15);
+                }
+            }
+
+            return true;
+        }
+
+        size_t GetSize() const noexcept { return static_cast<size_t>(m_op - m_start); }
+
+    private:
+        void WriteLength(size_t length) noexcept
+        {
+            while (length >= 255)
+            {
+                *m_op++ = 255;
+                length -= 255;
+            }
+            *m_op++ = static_cast<uint8_t>(length);
+        }
+
+        uint8_t*        m_op;
+        uint8_t*        m_end;
+        uint8_t*        m_start;
+    };
+}
+
+
+//--------------------------------------------------------------------------------------
+// Encoder
+//--------------------------------------------------------------------------------------
+size_t LZ::CompressBound(size_t srcLen) noexcept
+{
+    return srcLen + srcLen / 255 + 16;
+}
+
+Encoder::Encoder(Level level) :
+    m_level(level),
+    m_head(new uint32_t[c_HashSize])
+{
+    if (level == Level::High)
+    {
+        m_chain.reset(new uint32_t[c_WindowMask + 1]);
+    }
+}
+
+_Use_decl_annotations_
+size_t Encoder::Compress(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t destCapacity) noexcept
+{
+    if ((!src && srcLen) || !dest || srcLen > UINT32_MAX)
+        return 0;
+
+    if (srcLen <= c_MatchSearchLimit)
+    {
+        // Too short to hold a match
+        SequenceWriter writer(dest, destCapacity);
+        return writer.Write(src, srcLen, 0, 0) ? writer.GetSize() : 0;
+    }
+
+    return (m_level == Level::High)
+        ? CompressHigh(src, srcLen, dest, destCapacity)
+        : CompressFast(src, srcLen, dest, destCapacity);
+}
+
+size_t Encoder::CompressFast(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t destCapacity) noexcept
+{
+    uint32_t* head = m_head.get();
+    std::fill(head, head + c_HashSize, c_EmptySlot);
+
+    SequenceWriter writer(dest, destCapacity);
+
+    const uint8_t* matchLimit = src + srcLen - c_LastLiterals;
+    const size_t searchLimit = srcLen - c_MatchSearchLimit;
+
+    size_t anchor = 0;
+    size_t ip = 0;
+    uint32_t misses = 1u << c_SkipTrigger;
+
+    while (ip < searchLimit)
+    {
+        const uint32_t h = Hash4(src + ip);
+        const size_t candidate = head[h];
+        head[h] = static_cast<uint32_t>(ip);
+
+        if (candidate == c_EmptySlot
+            || ip - candidate > c_MaxOffset
+            || Read32(src + candidate) != Read32(src + ip))
+        {
+            ip += misses++ >> c_SkipTrigger;
+            continue;
+        }
+
+        // Extend the match backwards over pending literals, then forwards
+        size_t start = ip;
+        size_t match = candidate;
+        while (start > anchor && match > 0 && src[start - 1] == src[match - 1])
+        {
+            --start;
+            --match;
+        }
+
+        const size_t length = c_MinMatch + CountMatch(src + ip + c_MinMatch, src + candidate + c_MinMatch, matchLimit) + (ip - start);
+
+        if (!writer.Write(src + anchor, start - anchor, start - match, length))
+            return 0;
+
+        ip = start + length;
+        anchor = ip;
+        misses = 1u << c_SkipTrigger;
+
+        if (ip - 2 < searchLimit)
+        {
+            head[Hash4(src + ip - 2)] = static_cast<uint32_t>(ip - 2);
+        }
+    }
+
+    if (!writer.Write(src + anchor, srcLen - anchor, 0, 0))
+        return 0;
+
+    return writer.GetSize();
+}
+
+size_t Encoder::CompressHigh(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t destCapacity) noexcept
+{
+    uint32_t* head = m_head.get();
+    uint32_t* chain = m_chain.get();
+    std::fill(head, head + c_HashSize, c_EmptySlot);
+
+    SequenceWriter writer(dest, destCapacity);
+
+    const uint8_t* matchLimit = src + srcLen - c_LastLiterals;
+    const size_t searchLimit = srcLen - c_MatchSearchLimit;
+
+    size_t nextInsert = 0;
+
+    // Longest match for position ip among the earlier positions in the window
+    auto findMatch = [&](size_t ip, size_t& bestOffset) -> size_t
+    {
+        for (; nextInsert < ip; ++nextInsert)
+        {
+            const uint32_t h = Hash4(src + nextInsert);
+            chain[nextInsert & c_WindowMask] = head[h];
+            head[h] = static_cast<uint32_t>(nextInsert);
+        }
+
+        size_t bestLength = 0;
+        size_t candidate = head[Hash4(src + ip)];
+
+        for (uint32_t attempts = 0; attempts < c_MaxChainAttempts && candidate != c_EmptySlot; ++attempts)
+        {
+            if (ip - candidate > c_MaxOffset)
+                break;
+
+            // Check the byte that would extend the best match before comparing the rest
+            if (src[candidate + bestLength] == src[ip + bestLength] && Read32(src + candidate) == Read32(src + ip))
+            {
+                const size_t length = c_MinMatch + CountMatch(src + ip + c_MinMatch, src + candidate + c_MinMatch, matchLimit);
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestOffset = ip - candidate;
+
+                    if (length >= c_NiceMatchLength)
+                        break;
+                }
+            }
+
+            const size_t next = chain[candidate & c_WindowMask];
+            if (next >= candidate)
+                break;
+
+            candidate = next;
+        }
+
+        return bestLength;
+    };
+
+    size_t anchor = 0;
+    size_t ip = 0;
+
+    while (ip < searchLimit)
+    {
+        size_t offset = 0;
+        size_t length = findMatch(ip, offset);
+        if (length < c_MinMatch)
+        {
+            ++ip;
+            continue;
+        }
+
+        // Defer to the next position if it starts a longer match
+        while (ip + 1 < searchLimit)
+        {
+            size_t nextOffset = 0;
+            const size_t nextLength = findMatch(ip + 1, nextOffset);
+            if (nextLength <= length)
+                break;
+
+            ++ip;
+            length = nextLength;
+            offset = nextOffset;
+        }
+
+        if (!writer.Write(src + anchor, ip - anchor, offset, length))
+            return 0;
+
+        ip += length;
+        anchor = ip;
+    }
+
+    if (!writer.Write(src + anchor, srcLen - anchor, 0, 0))
+        return 0;
+
+    return writer.GetSize();
+}
+
@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------------------
+// File: lzencoder.h
+//
+// Encoder for the portable LZ77 codec used by xbcompress alongside the Compression API.
+// The stream format and the decoder live in Kits/ATGTK/LZCodec.h, which the runtime
+// (ReadCompressedData) shares, so there is only one decoder for the format.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "LZCodec.h"
+
+#include <memory>
+
+namespace LZ
+{
+    enum class Level
+    {
+        Fast,   // Greedy matching with a single hash probe
+        High,   // Lazy matching over hash chains, for a better ratio at the same decode speed
+    };
+
+    // Worst case compressed size of srcLen bytes
+    size_t CompressBound(size_t srcLen) noexcept;
+
+    class Encoder
+    {
+    public:
+        explicit Encoder(Level level);
+
+        Encoder(Encoder&&) = default;
+        Encoder& operator= (Encoder&&) = default;
+
+        Encoder(Encoder const&) = delete;
+        Encoder& operator= (Encoder const&) = delete;
+
+        // Returns the compressed size, or 0 if it does not fit in destCapacity
+        size_t Compress(
+            _In_reads_bytes_(srcLen) const uint8_t* src, size_t srcLen,
+            _Out_writes_bytes_to_(destCapacity, return) uint8_t* dest, size_t destCapacity) noexcept;
+
+    private:
+        size_t CompressFast(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t destCapacity) noexcept;
+        size_t CompressHigh(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t destCapacity) noexcept;
+
+        Level                       m_level;
+        std::unique_ptr<uint32_t[]> m_head;
+        std::unique_ptr<uint32_t[]> m_chain;
+    };
+}
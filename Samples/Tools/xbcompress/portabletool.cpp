@@ -0,0 +1,478 @@
+//--------------------------------------------------------------------------------------
+// File: portabletool.cpp
+//
+// Portable front end for xbcompress that only uses standard C++, so files can be
+// produced and verified on non-Windows build machines. It writes and reads the same
+// plain and chunked layouts (xbcformat.h) as compresstool.cpp, but only supports the
+// portable LZ codec: MSZIP and LZMS need the Windows Compression API.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#include "lzencoder.h"
+#include "xbcformat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace XBCompress;
+
+namespace
+{
+    constexpr uint32_t c_DefaultChunkSize = 256 * 1024;
+
+    struct Options
+    {
+        bool        uncompress = false;
+        bool        chunked = false;
+        bool        verify = false;
+        bool        overwrite = false;
+        bool        nologo = false;
+        LZ::Level   level = LZ::Level::Fast;
+        uint32_t    chunkSize = c_DefaultChunkSize;
+    };
+
+    void PrintUsage()
+    {
+        printf(
+            "Usage: xbcompress_portable <options> <files>\n\n"
+            "   -u                  decompress\n"
+            "   -codec:<lz|lzhc>    portable LZ codec (defaults to lz)\n"
+            "   -chunk[:<KB>]       compress in independent chunks (64 KB to 16 MB, defaults to 256 KB)\n"
+            "   -verify             decode each output and compare it with the source\n"
+            "   -y                  overwrite existing output files\n"
+            "   -nologo             suppress copyright message\n");
+    }
+
+    bool ReadFile(const std::string& fileName, std::vector<uint8_t>& data)
+    {
+        std::ifstream inFile(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!inFile)
+            return false;
+
+        const std::streamoff len = inFile.tellg();
+        if (len < 0)
+            return false;
+
+        data.resize(static_cast<size_t>(len));
+
+        inFile.seekg(0, std::ios::beg);
+        if (!inFile)
+            return false;
+
+        return !len || inFile.read(reinterpret_cast<char*>(data.data()), len);
+    }
+
+    bool WriteFile(const std::string& fileName, const std::vector<uint8_t>& data)
+    {
+        std::ofstream outFile(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outFile)
+            return false;
+
+        outFile.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        outFile.close();
+
+        if (!outFile)
+        {
+            std::remove(fileName.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool FileExists(const std::string& fileName)
+    {
+        std::ifstream inFile(fileName, std::ios::in | std::ios::binary);
+        return inFile.good();
+    }
+
+    template<typename T>
+    void Append(std::vector<uint8_t>& data, const T& value)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    CFileHeader MakeHeader(uint8_t version, uint16_t lastChar, size_t dataLen)
+    {
+        CFileHeader fileHeader = {};
+        memcpy(fileHeader.magic, c_Signature, c_CFileSignatureLen);
+        fileHeader.mode = c_CompressModeLZ;
+        fileHeader.version = version;
+        fileHeader.lastChar = lastChar;
+        fileHeader.uncompressedSize = static_cast<uint32_t>(dataLen);
+        return fileHeader;
+    }
+
+    // Same layout as CompressFile in compresstool.cpp
+    bool CompressData(const std::vector<uint8_t>& data, LZ::Level level, uint16_t lastChar, std::vector<uint8_t>& result)
+    {
+        if (data.empty() || data.size() > UINT32_MAX)
+            return false;
+
+        std::vector<uint8_t> compressed(LZ::CompressBound(data.size()));
+
+        LZ::Encoder encoder(level);
+        const size_t compressedSize = encoder.Compress(data.data(), data.size(), compressed.data(), compressed.size());
+
+        result.clear();
+        Append(result, MakeHeader(c_CFileVersion, lastChar, data.size()));
+
+        // Data that doesn't compress is stored as-is, as chunks are.
+        if (!compressedSize || compressedSize >= data.size())
+        {
+            result.insert(result.end(), data.begin(), data.end());
+        }
+        else
+        {
+            result.insert(result.end(), compressed.begin(), compressed.begin() + static_cast<ptrdiff_t>(compressedSize));
+        }
+        return true;
+    }
+
+    // Same layout as CompressChunkedFile in compresstool.cpp, compressing the chunks in order
+    bool CompressChunkedData(const std::vector<uint8_t>& data, LZ::Level level, uint32_t chunkSize, uint16_t lastChar, std::vector<uint8_t>& result)
+    {
+        if (data.empty() || data.size() > UINT32_MAX)
+            return false;
+
+        if (chunkSize < c_MinChunkSize || chunkSize > c_MaxChunkSize)
+            return false;
+
+        const size_t chunkCount = (data.size() + chunkSize - 1) / chunkSize;
+
+        std::vector<CChunkEntry> entries(chunkCount);
+        std::vector<uint8_t> payload;
+        std::vector<uint8_t> compressed(LZ::CompressBound(chunkSize));
+
+        LZ::Encoder encoder(level);
+
+        uint64_t offset = sizeof(CFileHeader) + sizeof(CChunkHeader) + sizeof(CChunkEntry) * uint64_t(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            const size_t chunkOffset = chunk * chunkSize;
+            const size_t chunkLen = std::min<size_t>(chunkSize, data.size() - chunkOffset);
+            const uint8_t* src = data.data() + chunkOffset;
+
+            size_t compressedSize = encoder.Compress(src, chunkLen, compressed.data(), compressed.size());
+
+            // Chunks that don't compress are stored as-is.
+            if (!compressedSize || compressedSize >= chunkLen)
+            {
+                payload.insert(payload.end(), src, src + chunkLen);
+                compressedSize = chunkLen;
+            }
+            else
+            {
+                payload.insert(payload.end(), compressed.begin(), compressed.begin() + static_cast<ptrdiff_t>(compressedSize));
+            }
+
+            if (offset + compressedSize > UINT32_MAX)
+                return false;
+
+            entries[chunk].offset = static_cast<uint32_t>(offset);
+            entries[chunk].compressedSize = static_cast<uint32_t>(compressedSize);
+            offset += compressedSize;
+        }
+
+        CChunkHeader chunkHeader = {};
+        chunkHeader.chunkSize = chunkSize;
+        chunkHeader.chunkCount = static_cast<uint32_t>(chunkCount);
+
+        result.clear();
+        result.reserve(static_cast<size_t>(offset));
+        Append(result, MakeHeader(c_CFileVersionChunked, lastChar, data.size()));
+        Append(result, chunkHeader);
+        for (auto& entry : entries)
+        {
+            Append(result, entry);
+        }
+        result.insert(result.end(), payload.begin(), payload.end());
+        return true;
+    }
+
+    // Expands a file of either layout; fails for modes other than the portable LZ codec
+    const char* DecompressData(const std::vector<uint8_t>& data, std::vector<uint8_t>& result)
+    {
+        if (data.size() <= sizeof(CFileHeader))
+            return "File too small to contain valid header";
+
+        auto hdr = reinterpret_cast<const CFileHeader*>(data.data());
+        if (memcmp(hdr->magic, c_Signature, c_CFileSignatureLen) != 0)
+            return "Invalid compress header signature";
+
+        if (hdr->version != c_CFileVersion && hdr->version != c_CFileVersionChunked)
+            return "Unknown compress header version";
+
+        if (hdr->mode != c_CompressModeLZ)
+            return "MSZIP and LZMS files need the Windows xbcompress";
+
+        result.resize(hdr->uncompressedSize);
+
+        if (hdr->version == c_CFileVersion)
+        {
+            if (data.size() - sizeof(CFileHeader) == result.size())
+            {
+                memcpy(result.data(), data.data() + sizeof(CFileHeader), result.size());
+            }
+            else if (!LZ::Decompress(data.data() + sizeof(CFileHeader), data.size() - sizeof(CFileHeader), result.data(), result.size()))
+                return "Corrupt compressed data";
+
+            return nullptr;
+        }
+
+        size_t chunkSize;
+        size_t chunkCount;
+        const CChunkEntry* entries = GetChunkIndex(data.data(), data.size(), chunkSize, chunkCount);
+        if (!entries)
+            return "Corrupt chunk index";
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            const size_t offset = chunk * chunkSize;
+            const size_t chunkLen = std::min(chunkSize, result.size() - offset);
+            const CChunkEntry& entry = entries[chunk];
+
+            if (entry.compressedSize == chunkLen)
+            {
+                memcpy(result.data() + offset, data.data() + entry.offset, chunkLen);
+            }
+            else if (!LZ::Decompress(data.data() + entry.offset, entry.compressedSize, result.data() + offset, chunkLen))
+            {
+                return "Corrupt compressed chunk";
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Splits 'path' into everything up to the extension and the extension itself (including the '.')
+    void SplitExtension(const std::string& path, std::string& stem, std::string& ext)
+    {
+        const size_t dir = path.find_last_of("/\\");
+        const size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos || (dir != std::string::npos && dot < dir))
+        {
+            stem = path;
+            ext.clear();
+        }
+        else
+        {
+            stem = path.substr(0, dot);
+            ext = path.substr(dot);
+        }
+    }
+
+    int ProcessFile(const std::string& fileName, const Options& options)
+    {
+        std::string stem, ext;
+        SplitExtension(fileName, stem, ext);
+
+        const char lastChar = ext.empty() ? 0 : ext.back();
+        if (options.uncompress && lastChar != '_')
+        {
+            printf("skipping '%s' as it lacks the '_' end marker\n", fileName.c_str());
+            return 0;
+        }
+        else if (!options.uncompress && lastChar == '_')
+        {
+            printf("skipping '%s' as it already has the '_' end marker\n", fileName.c_str());
+            return 0;
+        }
+
+        printf("%s %s", options.uncompress ? "expanding" : "compressing", fileName.c_str());
+        fflush(stdout);
+
+        std::vector<uint8_t> data;
+        if (!ReadFile(fileName, data))
+        {
+            printf(" FAILED - Unable to read file\n");
+            return 1;
+        }
+
+        // Same naming as compresstool.cpp: the last character of the extension is replaced by '_'
+        // and kept in the header, or the whole extension is replaced when it is too short.
+        std::string destName = stem;
+        uint16_t origChar = 0;
+        std::vector<uint8_t> result;
+
+        if (options.uncompress)
+        {
+            const char* error = DecompressData(data, result);
+            if (error)
+            {
+                printf(" FAILED - %s.\n", error);
+                return 1;
+            }
+
+            if (ext != "._")
+            {
+                if (ext.size() < 3)
+                {
+                    printf(" FAILED - Unexpected location of '_' in filename.\n");
+                    return 1;
+                }
+
+                const uint16_t restored = reinterpret_cast<const CFileHeader*>(data.data())->lastChar;
+                if (!restored || restored >= 0x80)
+                {
+                    printf(" FAILED - Original extension is not ASCII.\n");
+                    return 1;
+                }
+
+                destName += ext.substr(0, ext.size() - 1);
+                destName += static_cast<char>(restored);
+            }
+        }
+        else
+        {
+            if (ext.size() >= 3)
+            {
+                if (static_cast<unsigned char>(lastChar) >= 0x80)
+                {
+                    printf(" FAILED - Extension must end with an ASCII character.\n");
+                    return 1;
+                }
+
+                origChar = static_cast<uint16_t>(lastChar);
+                destName += ext.substr(0, ext.size() - 1);
+                destName += '_';
+            }
+            else
+            {
+                destName += "._";
+            }
+
+            const bool succeeded = (options.chunked)
+                ? CompressChunkedData(data, options.level, options.chunkSize, origChar, result)
+                : CompressData(data, options.level, origChar, result);
+            if (!succeeded)
+            {
+                printf(" FAILED - Unable to compress (empty or larger than 4 GB)\n");
+                return 1;
+            }
+        }
+
+        if (!options.overwrite && FileExists(destName))
+        {
+            printf("\nERROR: Output file %s already exists, use -y to overwrite!\n", destName.c_str());
+            return 1;
+        }
+
+        if (!WriteFile(destName, result))
+        {
+            printf(" FAILED - Unable to write %s\n", destName.c_str());
+            return 1;
+        }
+
+        if (options.verify && !options.uncompress)
+        {
+            // Reads back what was written, so a bad write is caught as well as a codec bug
+            std::vector<uint8_t> written;
+            std::vector<uint8_t> expanded;
+            const char* error = ReadFile(destName, written) ? DecompressData(written, expanded) : "Unable to read output";
+            if (error || expanded != data)
+            {
+                printf(" FAILED - Verification (%s).\n", error ? error : "Mismatch");
+                return 1;
+            }
+
+            printf(" verified");
+        }
+
+        printf(" done (%zu -> %zu bytes).\n", data.size(), result.size());
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<std::string> files;
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+    {
+        const std::string arg = argv[iArg];
+
+        if (arg.empty() || (arg[0] != '-' && arg[0] != '/'))
+        {
+            files.push_back(arg);
+            continue;
+        }
+
+        const std::string name = arg.substr(1);
+        if (name == "u")
+        {
+            options.uncompress = true;
+        }
+        else if (name == "codec:lz")
+        {
+            options.level = LZ::Level::Fast;
+        }
+        else if (name == "codec:lzhc")
+        {
+            options.level = LZ::Level::High;
+        }
+        else if (name == "chunk")
+        {
+            options.chunked = true;
+        }
+        else if (name.compare(0, 6, "chunk:") == 0)
+        {
+            const unsigned long kb = strtoul(name.c_str() + 6, nullptr, 10);
+            if (kb < c_MinChunkSize / 1024 || kb > c_MaxChunkSize / 1024)
+            {
+                printf("Invalid value specified with -chunk (%s)\n", name.c_str() + 6);
+                return 1;
+            }
+
+            options.chunked = true;
+            options.chunkSize = static_cast<uint32_t>(kb * 1024);
+        }
+        else if (name == "verify")
+        {
+            options.verify = true;
+        }
+        else if (name == "y")
+        {
+            options.overwrite = true;
+        }
+        else if (name == "nologo")
+        {
+            options.nologo = true;
+        }
+        else
+        {
+            printf("ERROR: Unknown option '%s'\n\n", arg.c_str());
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!options.nologo)
+    {
+        printf("Microsoft (R) File Compression Tool, portable LZ front end\n"
+               "Copyright (C) Microsoft Corp.\n\n");
+    }
+
+    if (files.empty())
+    {
+        PrintUsage();
+        return 0;
+    }
+
+    int retVal = 0;
+    for (auto& file : files)
+    {
+        retVal |= ProcessFile(file, options);
+    }
+
+    return retVal;
+}
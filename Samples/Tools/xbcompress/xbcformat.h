@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------------------
+// File: xbcformat.h
+//
+// Layout of the files written by xbcompress, shared by the Windows tool and the portable
+// LZ front end. Only uses standard C++; all fields are little-endian.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace XBCompress
+{
+    // The format used by this tool is the same design as the classic SZDD/KAWJ formats used by MS-DOS.
+    // Files generated by this tool, however, are not compatible with EXPAND.EXE or GnuWin32 MSCOMPRESS.EXE.
+
+    constexpr uint8_t c_CFileSignatureLen = 8;
+    constexpr uint8_t c_CFileVersion = 0x41;
+
+    const uint8_t c_Signature[c_CFileSignatureLen] = { 0x41, 0x46, 0x43, 0x57, 0x47, 0x50, 0x53, 0x4d };
+
+#pragma pack(push,1)
+    struct CFileHeader
+    {
+        uint8_t     magic[c_CFileSignatureLen]; // Must match c_Signature
+        uint8_t     mode;                       // COMPRESS_ALGORITHM_x enum or c_CompressModeLZ
+        uint8_t     version;
+        uint16_t    lastChar;                   // UTF-16 code unit (wchar_t on Windows)
+        uint32_t    uncompressedSize;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(CFileHeader) == 16, "File header size mismatch");
+
+    // Chunked files use a different header version and follow the header with a chunk index. Each
+    // chunk is compressed on its own, so chunks can be compressed and decompressed in parallel.
+    constexpr uint8_t c_CFileVersionChunked = 0x42;
+
+    constexpr uint32_t c_MinChunkSize = 64 * 1024;
+    constexpr uint32_t c_MaxChunkSize = 16 * 1024 * 1024;
+
+#pragma pack(push,1)
+    struct CChunkHeader
+    {
+        uint32_t    chunkSize;                  // Uncompressed size of every chunk but the last
+        uint32_t    chunkCount;
+    };
+
+    struct CChunkEntry
+    {
+        uint32_t    offset;                     // From the start of the file
+        uint32_t    compressedSize;             // Same as the uncompressed size if the chunk is stored
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(CChunkHeader) == 8, "Chunk header size mismatch");
+    static_assert(sizeof(CChunkEntry) == 8, "Chunk entry size mismatch");
+
+    // Header 'mode' of the portable LZ codec (Kits/ATGTK/LZCodec.h). Other modes are COMPRESS_ALGORITHM_x
+    // values for the Windows Compression API. Single-stream LZ files whose data doesn't compress are
+    // stored as-is, like chunks, so their payload is exactly 'uncompressedSize' bytes.
+    constexpr uint8_t c_CompressModeLZ = 0x80;
+
+    // Returns the chunk index of a chunked file, or nullptr if the index doesn't match the header or
+    // references data past the end of the file
+    inline const CChunkEntry* GetChunkIndex(
+        const uint8_t* data,
+        size_t dataLen,
+        size_t& chunkSize,
+        size_t& chunkCount) noexcept
+    {
+        if (!data || dataLen < sizeof(CFileHeader) + sizeof(CChunkHeader))
+            return nullptr;
+
+        auto hdr = reinterpret_cast<const CFileHeader*>(data);
+        auto chunkHeader = reinterpret_cast<const CChunkHeader*>(data + sizeof(CFileHeader));
+        const size_t uncompressedSize = hdr->uncompressedSize;
+        chunkSize = chunkHeader->chunkSize;
+        chunkCount = chunkHeader->chunkCount;
+
+        if (!chunkSize || chunkCount != (uncompressedSize + chunkSize - 1) / chunkSize)
+            return nullptr;
+
+        if ((dataLen - sizeof(CFileHeader) - sizeof(CChunkHeader)) / sizeof(CChunkEntry) < chunkCount)
+            return nullptr;
+
+        auto entries = reinterpret_cast<const CChunkEntry*>(data + sizeof(CFileHeader) + sizeof(CChunkHeader));
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            if (uint64_t(entries[chunk].offset) + entries[chunk].compressedSize > dataLen)
+                return nullptr;
+        }
+
+        return entries;
+    }
+}
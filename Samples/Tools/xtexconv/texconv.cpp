@@ -21,23 +21,34 @@
 #pragma warning(pop)
 
 #include <ShlObj.h>
+#include <bcrypt.h>
+#include <psapi.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cwchar>
 #include <cwctype>
 #include <fstream>
+#include <functional>
 #include <iterator>
 #include <list>
 #include <locale>
 #include <memory>
+#include <mutex>
 #include <new>
 #include <set>
 #include <string>
+#include <system_error>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 #include <wrl\client.h>
 
@@ -135,6 +146,11 @@ namespace
         OPT_SWIZZLE,
         OPT_USE_XBOX,
         OPT_XGMODE,
+        OPT_BENCHMARK,
+        OPT_FUSED,
+        OPT_JOBS,
+        OPT_JOB_MEMORY,
+        OPT_CACHE,
         OPT_MAX
     };
 
@@ -150,6 +166,22 @@ namespace
         ROTATE_P3D65_TO_709,
     };
 
+    enum JOB_RESULT
+    {
+        JOB_OK = 0,
+        JOB_FAILED,     // This file failed, continue with the rest
+        JOB_ABORT,      // Stop processing any more files
+    };
+
+    enum
+    {
+        BENCHMARK_BC7 = 1,
+        BENCHMARK_BC6H = 2,
+        BENCHMARK_MIPS = 4,
+        BENCHMARK_CONVERT = 8,
+        BENCHMARK_QUALITY = 16,
+    };
+
     static_assert(OPT_MAX <= 64, "dwOptions is a unsigned int bitfield");
 
     struct SConversion
@@ -226,6 +258,11 @@ namespace
         { L"swizzle",       OPT_SWIZZLE },
         { L"xbox",          OPT_USE_XBOX },
         { L"xgmode",        OPT_XGMODE },
+        { L"benchmark",     OPT_BENCHMARK },
+        { L"fuse",          OPT_FUSED },
+        { L"j",             OPT_JOBS },
+        { L"jmem",          OPT_JOB_MEMORY },
+        { L"cache",         OPT_CACHE },
         { nullptr,          0 }
     };
 
@@ -407,18 +444,24 @@ namespace
         { L"FANT",                      TEX_FILTER_FANT },
         { L"BOX",                       TEX_FILTER_BOX },
         { L"TRIANGLE",                  TEX_FILTER_TRIANGLE },
+        { L"LANCZOS",                   TEX_FILTER_LANCZOS },
+        { L"MITCHELL",                  TEX_FILTER_MITCHELL },
         { L"POINT_DITHER",              TEX_FILTER_POINT | TEX_FILTER_DITHER },
         { L"LINEAR_DITHER",             TEX_FILTER_LINEAR | TEX_FILTER_DITHER },
         { L"CUBIC_DITHER",              TEX_FILTER_CUBIC | TEX_FILTER_DITHER },
         { L"FANT_DITHER",               TEX_FILTER_FANT | TEX_FILTER_DITHER },
         { L"BOX_DITHER",                TEX_FILTER_BOX | TEX_FILTER_DITHER },
         { L"TRIANGLE_DITHER",           TEX_FILTER_TRIANGLE | TEX_FILTER_DITHER },
+        { L"LANCZOS_DITHER",            TEX_FILTER_LANCZOS | TEX_FILTER_DITHER },
+        { L"MITCHELL_DITHER",           TEX_FILTER_MITCHELL | TEX_FILTER_DITHER },
         { L"POINT_DITHER_DIFFUSION",    TEX_FILTER_POINT | TEX_FILTER_DITHER_DIFFUSION },
         { L"LINEAR_DITHER_DIFFUSION",   TEX_FILTER_LINEAR | TEX_FILTER_DITHER_DIFFUSION },
         { L"CUBIC_DITHER_DIFFUSION",    TEX_FILTER_CUBIC | TEX_FILTER_DITHER_DIFFUSION },
         { L"FANT_DITHER_DIFFUSION",     TEX_FILTER_FANT | TEX_FILTER_DITHER_DIFFUSION },
         { L"BOX_DITHER_DIFFUSION",      TEX_FILTER_BOX | TEX_FILTER_DITHER_DIFFUSION },
         { L"TRIANGLE_DITHER_DIFFUSION", TEX_FILTER_TRIANGLE | TEX_FILTER_DITHER_DIFFUSION },
+        { L"LANCZOS_DITHER_DIFFUSION",  TEX_FILTER_LANCZOS | TEX_FILTER_DITHER_DIFFUSION },
+        { L"MITCHELL_DITHER_DIFFUSION", TEX_FILTER_MITCHELL | TEX_FILTER_DITHER_DIFFUSION },
         { nullptr,                      TEX_FILTER_DEFAULT                              }
     };
 
@@ -483,6 +526,25 @@ namespace
         { L"12.2", 16384 },
         { nullptr, 0 },
     };
+
+    const SValue<uint32_t> g_pBenchmarks[] =
+    {
+        { L"bc7",       BENCHMARK_BC7 },
+        { L"bc6h",      BENCHMARK_BC6H },
+        { L"mips",      BENCHMARK_MIPS },
+        { L"convert",   BENCHMARK_CONVERT },
+        { L"quality",   BENCHMARK_QUALITY },
+        { nullptr,      0 }
+    };
+
+    const TEX_COMPRESS_FLAGS g_BC7QualityLevels[] =
+    {
+        TEX_COMPRESS_BC7_QUALITY_0,
+        TEX_COMPRESS_BC7_QUALITY_1,
+        TEX_COMPRESS_BC7_QUALITY_2,
+        TEX_COMPRESS_BC7_QUALITY_3,
+        TEX_COMPRESS_BC7_QUALITY_4,
+    };
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -728,13 +790,47 @@ namespace
         }
     }
 
+    //--------------------------------------------------------------------------------------
+    // Console output for a conversion. Under -j each job's text is buffered and then
+    // written in input order, so the log does not depend on which job finishes first.
+    //--------------------------------------------------------------------------------------
+    thread_local std::wstring* t_jobOutput = nullptr;
+
+    void JobPrint(_In_z_ _Printf_format_string_ const wchar_t* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+
+        if (t_jobOutput)
+        {
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            const int len = _vscwprintf(format, argsCopy);
+            va_end(argsCopy);
+
+            if (len > 0)
+            {
+                const size_t offset = t_jobOutput->size();
+                t_jobOutput->resize(offset + size_t(len) + 1);
+                vswprintf_s(&(*t_jobOutput)[offset], size_t(len) + 1, format, args);
+                t_jobOutput->resize(offset + size_t(len));
+            }
+        }
+        else
+        {
+            vwprintf(format, args);
+        }
+
+        va_end(args);
+    }
+
     void PrintFormat(DXGI_FORMAT Format)
     {
         for (auto pFormat = g_pFormats; pFormat->name; pFormat++)
         {
             if (static_cast<DXGI_FORMAT>(pFormat->value) == Format)
             {
-                wprintf(L"%ls", pFormat->name);
+                JobPrint(L"%ls", pFormat->name);
                 return;
             }
         }
@@ -743,65 +839,65 @@ namespace
         {
             if (static_cast<DXGI_FORMAT>(pFormat->value) == Format)
             {
-                wprintf(L"%ls", pFormat->name);
+                JobPrint(L"%ls", pFormat->name);
                 return;
             }
         }
 
-        wprintf(L"*UNKNOWN*");
+        JobPrint(L"*UNKNOWN*");
     }
 
     void PrintInfo(const TexMetadata& info, bool isXbox)
     {
-        wprintf(L" (%zux%zu", info.width, info.height);
+        JobPrint(L" (%zux%zu", info.width, info.height);
 
         if (TEX_DIMENSION_TEXTURE3D == info.dimension)
-            wprintf(L"x%zu", info.depth);
+            JobPrint(L"x%zu", info.depth);
 
         if (info.mipLevels > 1)
-            wprintf(L",%zu", info.mipLevels);
+            JobPrint(L",%zu", info.mipLevels);
 
         if (info.arraySize > 1)
-            wprintf(L",%zu", info.arraySize);
+            JobPrint(L",%zu", info.arraySize);
 
-        wprintf(L" ");
+        JobPrint(L" ");
         PrintFormat(info.format);
 
         switch (info.dimension)
         {
         case TEX_DIMENSION_TEXTURE1D:
-            wprintf(L"%ls", (info.arraySize > 1) ? L" 1DArray" : L" 1D");
+            JobPrint(L"%ls", (info.arraySize > 1) ? L" 1DArray" : L" 1D");
             break;
 
         case TEX_DIMENSION_TEXTURE2D:
             if (info.IsCubemap())
             {
-                wprintf(L"%ls", (info.arraySize > 6) ? L" CubeArray" : L" Cube");
+                JobPrint(L"%ls", (info.arraySize > 6) ? L" CubeArray" : L" Cube");
             }
             else
             {
-                wprintf(L"%ls", (info.arraySize > 1) ? L" 2DArray" : L" 2D");
+                JobPrint(L"%ls", (info.arraySize > 1) ? L" 2DArray" : L" 2D");
             }
             break;
 
         case TEX_DIMENSION_TEXTURE3D:
-            wprintf(L" 3D");
+            JobPrint(L" 3D");
             break;
         }
 
         switch (info.GetAlphaMode())
         {
         case TEX_ALPHA_MODE_OPAQUE:
-            wprintf(L" \x0e0:Opaque");
+            JobPrint(L" \x0e0:Opaque");
             break;
         case TEX_ALPHA_MODE_PREMULTIPLIED:
-            wprintf(L" \x0e0:PM");
+            JobPrint(L" \x0e0:PM");
             break;
         case TEX_ALPHA_MODE_STRAIGHT:
-            wprintf(L" \x0e0:NonPM");
+            JobPrint(L" \x0e0:NonPM");
             break;
         case TEX_ALPHA_MODE_CUSTOM:
-            wprintf(L" \x0e0:Custom");
+            JobPrint(L" \x0e0:Custom");
             break;
         case TEX_ALPHA_MODE_UNKNOWN:
             break;
@@ -809,10 +905,10 @@ namespace
 
         if (isXbox)
         {
-            wprintf(L" Xbox");
+            JobPrint(L" Xbox");
         }
 
-        wprintf(L")");
+        JobPrint(L")");
     }
 
     void PrintList(size_t cch, const SValue<uint32_t> *pValue)
@@ -933,16 +1029,21 @@ namespace
         wprintf(L"   -wiclossless        When writing images with WIC use lossless mode\n");
         wprintf(L"   -wicmulti           When writing images with WIC encode multiframe images\n");
         wprintf(L"\n   -nologo             suppress copyright message\n");
-        wprintf(L"   -timing             Display elapsed processing time\n\n");
-#ifdef _OPENMP
+        wprintf(L"   -timing             Display elapsed processing time, per-file stage times\n"
+                L"                       and peak working set\n\n");
         wprintf(L"   -singleproc         Do not use multi-threaded compression\n");
-#endif
+        wprintf(L"   -j <count>          Convert up to <count> files concurrently\n");
+        wprintf(L"   -jmem <MB>          Memory budget for -j (defaults to half of physical memory)\n");
+        wprintf(L"   -cache <dir>        Reuse outputs from <dir> when the source and options are unchanged\n");
         wprintf(L"   -gpu <adapter>      Select GPU for DirectCompute-based codecs (0 is default)\n");
         wprintf(L"   -nogpu              Do not use DirectCompute-based codecs\n");
+        wprintf(
+            L"   -fuse               Generate mips, premultiply, and BC compress in a single pass\n"
+            L"                       over block rows (DDS output, CPU codec, non-WIC filters)\n");
         wprintf(
             L"\n   -bc <options>       Sets options for BC compression\n"
             L"                       options must be one or more of\n"
-            L"                          d, u, q, x\n");
+            L"                          d, u, q, x, h (quick BC6H), or a BC7 quality level 0-4\n");
         wprintf(
             L"   -aw <weight>        BC7 GPU compressor weighting for alpha error metric\n"
             L"                       (defaults to 1.0)\n");
@@ -954,6 +1055,7 @@ namespace
         wprintf(L"   -inverty            Invert Y (i.e. green) channel values\n");
         wprintf(L"   -reconstructz       Rebuild Z (blue) channel assuming X/Y are normals\n");
         wprintf(L"   -swizzle <rgba>     Swizzle image channels using HLSL-style mask\n");
+        wprintf(L"\n   -benchmark <test>   Report codec throughput and quality for each input\n");
 
         wprintf(L"\n   <format>: ");
         PrintList(13, g_pFormats);
@@ -972,6 +1074,9 @@ namespace
         wprintf(L"\n   <feature-level>: ");
         PrintList(13, g_pFeatureLevels);
 
+        wprintf(L"\n   <test>: ");
+        PrintList(13, g_pBenchmarks);
+
         ComPtr<IDXGIFactory1> dxgiFactory;
         if (GetDXGIFactory(dxgiFactory.GetAddressOf()))
         {
@@ -993,7 +1098,7 @@ namespace
 
     const wchar_t* GetErrorDesc(HRESULT hr)
     {
-        static wchar_t desc[1024] = {};
+        static thread_local wchar_t desc[1024] = {};
 
         LPWSTR errorText = nullptr;
 
@@ -1062,7 +1167,7 @@ namespace
             {
                 if (FAILED(dxgiFactory->EnumAdapters(static_cast<UINT>(adapter), pAdapter.GetAddressOf())))
                 {
-                    wprintf(L"\nERROR: Invalid GPU adapter index (%d)!\n", adapter);
+                    JobPrint(L"\nERROR: Invalid GPU adapter index (%d)!\n", adapter);
                     return false;
                 }
             }
@@ -1107,7 +1212,7 @@ namespace
                     hr = pAdapter->GetDesc(&desc);
                     if (SUCCEEDED(hr))
                     {
-                        wprintf(L"\n[Using DirectCompute on \"%ls\"]\n", desc.Description);
+                        JobPrint(L"\n[Using DirectCompute on \"%ls\"]\n", desc.Description);
                     }
                 }
             }
@@ -1348,6 +1453,815 @@ namespace
 
         return true;
     }
+
+    //--------------------------------------------------------------------------------------
+    // Compresses all images once, returning the elapsed time and the pixel-weighted MSE
+    //--------------------------------------------------------------------------------------
+    HRESULT TimeCompress(const ScratchImage& image, DXGI_FORMAT format, TEX_COMPRESS_FLAGS cflags, float alphaThreshold,
+        double& seconds, double& error)
+    {
+        const Image* images = image.GetImages();
+        const size_t nimages = image.GetImageCount();
+
+        LARGE_INTEGER qpcFreq = {};
+        std::ignore = QueryPerformanceFrequency(&qpcFreq);
+
+        ScratchImage result;
+
+        LARGE_INTEGER qpcStart = {};
+        std::ignore = QueryPerformanceCounter(&qpcStart);
+
+        HRESULT hr = Compress(images, nimages, image.GetMetadata(), format, cflags, alphaThreshold, result);
+        if (FAILED(hr))
+            return hr;
+
+        LARGE_INTEGER qpcEnd = {};
+        std::ignore = QueryPerformanceCounter(&qpcEnd);
+
+        seconds = double(qpcEnd.QuadPart - qpcStart.QuadPart) / double(qpcFreq.QuadPart);
+
+        double pixels = 0.0;
+        error = 0.0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            float mse = 0.f;
+            hr = ComputeMSE(images[index], result.GetImages()[index], mse, nullptr);
+            if (FAILED(hr))
+                return hr;
+
+            const double count = double(images[index].width) * double(images[index].height);
+            error += double(mse) * count;
+            pixels += count;
+        }
+
+        if (pixels > 0.0)
+        {
+            error /= pixels;
+        }
+
+        return S_OK;
+    }
+
+    double CountPixels(const ScratchImage& image) noexcept
+    {
+        const Image* images = image.GetImages();
+
+        double pixels = 0.0;
+        for (size_t index = 0; index < image.GetImageCount(); ++index)
+        {
+            pixels += double(images[index].width) * double(images[index].height);
+        }
+        return pixels;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Compresses the image to BC7 at every quality level, reporting throughput and PSNR
+    //--------------------------------------------------------------------------------------
+    HRESULT BenchmarkBC7(const ScratchImage& image, DXGI_FORMAT format, TEX_COMPRESS_FLAGS cflags, float alphaThreshold)
+    {
+        const double pixels = CountPixels(image);
+
+        JobPrint(L"\n BC7 benchmark (%zu images, %.2f MPix)\n", image.GetImageCount(), pixels / 1000000.0);
+        JobPrint(L"   level     seconds      MPix/s   PSNR (dB)\n");
+
+        cflags &= ~(TEX_COMPRESS_BC7_QUICK | TEX_COMPRESS_BC7_QUALITY_MASK);
+
+        for (size_t level = 0; level < std::size(g_BC7QualityLevels); ++level)
+        {
+            // Values are normalized to [0,1] for PSNR
+            double seconds, error;
+            HRESULT hr = TimeCompress(image, format, cflags | g_BC7QualityLevels[level], alphaThreshold, seconds, error);
+            if (FAILED(hr))
+                return hr;
+
+            if (error > 0.0)
+            {
+                JobPrint(L"   %5zu  %10.3f  %10.2f  %10.2f\n", level, seconds, pixels / (seconds * 1000000.0), 10.0 * log10(1.0 / error));
+            }
+            else
+            {
+                JobPrint(L"   %5zu  %10.3f  %10.2f    lossless\n", level, seconds, pixels / (seconds * 1000000.0));
+            }
+        }
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Compresses the image to BC6H with the reference and quick searches, reporting
+    // throughput and the error of the quick path relative to the reference
+    //--------------------------------------------------------------------------------------
+    HRESULT BenchmarkBC6H(const ScratchImage& image, DXGI_FORMAT format, TEX_COMPRESS_FLAGS cflags)
+    {
+        const double pixels = CountPixels(image);
+
+        JobPrint(L"\n BC6H benchmark (%zu images, %.2f MPix)\n", image.GetImageCount(), pixels / 1000000.0);
+        JobPrint(L"   search        seconds      MPix/s           MSE\n");
+
+        cflags &= ~TEX_COMPRESS_BC6H_QUICK;
+
+        double refSeconds, refError;
+        HRESULT hr = TimeCompress(image, format, cflags, TEX_THRESHOLD_DEFAULT, refSeconds, refError);
+        if (FAILED(hr))
+            return hr;
+
+        JobPrint(L"   reference  %10.3f  %10.2f  %12.6g\n", refSeconds, pixels / (refSeconds * 1000000.0), refError);
+
+        double seconds, error;
+        hr = TimeCompress(image, format, cflags | TEX_COMPRESS_BC6H_QUICK, TEX_THRESHOLD_DEFAULT, seconds, error);
+        if (FAILED(hr))
+            return hr;
+
+        JobPrint(L"   quick      %10.3f  %10.2f  %12.6g\n", seconds, pixels / (seconds * 1000000.0), error);
+
+        if (refError > 0.0)
+        {
+            JobPrint(L"   quick is %.2fx faster, MSE delta %+.6g (%+.2f%%)\n",
+                refSeconds / seconds, error - refError, 100.0 * (error - refError) / refError);
+        }
+        else
+        {
+            JobPrint(L"   quick is %.2fx faster, MSE delta %+.6g\n", refSeconds / seconds, error - refError);
+        }
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Generates the mip chain single-threaded and then with increasing thread counts,
+    // reporting the scaling and checking that every parallel result matches
+    //--------------------------------------------------------------------------------------
+    HRESULT BenchmarkMips(const ScratchImage& image, TEX_FILTER_FLAGS filter)
+    {
+        const TexMetadata& metadata = image.GetMetadata();
+
+        // Parallel generation only applies to the non-WIC filters
+        filter = (filter & ~TEX_FILTER_PARALLEL) | TEX_FILTER_FORCE_NON_WIC;
+
+        LARGE_INTEGER qpcFreq = {};
+        std::ignore = QueryPerformanceFrequency(&qpcFreq);
+
+        auto generate = [&](TEX_FILTER_FLAGS flags, ScratchImage& result, double& seconds) -> HRESULT
+            {
+                LARGE_INTEGER qpcStart = {};
+                std::ignore = QueryPerformanceCounter(&qpcStart);
+
+                HRESULT hr = (metadata.dimension == TEX_DIMENSION_TEXTURE3D)
+                    ? GenerateMipMaps3D(image.GetImages(), image.GetImageCount(), metadata, flags, 0, result)
+                    : GenerateMipMaps(image.GetImages(), image.GetImageCount(), metadata, flags, 0, result);
+
+                LARGE_INTEGER qpcEnd = {};
+                std::ignore = QueryPerformanceCounter(&qpcEnd);
+
+                seconds = double(qpcEnd.QuadPart - qpcStart.QuadPart) / double(qpcFreq.QuadPart);
+                return hr;
+            };
+
+        ScratchImage reference;
+        double serial;
+        HRESULT hr = generate(filter, reference, serial);
+        if (FAILED(hr))
+            return hr;
+
+        JobPrint(L"\n Mipmap benchmark (%zu x %zu, %zu items, %zu levels)\n",
+            metadata.width, metadata.height, std::max(metadata.arraySize, metadata.depth), reference.GetMetadata().mipLevels);
+        JobPrint(L"   threads     seconds     speedup  identical\n");
+        JobPrint(L"    serial  %10.3f  %10.2f\n", serial, 1.0);
+
+        const size_t savedThreads = GetParallelThreadCount();
+        const size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        for (size_t threads = 1; ; threads = std::min(threads * 2, maxThreads))
+        {
+            SetParallelThreadCount(threads);
+
+            ScratchImage result;
+            double seconds;
+            hr = generate(filter | TEX_FILTER_PARALLEL, result, seconds);
+            if (FAILED(hr))
+                break;
+
+            const bool identical = (result.GetPixelsSize() == reference.GetPixelsSize())
+                && (memcmp(result.GetPixels(), reference.GetPixels(), reference.GetPixelsSize()) == 0);
+
+            JobPrint(L"   %7zu  %10.3f  %10.2f  %9ls\n", threads, seconds, serial / seconds, identical ? L"yes" : L"NO");
+
+            if (threads >= maxThreads)
+                break;
+        }
+
+        SetParallelThreadCount(savedThreads);
+
+        return hr;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Times the direct format-pair conversion kernels against the generic scanline path,
+    // checking that both produce the same bits
+    //--------------------------------------------------------------------------------------
+    HRESULT BenchmarkConvert(const ScratchImage& image, TEX_FILTER_FLAGS filter)
+    {
+        static const struct
+        {
+            DXGI_FORMAT source;
+            DXGI_FORMAT target;
+            const wchar_t* name;
+        } s_pairs[] =
+        {
+            { DXGI_FORMAT_R8G8B8A8_UNORM,       DXGI_FORMAT_B8G8R8A8_UNORM,         L"RGBA8 -> BGRA8" },
+            { DXGI_FORMAT_B8G8R8A8_UNORM,       DXGI_FORMAT_R8G8B8A8_UNORM,         L"BGRA8 -> RGBA8" },
+            { DXGI_FORMAT_R8G8B8A8_UNORM,       DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,    L"RGBA8 -> sRGB8" },
+            { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,  DXGI_FORMAT_R16G16B16A16_FLOAT,     L"sRGB8 -> RGBA16F" },
+            { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,  DXGI_FORMAT_R16G16B16A16_FLOAT,     L"sBGRA8 -> RGBA16F" },
+            { DXGI_FORMAT_R32G32B32A32_FLOAT,   DXGI_FORMAT_R16G16B16A16_FLOAT,     L"RGBA32F -> RGBA16F" },
+            { DXGI_FORMAT_R16G16B16A16_FLOAT,   DXGI_FORMAT_R32G32B32A32_FLOAT,     L"RGBA16F -> RGBA32F" },
+        };
+
+        // Block-compressed inputs are decompressed first, as the main conversion path does
+        const ScratchImage* input = &image;
+        ScratchImage decompressed;
+        if (IsCompressed(image.GetMetadata().format))
+        {
+            HRESULT hr = Decompress(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+                DXGI_FORMAT_UNKNOWN /* picks good default */, decompressed);
+            if (FAILED(hr))
+                return hr;
+
+            input = &decompressed;
+        }
+
+        const TexMetadata& metadata = input->GetMetadata();
+        const double pixels = CountPixels(*input);
+
+        // Only the non-dithered non-WIC path has direct kernels
+        filter = (filter & ~(TEX_FILTER_DITHER | TEX_FILTER_DITHER_DIFFUSION | TEX_FILTER_FORCE_WIC | TEX_FILTER_FORCE_SCANLINE))
+            | TEX_FILTER_FORCE_NON_WIC;
+
+        LARGE_INTEGER qpcFreq = {};
+        std::ignore = QueryPerformanceFrequency(&qpcFreq);
+
+        auto convert = [&](const ScratchImage& src, DXGI_FORMAT format, TEX_FILTER_FLAGS flags, ScratchImage& result, double& seconds) -> HRESULT
+            {
+                LARGE_INTEGER qpcStart = {};
+                std::ignore = QueryPerformanceCounter(&qpcStart);
+
+                HRESULT hr = Convert(src.GetImages(), src.GetImageCount(), src.GetMetadata(), format, flags, TEX_THRESHOLD_DEFAULT, result);
+
+                LARGE_INTEGER qpcEnd = {};
+                std::ignore = QueryPerformanceCounter(&qpcEnd);
+
+                seconds = double(qpcEnd.QuadPart - qpcStart.QuadPart) / double(qpcFreq.QuadPart);
+                return hr;
+            };
+
+        JobPrint(L"\n Conversion benchmark (%zu images, %.2f MPix)\n", input->GetImageCount(), pixels / 1000000.0);
+        JobPrint(L"   pair                   generic      direct     speedup  identical\n");
+
+        for (size_t j = 0; j < std::size(s_pairs); ++j)
+        {
+            const DXGI_FORMAT target = s_pairs[j].target;
+
+            // Bring the input into the pair's source format with the regular conversion
+            const ScratchImage* src = input;
+            ScratchImage converted;
+            if (metadata.format != s_pairs[j].source)
+            {
+                HRESULT hr = Convert(input->GetImages(), input->GetImageCount(), metadata, s_pairs[j].source,
+                    TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted);
+                if (FAILED(hr))
+                    return hr;
+
+                src = &converted;
+            }
+
+            ScratchImage generic;
+            double genericSeconds;
+            HRESULT hr = convert(*src, target, filter | TEX_FILTER_FORCE_SCANLINE, generic, genericSeconds);
+            if (FAILED(hr))
+                return hr;
+
+            ScratchImage direct;
+            double directSeconds;
+            hr = convert(*src, target, filter, direct, directSeconds);
+            if (FAILED(hr))
+                return hr;
+
+            const bool identical = (direct.GetPixelsSize() == generic.GetPixelsSize())
+                && (memcmp(direct.GetPixels(), generic.GetPixels(), generic.GetPixelsSize()) == 0);
+
+            JobPrint(L"   %-20ls  %10.3f  %10.3f  %10.2f  %9ls\n",
+                s_pairs[j].name, genericSeconds, directSeconds, genericSeconds / directSeconds, identical ? L"yes" : L"NO");
+        }
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Reports MSE, PSNR, and SSIM of the top mip of each item/slice after compression
+    //--------------------------------------------------------------------------------------
+    HRESULT ReportQuality(const ScratchImage& source, const ScratchImage& result, CMSE_FLAGS flags)
+    {
+        const TexMetadata& metadata = result.GetMetadata();
+        const size_t slices = (metadata.dimension == TEX_DIMENSION_TEXTURE3D) ? metadata.depth : 1;
+
+        double pixels = 0.0;
+        double mse = 0.0;
+        double meanMSE = 0.0;
+        double ssim = 0.0;
+        double ssimV[4] = {};
+        for (size_t item = 0; item < metadata.arraySize; ++item)
+        {
+            for (size_t slice = 0; slice < slices; ++slice)
+            {
+                const Image* img1 = source.GetImage(0, item, slice);
+                const Image* img2 = result.GetImage(0, item, slice);
+                if (!img1 || !img2)
+                    return E_POINTER;
+
+                ImageMetrics metrics;
+                HRESULT hr = ComputeImageMetrics(*img1, *img2, metrics, flags);
+                if (FAILED(hr))
+                    return hr;
+
+                const double count = double(img1->width) * double(img1->height);
+                mse += double(metrics.mse) * count;
+                meanMSE += (std::isinf(metrics.psnr) ? 0.0 : pow(10.0, -0.1 * double(metrics.psnr))) * count;
+                ssim += double(metrics.ssim) * count;
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    ssimV[j] += double(metrics.ssimV[j]) * count;
+                }
+                pixels += count;
+            }
+        }
+
+        if (pixels > 0.0)
+        {
+            mse /= pixels;
+            meanMSE /= pixels;
+            ssim /= pixels;
+            for (size_t j = 0; j < 4; ++j)
+            {
+                ssimV[j] /= pixels;
+            }
+        }
+
+        // PSNR uses the mean over the compared channels, with values normalized to [0,1]
+        const double psnr = (meanMSE > 0.0) ? 10.0 * log10(1.0 / meanMSE) : 999.99;
+
+        JobPrint(L"\n Quality: MSE %.6f, PSNR %.2f dB, SSIM %.4f (R %.4f G %.4f B %.4f A %.4f)\n",
+            mse, psnr, ssim, ssimV[0], ssimV[1], ssimV[2], ssimV[3]);
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Per-file stage timings for -timing
+    //--------------------------------------------------------------------------------------
+    class StageTimer
+    {
+    public:
+        StageTimer() noexcept : m_freq{}, m_last{}, m_count(0), m_stages{}
+        {
+            std::ignore = QueryPerformanceFrequency(&m_freq);
+            Reset();
+        }
+
+        void Reset() noexcept
+        {
+            m_count = 0;
+            std::ignore = QueryPerformanceCounter(&m_last);
+        }
+
+        // Charges the time since the previous mark to the named stage
+        void Mark(const wchar_t* name) noexcept
+        {
+            LARGE_INTEGER now = {};
+            std::ignore = QueryPerformanceCounter(&now);
+
+            if (m_count < std::size(m_stages))
+            {
+                m_stages[m_count].name = name;
+                m_stages[m_count].seconds = double(now.QuadPart - m_last.QuadPart) / double(m_freq.QuadPart);
+                ++m_count;
+            }
+
+            m_last = now;
+        }
+
+        void Print() const noexcept
+        {
+            JobPrint(L"  stages:");
+            for (size_t j = 0; j < m_count; ++j)
+            {
+                JobPrint(L" %ls %.3fs", m_stages[j].name, m_stages[j].seconds);
+            }
+
+            // Peak working set is a high-water mark for the whole process, not just this file
+            PROCESS_MEMORY_COUNTERS pmc = {};
+            if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+            {
+                JobPrint(L", peak RSS %.1f MB", double(pmc.PeakWorkingSetSize) / (1024.0 * 1024.0));
+            }
+            JobPrint(L"\n");
+        }
+
+    private:
+        struct Stage
+        {
+            const wchar_t*  name;
+            double          seconds;
+        };
+
+        LARGE_INTEGER   m_freq;
+        LARGE_INTEGER   m_last;
+        size_t          m_count;
+        Stage           m_stages[8];
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Generates mips, premultiplies alpha, and BC compresses one band of block rows at a
+    // time. Generated levels alternate between two buffers sized for mip levels 1 and 2, so
+    // only the source image, those two buffers, and the compressed result are resident.
+    //--------------------------------------------------------------------------------------
+    HRESULT CompressFused(
+        const ScratchImage& image,
+        bool generateMips,
+        TEX_FILTER_FLAGS filter,
+        bool premultiply,
+        TEX_PMALPHA_FLAGS pmflags,
+        TEX_COMPRESS_FLAGS compress,
+        float threshold,
+        ScratchImage& result)
+    {
+        const TexMetadata& mdata = result.GetMetadata();
+        const DXGI_FORMAT srcFormat = image.GetMetadata().format;
+
+        ScratchImage mipBuffers[2];
+        if (generateMips)
+        {
+            size_t width = mdata.width;
+            size_t height = mdata.height;
+            for (size_t j = 0; j < 2 && j + 1 < mdata.mipLevels; ++j)
+            {
+                width = std::max<size_t>(width >> 1, 1);
+                height = std::max<size_t>(height >> 1, 1);
+
+                HRESULT hr = mipBuffers[j].Initialize2D(srcFormat, width, height, 1, 1);
+                if (FAILED(hr))
+                    return hr;
+            }
+        }
+
+        for (size_t item = 0; item < mdata.arraySize; ++item)
+        {
+            Image levels[2] = {};
+            const Image* src = image.GetImage(0, item, 0);
+
+            for (size_t level = 0; level < mdata.mipLevels; ++level)
+            {
+                if (level > 0)
+                {
+                    if (generateMips)
+                    {
+                        // Each non-WIC level is filtered from the one above it, so this matches the full chain
+                        const Image* buffer = mipBuffers[(level - 1) & 1].GetImage(0, 0, 0);
+                        if (!src || !buffer)
+                            return E_POINTER;
+
+                        Image& next = levels[(level - 1) & 1];
+                        next.width = std::max<size_t>(src->width >> 1, 1);
+                        next.height = std::max<size_t>(src->height >> 1, 1);
+                        next.format = srcFormat;
+                        next.pixels = buffer->pixels;
+
+                        HRESULT hr = ComputePitch(srcFormat, next.width, next.height, next.rowPitch, next.slicePitch);
+                        if (FAILED(hr))
+                            return hr;
+
+                        hr = GenerateMipLevel(*src, filter, next);
+                        if (FAILED(hr))
+                            return hr;
+
+                        src = &next;
+                    }
+                    else
+                    {
+                        src = image.GetImage(level, item, 0);
+                    }
+                }
+
+                const Image* dest = result.GetImage(level, item, 0);
+                if (!src || !dest)
+                    return E_POINTER;
+
+                HRESULT hr = CompressStream(src->width, src->height, src->format,
+                    [&](size_t y, const Image& band) -> HRESULT
+                    {
+                        const size_t rowBytes = std::min(band.rowPitch, src->rowPitch);
+                        for (size_t row = 0; row < band.height; ++row)
+                        {
+                            memcpy(band.pixels + row * band.rowPitch, src->pixels + (y + row) * src->rowPitch, rowBytes);
+                        }
+
+                        return (premultiply) ? PremultiplyAlpha(band, pmflags) : S_OK;
+                    },
+                    mdata.format, compress, threshold,
+                    [&](size_t y, const Image& blocks) -> HRESULT
+                    {
+                        const size_t offset = (y / 4) * dest->rowPitch;
+                        if (blocks.rowPitch != dest->rowPitch || (offset + blocks.slicePitch) > dest->slicePitch)
+                            return E_UNEXPECTED;
+
+                        memcpy(dest->pixels + offset, blocks.pixels, blocks.slicePitch);
+                        return S_OK;
+                    });
+                if (FAILED(hr))
+                    return hr;
+            }
+        }
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Incremental cache key: SHA-256 of the effective options, the source extension (which
+    // picks the reader), and the source file contents, as 64 hex digits
+    //--------------------------------------------------------------------------------------
+    struct bcrypt_alg_closer { void operator()(BCRYPT_ALG_HANDLE h) noexcept { std::ignore = BCryptCloseAlgorithmProvider(h, 0); } };
+    struct bcrypt_hash_closer { void operator()(BCRYPT_HASH_HANDLE h) noexcept { std::ignore = BCryptDestroyHash(h); } };
+
+    // Bump when the layout of cache entries or the options string changes
+    constexpr unsigned int c_cacheFormatVersion = 2;
+
+    // Longest ".<pid>.<tid>.tmp" suffix appended to a cache entry while it is being written
+    constexpr size_t c_cacheTempSuffix = 26;
+
+    HRESULT ComputeCacheKey(const wchar_t* szFile, const std::wstring& options, wchar_t(&szKey)[65])
+    {
+        constexpr size_t c_readChunk = 1024 * 1024;
+
+        BCRYPT_ALG_HANDLE hAlg = nullptr;
+        NTSTATUS status = BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_SHA256_ALGORITHM, nullptr, 0);
+        if (!BCRYPT_SUCCESS(status))
+            return HRESULT_FROM_NT(status);
+
+        std::unique_ptr<void, bcrypt_alg_closer> alg(hAlg);
+
+        BCRYPT_HASH_HANDLE hHash = nullptr;
+        status = BCryptCreateHash(hAlg, &hHash, nullptr, 0, nullptr, 0, 0);
+        if (!BCRYPT_SUCCESS(status))
+            return HRESULT_FROM_NT(status);
+
+        std::unique_ptr<void, bcrypt_hash_closer> hash(hHash);
+
+        wchar_t ext[_MAX_EXT] = {};
+        _wsplitpath_s(szFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+        std::ignore = _wcslwr_s(ext);
+
+        std::wstring header = options;
+        header += L'|';
+        header += ext;
+        status = BCryptHashData(hHash, reinterpret_cast<PUCHAR>(header.data()), static_cast<ULONG>(header.size() * sizeof(wchar_t)), 0);
+        if (!BCRYPT_SUCCESS(status))
+            return HRESULT_FROM_NT(status);
+
+        std::ifstream inFile(szFile, std::ios::in | std::ios::binary);
+        if (!inFile)
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+        std::unique_ptr<char[]> buffer(new (std::nothrow) char[c_readChunk]);
+        if (!buffer)
+            return E_OUTOFMEMORY;
+
+        while (inFile)
+        {
+            inFile.read(buffer.get(), c_readChunk);
+
+            const auto bytes = static_cast<ULONG>(inFile.gcount());
+            if (bytes > 0)
+            {
+                status = BCryptHashData(hHash, reinterpret_cast<PUCHAR>(buffer.get()), bytes, 0);
+                if (!BCRYPT_SUCCESS(status))
+                    return HRESULT_FROM_NT(status);
+            }
+        }
+
+        if (inFile.bad())
+            return HRESULT_FROM_WIN32(ERROR_READ_FAULT);
+
+        uint8_t digest[32] = {};
+        status = BCryptFinishHash(hHash, digest, sizeof(digest), 0);
+        if (!BCRYPT_SUCCESS(status))
+            return HRESULT_FROM_NT(status);
+
+        for (size_t j = 0; j < sizeof(digest); ++j)
+        {
+            swprintf_s(&szKey[j * 2], 3, L"%02x", digest[j]);
+        }
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Rough peak working set for converting a file, used to schedule -j jobs. Assumes two
+    // live 128bpp copies of the full mip chain, which covers the float intermediates that
+    // most conversion stages use.
+    //--------------------------------------------------------------------------------------
+    uint64_t EstimateJobMemory(const wchar_t* szFile)
+    {
+        wchar_t ext[_MAX_EXT] = {};
+        _wsplitpath_s(szFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+
+        TexMetadata mdata = {};
+        HRESULT hr = E_FAIL;
+        if (_wcsicmp(ext, L".dds") == 0)
+        {
+            bool isXbox = false;
+            hr = Xbox::GetMetadataFromDDSFile(szFile, mdata, isXbox);
+        }
+        else if (_wcsicmp(ext, L".tga") == 0)
+        {
+            hr = GetMetadataFromTGAFile(szFile, TGA_FLAGS_NONE, mdata);
+        }
+        else if (_wcsicmp(ext, L".hdr") == 0)
+        {
+            hr = GetMetadataFromHDRFile(szFile, mdata);
+        }
+#ifdef USE_OPENEXR
+        else if (_wcsicmp(ext, L".exr") == 0)
+        {
+            hr = GetMetadataFromEXRFile(szFile, mdata);
+        }
+#endif
+        else if (_wcsicmp(ext, L".ppm") != 0 && _wcsicmp(ext, L".pfm") != 0)
+        {
+            hr = GetMetadataFromWICFile(szFile, WIC_FLAGS_NONE, mdata);
+        }
+
+        if (FAILED(hr))
+        {
+            // No cheap metadata reader, so fall back to the file size as a 4:1 compressed 128bpp image
+            WIN32_FILE_ATTRIBUTE_DATA data = {};
+            if (!GetFileAttributesExW(szFile, GetFileExInfoStandard, &data))
+                return 0;
+
+            const uint64_t fileSize = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            return fileSize * 4 * 2;
+        }
+
+        const uint64_t pixels = uint64_t(mdata.width) * uint64_t(mdata.height) * uint64_t(mdata.depth) * uint64_t(mdata.arraySize);
+        return (pixels * 16 * 2) * 4 / 3;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Runs conversion jobs on up to 'threads' threads. Jobs start in input order, and a job
+    // waits until its estimated memory fits in the budget alongside those already running
+    // (a job larger than the whole budget runs by itself). Output is written in input order.
+    //--------------------------------------------------------------------------------------
+    JOB_RESULT RunJobs(size_t count, const uint64_t* costs, size_t threads, uint64_t budget,
+        const std::function<JOB_RESULT(size_t index)>& job)
+    {
+        struct JobSlot
+        {
+            std::wstring    output;
+            JOB_RESULT      result;
+            bool            done;
+        };
+
+        std::unique_ptr<JobSlot[]> slots(new JobSlot[count]);
+        for (size_t index = 0; index < count; ++index)
+        {
+            slots[index].result = JOB_OK;
+            slots[index].done = false;
+        }
+
+        std::mutex lock;
+        std::condition_variable changed;
+        size_t next = 0;
+        uint64_t inFlight = 0;
+        bool stop = false;
+
+        auto worker = [&]()
+            {
+                for (;;)
+                {
+                    size_t index;
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        changed.wait(guard, [&]()
+                            {
+                                return stop || next >= count || !inFlight || (costs[next] <= budget - std::min(inFlight, budget));
+                            });
+
+                        if (stop || next >= count)
+                            return;
+
+                        index = next++;
+                        inFlight += costs[index];
+                    }
+
+                    JOB_RESULT result;
+                    t_jobOutput = &slots[index].output;
+                    try
+                    {
+                        result = job(index);
+                    }
+                    catch (...)
+                    {
+                        result = JOB_ABORT;
+                    }
+                    t_jobOutput = nullptr;
+
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        inFlight -= costs[index];
+                        slots[index].result = result;
+                        slots[index].done = true;
+                        if (result == JOB_ABORT)
+                            stop = true;
+                    }
+                    changed.notify_all();
+                }
+            };
+
+        std::vector<std::thread> pool;
+        try
+        {
+            pool.reserve(threads);
+            for (size_t j = 0; j < threads; ++j)
+            {
+                pool.emplace_back(worker);
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Run with however many threads started
+        }
+
+        // Joinable threads must never be destroyed, so anything thrown while collecting the results
+        // stops the workers and joins them before it propagates
+        auto stopAndJoin = [&]()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    stop = true;
+                }
+                changed.notify_all();
+
+                for (auto& t : pool)
+                {
+                    if (t.joinable())
+                        t.join();
+                }
+            };
+
+        JOB_RESULT overall = JOB_OK;
+        try
+        {
+            if (pool.empty())
+            {
+                worker();
+            }
+
+            for (size_t index = 0; index < count; ++index)
+            {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    changed.wait(guard, [&]() { return slots[index].done || (stop && index >= next); });
+                }
+
+                if (!slots[index].done)
+                    break;
+
+                wprintf(L"%ls", slots[index].output.c_str());
+                fflush(stdout);
+                slots[index].output.clear();
+
+                if (slots[index].result == JOB_ABORT)
+                {
+                    overall = JOB_ABORT;
+                    break;
+                }
+                else if (slots[index].result == JOB_FAILED)
+                {
+                    overall = JOB_FAILED;
+                }
+            }
+        }
+        catch (...)
+        {
+            stopAndJoin();
+            throw;
+        }
+
+        for (auto& t : pool)
+        {
+            t.join();
+        }
+
+        return overall;
+    }
 }
 
 //--------------------------------------------------------------------------------------
@@ -1379,6 +2293,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     float wicQuality = -1.f;
     uint32_t colorKey = 0;
     uint32_t dwRotateColor = 0;
+    uint32_t dwBenchmark = 0;
+    size_t jobs = 1;
+    size_t jobMemory = 0;
+    uint32_t xgMode = 0;
     float paperWhiteNits = 200.f;
     float preserveAlphaCoverageRef = 0.0f;
     bool keepRecursiveDirs = false;
@@ -1389,16 +2307,19 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     wchar_t szPrefix[MAX_PATH] = {};
     wchar_t szSuffix[MAX_PATH] = {};
     wchar_t szOutputDir[MAX_PATH] = {};
+    wchar_t szCacheDir[MAX_PATH] = {};
 
     // Set locale for output since GetErrorDesc can get localized strings.
     std::locale::global(std::locale(""));
 
     // Initialize COM (needed for WIC)
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-    if (FAILED(hr))
     {
-        wprintf(L"Failed to initialize COM (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-        return 1;
+        HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        if (FAILED(hr))
+        {
+            wprintf(L"Failed to initialize COM (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+            return 1;
+        }
     }
 
     // Process command line
@@ -1456,6 +2377,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_PRESERVE_ALPHA_COVERAGE:
             case OPT_SWIZZLE:
             case OPT_XGMODE:
+            case OPT_BENCHMARK:
+            case OPT_JOBS:
+            case OPT_JOB_MEMORY:
+            case OPT_CACHE:
                 // These support either "-arg:value" or "-arg value"
                 if (!*pValue)
                 {
@@ -1786,6 +2711,12 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     found = true;
                 }
 
+                if (wcschr(pValue, L'h'))
+                {
+                    dwCompress |= TEX_COMPRESS_BC6H_QUICK;
+                    found = true;
+                }
+
                 if ((dwCompress & (TEX_COMPRESS_BC7_QUICK | TEX_COMPRESS_BC7_USE_3SUBSETS)) == (TEX_COMPRESS_BC7_QUICK | TEX_COMPRESS_BC7_USE_3SUBSETS))
                 {
                     wprintf(L"Can't use -bc x (max) and -bc q (quick) at same time\n\n");
@@ -1793,9 +2724,30 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     return 1;
                 }
 
+                const wchar_t* pLevel = wcspbrk(pValue, L"0123456789");
+                if (pLevel)
+                {
+                    const size_t level = static_cast<size_t>(*pLevel - L'0');
+                    if (level >= std::size(g_BC7QualityLevels) || wcspbrk(pLevel + 1, L"0123456789"))
+                    {
+                        wprintf(L"Invalid BC7 quality level specified for -bc (%ls), must be a single digit 0-%zu\n\n", pValue, std::size(g_BC7QualityLevels) - 1);
+                        return 1;
+                    }
+
+                    if (dwCompress & TEX_COMPRESS_BC7_QUICK)
+                    {
+                        wprintf(L"Can't use -bc q (quick) and a BC7 quality level at same time\n\n");
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    dwCompress |= g_BC7QualityLevels[level];
+                    found = true;
+                }
+
                 if (!found)
                 {
-                    wprintf(L"Invalid value specified for -bc (%ls), missing d, u, q, or x\n\n", pValue);
+                    wprintf(L"Invalid value specified for -bc (%ls), missing d, u, q, x, h, or 0-%zu\n\n", pValue, std::size(g_BC7QualityLevels) - 1);
                     return 1;
                 }
             }
@@ -1949,8 +2901,44 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 };
 
                 XGSetHardwareVersion(static_cast<XG_HARDWARE_VERSION>(mode));
+                xgMode = mode;
                 break;
             }
+
+            case OPT_BENCHMARK:
+                dwBenchmark = LookupByName(pValue, g_pBenchmarks);
+                if (!dwBenchmark)
+                {
+                    wprintf(L"Invalid value specified with -benchmark (%ls)\n", pValue);
+                    wprintf(L"\n");
+                    PrintUsage();
+                    return 1;
+                }
+                break;
+
+            case OPT_JOBS:
+                if (swscanf_s(pValue, L"%zu", &jobs) != 1 || !jobs)
+                {
+                    wprintf(L"Invalid value specified with -j (%ls)\n", pValue);
+                    wprintf(L"\n");
+                    PrintUsage();
+                    return 1;
+                }
+                break;
+
+            case OPT_JOB_MEMORY:
+                if (swscanf_s(pValue, L"%zu", &jobMemory) != 1 || !jobMemory)
+                {
+                    wprintf(L"Invalid value specified with -jmem (%ls)\n", pValue);
+                    wprintf(L"\n");
+                    PrintUsage();
+                    return 1;
+                }
+                break;
+
+            case OPT_CACHE:
+                wcscpy_s(szCacheDir, MAX_PATH, pValue);
+                break;
             }
         }
         else if (wcspbrk(pArg, L"?*") != nullptr)
@@ -1997,34 +2985,224 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         wcscat_s(szSuffix, MAX_PATH, L".unknown");
     }
 
-    if (FileType != CODEC_DDS)
-    {
-        mipLevels = 1;
-    }
+    if (FileType != CODEC_DDS)
+    {
+        mipLevels = 1;
+    }
+
+    // Everything that can change the output contents goes into the cache key
+    std::wstring cacheOptions;
+    if (*szCacheDir)
+    {
+        if (L'\\' != szCacheDir[wcslen(szCacheDir) - 1])
+            wcscat_s(szCacheDir, MAX_PATH, L"\\");
+
+        wchar_t szPath[MAX_PATH] = {};
+        if (!GetFullPathNameW(szCacheDir, MAX_PATH, szPath, nullptr))
+        {
+            wprintf(L"ERROR: Invalid cache directory (%ls)\n", szCacheDir);
+            return 1;
+        }
+
+        auto err = static_cast<DWORD>(SHCreateDirectoryExW(nullptr, szPath, nullptr));
+        if (err != ERROR_SUCCESS && err != ERROR_ALREADY_EXISTS)
+        {
+            wprintf(L"ERROR: Cache directory creation FAILED (%08X%ls)\n",
+                static_cast<unsigned int>(HRESULT_FROM_WIN32(err)), GetErrorDesc(HRESULT_FROM_WIN32(err)));
+            return 1;
+        }
+
+        const uint64_t outputOptions = dwOptions & ~(
+            (uint64_t(1) << OPT_RECURSIVE) | (uint64_t(1) << OPT_FILELIST) | (uint64_t(1) << OPT_PREFIX)
+            | (uint64_t(1) << OPT_SUFFIX) | (uint64_t(1) << OPT_OUTPUTDIR) | (uint64_t(1) << OPT_TOLOWER)
+            | (uint64_t(1) << OPT_OVERWRITE) | (uint64_t(1) << OPT_NOLOGO) | (uint64_t(1) << OPT_TIMING)
+            | (uint64_t(1) << OPT_FORCE_SINGLEPROC) | (uint64_t(1) << OPT_BENCHMARK) | (uint64_t(1) << OPT_JOBS)
+            | (uint64_t(1) << OPT_JOB_MEMORY) | (uint64_t(1) << OPT_CACHE));
+
+        // DirectXTex is linked statically, so a hash of the executable image changes with any codec or
+        // filter change. The format version covers changes to how entries are keyed or stored.
+        wchar_t szImage[MAX_PATH] = {};
+        const DWORD imageLen = GetModuleFileNameW(nullptr, szImage, MAX_PATH);
+        if (!imageLen || imageLen >= MAX_PATH)
+        {
+            wprintf(L"ERROR: Failed to locate the executable for the cache key\n");
+            return 1;
+        }
+
+        wchar_t szImageKey[65] = {};
+        HRESULT hr = ComputeCacheKey(szImage, std::wstring(), szImageKey);
+        if (FAILED(hr))
+        {
+            wprintf(L"ERROR: Failed to hash the executable for the cache key (%08X%ls)\n",
+                static_cast<unsigned int>(hr), GetErrorDesc(hr));
+            return 1;
+        }
+
+        wchar_t buff[1024] = {};
+        swprintf_s(buff,
+            L"xtexconv %u %d %ls|%zu %zu %zu %d|%08X %08X %08X %08X %08X|%u %u %d|%a %a %08X %a %a|%08X %u %a %a|%u%u%u%u %u%u%u%u %u%u%u%u|%016llX %u",
+            c_cacheFormatVersion, DIRECTX_TEX_VERSION, szImageKey,
+            width, height, mipLevels, static_cast<int>(format),
+            static_cast<unsigned int>(dwFilter), static_cast<unsigned int>(dwSRGB), static_cast<unsigned int>(dwConvert),
+            static_cast<unsigned int>(dwCompress), static_cast<unsigned int>(dwFilterOpts),
+            FileType, maxSize, adapter,
+            double(alphaThreshold), double(alphaWeight), static_cast<unsigned int>(dwNormalMap), double(nmapAmplitude), double(wicQuality),
+            colorKey, dwRotateColor, double(paperWhiteNits), double(preserveAlphaCoverageRef),
+            swizzleElements[0], swizzleElements[1], swizzleElements[2], swizzleElements[3],
+            zeroElements[0], zeroElements[1], zeroElements[2], zeroElements[3],
+            oneElements[0], oneElements[1], oneElements[2], oneElements[3],
+            outputOptions, xgMode);
+        cacheOptions = buff;
+    }
+
+    LARGE_INTEGER qpcFreq = {};
+    std::ignore = QueryPerformanceFrequency(&qpcFreq);
+
+    LARGE_INTEGER qpcStart = {};
+    std::ignore = QueryPerformanceCounter(&qpcStart);
+
+    // Convert images
+    std::atomic<bool> sizewarn(false);
+    std::atomic<bool> nonpow2warn(false);
+    std::atomic<bool> non4bc(false);
+    ComPtr<ID3D11Device> pDevice;
+    std::mutex gpuLock;
+
+    // Builds the output filename for a source file, creating the output folder if needed
+    auto makeDestName = [&](const SConversion* pConv, wchar_t(&szDest)[1024]) -> bool
+    {
+        const wchar_t* pchSlash;
+        wchar_t* pchDot;
+
+        wcscpy_s(szDest, szOutputDir);
+
+        if (keepRecursiveDirs && *pConv->szFolder)
+        {
+            wcscat_s(szDest, pConv->szFolder);
+
+            wchar_t szPath[MAX_PATH] = {};
+            if (!GetFullPathNameW(szDest, MAX_PATH, szPath, nullptr))
+            {
+                JobPrint(L" get full path FAILED (%08X%ls)\n",
+                    static_cast<unsigned int>(HRESULT_FROM_WIN32(GetLastError())), GetErrorDesc(HRESULT_FROM_WIN32(GetLastError())));
+                return false;
+            }
+
+            auto err = static_cast<DWORD>(SHCreateDirectoryExW(nullptr, szPath, nullptr));
+            if (err != ERROR_SUCCESS && err != ERROR_ALREADY_EXISTS)
+            {
+                JobPrint(L" directory creation FAILED (%08X%ls)\n",
+                    static_cast<unsigned int>(HRESULT_FROM_WIN32(err)), GetErrorDesc(HRESULT_FROM_WIN32(err)));
+                return false;
+            }
+        }
+
+        if (*szPrefix)
+            wcscat_s(szDest, szPrefix);
+
+        pchSlash = wcsrchr(pConv->szSrc, L'\\');
+        if (pchSlash)
+            wcscat_s(szDest, pchSlash + 1);
+        else
+            wcscat_s(szDest, pConv->szSrc);
+
+        pchSlash = wcsrchr(szDest, '\\');
+        pchDot = wcsrchr(szDest, '.');
+
+        if (pchDot > pchSlash)
+            *pchDot = 0;
+
+        if (*szSuffix)
+            wcscat_s(szDest, szSuffix);
+
+        if (dwOptions & (uint64_t(1) << OPT_TOLOWER))
+        {
+            std::ignore = _wcslwr_s(szDest);
+        }
+
+        if (wcslen(szDest) > _MAX_PATH)
+        {
+            JobPrint(L"\nERROR: Output filename exceeds max-path, skipping!\n");
+            return false;
+        }
+
+        return true;
+    };
+
+    std::atomic<size_t> cacheHits(0);
+    std::atomic<size_t> cacheMisses(0);
+
+    auto convertFile = [&](const SConversion* pConv, bool first) -> JOB_RESULT
+    {
+        if (!first)
+            JobPrint(L"\n");
+
+        HRESULT hr = S_OK;
+        bool preserveAlphaCoverage = false;
+        StageTimer timer;
+
+        // --- Load source image -------------------------------------------------------
+        JobPrint(L"reading %ls", pConv->szSrc);
+        fflush(stdout);
+
+        // --- Incremental cache -------------------------------------------------------
+        wchar_t szCached[1024] = {};
+        if (*szCacheDir)
+        {
+            wchar_t szKey[65] = {};
+            hr = ComputeCacheKey(pConv->szSrc, cacheOptions, szKey);
+            if (FAILED(hr))
+            {
+                JobPrint(L" FAILED [cache key] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+
+            // Leave room for the ".<pid>.<tid>.tmp" suffix used when publishing to the cache
+            const wchar_t* cacheExt = fileTypeName ? fileTypeName : L"unknown";
+            if (wcslen(szCacheDir) + wcslen(szKey) + wcslen(cacheExt) + 1 + c_cacheTempSuffix >= std::size(szCached))
+            {
+                hr = HRESULT_FROM_WIN32(ERROR_FILENAME_EXCED_RANGE);
+                JobPrint(L" FAILED [cache path] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+
+            swprintf_s(szCached, L"%ls%ls.%ls", szCacheDir, szKey, cacheExt);
 
-    LARGE_INTEGER qpcFreq = {};
-    std::ignore = QueryPerformanceFrequency(&qpcFreq);
+            if (GetFileAttributesW(szCached) != INVALID_FILE_ATTRIBUTES)
+            {
+                ++cacheHits;
 
-    LARGE_INTEGER qpcStart = {};
-    std::ignore = QueryPerformanceCounter(&qpcStart);
+                JobPrint(L" (cached)\n");
 
-    // Convert images
-    bool sizewarn = false;
-    bool nonpow2warn = false;
-    bool non4bc = false;
-    bool preserveAlphaCoverage = false;
-    ComPtr<ID3D11Device> pDevice;
+                wchar_t szDest[1024] = {};
+                if (!makeDestName(pConv, szDest))
+                    return JOB_FAILED;
 
-    int retVal = 0;
+                JobPrint(L"writing %ls", szDest);
+                fflush(stdout);
 
-    for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv)
-    {
-        if (pConv != conversion.begin())
-            wprintf(L"\n");
+                if (~dwOptions & (uint64_t(1) << OPT_OVERWRITE))
+                {
+                    if (GetFileAttributesW(szDest) != INVALID_FILE_ATTRIBUTES)
+                    {
+                        JobPrint(L"\nERROR: Output file already exists, use -y to overwrite:\n");
+                        return JOB_FAILED;
+                    }
+                }
 
-        // --- Load source image -------------------------------------------------------
-        wprintf(L"reading %ls", pConv->szSrc);
-        fflush(stdout);
+                if (!CopyFileW(szCached, szDest, FALSE))
+                {
+                    hr = HRESULT_FROM_WIN32(GetLastError());
+                    JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_FAILED;
+                }
+
+                JobPrint(L"\n");
+                return JOB_OK;
+            }
+
+            ++cacheMisses;
+        }
 
         wchar_t ext[_MAX_EXT] = {};
         wchar_t fname[_MAX_FNAME] = {};
@@ -2035,8 +3213,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
         if (!image)
         {
-            wprintf(L"\nERROR: Memory allocation failed\n");
-            return 1;
+            JobPrint(L"\nERROR: Memory allocation failed\n");
+            return JOB_ABORT;
         }
 
         bool isXbox = false;
@@ -2045,9 +3223,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = Xbox::GetMetadataFromDDSFile(pConv->szSrc, info, isXbox);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
 
             if (isXbox)
@@ -2074,9 +3251,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
 
             if (IsTypeless(info.format))
@@ -2092,9 +3268,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                 if (IsTypeless(info.format))
                 {
-                    wprintf(L" FAILED due to Typeless format %d\n", info.format);
-                    retVal = 1;
-                    continue;
+                    JobPrint(L" FAILED due to Typeless format %d\n", info.format);
+                    return JOB_FAILED;
                 }
 
                 image->OverrideFormat(info.format);
@@ -2105,29 +3280,38 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromBMPEx(pConv->szSrc, WIC_FLAGS_NONE | dwFilter, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
         else if (_wcsicmp(ext, L".tga") == 0)
         {
-            hr = LoadFromTGAFile(pConv->szSrc, TGA_FLAGS_NONE, &info, *image);
+            TGA_FLAGS tgaFlags = TGA_FLAGS_NONE;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                tgaFlags |= TGA_FLAGS_PARALLEL;
+            }
+
+            hr = LoadFromTGAFile(pConv->szSrc, tgaFlags, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
         else if (_wcsicmp(ext, L".hdr") == 0)
         {
-            hr = LoadFromHDRFile(pConv->szSrc, &info, *image);
+            HDR_FLAGS hdrFlags = HDR_FLAGS_NONE;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                hdrFlags |= HDR_FLAGS_PARALLEL;
+            }
+
+            hr = LoadFromHDRFile(pConv->szSrc, hdrFlags, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
         else if (_wcsicmp(ext, L".ppm") == 0)
@@ -2135,9 +3319,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromPortablePixMap(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
         else if (_wcsicmp(ext, L".pfm") == 0)
@@ -2145,9 +3328,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromPortablePixMapHDR(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
 #ifdef USE_OPENEXR
@@ -2156,9 +3338,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromEXRFile(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
 #endif
@@ -2179,18 +3360,19 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromWICFile(pConv->szSrc, wicFlags, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
         }
 
         PrintInfo(info, isXbox);
 
+        timer.Mark(L"load");
+
         size_t tMips = (!mipLevels && info.mipLevels > 1) ? info.mipLevels : mipLevels;
 
         // Convert texture
-        wprintf(L" as");
+        JobPrint(L" as");
         fflush(stdout);
 
         // --- Planar ------------------------------------------------------------------
@@ -2203,17 +3385,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             hr = ConvertToSinglePlane(img, nimg, info, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [converttosingleplane] (%08X%ls)\n",
+                JobPrint(L" FAILED [converttosingleplane] (%08X%ls)\n",
                     static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                return JOB_FAILED;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2245,8 +3426,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                     if (!timage)
                     {
-                        wprintf(L"\nERROR: Memory allocation failed\n");
-                        return 1;
+                        JobPrint(L"\nERROR: Memory allocation failed\n");
+                        return JOB_ABORT;
                     }
 
                     // If we started with < 4x4 then no need to generate mips
@@ -2263,9 +3444,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     hr = timage->Initialize(mdata);
                     if (FAILED(hr))
                     {
-                        wprintf(L" FAILED [BC non-multiple-of-4 fixup] (%08X%ls)\n",
+                        JobPrint(L" FAILED [BC non-multiple-of-4 fixup] (%08X%ls)\n",
                             static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                        return 1;
+                        return JOB_ABORT;
                     }
 
                     if (mdata.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -2307,16 +3488,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             hr = Decompress(img, nimg, info, DXGI_FORMAT_UNKNOWN /* picks good default */, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [decompress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED [decompress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2350,11 +3530,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         {
             if (info.GetAlphaMode() == TEX_ALPHA_MODE_STRAIGHT)
             {
-                printf("\nWARNING: Image is already using straight alpha\n");
+                JobPrint(L"\nWARNING: Image is already using straight alpha\n");
             }
             else if (!info.IsPMAlpha())
             {
-                printf("\nWARNING: Image is not using premultipled alpha\n");
+                JobPrint(L"\nWARNING: Image is not using premultipled alpha\n");
             }
             else
             {
@@ -2365,17 +3545,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    JobPrint(L"\nERROR: Memory allocation failed\n");
+                    return JOB_ABORT;
                 }
 
                 hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_REVERSE | dwSRGB, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [demultiply alpha] (%08X%ls)\n",
+                    JobPrint(L" FAILED [demultiply alpha] (%08X%ls)\n",
                         static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    retVal = 1;
-                    continue;
+                    return JOB_FAILED;
                 }
 
                 auto& tinfo = timage->GetMetadata();
@@ -2400,8 +3579,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             TEX_FR_FLAGS dwFlags = TEX_FR_ROTATE0;
@@ -2417,8 +3596,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = FlipRotate(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwFlags, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [fliprotate] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [fliprotate] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2466,15 +3645,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
+            }
+
+            TEX_FILTER_FLAGS resizeFilterOpts = dwFilterOpts;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                resizeFilterOpts |= TEX_FILTER_PARALLEL;
             }
 
-            hr = Resize(image->GetImages(), image->GetImageCount(), image->GetMetadata(), twidth, theight, dwFilter | dwFilterOpts, *timage);
+            hr = Resize(image->GetImages(), image->GetImageCount(), image->GetMetadata(), twidth, theight, dwFilter | resizeFilterOpts, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [resize] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [resize] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2514,8 +3699,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             XMVECTOR zc = XMVectorSelectControl(zeroElements[0], zeroElements[1], zeroElements[2], zeroElements[3]);
@@ -2536,8 +3721,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [swizzle] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [swizzle] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
 #ifndef NDEBUG
@@ -2565,16 +3750,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    JobPrint(L"\nERROR: Memory allocation failed\n");
+                    return JOB_ABORT;
                 }
 
                 hr = Convert(image->GetImages(), image->GetImageCount(), image->GetMetadata(), DXGI_FORMAT_R16G16B16A16_FLOAT,
                     dwFilter | dwFilterOpts | dwSRGB | dwConvert, alphaThreshold, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    return 1;
+                    JobPrint(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_ABORT;
                 }
 
 #ifndef NDEBUG
@@ -2599,8 +3784,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             switch (dwRotateColor)
@@ -2805,9 +3990,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [rotate color apply] (%08X%ls)\n",
+                JobPrint(L" FAILED [rotate color apply] (%08X%ls)\n",
                     static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                return JOB_ABORT;
             }
 
 #ifndef NDEBUG
@@ -2833,8 +4018,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             // Compute max luminosity across all images
@@ -2857,8 +4042,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 });
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [tonemap maxlum] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [tonemap maxlum] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             // Reinhard et al, "Photographic Tone Reproduction for Digital Images"
@@ -2886,8 +4071,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [tonemap apply] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [tonemap apply] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
 #ifndef NDEBUG
@@ -2913,8 +4098,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             DXGI_FORMAT nmfmt = tformat;
@@ -2941,8 +4126,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = ComputeNormalMap(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwNormalMap, nmapAmplitude, nmfmt, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [normalmap] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [normalmap] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2966,16 +4151,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             hr = Convert(image->GetImages(), image->GetImageCount(), image->GetMetadata(), tformat,
                 dwFilter | dwFilterOpts | dwSRGB | dwConvert, alphaThreshold, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -3002,8 +4187,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             XMVECTOR colorKeyValue = XMLoadColor(reinterpret_cast<const XMCOLOR*>(&colorKey));
@@ -3033,8 +4218,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [colorkey] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [colorkey] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
 #ifndef NDEBUG
@@ -3060,8 +4245,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
@@ -3082,8 +4267,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [inverty] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [inverty] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
 #ifndef NDEBUG
@@ -3109,8 +4294,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             bool isunorm = (FormatDataType(info.format) == FORMAT_TYPE_UNORM) != 0;
@@ -3143,8 +4328,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [reconstructz] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [reconstructz] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
 #ifndef NDEBUG
@@ -3164,14 +4349,71 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             cimage.reset();
         }
 
+        timer.Mark(L"process");
+
         // --- Determine whether preserve alpha coverage is required (if requested) ----
         if (preserveAlphaCoverageRef > 0.0f && HasAlpha(info.format) && !image->IsAlphaAllOpaque())
         {
             preserveAlphaCoverage = true;
         }
 
+        // --- Determine whether mips, premultiply, and compress can be fused ----------
+        // Benchmark runs always take the separate stages so each one can be timed and measured
+        bool fused = false;
+        bool fusedMips = false;
+        size_t fusedLevels = info.mipLevels;
+        TEX_FILTER_FLAGS fusedFilter = TEX_FILTER_DEFAULT;
+        if ((dwOptions & (uint64_t(1) << OPT_FUSED))
+            && IsCompressed(tformat)
+            && !IsTypeless(tformat)
+            && (FileType == CODEC_DDS)
+            && !(cimage && (cimage->GetMetadata().format == tformat))
+            && (info.dimension != TEX_DIMENSION_TEXTURE3D)
+            && !preserveAlphaCoverage
+            && !dwBenchmark)
+        {
+            fused = true;
+
+            if ((!tMips || info.mipLevels != tMips) && (info.width > 1 || info.height > 1))
+            {
+                size_t maxLevels = 1;
+                for (size_t w = info.width, h = info.height; w > 1 || h > 1; w = std::max<size_t>(w >> 1, 1), h = std::max<size_t>(h >> 1, 1))
+                {
+                    ++maxLevels;
+                }
+
+                // Resolve the default filter up front, since the library picks it per call from the source size
+                unsigned long mode = dwFilter & TEX_FILTER_MODE_MASK;
+                if (!mode)
+                {
+                    mode = (ispow2(info.width) && ispow2(info.height)) ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
+                }
+
+                fusedMips = true;
+                fusedLevels = (tMips) ? tMips : maxLevels;
+                fusedFilter = static_cast<TEX_FILTER_FLAGS>((dwFilter & ~TEX_FILTER_MODE_MASK) | mode)
+                    | dwFilterOpts | TEX_FILTER_FORCE_NON_WIC;
+                if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+                {
+                    fusedFilter |= TEX_FILTER_PARALLEL;
+                }
+
+                // The triangle filter reads the whole chain, and invalid counts are reported by the regular path
+                if (mode == TEX_FILTER_TRIANGLE || fusedLevels > maxLevels)
+                {
+                    fused = false;
+                }
+            }
+        }
+
         // --- Generate mips -----------------------------------------------------------
         TEX_FILTER_FLAGS dwFilter3D = dwFilter;
+        if ((dwFilter & TEX_FILTER_MODE_MASK) == TEX_FILTER_LANCZOS || (dwFilter & TEX_FILTER_MODE_MASK) == TEX_FILTER_MITCHELL)
+        {
+            // Volume mipmap generation does not implement the separable windowed filters
+            dwFilter3D = static_cast<TEX_FILTER_FLAGS>(dwFilter & ~TEX_FILTER_MODE_MASK);
+        }
+
         if (!ispow2(info.width) || !ispow2(info.height) || !ispow2(info.depth))
         {
             if (!tMips || info.mipLevels != 1)
@@ -3186,7 +4428,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
         }
 
-        if ((!tMips || info.mipLevels != tMips || preserveAlphaCoverage) && (info.mipLevels != 1))
+        if (!fused && (!tMips || info.mipLevels != tMips || preserveAlphaCoverage) && (info.mipLevels != 1))
         {
             // Mips generation only works on a single base image, so strip off existing mip levels
             // Also required for preserve alpha coverage so that existing mips are regenerated
@@ -3194,8 +4436,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             TexMetadata mdata = info;
@@ -3203,9 +4445,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = timage->Initialize(mdata);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [copy to single level] (%08X%ls)\n",
+                JobPrint(L" FAILED [copy to single level] (%08X%ls)\n",
                     static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                return JOB_ABORT;
             }
 
             if (info.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -3216,9 +4458,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                         *timage->GetImage(0, 0, d), TEX_FILTER_DEFAULT, 0, 0);
                     if (FAILED(hr))
                     {
-                        wprintf(L" FAILED [copy to single level] (%08X%ls)\n",
+                        JobPrint(L" FAILED [copy to single level] (%08X%ls)\n",
                             static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                        return 1;
+                        return JOB_ABORT;
                     }
                 }
             }
@@ -3230,8 +4472,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                         *timage->GetImage(0, i, 0), TEX_FILTER_DEFAULT, 0, 0);
                     if (FAILED(hr))
                     {
-                        wprintf(L" FAILED [copy to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                        return 1;
+                        JobPrint(L" FAILED [copy to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                        return JOB_ABORT;
                     }
                 }
             }
@@ -3247,8 +4489,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 hr = timage->Initialize(mdata);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [copy compressed to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    return 1;
+                    JobPrint(L" FAILED [copy compressed to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_ABORT;
                 }
 
                 if (mdata.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -3280,27 +4522,43 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
         }
 
-        if ((!tMips || info.mipLevels != tMips) && (info.width > 1 || info.height > 1 || info.depth > 1))
+        if (!fused && (!tMips || info.mipLevels != tMips) && (info.width > 1 || info.height > 1 || info.depth > 1))
         {
+            TEX_FILTER_FLAGS mipFilterOpts = dwFilterOpts;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                mipFilterOpts |= TEX_FILTER_PARALLEL;
+            }
+
+            if (dwBenchmark & BENCHMARK_MIPS)
+            {
+                hr = BenchmarkMips(*image, ((info.dimension == TEX_DIMENSION_TEXTURE3D) ? dwFilter3D : dwFilter) | dwFilterOpts);
+                if (FAILED(hr))
+                {
+                    JobPrint(L" FAILED [benchmark] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_FAILED;
+                }
+            }
+
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             if (info.dimension == TEX_DIMENSION_TEXTURE3D)
             {
-                hr = GenerateMipMaps3D(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwFilter3D | dwFilterOpts, tMips, *timage);
+                hr = GenerateMipMaps3D(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwFilter3D | mipFilterOpts, tMips, *timage);
             }
             else
             {
-                hr = GenerateMipMaps(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwFilter | dwFilterOpts, tMips, *timage);
+                hr = GenerateMipMaps(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwFilter | mipFilterOpts, tMips, *timage);
             }
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [mipmaps] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [mipmaps] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -3324,15 +4582,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
             }
 
             hr = timage->Initialize(image->GetMetadata());
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                JobPrint(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_ABORT;
             }
 
             const size_t items = image->GetMetadata().arraySize;
@@ -3344,8 +4602,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 hr = ScaleMipMapsAlphaForCoverage(img, info.mipLevels, info, item, preserveAlphaCoverageRef, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    return 1;
+                    JobPrint(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_ABORT;
                 }
             }
 
@@ -3365,14 +4623,17 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             cimage.reset();
         }
 
+        timer.Mark(L"mips");
+
         // --- Premultiplied alpha (if requested) --------------------------------------
-        if ((dwOptions & (uint64_t(1) << OPT_PREMUL_ALPHA))
+        if (!fused
+            && (dwOptions & (uint64_t(1) << OPT_PREMUL_ALPHA))
             && HasAlpha(info.format)
             && info.format != DXGI_FORMAT_A8_UNORM)
         {
             if (info.IsPMAlpha())
             {
-                printf("\nWARNING: Image is already using premultiplied alpha\n");
+                JobPrint(L"\nWARNING: Image is already using premultiplied alpha\n");
             }
             else
             {
@@ -3383,16 +4644,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    JobPrint(L"\nERROR: Memory allocation failed\n");
+                    return JOB_ABORT;
                 }
 
                 hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_DEFAULT | dwSRGB, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [premultiply alpha] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    retVal = 1;
-                    continue;
+                    JobPrint(L" FAILED [premultiply alpha] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_FAILED;
                 }
 
                 auto& tinfo = timage->GetMetadata();
@@ -3411,8 +4671,126 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
         }
 
+        timer.Mark(L"premultiply");
+
+        // --- Benchmark (if requested) ------------------------------------------------
+        if (dwBenchmark & BENCHMARK_BC7)
+        {
+            TEX_COMPRESS_FLAGS cflags = dwCompress;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                cflags |= TEX_COMPRESS_PARALLEL;
+            }
+
+            const DXGI_FORMAT bformat = IsSRGB(tformat) ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+
+            hr = BenchmarkBC7(*image, bformat, cflags | dwSRGB, alphaThreshold);
+            if (FAILED(hr))
+            {
+                JobPrint(L" FAILED [benchmark] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+        }
+
+        if (dwBenchmark & BENCHMARK_BC6H)
+        {
+            TEX_COMPRESS_FLAGS cflags = dwCompress;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                cflags |= TEX_COMPRESS_PARALLEL;
+            }
+
+            const DXGI_FORMAT bformat = (tformat == DXGI_FORMAT_BC6H_SF16) ? DXGI_FORMAT_BC6H_SF16 : DXGI_FORMAT_BC6H_UF16;
+
+            hr = BenchmarkBC6H(*image, bformat, cflags);
+            if (FAILED(hr))
+            {
+                JobPrint(L" FAILED [benchmark] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+        }
+
+        if (dwBenchmark & BENCHMARK_CONVERT)
+        {
+            hr = BenchmarkConvert(*image, dwFilterOpts | dwSRGB);
+            if (FAILED(hr))
+            {
+                JobPrint(L" FAILED [benchmark] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+        }
+
+        if (dwBenchmark)
+        {
+            timer.Mark(L"benchmark");
+        }
+
         // --- Compress ----------------------------------------------------------------
-        if (IsCompressed(tformat) && (FileType == CODEC_DDS))
+        const CMSE_FLAGS qflags = (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? CMSE_DEFAULT : CMSE_PARALLEL;
+
+        if (fused)
+        {
+            cimage.reset();
+
+            bool premultiply = false;
+            if ((dwOptions & (uint64_t(1) << OPT_PREMUL_ALPHA))
+                && HasAlpha(info.format)
+                && info.format != DXGI_FORMAT_A8_UNORM)
+            {
+                if (info.IsPMAlpha())
+                {
+                    JobPrint(L"\nWARNING: Image is already using premultiplied alpha\n");
+                }
+                else
+                {
+                    premultiply = true;
+                }
+            }
+
+            TEX_COMPRESS_FLAGS cflags = dwCompress;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                cflags |= TEX_COMPRESS_PARALLEL;
+            }
+
+            if ((info.width % 4) != 0 || (info.height % 4) != 0)
+            {
+                non4bc = true;
+            }
+
+            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
+            if (!timage)
+            {
+                JobPrint(L"\nERROR: Memory allocation failed\n");
+                return JOB_ABORT;
+            }
+
+            TexMetadata mdata = info;
+            mdata.format = tformat;
+            mdata.mipLevels = fusedLevels;
+
+            hr = timage->Initialize(mdata);
+            if (SUCCEEDED(hr))
+            {
+                hr = CompressFused(*image, fusedMips, fusedFilter, premultiply, TEX_PMALPHA_DEFAULT | dwSRGB,
+                    cflags | dwSRGB, alphaThreshold, *timage);
+            }
+            if (FAILED(hr))
+            {
+                JobPrint(L" FAILED [fused compress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+
+            info.format = tformat;
+            info.mipLevels = fusedLevels;
+            if (premultiply)
+            {
+                info.SetAlphaMode(TEX_ALPHA_MODE_PREMULTIPLIED);
+            }
+
+            image.swap(timage);
+        }
+        else if (IsCompressed(tformat) && (FileType == CODEC_DDS))
         {
             if (cimage && (cimage->GetMetadata().format == tformat))
             {
@@ -3446,8 +4824,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    JobPrint(L"\nERROR: Memory allocation failed\n");
+                    return JOB_ABORT;
                 }
 
                 bool bc6hbc7 = false;
@@ -3462,6 +4840,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     bc6hbc7 = true;
 
                     {
+                        std::lock_guard<std::mutex> lock(gpuLock);
+
                         static bool s_tryonce = false;
 
                         if (!s_tryonce)
@@ -3471,11 +4851,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                             if (!(dwOptions & (uint64_t(1) << OPT_NOGPU)))
                             {
                                 if (!CreateDevice(adapter, pDevice.GetAddressOf()))
-                                    wprintf(L"\nWARNING: DirectCompute is not available, using BC6H / BC7 CPU codec\n");
+                                    JobPrint(L"\nWARNING: DirectCompute is not available, using BC6H / BC7 CPU codec\n");
                             }
                             else
                             {
-                                wprintf(L"\nWARNING: using BC6H / BC7 CPU codec\n");
+                                JobPrint(L"\nWARNING: using BC6H / BC7 CPU codec\n");
                             }
                         }
                     }
@@ -3486,12 +4866,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
 
                 TEX_COMPRESS_FLAGS cflags = dwCompress;
-#ifdef _OPENMP
                 if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
                 {
                     cflags |= TEX_COMPRESS_PARALLEL;
                 }
-#endif
 
                 if ((img->width % 4) != 0 || (img->height % 4) != 0)
                 {
@@ -3500,6 +4878,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                 if (bc6hbc7 && pDevice)
                 {
+                    // The immediate context is not free-threaded
+                    std::lock_guard<std::mutex> lock(gpuLock);
                     hr = Compress(pDevice.Get(), img, nimg, info, tformat, dwCompress | dwSRGB, alphaWeight, *timage);
                 }
                 else
@@ -3508,9 +4888,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [compress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    retVal = 1;
-                    continue;
+                    JobPrint(L" FAILED [compress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return JOB_FAILED;
                 }
 
                 auto& tinfo = timage->GetMetadata();
@@ -3524,6 +4903,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 assert(info.miscFlags == tinfo.miscFlags);
                 assert(info.dimension == tinfo.dimension);
 
+                if (dwBenchmark & BENCHMARK_QUALITY)
+                {
+                    hr = ReportQuality(*image, *timage, qflags);
+                    if (FAILED(hr))
+                    {
+                        JobPrint(L" FAILED [benchmark] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                        return JOB_FAILED;
+                    }
+                }
+
                 image.swap(timage);
             }
         }
@@ -3532,6 +4921,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             cimage.reset();
         }
 
+        timer.Mark(fused ? L"fused" : L"compress");
+
         // --- Set alpha mode ----------------------------------------------------------
         if (HasAlpha(info.format)
             && info.format != DXGI_FORMAT_A8_UNORM)
@@ -3565,78 +4956,23 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             size_t nimg = image->GetImageCount();
 
             PrintInfo(info, (FileType == CODEC_DDS) && (dwOptions & (uint64_t(1) << OPT_USE_XBOX)));
-            wprintf(L"\n");
+            JobPrint(L"\n");
 
             // Figure out dest filename
-            wchar_t *pchSlash, *pchDot;
-
             wchar_t szDest[1024] = {};
-            wcscpy_s(szDest, szOutputDir);
-
-            if (keepRecursiveDirs && *pConv->szFolder)
-            {
-                wcscat_s(szDest, pConv->szFolder);
-
-                wchar_t szPath[MAX_PATH] = {};
-                if (!GetFullPathNameW(szDest, MAX_PATH, szPath, nullptr))
-                {
-                    wprintf(L" get full path FAILED (%08X%ls)\n",
-                        static_cast<unsigned int>(HRESULT_FROM_WIN32(GetLastError())), GetErrorDesc(HRESULT_FROM_WIN32(GetLastError())));
-                    retVal = 1;
-                    continue;
-                }
-
-                auto err = static_cast<DWORD>(SHCreateDirectoryExW(nullptr, szPath, nullptr));
-                if (err != ERROR_SUCCESS && err != ERROR_ALREADY_EXISTS)
-                {
-                    wprintf(L" directory creation FAILED (%08X%ls)\n",
-                        static_cast<unsigned int>(HRESULT_FROM_WIN32(err)), GetErrorDesc(HRESULT_FROM_WIN32(err)));
-                    retVal = 1;
-                    continue;
-                }
-            }
-
-            if (*szPrefix)
-                wcscat_s(szDest, szPrefix);
-
-            pchSlash = wcsrchr(pConv->szSrc, L'\\');
-            if (pchSlash)
-                wcscat_s(szDest, pchSlash + 1);
-            else
-                wcscat_s(szDest, pConv->szSrc);
-
-            pchSlash = wcsrchr(szDest, '\\');
-            pchDot = wcsrchr(szDest, '.');
-
-            if (pchDot > pchSlash)
-                *pchDot = 0;
-
-            if (*szSuffix)
-                wcscat_s(szDest, szSuffix);
-
-            if (dwOptions & (uint64_t(1) << OPT_TOLOWER))
-            {
-                std::ignore = _wcslwr_s(szDest);
-            }
-
-            if (wcslen(szDest) > _MAX_PATH)
-            {
-                wprintf(L"\nERROR: Output filename exceeds max-path, skipping!\n");
-                retVal = 1;
-                continue;
-            }
+            if (!makeDestName(pConv, szDest))
+                return JOB_FAILED;
 
             // Write texture
-            wprintf(L"writing %ls", szDest);
+            JobPrint(L"writing %ls", szDest);
             fflush(stdout);
 
             if (~dwOptions & (uint64_t(1) << OPT_OVERWRITE))
             {
                 if (GetFileAttributesW(szDest) != INVALID_FILE_ATTRIBUTES)
                 {
-                    wprintf(L"\nERROR: Output file already exists, use -y to overwrite:\n");
-                    retVal = 1;
-                    continue;
+                    JobPrint(L"\nERROR: Output file already exists, use -y to overwrite:\n");
+                    return JOB_FAILED;
                 }
             }
 
@@ -3674,7 +5010,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 break;
 
             case CODEC_HDR:
-                hr = SaveToHDRFile(img[0], szDest);
+                hr = SaveToHDRFile(img[0],
+                    (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? HDR_FLAGS_NONE : HDR_FLAGS_PARALLEL,
+                    szDest);
                 break;
 
             case CODEC_PPM:
@@ -3763,14 +5101,103 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                JobPrint(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return JOB_FAILED;
+            }
+            JobPrint(L"\n");
+
+            if (*szCached)
+            {
+                // Publish through a temporary name so a concurrent job never reads a partial entry
+                wchar_t szTemp[1024] = {};
+                swprintf_s(szTemp, L"%ls.%lu.%lu.tmp", szCached, GetCurrentProcessId(), GetCurrentThreadId());
+
+                if (!CopyFileW(szDest, szTemp, FALSE)
+                    || !MoveFileExW(szTemp, szCached, MOVEFILE_REPLACE_EXISTING))
+                {
+                    hr = HRESULT_FROM_WIN32(GetLastError());
+                    std::ignore = DeleteFileW(szTemp);
+                    JobPrint(L"WARNING: Failed to add output to cache (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                }
+            }
+
+            if (dwOptions & (uint64_t(1) << OPT_TIMING))
+            {
+                timer.Mark(L"save");
+                timer.Print();
+            }
+        }
+
+        return JOB_OK;
+    };
+
+    JOB_RESULT result = JOB_OK;
+
+    if (jobs > 1 && conversion.size() > 1)
+    {
+        if (dwBenchmark)
+        {
+            wprintf(L"\nWARNING: -benchmark runs one file at a time, ignoring -j\n");
+            jobs = 1;
+        }
+    }
+
+    if (jobs > 1 && conversion.size() > 1)
+    {
+        // Split the hardware threads between the concurrent files
+        if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+        {
+            SetParallelThreadCount(std::max<size_t>(1, std::thread::hardware_concurrency() / jobs));
+        }
+
+        uint64_t budget = uint64_t(jobMemory) * 1024 * 1024;
+        if (!budget)
+        {
+            MEMORYSTATUSEX status = { sizeof(MEMORYSTATUSEX) };
+            budget = GlobalMemoryStatusEx(&status) ? (status.ullTotalPhys / 2) : UINT64_MAX;
+        }
+
+        std::vector<const SConversion*> files;
+        std::vector<uint64_t> costs;
+        files.reserve(conversion.size());
+        costs.reserve(conversion.size());
+        for (const auto& conv : conversion)
+        {
+            files.push_back(&conv);
+            costs.push_back(EstimateJobMemory(conv.szSrc));
+        }
+
+        result = RunJobs(files.size(), costs.data(), jobs, budget,
+            [&](size_t index) -> JOB_RESULT
+            {
+                return convertFile(files[index], index == 0);
+            });
+    }
+    else
+    {
+        bool first = true;
+        for (const auto& conv : conversion)
+        {
+            const JOB_RESULT jr = convertFile(&conv, first);
+            first = false;
+
+            if (jr == JOB_ABORT)
+            {
+                result = JOB_ABORT;
+                break;
+            }
+            else if (jr == JOB_FAILED)
+            {
+                result = JOB_FAILED;
             }
-            wprintf(L"\n");
         }
     }
 
+    if (result == JOB_ABORT)
+        return 1;
+
+    const int retVal = (result == JOB_FAILED) ? 1 : 0;
+
     if (sizewarn)
     {
         wprintf(L"\nWARNING: Target size exceeds maximum size for feature level (%u)\n", maxSize);
@@ -3785,6 +5212,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     if (non4bc)
         wprintf(L"\nWARNING: Direct3D requires BC image to be multiple of 4 in width & height\n");
 
+    if (*szCacheDir)
+    {
+        wprintf(L"\n Cache: %zu hits, %zu misses\n", cacheHits.load(), cacheMisses.load());
+    }
+
     if (dwOptions & (uint64_t(1) << OPT_TIMING))
     {
         LARGE_INTEGER qpcEnd = {};